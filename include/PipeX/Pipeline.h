@@ -6,10 +6,12 @@
 #define PIPEX_PIPELINE_H
 
 
+#include <chrono>
 #include <string>
 #include <list>
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "PipeX/debug/pipex_print_debug.h"
 #include "my_extended_cpp_standard/my_memory.h"
@@ -21,6 +23,7 @@
 #include "errors/NodeNameConflictException.h"
 #include "errors/PipeX_IO_Exception.h"
 #include "errors/TypeMismatchExpection.h"
+#include "utils/block_timing_utils.h"
 
 
 
@@ -92,6 +95,10 @@ namespace PipeX {
                 }
                 hasSourceNode = _pipeline.hasSourceNode;
                 hasSinkNode = _pipeline.hasSinkNode;
+                nodeFusionEnabled = _pipeline.nodeFusionEnabled;
+                realTimeMode = _pipeline.realTimeMode;
+                realTimeBudget = _pipeline.realTimeBudget;
+                invalidateExecutionPlan();
             }
 
             return *this;
@@ -107,7 +114,10 @@ namespace PipeX {
         Pipeline(const Pipeline& _pipeline) : name(_pipeline.name + "_copy"),
                                               nodesNameSet(_pipeline.nodesNameSet),
                                               hasSourceNode(_pipeline.hasSourceNode),
-                                              hasSinkNode(_pipeline.hasSinkNode) {
+                                              hasSinkNode(_pipeline.hasSinkNode),
+                                              nodeFusionEnabled(_pipeline.nodeFusionEnabled),
+                                              realTimeMode(_pipeline.realTimeMode),
+                                              realTimeBudget(_pipeline.realTimeBudget) {
             PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p}.Constructor(&)\n", name.c_str(), this);
             for (const auto& node : _pipeline.nodes) {
                 nodes.push_back(node->clone());
@@ -126,8 +136,12 @@ namespace PipeX {
                                               nodesNameSet(std::move(_pipeline.nodesNameSet)),
                                               nodes(std::move(_pipeline.nodes)),
                                               hasSourceNode(_pipeline.hasSourceNode),
-                                              hasSinkNode(_pipeline.hasSinkNode){
+                                              hasSinkNode(_pipeline.hasSinkNode),
+                                              nodeFusionEnabled(_pipeline.nodeFusionEnabled),
+                                              realTimeMode(_pipeline.realTimeMode),
+                                              realTimeBudget(_pipeline.realTimeBudget) {
             PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p}.Constructor(&)\n", name.c_str(), this);
+            _pipeline.invalidateExecutionPlan();
         }
 
         /**
@@ -145,8 +159,14 @@ namespace PipeX {
 
                 this->hasSourceNode = _pipeline.hasSourceNode;
                 this->hasSinkNode = _pipeline.hasSinkNode;
+                this->nodeFusionEnabled = _pipeline.nodeFusionEnabled;
+                this->realTimeMode = _pipeline.realTimeMode;
+                this->realTimeBudget = _pipeline.realTimeBudget;
                 _pipeline.hasSourceNode = false;
                 _pipeline.hasSinkNode = false;
+
+                invalidateExecutionPlan();
+                _pipeline.invalidateExecutionPlan();
             }
 
             return *this;
@@ -172,6 +192,7 @@ namespace PipeX {
 
                 PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p}.addNode(\"%s\")&\n", name.c_str(), this, newNode->getName().c_str());
                 nodes.push_back(std::move(newNode));
+                invalidateExecutionPlan();
 
             } catch (InvalidPipelineException& e) {
                 PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p}.addNode() -> InvalidPipelineException: %s\n", name.c_str(), this, e.what());
@@ -213,6 +234,7 @@ namespace PipeX {
 
                     nodes.erase(it);
                     nodesNameSet.erase(nodeName);
+                    invalidateExecutionPlan();
                     return *this;
                 }
             }
@@ -228,6 +250,13 @@ namespace PipeX {
          * After all nodes have processed the data, the IData elements are dynamic_cast back
          * to Data<OutputT> and their contained values are extracted into the returned vector.
          *
+         * A streaming Source (see INode::hasPendingData) produces its data in blocks: the nodes are run
+         * once per block, until the Source is exhausted. Then every node is notified of the end of the
+         * stream (INode::endOfStream), in pipeline order. If a node throws, every node is notified as well
+         * before the exception is rethrown, so the pipeline can be run again.
+         *
+         * In real-time mode every block is timed, from the Source to the Sink, against its deadline (see
+         * setRealTimeMode); the results are available from getBlockTimingReport() until the next run.
          *
          * @throws TypeMismatchException If any intermediate or final IData cannot be cast to the
          *         expected Data<OutputT> type.
@@ -241,39 +270,50 @@ namespace PipeX {
                 throw InvalidPipelineException(this->name, "Cannot run pipeline, invalid configuration:" + details);
             }
 
-            std::unique_ptr<IData> data;
             // std::cout << "Valid pipeline \"" << name << "\" starting execution with " << nodes.size() << " nodes." << std::endl;
-            // Process through nodes
-            for (const auto& node : nodes) {
-                try {
-                    PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p} :: run() -> processing node \"%s\"\n", name.c_str(), this, node->getName().c_str());
-
-                    data = node->process(std::move(data));
-                } catch (TypeMismatchException &e) {
-                    std::string err = "TypeMismatchException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeXException(err);
-                } catch (MetadataTypeMismatchException &e) {
-                    std::string err = "MetadataTypeMismatchException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeXException(err);
-                } catch (InvalidOperation &e) {
-                    std::string err = "InvalidOperation in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeXException(err);
-                } catch (PipeX_IO_Exception &e) {
-                    std::string err = "PipeX_IO_Exception in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeX_IO_Exception(err);
-                } catch (PipeXException &e) {
-                    std::string err = "PipeXException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeXException(err);
-                } catch (std::exception &e) {
-                    std::string err = "Unknown exception in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
-                    // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
-                    throw PipeXException(err);
+            // Process through nodes (adjacent fusible nodes are executed as a single fused node)
+            const auto& plan = executionPlan();
+            timingReport.reset();
+            try {
+                do {
+                    const auto blockBegin = std::chrono::steady_clock::now();
+                    std::unique_ptr<IData> data;
+                    for (const auto node : plan) {
+                        PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p} :: run() -> processing node \"%s\"\n", name.c_str(), this, node->getName().c_str());
+
+                        runNodeStep(node, [node, &data]() { data = node->process(std::move(data)); });
+                    }
+
+                    if (realTimeMode) {
+                        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - blockBegin).count();
+                        const double deadline = plan.front()->blockDuration() * realTimeBudget;
+                        if (timingReport.record(seconds, deadline)) {
+                            PIPEX_PRINT_DEBUG_WARN("[Pipeline] \"%s\" {%p} :: run() -> block %zu missed its deadline: %.3f ms > %.3f ms\n",
+                                                   name.c_str(), this, timingReport.blocks - 1, seconds * 1e3, deadline * 1e3);
+                        }
+                    }
+                } while (plan.front()->hasPendingData());
+            } catch (...) {
+                // The stream is aborted: the nodes still release what they hold (open files, stream positions), so
+                // the pipeline can run again
+                for (const auto node : plan) {
+                    try {
+                        node->endOfStream();
+                    } catch (...) {
+                        // Already failing: the first error is the one reported
+                    }
                 }
+                throw;
+            }
+
+            for (const auto node : plan) {
+                runNodeStep(node, [node]() { node->endOfStream(); });
+            }
+
+            if (realTimeMode) {
+                PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p} :: run() -> %zu blocks, %zu deadline misses, worst %.3f ms, load %.1f%%\n",
+                                       name.c_str(), this, timingReport.blocks, timingReport.deadlineMisses, timingReport.worstSeconds * 1e3,
+                                       timingReport.averageLoad() * 100.0);
             }
 
             // std::cout << "***Pipeline \"" << name << "\" execution completed." << std::endl;
@@ -286,6 +326,67 @@ namespace PipeX {
          */
         std::string getName() const { return name; }
 
+        /**
+         * @brief Enables or disables the fusion of adjacent nodes (enabled by default).
+         *
+         * When enabled, consecutive nodes that support fusion (see INode::canFuseWith, e.g. image point
+         * operations) are executed as a single node in one pass over the data.
+         *
+         * @param enabled true to enable node fusion.
+         * @return Reference to this pipeline (allows chaining).
+         */
+        Pipeline& setNodeFusion(const bool enabled) & {
+            nodeFusionEnabled = enabled;
+            invalidateExecutionPlan();
+            return *this;
+        }
+
+        /**
+         * @brief Enables or disables the real-time mode (disabled by default).
+         *
+         * In real-time mode run() measures the processing time of every block, from the Source to the Sink, and
+         * compares it with the deadline of the block: the real-time length of its data (INode::blockDuration of the
+         * Source, e.g. the frames of an audio block over the sample rate) times the budget. Blocks taking longer are
+         * counted as deadline misses and logged; see getBlockTimingReport(). Use a streaming Source with fixed-size
+         * blocks (e.g. WAV_Audio_Source with 64 to 1024 frames) to measure the latency budget of a block length.
+         *
+         * @param enabled true to time the blocks.
+         * @param budget Fraction of the duration of a block available to process it (e.g. 0.5 to keep half of it
+         *               for the rest of the system).
+         * @return Reference to this pipeline (allows chaining).
+         * @throws InvalidOperation if budget is not positive.
+         */
+        Pipeline& setRealTimeMode(const bool enabled, const double budget = 1.0) & {
+            if (!(budget > 0.0)) {
+                throw InvalidOperation("Pipeline::setRealTimeMode", "budget must be positive");
+            }
+            realTimeMode = enabled;
+            realTimeBudget = budget;
+            return *this;
+        }
+
+        bool isRealTimeMode() const { return realTimeMode; }
+
+        /**
+         * @brief Timing of the blocks of the last run() in real-time mode (empty otherwise).
+         */
+        const BlockTimingReport& getBlockTimingReport() const { return timingReport; }
+
+        /**
+         * @brief Get the names of the nodes as they are executed by run(), after node fusion.
+         *
+         * A group of fused nodes appears as a single entry (e.g. "fused(A + B)").
+         *
+         * @return Node names in execution order.
+         */
+        std::vector<std::string> getExecutionPlan() const {
+            std::vector<std::string> names;
+            for (const auto node : executionPlan()) {
+                names.push_back(node->getName());
+            }
+            return names;
+        }
+
         bool isValid(std::string& details) const {
             if (!hasSourceNode) {
                 details = " missing Source node";
@@ -314,6 +415,84 @@ namespace PipeX {
 
         bool hasSourceNode = false;
         bool hasSinkNode = false;
+        bool nodeFusionEnabled = true;
+        bool realTimeMode = false;
+        double realTimeBudget = 1.0;
+        /// Block timing of the last run, in real-time mode
+        mutable BlockTimingReport timingReport;
+
+        /**
+         * @brief Cached execution plan: the nodes run() goes through, with fusible runs replaced by fused nodes.
+         *
+         * Rebuilt lazily after any change to the node list. Fused nodes are owned by \c fusedNodes.
+         */
+        mutable std::vector<INode*> executionPlanNodes;
+        mutable std::list<std::unique_ptr<INode>> fusedNodes;
+        mutable bool executionPlanValid = false;
+
+        void invalidateExecutionPlan() {
+            executionPlanValid = false;
+            executionPlanNodes.clear();
+            fusedNodes.clear();
+        }
+
+        const std::vector<INode*>& executionPlan() const {
+            if (executionPlanValid) {
+                return executionPlanNodes;
+            }
+
+            executionPlanNodes.clear();
+            fusedNodes.clear();
+            for (const auto& node : nodes) {
+                if (nodeFusionEnabled && !executionPlanNodes.empty() && executionPlanNodes.back()->canFuseWith(*node)) {
+                    auto fusedNode = executionPlanNodes.back()->fuseWith(*node);
+                    if (fusedNode) {
+                        PIPEX_PRINT_DEBUG_INFO("[Pipeline] \"%s\" {%p} :: executionPlan() -> fused node \"%s\"\n", name.c_str(), this, fusedNode->getName().c_str());
+                        fusedNodes.push_back(std::move(fusedNode));
+                        executionPlanNodes.back() = fusedNodes.back().get();
+                        continue;
+                    }
+                }
+                executionPlanNodes.push_back(node.get());
+            }
+
+            executionPlanValid = true;
+            return executionPlanNodes;
+        }
+
+        /**
+         * @brief Runs one step of a node, rethrowing its exceptions with the pipeline and node names.
+         */
+        template <typename Step>
+        void runNodeStep(const INode* node, Step&& step) const {
+            try {
+                step();
+            } catch (TypeMismatchException &e) {
+                std::string err = "TypeMismatchException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeXException(err);
+            } catch (MetadataTypeMismatchException &e) {
+                std::string err = "MetadataTypeMismatchException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeXException(err);
+            } catch (InvalidOperation &e) {
+                std::string err = "InvalidOperation in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeXException(err);
+            } catch (PipeX_IO_Exception &e) {
+                std::string err = "PipeX_IO_Exception in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeX_IO_Exception(err);
+            } catch (PipeXException &e) {
+                std::string err = "PipeXException in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeXException(err);
+            } catch (std::exception &e) {
+                std::string err = "Unknown exception in pipeline '" + name + "' at node '" + node->getName() + "': " + e.what();
+                // PIPEX_PRINT_DEBUG_ERROR("[Pipeline] \"%s\" {%p} :: run() -> %s\n", name.c_str(), this, err.c_str());
+                throw PipeXException(err);
+            }
+        }
 
         /**
          * @brief Checks pipeline integrity rules before adding a node.
@@ -8,11 +8,23 @@
 #include "PipeX/metadata/IMetadata.h"
 
 namespace PipeX {
+    /**
+     * @brief Colour space of the channels of an image.
+     *
+     * All channels span [0, bit_depth]: chroma channels are offset by (bit_depth + 1) / 2 and the HSV hue
+     * maps [0, 360) degrees to [0, bit_depth].
+     */
+    enum class ColorSpace {
+        RGB,
+        YCbCr, ///< ITU-R BT.601 full range (JPEG): Y, Cb, Cr
+        HSV    ///< Hue, saturation, value
+    };
+
     /**
      * @brief Metadata for PPM image format.
      *
-     * Stores information about the image such as dimensions and bit depth.
-     * The number of channels is fixed to 3 (RGB).
+     * Stores information about the image such as dimensions, bit depth and colour space.
+     * The number of channels is fixed to 3 (RGB, or the components of color_space).
      */
     class PPM_Metadata final : public IMetadata {
     public:
@@ -23,8 +35,11 @@ namespace PipeX {
         int width{};
         int height{};
 
+        ColorSpace color_space = ColorSpace::RGB;
+
         PPM_Metadata() = default;
-        PPM_Metadata(int bit_depth, int width, int height);
+        PPM_Metadata(const int bit_depth, const int width, const int height, const ColorSpace color_space = ColorSpace::RGB)
+            : bit_depth(bit_depth), width(width), height(height), color_space(color_space) {}
 
 
     };
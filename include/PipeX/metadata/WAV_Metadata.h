@@ -32,6 +32,17 @@ namespace PipeX {
         uint32_t dataSize{};
         uint32_t riffSize{};
 
+        // Streaming
+        /**
+         * @brief Position, in samples per channel, of the buffers in their stream (streaming sources emit blocks).
+         *
+         * Audio nodes that keep state from one buffer to the next keep it per stream of the batch (the i-th buffer of
+         * every batch belongs to stream i) and per channel, so the blocks of a stream are processed as one continuous
+         * signal. A buffer with blockStart == 0 starts a stream, restarting its state from silence; a buffer with
+         * blockStart + numFrames >= numSamples, or any buffer if numSamples == 0, ends it.
+         */
+        uint32_t blockStart{};
+
         WAV_Metadata() = default;
 
         WAV_Metadata(const uint16_t numChannels, const uint32_t sampleRate, const uint16_t bitsPerSample, const uint32_t durationSec) :
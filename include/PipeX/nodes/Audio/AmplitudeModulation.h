@@ -12,6 +12,7 @@
 #include "PipeX/metadata/WAV_Metadata.h"
 #include "PipeX/nodes/primitives/Transformer.h"
 #include "PipeX/utils/sound_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -21,31 +22,52 @@ namespace PipeX {
     /**
      * @brief Transformer node that applies amplitude modulation to audio data.
      *
-     * Modulates the amplitude of the input audio signal using a sine wave (Low Frequency Modulator).
+     * Modulates the amplitude of the input audio signal using a sine wave (Low Frequency Modulator). The modulator is
+     * generated in float by a vectorized recurrence oscillator (sineOscillator) and applied in place to every channel;
+     * long buffers are split into frame ranges processed in parallel on the shared ThreadPool. Its phase follows
+     * WAV_Metadata::blockStart, so the blocks of a stream are modulated as a single continuous signal.
      */
     class AmplitudeModulation final : public Transformer<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
     public:
         AmplitudeModulation(std::string node_name, double rateHz, double depth)
-            : Transformer(std::move(node_name), [this, rateHz, depth] (WAV_AudioBuffer& input) mutable  {
-                rateHz = std::abs(rateHz);
-                depth = this->clamp(depth, 0.0, 1.0);
-                return this->applyAmplitudeModulation(input, rateHz, depth);
-            }) {
+            : Transformer(std::move(node_name), [this] (WAV_AudioBuffer& input) {
+                return this->applyAmplitudeModulation(input);
+            }), rateHz_(std::abs(rateHz)), depth_(clamp(depth, 0.0, 1.0)) {
             this->logLifeCycle("AmplitudeModulation(std::string node_name, double modulationIndex, double modulationFrequency)");
         }
 
     private:
-        WAV_AudioBuffer applyAmplitudeModulation(WAV_AudioBuffer& data, double rateHz, double depth) const {
+        /// Frames modulated by each task of the thread pool
+        static constexpr std::size_t framesPerTask = 1 << 15;
+
+        const double rateHz_;
+        const double depth_;
+
+        WAV_AudioBuffer applyAmplitudeModulation(WAV_AudioBuffer& data) const {
             const auto& metadata = this->getMetadata();
-            const double sampleRate = static_cast<double>(metadata->sampleRate);
-            WAV_AudioBuffer modulatedData(data.size());
+            const double increment = 2.0 * M_PI * rateHz_ / static_cast<double>(metadata->sampleRate);
+            // Phase of the first frame of the buffer in the stream (0 for whole buffers)
+            const double phase = std::fmod(increment * metadata->blockStart, 2.0 * M_PI);
+            // (1 + depth * sin) / 2
+            const auto amplitude = static_cast<float>(depth_ / 2.0);
 
-            for (std::size_t n = 0; n < data.size(); ++n) {
-                double modulation = (1.0 + depth * sin(2.0 * M_PI * rateHz * n / sampleRate)) / 2.0;
-                modulatedData[n] = static_cast<bit_depth_t>(data[n] * modulation);
-            }
+            // In place: float samples need no intermediate buffer nor requantization
+            data.setLayout(AudioLayout::Planar);
+            const std::size_t taskFrames = framesPerTask;
+            const std::size_t nTasks = (data.numFrames + taskFrames - 1) / taskFrames;
+            ThreadPool::getThreadPool().parallelFor(0, nTasks, [&](const std::size_t task) {
+                audio_sample_t modulation[oscillatorReseed];
+                const std::size_t end = data.numFrames - task * taskFrames < taskFrames ? data.numFrames : (task + 1) * taskFrames;
+                for (std::size_t n = task * taskFrames; n < end; n += oscillatorReseed) {
+                    const std::size_t count = end - n < oscillatorReseed ? end - n : oscillatorReseed;
+                    sineOscillator(modulation, count, phase + static_cast<double>(n) * increment, increment, amplitude, 0.5f);
+                    for (std::size_t c = 0; c < data.numChannels; ++c) {
+                        multiply(data.channel(c) + n, modulation, count);
+                    }
+                }
+            });
 
-            return modulatedData;
+            return std::move(data);
         }
 
         static double clamp(const double& v, const double& lo, const double& hi) {
@@ -6,11 +6,16 @@
 #define PIPEX_EQ_BELLCURVE_HPP
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "PipeX/metadata/WAV_Metadata.h"
-#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/nodes/primitives/Processor.h"
 #include "PipeX/utils/sound_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -18,28 +23,50 @@
 
 namespace PipeX {
     /**
-     * @brief Transformer node that applies a bell curve equalization filter.
+     * @brief Processor node that applies a bell curve equalization filter.
      *
-     * Implements a peaking EQ filter using a biquad implementation.
+     * Implements a peaking EQ filter using a biquad implementation. Every channel has its own filter state: all the
+     * channels of all the (planar) buffers of the batch are filtered in parallel on the shared ThreadPool. The state
+     * follows the streams of the batch (see WAV_Metadata::blockStart).
+     * See ParametricEQ to apply several bands in a single pass.
      */
-    class EQ_BellCurve final : public Transformer<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
+    class EQ_BellCurve final : public Processor<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
     public:
-        EQ_BellCurve(std::string node_name, double centerFrequency, double qFactor, double gainDB)
-            : Transformer(std::move(node_name), [this, centerFrequency, qFactor, gainDB] (WAV_AudioBuffer& input) {
-                return this->applyEQ(input, centerFrequency, qFactor, gainDB);
-            }) {
+        EQ_BellCurve(std::string node_name, const double centerFrequency, const double qFactor, const double gainDB)
+            : Processor(std::move(node_name), [this] (std::vector<WAV_AudioBuffer>& batch) {
+                return this->applyEQ(batch);
+            }), centerFrequency_(centerFrequency), qFactor_(qFactor), gainDB_(gainDB) {
             this->logLifeCycle("EQ_BellCurve(std::string node_name, double centerFrequency, double qFactor, double gainDB)");
         }
 
+    protected:
+        void preProcessHook() const override {
+            const std::uint32_t sampleRate = this->getMetadata()->sampleRate;
+            if (sampleRate != sampleRate_) {
+                prototype_ = makePeakingEQ(centerFrequency_, qFactor_, gainDB_, sampleRate);
+                sampleRate_ = sampleRate;
+                for (auto& stream : streams_) {
+                    for (auto& eq : stream) {
+                        eq.setCoefficients(prototype_);
+                    }
+                }
+            }
+        }
+
+        std::string typeName() const override {
+            return "EQ_BellCurve";
+        }
+
     private:
+        /// Coefficients are computed in double, samples and state are float32 like the audio buffers
         struct Biquad {
-            double b0, b1, b2;
-            double a1, a2;
-            double x1 = 0, x2 = 0;
-            double y1 = 0, y2 = 0;
+            float b0, b1, b2;
+            float a1, a2;
+            float x1 = 0, x2 = 0;
+            float y1 = 0, y2 = 0;
 
-            double process(double x) {
-                const double y = b0*x + b1*x1 + b2*x2
+            float process(float x) {
+                const float y = b0*x + b1*x1 + b2*x2
                            - a1*y1 - a2*y2;
                 x2 = x1;
                 x1 = x;
@@ -47,17 +74,60 @@ namespace PipeX {
                 y1 = y;
                 return y;
             }
+
+            void setCoefficients(const Biquad& other) {
+                b0 = other.b0;
+                b1 = other.b1;
+                b2 = other.b2;
+                a1 = other.a1;
+                a2 = other.a2;
+            }
         };
 
-        WAV_AudioBuffer applyEQ(WAV_AudioBuffer& data, double centerFrequency, double qFactor, double gainDB) const {
-            const auto& metadata = this->getMetadata();
+        const double centerFrequency_;
+        const double qFactor_;
+        const double gainDB_;
+
+        mutable std::uint32_t sampleRate_ = 0;
+        /// Coefficients for sampleRate_, with a silent state
+        mutable Biquad prototype_{};
+
+        /// Filter of every channel of every stream of the batch
+        mutable std::vector<std::vector<Biquad>> streams_;
+
+        std::vector<WAV_AudioBuffer> applyEQ(std::vector<WAV_AudioBuffer>& batch) const {
+            const bool streamStart = this->getMetadata()->blockStart == 0;
+            if (streams_.size() < batch.size()) {
+                streams_.resize(batch.size());
+            }
 
-            Biquad eq = makePeakingEQ(centerFrequency, qFactor, gainDB, metadata->sampleRate);
-            for (auto& sample: data) {
-                sample = eq.process(sample);
+            // (stream, channel) of every task
+            std::vector<std::pair<std::size_t, std::size_t>> tasks;
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                WAV_AudioBuffer& data = batch[i];
+                std::vector<Biquad>& filters = streams_[i];
+                if (streamStart || filters.size() != data.numChannels) {
+                    filters.assign(data.numChannels, prototype_);
+                }
+
+                data.setLayout(AudioLayout::Planar);
+                for (std::size_t c = 0; c < data.numChannels; ++c) {
+                    tasks.emplace_back(i, c);
+                }
             }
 
-            return data;
+            ThreadPool::getThreadPool().parallelFor(0, tasks.size(), [this, &batch, &tasks](const std::size_t t) {
+                WAV_AudioBuffer& data = batch[tasks[t].first];
+                Biquad& filter = streams_[tasks[t].first][tasks[t].second];
+                Biquad eq = filter;
+                audio_sample_t* samples = data.channel(tasks[t].second);
+                for (std::size_t n = 0; n < data.numFrames; ++n) {
+                    samples[n] = eq.process(samples[n]);
+                }
+                filter = eq;
+            });
+
+            return std::move(batch);
         }
 
 
@@ -75,11 +145,11 @@ namespace PipeX {
             const double a1 = -2 * cos(w0);
             const double a2 = 1 - alpha / A;
 
-            eq.b0 = b0 / a0;
-            eq.b1 = b1 / a0;
-            eq.b2 = b2 / a0;
-            eq.a1 = a1 / a0;
-            eq.a2 = a2 / a0;
+            eq.b0 = static_cast<float>(b0 / a0);
+            eq.b1 = static_cast<float>(b1 / a0);
+            eq.b2 = static_cast<float>(b2 / a0);
+            eq.a1 = static_cast<float>(a1 / a0);
+            eq.a2 = static_cast<float>(a2 / a0);
 
             return eq;
         }
@@ -0,0 +1,125 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_PARAMETRIC_EQ_H
+#define PIPEX_PARAMETRIC_EQ_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/primitives/Processor.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/sound_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief A band of a ParametricEQ (Audio EQ Cookbook filters).
+     */
+    struct EQ_Band {
+        enum class Type {
+            Peaking,    ///< Bell curve around frequency, gainDB at its center
+            LowShelf,   ///< gainDB below frequency
+            HighShelf,  ///< gainDB above frequency
+            LowPass,    ///< Second order low-pass (gainDB ignored)
+            HighPass    ///< Second order high-pass (gainDB ignored)
+        };
+
+        Type type = Type::Peaking;
+        double frequency = 1000.0;  ///< Center or corner frequency in Hz
+        double q = 0.7071;          ///< Quality factor (bandwidth, or shelf slope)
+        double gainDB = 0.0;
+
+        EQ_Band() = default;
+        EQ_Band(const Type _type, const double _frequency, const double _q, const double _gainDB = 0.0)
+            : type(_type), frequency(_frequency), q(_q), gainDB(_gainDB) {}
+
+        static EQ_Band peaking(const double frequency, const double q, const double gainDB) { return {Type::Peaking, frequency, q, gainDB}; }
+        static EQ_Band lowShelf(const double frequency, const double q, const double gainDB) { return {Type::LowShelf, frequency, q, gainDB}; }
+        static EQ_Band highShelf(const double frequency, const double q, const double gainDB) { return {Type::HighShelf, frequency, q, gainDB}; }
+        static EQ_Band lowPass(const double frequency, const double q) { return {Type::LowPass, frequency, q}; }
+        static EQ_Band highPass(const double frequency, const double q) { return {Type::HighPass, frequency, q}; }
+    };
+
+    /**
+     * @brief Processor node applying a cascade of biquad filters (peaking, shelf, low/high-pass bands) in a single pass.
+     *
+     * The filters run in transposed direct form II, in float. Every channel of every stream of the batch is a signal;
+     * signals of the same length are packed by SIMD width (8 with AVX2, 4 otherwise), a vector holding the same frame
+     * of the signals of its group, so a batch of mono streams fills the lanes as well as a single buffer with many
+     * channels. Each group is processed in blocks of frames small enough to stay in cache, every band of the cascade
+     * running over the block in turn, and the groups are filtered in parallel on the shared ThreadPool.
+     *
+     * Coefficients are computed in double when the bands or the sample rate change, not for every batch.
+     * The filter state follows the streams of the batch (see WAV_Metadata::blockStart).
+     */
+    class ParametricEQ final : public Processor<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
+    public:
+        ParametricEQ(std::string node_name, std::vector<EQ_Band> bands);
+
+        const std::vector<EQ_Band>& bands() const { return bands_; }
+
+        /**
+         * @brief Replaces the bands (the coefficients are recomputed by the next run, the filter state is kept if the
+         * number of bands does not change).
+         */
+        ParametricEQ& setBands(std::vector<EQ_Band> bands);
+
+        /**
+         * @brief Replaces band index.
+         */
+        ParametricEQ& setBand(std::size_t index, const EQ_Band& band);
+
+    protected:
+        void preProcessHook() const override;
+
+        std::string typeName() const override {
+            return "ParametricEQ";
+        }
+
+    private:
+        /// Signals filtered together, one per SIMD lane
+#if defined(PIPEX_SIMD_AVX2)
+        static constexpr std::size_t lanes = 8;
+#else
+        static constexpr std::size_t lanes = 4;
+#endif
+        /// Frames transposed and filtered at a time (lanes * blockFrames floats stay in L1)
+        static constexpr std::size_t blockFrames = 128;
+
+        /// Normalized coefficients (a0 = 1)
+        struct Coefficients {
+            float b0, b1, b2, a1, a2;
+        };
+
+        /// Filter state of a stream: s1, s2 of every band, channel after channel
+        struct StreamState {
+            std::size_t numChannels = 0;
+            std::vector<float> state;
+        };
+
+        /// A channel of a stream of the batch, with its filter state
+        struct Signal {
+            audio_sample_t* samples;
+            std::size_t numFrames;
+            float* state;
+        };
+
+        std::vector<EQ_Band> bands_;
+        mutable bool dirty_ = true;
+        mutable std::uint32_t sampleRate_ = 0;
+        mutable std::vector<Coefficients> coefficients_;
+
+        mutable std::vector<StreamState> streams_;
+
+        static Coefficients design(const EQ_Band& band, double sampleRate);
+
+        std::vector<WAV_AudioBuffer> applyEQ(std::vector<WAV_AudioBuffer>& batch) const;
+        void filterGroup(const Signal* signals, std::size_t count) const;
+    };
+}
+
+#endif //PIPEX_PARAMETRIC_EQ_H
@@ -0,0 +1,103 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_PARTITIONED_CONVOLUTION_H
+#define PIPEX_PARTITIONED_CONVOLUTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/primitives/Processor.h"
+#include "PipeX/utils/fft_utils.h"
+#include "PipeX/utils/sound_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Processor node convolving audio with a long impulse response (FIR filter, reverb) in the frequency domain.
+     *
+     * Uniformly partitioned overlap-save: the impulse response is split into partitions of partitionSize samples,
+     * transformed once at construction (FFT of 2 * partitionSize, plan from FFT::plan). Each partition of input is
+     * transformed once and kept in a frequency-domain delay line; an output partition is the inverse transform of
+     * the sum of the delay line times the impulse response spectra (SIMD complex multiply-adds), so the cost per
+     * sample grows with log(partitionSize) and the number of partitions instead of the length of the response.
+     *
+     * No latency is added: when a buffer ends in the middle of a partition, the partial partition is transformed
+     * zero-padded to produce its samples (the contribution of the previous partitions is computed once per partition),
+     * so buffers of any size are convolved exactly. The output has the length of the input (the tail of the response
+     * past the end of the stream is not emitted).
+     *
+     * A mono impulse response is applied to every channel, otherwise it must have one channel per channel of the
+     * audio. The delay lines follow the streams of the batch (see WAV_Metadata::blockStart).
+     * All the channels of all the streams of a batch are convolved in parallel on the shared ThreadPool.
+     */
+    class PartitionedConvolution final : public Processor<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
+    public:
+        /**
+         * @param impulseResponse Impulse response, one channel or one per channel of the audio.
+         * @param partitionSize Samples per partition, a power of two: larger partitions need fewer operations per
+         *                      sample, smaller ones less work per partition.
+         * @param sampleRate Sample rate of the impulse response, checked against WAV_Metadata::sampleRate (0 = any).
+         * @throws InvalidOperation if the impulse response is empty or partitionSize is not a power of two.
+         */
+        PartitionedConvolution(std::string node_name, WAV_AudioBuffer impulseResponse, std::size_t partitionSize = 512, std::uint32_t sampleRate = 0);
+
+        /**
+         * @brief Loads the impulse response from a PCM WAV file.
+         *
+         * @throws PipeX_IO_Exception if the file cannot be read.
+         */
+        PartitionedConvolution(std::string node_name, const std::string& impulseResponseFile, std::size_t partitionSize = 512);
+
+        std::size_t partitionSize() const { return partitionSize_; }
+        std::size_t partitions() const { return partitions_; }
+        std::size_t impulseResponseChannels() const { return irChannels_; }
+
+    protected:
+        void preProcessHook() const override;
+
+        std::string typeName() const override {
+            return "PartitionedConvolution";
+        }
+
+    private:
+        /// Convolution state of a channel of a stream
+        struct ChannelState {
+            /// Previous partition of input followed by the current one (zero-padded past fill)
+            std::vector<float> window;
+            std::size_t fill = 0;
+            /// Spectra of the last partitions of input: a ring of partitions - 1 spectra, newest at head
+            std::vector<float> delayRe, delayIm;
+            std::size_t head = 0;
+            /// Contribution of the previous partitions to the current output partition
+            std::vector<float> pastRe, pastIm;
+        };
+
+        struct StreamState {
+            std::size_t numChannels = 0;
+            std::vector<ChannelState> channels;
+        };
+
+        const std::size_t partitionSize_;
+        std::shared_ptr<const FFT> plan_;
+        std::uint32_t sampleRate_;
+        std::size_t irChannels_ = 0;
+        std::size_t partitions_ = 0;
+        /// Spectra of the partitions of every channel of the impulse response: partition p of channel c at (c * partitions + p) * bins
+        std::vector<float> irRe_, irIm_;
+
+        mutable std::vector<StreamState> streams_;
+
+        void prepare(WAV_AudioBuffer impulseResponse);
+
+        std::vector<WAV_AudioBuffer> convolve(std::vector<WAV_AudioBuffer>& batch) const;
+        void convolveChannel(audio_sample_t* samples, std::size_t numFrames, std::size_t irChannel, ChannelState& state) const;
+        void resetChannel(ChannelState& state) const;
+    };
+}
+
+#endif //PIPEX_PARTITIONED_CONVOLUTION_H
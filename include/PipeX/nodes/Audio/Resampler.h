@@ -0,0 +1,99 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_RESAMPLER_H
+#define PIPEX_RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/primitives/Processor.h"
+#include "PipeX/utils/sound_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Filter length of a Resampler, trading speed for stopband attenuation and passband width.
+     */
+    enum class ResamplerQuality {
+        Fast,   ///< 16 taps per output sample, ~60 dB stopband, passband up to ~77% of the lower Nyquist frequency
+        Medium, ///< 32 taps per output sample, ~80 dB stopband, passband up to ~84% of the lower Nyquist frequency
+        High    ///< 64 taps per output sample, ~100 dB stopband, passband up to ~90% of the lower Nyquist frequency
+    };
+
+    /**
+     * @brief Processor node converting audio to another sample rate with a polyphase FIR filter.
+     *
+     * The ratio targetRate / sampleRate is reduced to L / M: output sample j is the input upsampled by L, low-pass
+     * filtered (Kaiser-windowed sinc) and decimated by M, which only needs one of the L phases of the filter per
+     * output sample. The phases are tabulated (each normalized to unit DC gain) when the input sample rate changes,
+     * and every output sample is a SIMD inner product of its phase with the last input samples; all the channels of
+     * all the streams of a batch are resampled in parallel on the shared ThreadPool. When downsampling, the taps are
+     * multiplied by ceil(M / L) so the filter keeps its transition band at the lower rate.
+     *
+     * The group delay of the filter is compensated: output sample j is aligned with the input time j * M / L. To do
+     * so the node looks ahead half the filter length, so a buffer emits the output samples whose inputs it has, and the
+     * last buffer of a stream emits the rest, the input past the end being silence. A stream in blocks is thus
+     * resampled exactly like a single buffer, and a whole stream gives ceil(numSamples * L / M) samples; the blocks of
+     * a stream may however differ in length from the input ones. The input samples needed by the next buffer are the
+     * state of the stream (see WAV_Metadata::blockStart for the streams of a batch, their start and their end).
+     *
+     * The metadata is updated to the output: sampleRate, numSamples, blockStart and the derived byteRate, dataSize
+     * and riffSize.
+     */
+    class Resampler final : public Processor<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata> {
+    public:
+        /**
+         * @throws InvalidOperation if targetRate is 0.
+         */
+        Resampler(std::string node_name, std::uint32_t targetRate, ResamplerQuality quality = ResamplerQuality::Medium);
+
+        std::uint32_t targetRate() const { return targetRate_; }
+        ResamplerQuality quality() const { return quality_; }
+
+    protected:
+        void preProcessHook() const override;
+        void postProcessHook() const override;
+
+        std::string typeName() const override {
+            return "Resampler";
+        }
+
+    private:
+        /// Input samples kept by a stream for the next buffer: taps - 1 per channel
+        struct StreamState {
+            std::size_t numChannels = 0;
+            std::vector<float> history;
+        };
+
+        const std::uint32_t targetRate_;
+        const ResamplerQuality quality_;
+
+        /// Reduced ratio: L / M = targetRate / sampleRate
+        mutable std::uint64_t up_ = 1;
+        mutable std::uint64_t down_ = 1;
+        mutable std::uint32_t sampleRate_ = 0;
+        mutable std::size_t taps_ = 0;
+        /// Delay of the filter in upsampled samples (half its length)
+        mutable std::uint64_t delay_ = 0;
+        /// Phase p of the filter at p * taps, its coefficients in the order of the input samples
+        mutable std::vector<float> phases_;
+
+        mutable std::vector<StreamState> streams_;
+
+        void design(std::uint32_t sampleRate) const;
+
+        /// Output samples whose inputs are all before input sample end (not counting the end of the stream)
+        std::uint64_t outputsBefore(std::uint64_t end) const;
+        /// Output samples of a whole stream of the given length
+        std::uint64_t outputLength(std::uint64_t length) const;
+
+        std::vector<WAV_AudioBuffer> resample(std::vector<WAV_AudioBuffer>& batch) const;
+        void resampleChannel(const WAV_AudioBuffer& data, std::size_t channel, float* kept, WAV_AudioBuffer& output) const;
+    };
+}
+
+#endif //PIPEX_RESAMPLER_H
@@ -0,0 +1,227 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_SPECTRAL_ANALYSIS_H
+#define PIPEX_SPECTRAL_ANALYSIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/primitives/Processor.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/fft_utils.h"
+#include "PipeX/utils/sound_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Complex short-time spectra of a multichannel buffer, as produced by STFT.
+     *
+     * Frame t of channel c holds numBins bins (0 to the Nyquist frequency), real and imaginary parts in two separate
+     * arrays starting at (c * numFrames + t) * numBins.
+     */
+    struct ComplexSpectrogram {
+        std::size_t numChannels = 0;
+        std::size_t numFrames = 0;
+        std::size_t numBins = 0;
+        std::size_t fftSize = 0;
+        std::size_t hopSize = 0;
+        std::uint32_t sampleRate = 0;
+        std::vector<float> re;
+        std::vector<float> im;
+
+        float* real(const std::size_t c, const std::size_t t) { return re.data() + (c * numFrames + t) * numBins; }
+        const float* real(const std::size_t c, const std::size_t t) const { return re.data() + (c * numFrames + t) * numBins; }
+        float* imag(const std::size_t c, const std::size_t t) { return im.data() + (c * numFrames + t) * numBins; }
+        const float* imag(const std::size_t c, const std::size_t t) const { return im.data() + (c * numFrames + t) * numBins; }
+
+        /// Center frequency of bin k in Hz
+        double binFrequency(const std::size_t k) const { return static_cast<double>(k) * sampleRate / static_cast<double>(fftSize); }
+    };
+
+    /**
+     * @brief Scale of the values of a Spectrogram.
+     */
+    enum class SpectrumScale {
+        Magnitude, ///< |X[k]|
+        Power,     ///< |X[k]|^2
+        Decibels   ///< 10 log10(|X[k]|^2), floored at -200 dB
+    };
+
+    /**
+     * @brief Real short-time spectra (magnitude, power or decibels), laid out like a ComplexSpectrogram.
+     */
+    struct Spectrogram {
+        std::size_t numChannels = 0;
+        std::size_t numFrames = 0;
+        std::size_t numBins = 0;
+        std::size_t fftSize = 0;
+        std::size_t hopSize = 0;
+        std::uint32_t sampleRate = 0;
+        SpectrumScale scale = SpectrumScale::Magnitude;
+        std::vector<float> values;
+
+        float* frame(const std::size_t c, const std::size_t t) { return values.data() + (c * numFrames + t) * numBins; }
+        const float* frame(const std::size_t c, const std::size_t t) const { return values.data() + (c * numFrames + t) * numBins; }
+
+        /// Center frequency of bin k in Hz
+        double binFrequency(const std::size_t k) const { return static_cast<double>(k) * sampleRate / static_cast<double>(fftSize); }
+    };
+
+    /**
+     * @brief Per-frame features of a Spectrogram: numFeatures named values for every frame of every channel,
+     * starting at (c * numFrames + t) * numFeatures.
+     */
+    struct SpectralFeatures {
+        std::size_t numChannels = 0;
+        std::size_t numFrames = 0;
+        std::size_t hopSize = 0;
+        std::uint32_t sampleRate = 0;
+        std::vector<std::string> names;
+        std::vector<float> values;
+
+        std::size_t numFeatures() const { return names.size(); }
+
+        float* frame(const std::size_t c, const std::size_t t) { return values.data() + (c * numFrames + t) * names.size(); }
+        const float* frame(const std::size_t c, const std::size_t t) const { return values.data() + (c * numFrames + t) * names.size(); }
+    };
+
+
+    /**
+     * @brief Processor node computing the short-time Fourier transform of every channel of each stream of the batch.
+     *
+     * Frame t covers the samples [t * hopSize, t * hopSize + fftSize) of the stream, weighted by a periodic Hann
+     * window; the last frame is zero-padded, and a stream shorter than fftSize gives a single frame. The FFT plan is
+     * taken from the process-wide cache (FFT::plan) at construction, so repeated runs and nodes of the same size share
+     * it, and the frames of all channels of all the streams are transformed in parallel on the shared ThreadPool.
+     *
+     * Frames span the blocks of a stream: a buffer emits the frames it completes, and the samples of the frames still
+     * open (at most fftSize per channel) are kept for the next buffer (see WAV_Metadata::blockStart for the streams of
+     * a batch, their start and their end). The last buffer of a stream emits the remaining, zero-padded frames, so a
+     * stream in blocks gives the frames of the whole stream; small blocks may emit no frame at all. The state is also
+     * reset when a buffer does not follow the previous one.
+     * The sample rate of the spectrogram comes from WAV_Metadata::sampleRate; the metadata is forwarded unchanged.
+     */
+    class STFT final : public Processor<WAV_AudioBuffer, ComplexSpectrogram, WAV_Metadata> {
+    public:
+        /**
+         * @throws InvalidOperation if fftSize is not a power of two >= 2 or hopSize is 0.
+         */
+        explicit STFT(std::string node_name, std::size_t fftSize = 2048, std::size_t hopSize = 512);
+
+        std::size_t fftSize() const { return plan_->size(); }
+        std::size_t hopSize() const { return hopSize_; }
+
+    protected:
+        std::string typeName() const override {
+            return "STFT";
+        }
+
+    private:
+        /// Frames transformed by a task (they share its scratch buffer)
+        static constexpr std::size_t framesPerTask = 16;
+
+        /// Samples of a stream from the first frame not yet emitted (or the end of the last buffer)
+        struct StreamState {
+            std::size_t numChannels = 0;
+            /// Index in the stream of the next frame
+            std::uint64_t nextFrame = 0;
+            /// Position in the stream of the first sample kept
+            std::uint64_t offset = 0;
+            /// Samples kept per channel, channel c at c * length
+            std::size_t length = 0;
+            std::vector<float> samples;
+        };
+
+        std::shared_ptr<const FFT> plan_;
+        const std::size_t hopSize_;
+        std::vector<float> window_;
+
+        mutable std::vector<StreamState> streams_;
+
+        /// Frames ending before sample end of the stream
+        std::uint64_t completeFrames(std::uint64_t end) const;
+        /// Frames of a whole stream of the given length
+        std::uint64_t frameCount(std::uint64_t length) const;
+
+        std::vector<ComplexSpectrogram> analyse(std::vector<WAV_AudioBuffer>& batch) const;
+    };
+
+
+    /**
+     * @brief Transformer node turning complex spectra into magnitude, power or decibel spectra (SIMD).
+     */
+    class MagnitudeSpectrum final : public Transformer<ComplexSpectrogram, Spectrogram, WAV_Metadata> {
+    public:
+        explicit MagnitudeSpectrum(std::string node_name, SpectrumScale scale = SpectrumScale::Magnitude);
+
+    protected:
+        std::string typeName() const override {
+            return "MagnitudeSpectrum";
+        }
+
+    private:
+        const SpectrumScale scale_;
+
+        Spectrogram magnitude(const ComplexSpectrogram& spectrum) const;
+    };
+
+
+    /**
+     * @brief Transformer node computing the spectral centroid and rolloff of every frame, in Hz.
+     *
+     * Features: "centroid", the mean frequency weighted by the magnitude, and "rolloff", the frequency of the first
+     * bin below which (inclusive) rolloffPercent of the power of the frame lies. Both are 0 for a silent frame.
+     */
+    class SpectralShape final : public Transformer<Spectrogram, SpectralFeatures, WAV_Metadata> {
+    public:
+        /**
+         * @throws InvalidOperation if rolloffPercent is not in (0, 1].
+         */
+        explicit SpectralShape(std::string node_name, double rolloffPercent = 0.85);
+
+    protected:
+        std::string typeName() const override {
+            return "SpectralShape";
+        }
+
+    private:
+        const double rolloffPercent_;
+
+        SpectralFeatures shape(const Spectrogram& spectrum) const;
+    };
+
+
+    /**
+     * @brief Transformer node summing the power of every frame in frequency bands.
+     *
+     * Band b collects the bins whose frequency lies in [edgesHz[b], edgesHz[b + 1]); the features are named
+     * "<low>-<high>Hz".
+     */
+    class BandEnergy final : public Transformer<Spectrogram, SpectralFeatures, WAV_Metadata> {
+    public:
+        /**
+         * @throws InvalidOperation if there are less than 2 edges or they are not increasing from a value >= 0.
+         */
+        BandEnergy(std::string node_name, std::vector<double> edgesHz);
+
+        const std::vector<double>& edges() const { return edgesHz_; }
+
+    protected:
+        std::string typeName() const override {
+            return "BandEnergy";
+        }
+
+    private:
+        const std::vector<double> edgesHz_;
+        std::vector<std::string> names_;
+
+        SpectralFeatures bandEnergy(const Spectrogram& spectrum) const;
+    };
+}
+
+#endif //PIPEX_SPECTRAL_ANALYSIS_H
@@ -16,24 +16,42 @@ namespace PipeX {
     /**
      * @brief Source node that generates audio data based on presets.
      *
-     * Can generate sinusoidal waves, white noise, pink noise, or load from a WAV file.
+     * Can generate sinusoidal waves, white noise, pink noise, or load from WAV files (see WAV_Audio_Source to
+     * stream a long file in blocks). Each of the nStreams tracks is a planar buffer of numChannels channels: the
+     * sine wave is the same on every channel, the noise channels are independent.
      */
     class WAV_SoundPreset_Source final : public Source<WAV_AudioBuffer, WAV_Metadata> {
     public:
-        WAV_SoundPreset_Source(std::string node_name, const int nStreams, const int sampleRate, const int bitsPerSample, const int durationSec, const int preset = 0)
+        static constexpr int SINE = 0;          ///< 440 Hz sine wave
+        static constexpr int WHITE_NOISE = 1;   ///< Gaussian white noise
+        static constexpr int PINK_NOISE = 2;    ///< Voss-McCartney pink noise
+        static constexpr int WAV_FILE = 3;      ///< Tracks read from the files filename_<i>.wav (as written by WAV_Sound_Sink)
+
+        WAV_SoundPreset_Source(std::string node_name, const int nStreams, const int sampleRate, const int bitsPerSample, const int durationSec, const int preset = 0,
+                               const int numChannels = 1)
         : Source(std::move(node_name), [this]() {
             this->createMetadata();
             this->setupWAVMetadata();
 
             auto audioTracks = std::vector<WAV_AudioBuffer>();
-            audioTracks.reserve(this->sourceMetadata->numChannels);
+            audioTracks.reserve(this->nStreams);
             for (int i = 0; i < this->nStreams; i++) {
-                audioTracks.push_back(getSoundPreset());
+                audioTracks.push_back(getSoundPreset(i));
             }
 
             return audioTracks;
-        }), nStreams(nStreams), sampleRate(sampleRate), bitsPerSample(bitsPerSample), durationSec(durationSec), preset(preset) {
-            this->logLifeCycle("Constructor(std::string node_name, const int numChannels, const int sampleRate, const int bitsPerSample, const int durationSec)");
+        }), nStreams(nStreams), sampleRate(sampleRate), bitsPerSample(bitsPerSample), durationSec(durationSec), preset(preset), numChannels(numChannels) {
+            this->logLifeCycle("Constructor(std::string node_name, const int nStreams, const int sampleRate, const int bitsPerSample, const int durationSec, const int preset, const int numChannels)");
+        }
+
+        /**
+         * @brief Loads nStreams tracks from the WAV files filename_0.wav, filename_1.wav, ... (WAV_FILE preset).
+         *
+         * The metadata is read from the first file; all the files must share its format.
+         */
+        WAV_SoundPreset_Source(std::string node_name, const int nStreams, std::string filename)
+        : WAV_SoundPreset_Source(std::move(node_name), nStreams, 0, 0, 0, WAV_FILE) {
+            this->filename = std::move(filename);
         }
 
 
@@ -43,21 +61,25 @@ namespace PipeX {
         int bitsPerSample;
         int durationSec;
         int preset;
+        int numChannels;
+        std::string filename;
 
         void setupWAVMetadata() const {
-            sourceMetadata->setParameters(1, sampleRate, bitsPerSample, durationSec);
+            if (preset != WAV_FILE) {
+                sourceMetadata->setParameters(numChannels, sampleRate, bitsPerSample, durationSec);
+            }
         }
 
-        WAV_AudioBuffer getSoundPreset() const {
+        WAV_AudioBuffer getSoundPreset(const int index) const {
             switch (preset) {
-            case 0:
+            case SINE:
                 return sinusoidalWave();
-            case 1:
+            case WHITE_NOISE:
                 return whiteNoise();
-            case 2:
+            case PINK_NOISE:
                 return pinkNoise();
             default:
-                return loadWAVFile(preset);
+                return loadWAVFile(index);
             }
         }
 
@@ -5,13 +5,18 @@
 #ifndef PIPEX_WAV_SOUND_SINK_H
 #define PIPEX_WAV_SOUND_SINK_H
 
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "PipeX/metadata/WAV_Metadata.h"
 #include "PipeX/nodes/primitives/Sink.h"
 #include "PipeX/utils/sound_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/utils/wav_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
 #include "PipeX/errors/PipeX_IO_Exception.h"
 
 
@@ -20,64 +25,178 @@ namespace PipeX {
      * @brief Sink node that saves audio data to WAV files.
      *
      * Writes each received audio buffer to a separate WAV file with an index suffix and adds the .wav extension.
+     * Samples are converted to the bit depth of the metadata (8, 16, 24 packed or 32 bits, saturated) in bulk,
+     * into a buffer written in large blocks; the buffers of a batch are written concurrently on the shared ThreadPool.
+     * Multichannel buffers are written as interleaved frames whatever their layout (planar buffers are interleaved
+     * chunk by chunk); their number of channels must match the metadata.
+     *
+     * Streams are supported: the blocks emitted by a streaming source are appended to the same files, whose header
+     * sizes (riffSize, dataSize) are patched when the stream ends (endOfStream). A buffer holding a whole stream is
+     * written with its final header and the file closed at once.
+     *
+     * batchParallelism bounds how many buffers of a batch are written concurrently (0 = whole thread pool); as a
+     * constructor argument it can be set on a sink built in place by Pipeline::addNode().
      */
     class WAV_Sound_Sink final : public Sink<WAV_AudioBuffer, WAV_Metadata> {
     public:
-        WAV_Sound_Sink(std::string node_name, std::string filename)
+        WAV_Sound_Sink(std::string node_name, std::string filename, const std::size_t batchParallelism = 0)
                 : Sink(std::move(node_name), [this](const std::vector<WAV_AudioBuffer>& audios) {
-                    int index = 0;
-                    for (const auto& audio : audios) {
-                        saveToFile(audio, filename_ + "_" + std::to_string(index++) + ".wav");
+                    const auto& metadata = this->getMetadata();
+                    const int bits = metadata->bitsPerSample;
+                    if (bits != 8 && bits != 16 && bits != 24 && bits != 32) {
+                        throw InvalidOperation("WAV_Sound_Sink", "unsupported bits per sample: " + std::to_string(bits));
                     }
-                }), filename_(std::move(filename)) {
+
+                    if (streams_.size() < audios.size()) {
+                        streams_.resize(audios.size());
+                    }
+                    ThreadPool::getThreadPool().parallelFor(0, audios.size(), [this, &audios, &metadata](const std::size_t i) {
+                        writeBlock(i, audios[i], *metadata);
+                    }, 1, batchParallelism_);
+                }), filename_(std::move(filename)), batchParallelism_(batchParallelism) {
             this->logLifeCycle("Constructor(filename, name)");
         }
 
+        ~WAV_Sound_Sink() override {
+            try {
+                finish();
+            } catch (...) {
+                // Destructors must not throw: call endOfStream() to get the errors
+            }
+        }
+
+        /**
+         * @brief Patches the headers of the files still open with their final size and closes them.
+         */
+        void endOfStream() override {
+            finish();
+        }
+
+        /**
+         * @brief Sets how many buffers of the batch may be written concurrently (0 = whole thread pool, the default).
+         */
+        WAV_Sound_Sink& setBatchParallelism(const std::size_t maxThreads) {
+            batchParallelism_ = maxThreads;
+            return *this;
+        }
+
+        std::size_t getBatchParallelism() const {
+            return batchParallelism_;
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "WAV_Sound_Sink";
+        }
+
     private:
+        /// Samples converted per write call
+        static constexpr std::size_t samplesPerWrite = 1 << 16;
+
+        struct Stream {
+            std::string filename;
+            std::ofstream file;
+            std::vector<std::uint8_t> buffer;
+            std::vector<audio_sample_t> interleaved;
+            std::uint64_t dataSize = 0;
+            bool sizeKnown = false;
+        };
+
         const std::string filename_;
+        std::size_t batchParallelism_;
+        mutable std::vector<std::shared_ptr<Stream>> streams_;
 
-        void saveToFile(const WAV_AudioBuffer& audio, const std::string& filename) const {
-            const auto& metadata = this->getMetadata();
+        void writeBlock(const std::size_t index, const WAV_AudioBuffer& audio, const WAV_Metadata& metadata) const {
+            auto& stream = streams_[index];
+            const std::size_t bytesPerSample = metadata.bitsPerSample / 8;
+            const std::size_t numChannels = audio.numChannels;
+            if (numChannels != metadata.numChannels) {
+                throw InvalidOperation("WAV_Sound_Sink", "buffer with " + std::to_string(numChannels) + " channels, metadata with "
+                    + std::to_string(metadata.numChannels));
+            }
+            const std::size_t framesPerWrite = samplesPerWrite / numChannels > 0 ? samplesPerWrite / numChannels : 1;
 
-            std::ofstream file(filename, std::ios::binary);
-            if (!file) {
-                throw PipeX_IO_Exception("[PPM_Image_Sink::saveToFile] Could not open file for writing: " + filename
-                    + ", make sure the directory exists.");
+            if (!stream) {
+                stream = std::make_shared<Stream>();
+                stream->filename = filename_ + "_" + std::to_string(index) + ".wav";
+                stream->file.open(stream->filename, std::ios::binary | std::ios::trunc);
+                if (!stream->file) {
+                    throw PipeX_IO_Exception("[WAV_Sound_Sink::writeBlock] Could not open file for writing: " + stream->filename
+                        + ", make sure the directory exists.");
+                }
+
+                // The final size is only known upfront when the buffer is the whole stream
+                stream->sizeKnown = metadata.blockStart == 0 && audio.numFrames == metadata.numSamples;
+                std::uint8_t header[WAV::headerSize];
+                WAV::writeHeader(header, metadata.numChannels, metadata.sampleRate, metadata.bitsPerSample,
+                                 stream->sizeKnown ? static_cast<std::uint32_t>(audio.size() * bytesPerSample) : 0);
+                stream->file.write(reinterpret_cast<const char*>(header), WAV::headerSize);
+                stream->buffer.resize(framesPerWrite * numChannels * bytesPerSample);
+            }
+
+            const bool interleaved = audio.layout == AudioLayout::Interleaved || numChannels == 1;
+            if (!interleaved) {
+                stream->interleaved.resize(framesPerWrite * numChannels);
+            }
+            for (std::size_t n = 0; n < audio.numFrames; n += framesPerWrite) {
+                const std::size_t frames = audio.numFrames - n < framesPerWrite ? audio.numFrames - n : framesPerWrite;
+                const audio_sample_t* frameData = audio.data() + n * numChannels;
+                if (!interleaved) {
+                    interleave(audio.data() + n, audio.numFrames, numChannels, frames, stream->interleaved.data());
+                    frameData = stream->interleaved.data();
+                }
+                WAV::encode(frameData, frames * numChannels, metadata.bitsPerSample, stream->buffer.data());
+                stream->file.write(reinterpret_cast<const char*>(stream->buffer.data()), static_cast<std::streamsize>(frames * numChannels * bytesPerSample));
             }
+            stream->dataSize += audio.size() * bytesPerSample;
+            if (!stream->file) {
+                throw PipeX_IO_Exception("[WAV_Sound_Sink::writeBlock] Could not write file: " + stream->filename);
+            }
+
+            if (stream->sizeKnown) {
+                close(*stream);
+                stream.reset();
+            }
+        }
 
-            // RIFF
-            file.write("RIFF", 4);
-            file.write(reinterpret_cast<const char*>(&(metadata->riffSize)), 4);
-            file.write("WAVE", 4);
-
-            // fmt chunk
-            file.write("fmt ", 4);
-            constexpr uint32_t fmtSize = 16;
-            constexpr uint16_t audioFormat = 1; // PCM
-            file.write(reinterpret_cast<const char*>(&fmtSize), 4);
-            file.write(reinterpret_cast<const char*>(&audioFormat), 2);
-            file.write(reinterpret_cast<const char*>(&(metadata->numChannels)), 2);
-            file.write(reinterpret_cast<const char*>(&(metadata->sampleRate)), 4);
-            file.write(reinterpret_cast<const char*>(&(metadata->byteRate)), 4);
-            file.write(reinterpret_cast<const char*>(&(metadata->blockAlign)), 2);
-            file.write(reinterpret_cast<const char*>(&(metadata->bitsPerSample)), 2);
-
-            // data chunk
-            file.write("data", 4);
-            file.write(reinterpret_cast<const char*>(&(metadata->dataSize)), 4);
-
-            // write samples - convert to the correct bit depth
-            for (const auto& sample : audio) {
-                if (metadata->bitsPerSample == 16) {
-                    const auto sample16 = static_cast<int16_t>(sample);
-                    file.write(reinterpret_cast<const char*>(&sample16), sizeof(int16_t));
-                } else if (metadata->bitsPerSample == 32) {
-                    file.write(reinterpret_cast<const char*>(&sample), sizeof(int32_t));
-                } else {
-                    // Handle other bit depths as needed
-                    file.write(reinterpret_cast<const char*>(&sample), metadata->bytesPerSample);
+        void finish() const {
+            for (auto& stream : streams_) {
+                if (stream) {
+                    close(*stream);
                 }
             }
+            streams_.clear();
+        }
+
+        /**
+         * @brief Pads the data chunk to an even size, patches the header sizes if needed and closes the file.
+         */
+        static void close(Stream& stream) {
+            if (stream.dataSize > 0xffffffffULL - WAV::headerSize) {
+                throw PipeX_IO_Exception("[WAV_Sound_Sink::close] Stream too long for the WAV format: " + stream.filename);
+            }
+            const auto dataSize = static_cast<std::uint32_t>(stream.dataSize);
+            if (dataSize & 1) {
+                stream.file.put(0);
+            }
+
+            if (!stream.sizeKnown) {
+                std::uint8_t size[4];
+                const auto patch = [&stream, &size](const std::streamoff offset, const std::uint32_t value) {
+                    for (int b = 0; b < 4; ++b) {
+                        size[b] = static_cast<std::uint8_t>(value >> (8 * b));
+                    }
+                    stream.file.seekp(offset);
+                    stream.file.write(reinterpret_cast<const char*>(size), 4);
+                };
+                patch(4, static_cast<std::uint32_t>(WAV::headerSize - 8) + dataSize + (dataSize & 1));
+                patch(40, dataSize);
+            }
+
+            stream.file.close();
+            if (!stream.file) {
+                throw PipeX_IO_Exception("[WAV_Sound_Sink::close] Could not write file: " + stream.filename);
+            }
         }
     };
 }
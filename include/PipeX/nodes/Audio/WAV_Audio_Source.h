@@ -0,0 +1,68 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_WAV_AUDIO_SOURCE_H
+#define PIPEX_WAV_AUDIO_SOURCE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/primitives/Source.h"
+#include "PipeX/utils/mapped_file_utils.h"
+#include "PipeX/utils/sound_utils.h"
+#include "PipeX/utils/wav_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Streaming source node reading a PCM WAV file (8, 16, 24 or 32 bits, mono, stereo or surround).
+     *
+     * The file is memory-mapped and its RIFF chunks parsed (unknown chunks are skipped); the metadata describes the
+     * whole file. With blockFrames > 0 the source streams the file: each run of the pipeline nodes receives one
+     * buffer holding the next blockFrames frames (fewer for the last block) and WAV_Metadata::blockStart gives its
+     * position in the file; the pages already decoded are released, so memory stays bounded by the block size
+     * whatever the length of the file. With blockFrames == 0 the whole file is emitted as a single buffer.
+     * Small blocks (e.g. 64 to 1024 frames) give a low-latency stream for the real-time mode of the pipeline: every
+     * block must then be processed within its duration (blockDuration()).
+     * The interleaved frames of the file are split into the channels of a planar WAV_AudioBuffer.
+     */
+    class WAV_Audio_Source final : public Source<WAV_AudioBuffer, WAV_Metadata> {
+    public:
+        WAV_Audio_Source(std::string node_name, std::string filename, std::size_t blockFrames = 0);
+
+        bool hasPendingData() const override;
+
+        /**
+         * @brief Closes the file: the next run starts again from the beginning.
+         */
+        void endOfStream() override;
+
+        /**
+         * @brief Duration of the last block emitted: its frames divided by the sample rate of the file.
+         */
+        double blockDuration() const override;
+
+    protected:
+        std::string typeName() const override {
+            return "WAV_Audio_Source";
+        }
+
+    private:
+        const std::string filename_;
+        const std::size_t blockFrames_;
+
+        mutable std::shared_ptr<MappedFile> file_;
+        mutable WAV::Layout layout_;
+        /// Frames already emitted
+        mutable std::size_t position_ = 0;
+        /// Frames of the last block emitted
+        std::size_t lastBlockFrames_ = 0;
+
+        std::vector<WAV_AudioBuffer> nextBlock();
+    };
+}
+
+#endif //PIPEX_WAV_AUDIO_SOURCE_H
@@ -0,0 +1,119 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_AUTOLEVELS_H
+#define PIPEX_AUTOLEVELS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/Image/ImageStatistics.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Transformer node that stretches the channel range of every image to the full channel depth.
+     *
+     * The black and white points are the clipPercent and (100 - clipPercent) percentiles of the image histogram
+     * (see ImageHistogram), so a few outlier pixels do not prevent the stretch. With perChannel, each channel is
+     * stretched independently (which also neutralizes colour casts); otherwise the same curve is applied to all
+     * channels. The curve is applied through a lookup table, tile by tile on the shared ThreadPool.
+     */
+    class AutoLevels final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        explicit AutoLevels(std::string node_name, const double clipPercent = 0.5, const bool perChannel = false)
+            : Transformer(std::move(node_name), [this](PPM_Image& input) {
+                return this->autoLevels(input);
+            }), clipPercent_(clipPercent), perChannel_(perChannel) {
+            if (clipPercent_ < 0.0 || clipPercent_ >= 50.0) {
+                throw InvalidOperation("AutoLevels::AutoLevels", "clipPercent must be in [0, 50)");
+            }
+            this->setBatchParallelism(0);
+            this->logLifeCycle("Constructor(std::string, double, bool)");
+        }
+
+        /**
+         * @brief Lookup table mapping [black, white] linearly to [0, max_value] (identity if white <= black).
+         */
+        static std::vector<int> stretchLUT(const int black, const int white, const int max_value) {
+            std::vector<int> lut(static_cast<std::size_t>(max_value) + 1);
+            for (int v = 0; v <= max_value; ++v) {
+                if (white <= black) {
+                    lut[v] = v;
+                } else {
+                    const double stretched = std::round(static_cast<double>(v - black) * max_value / (white - black));
+                    lut[v] = static_cast<int>(std::min(std::max(stretched, 0.0), static_cast<double>(max_value)));
+                }
+            }
+            return lut;
+        }
+
+    protected:
+        void preProcessHook() const override {
+            maxValue_ = this->getMetadata()->bit_depth;
+        }
+
+        std::string typeName() const override {
+            return "AutoLevels";
+        }
+
+    private:
+        const double clipPercent_;
+        const bool perChannel_;
+        mutable int maxValue_ = 255;
+
+        PPM_Image autoLevels(PPM_Image& data) const {
+            if (data.empty() || data[0].empty()) {
+                return std::move(data);
+            }
+
+            const ImageHistogram histogram = ImageHistogram::compute(data, maxValue_);
+            std::array<int, 3> black{}, white{};
+            for (int c = 0; c < 3; ++c) {
+                black[c] = histogram.percentile(c, clipPercent_);
+                white[c] = histogram.percentile(c, 100.0 - clipPercent_);
+            }
+
+            const int width = static_cast<int>(data[0].size());
+            const int height = static_cast<int>(data.size());
+
+            if (!perChannel_) {
+                const auto lut = stretchLUT(*std::min_element(black.begin(), black.end()), *std::max_element(white.begin(), white.end()), maxValue_);
+                ImageTiling::forEachTile(width, height, ImageTiling::defaultOptions(), [&data, &lut](const ImageTile& tile) {
+                    for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                        applyLUT(data[y][tile.x0].data(), static_cast<std::size_t>(tile.width) * 3, lut);
+                    }
+                });
+                return std::move(data);
+            }
+
+            std::array<std::vector<int>, 3> luts;
+            for (int c = 0; c < 3; ++c) {
+                luts[c] = stretchLUT(black[c], white[c], maxValue_);
+            }
+            ImageTiling::forEachTile(width, height, ImageTiling::defaultOptions(), [this, &data, &luts](const ImageTile& tile) {
+                for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                    auto& row = data[y];
+                    for (int x = tile.x0; x < tile.x0 + tile.width; ++x) {
+                        for (int c = 0; c < 3; ++c) {
+                            const int v = row[x][c];
+                            row[x][c] = luts[c][v < 0 ? 0 : (v > maxValue_ ? maxValue_ : v)];
+                        }
+                    }
+                }
+            });
+            return std::move(data);
+        }
+    };
+}
+
+#endif //PIPEX_AUTOLEVELS_H
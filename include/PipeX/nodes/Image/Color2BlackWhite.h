@@ -5,43 +5,37 @@
 #ifndef PIPEX_COLOR2BLACKWHITE_H
 #define PIPEX_COLOR2BLACKWHITE_H
 
-#include <cmath>
 #include <string>
+#include <vector>
 
-#include "PipeX/metadata/PPM_Metadata.h"
-#include "PipeX/nodes/primitives/Transformer.h"
-#include "PipeX/utils/image_utils.h"
+#include "PipeX/nodes/Image/PointOperation.h"
 
 namespace PipeX {
-    class Color2BlackWhite final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    /**
+     * @brief Point operation that converts PPM images to grayscale.
+     *
+     * Uses the luminosity method (0.21 R + 0.72 G + 0.07 B) and writes the gray value to all channels.
+     */
+    class Color2BlackWhite final : public PointOperationCRTP<Color2BlackWhite> {
     public:
         explicit Color2BlackWhite(std::string node_name)
-            : Transformer(std::move(node_name), [this] (PPM_Image& input) {
-                return this->grayscale(input);
-            }) {
+            : PointOperationCRTP(std::move(node_name)) {
             this->logLifeCycle("Color2BlackWhite");
         }
 
-    private:
-        PPM_Image grayscale(PPM_Image& data) {
-            static const auto& metadata = this->getMetadata();
-
-            for (auto& row: data) {
-                for (auto& pixel: row) {
-                    auto gray = toGrayscale(pixel);
-                    for (auto& channel: pixel) {
-                        channel = gray;
-                    }
-                }
-            }
-            return data;
+        std::vector<Stage> stages() const override {
+            return {[](PointOperationProgram& program) {
+                // Using luminosity method for better grayscale conversion
+                program.appendLumaMix(0.21, 0.72, 0.07);
+            }};
         }
 
-        double toGrayscale(channelsT channels) const {
-            // Using luminosity method for better grayscale conversion
-            double gray = 0.21 * channels[0] + 0.72 * channels[1] + 0.07 * channels[2];
-            return static_cast<int>(std::round(gray));
+        int lumaMixCount() const override { return 1; }
+
+    protected:
+        std::string typeName() const override {
+            return "Color2BlackWhite";
         }
     };
 }
-#endif //PIPEX_COLOR2BLACKWHITE_H
\ No newline at end of file
+#endif //PIPEX_COLOR2BLACKWHITE_H
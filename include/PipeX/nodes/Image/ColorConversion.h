@@ -0,0 +1,115 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_COLORCONVERSION_H
+#define PIPEX_COLORCONVERSION_H
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/color_utils.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Transformer node converting images from the colour space tagged in their PPM_Metadata to another one.
+     *
+     * RGB <-> YCbCr uses SIMD fixed-point matrices (see ColorMatrix). HSV is converted per pixel;
+     * YCbCr <-> HSV goes through RGB. Images are processed in tiles on the shared ThreadPool,
+     * and the output metadata is tagged with the target colour space.
+     */
+    class ColorConversion final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        ColorConversion(std::string node_name, const ColorSpace target)
+            : Transformer(std::move(node_name), [this](PPM_Image& input) {
+                return this->convert(input);
+            }), target_(target) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("Constructor(std::string, ColorSpace)");
+        }
+
+    protected:
+        void preProcessHook() const override {
+            const auto& metadata = this->getMetadata();
+            source_ = metadata->color_space;
+            if (metadata->bit_depth != maxValue_) {
+                maxValue_ = metadata->bit_depth;
+                toYCbCr_ = rgbToYCbCrMatrix(maxValue_);
+                fromYCbCr_ = yCbCrToRGBMatrix(maxValue_);
+            }
+        }
+
+        void postProcessHook() const override {
+            // The input metadata may be shared with upstream nodes: the output gets its own copy
+            auto metadata = std::make_shared<PPM_Metadata>(*this->getMetadata());
+            metadata->color_space = target_;
+            this->outputData->metadata = std::move(metadata);
+        }
+
+        std::string typeName() const override {
+            return "ColorConversion";
+        }
+
+    private:
+        const ColorSpace target_;
+
+        mutable ColorSpace source_ = ColorSpace::RGB;
+        mutable int maxValue_ = -1;
+        mutable ColorMatrix toYCbCr_;
+        mutable ColorMatrix fromYCbCr_;
+
+        PPM_Image convert(PPM_Image& data) const {
+            if (source_ == target_ || data.empty() || data[0].empty()) {
+                return std::move(data);
+            }
+
+            ImageTiling::forEachTile(static_cast<int>(data[0].size()), static_cast<int>(data.size()), ImageTiling::defaultOptions(), [this, &data](const ImageTile& tile) {
+                for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                    int* channels = data[y][tile.x0].data();
+                    convertToRGB(channels, tile.width);
+                    convertFromRGB(channels, tile.width);
+                }
+            });
+            return std::move(data);
+        }
+
+        void convertToRGB(int* channels, const int pixels) const {
+            switch (source_) {
+            case ColorSpace::YCbCr:
+                applyColorMatrix(channels, pixels, fromYCbCr_);
+                break;
+            case ColorSpace::HSV:
+                for (int i = 0; i < pixels; ++i) {
+                    hsvToRGB(channels + 3 * i, maxValue_);
+                }
+                break;
+            case ColorSpace::RGB:
+            default:
+                break;
+            }
+        }
+
+        void convertFromRGB(int* channels, const int pixels) const {
+            switch (target_) {
+            case ColorSpace::YCbCr:
+                applyColorMatrix(channels, pixels, toYCbCr_);
+                break;
+            case ColorSpace::HSV:
+                for (int i = 0; i < pixels; ++i) {
+                    rgbToHSV(channels + 3 * i, maxValue_);
+                }
+                break;
+            case ColorSpace::RGB:
+            default:
+                break;
+            }
+        }
+    };
+}
+
+#endif //PIPEX_COLORCONVERSION_H
@@ -0,0 +1,255 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_CONVOLUTION_H
+#define PIPEX_CONVOLUTION_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+#include "my_extended_cpp_standard/my_memory.h"
+
+namespace PipeX {
+    /**
+     * @brief How a neighbourhood kernel reads pixels outside the image.
+     */
+    enum class BorderMode {
+        Clamp,  ///< Replicates the edge pixel (aaa|abcd|ddd)
+        Mirror, ///< Reflects around the edge pixel, without repeating it (cb|abcd|cb)
+        Zero    ///< Pixels outside the image are black
+    };
+
+    /**
+     * @brief Maps a coordinate, possibly outside [0, size), to the pixel to read according to the border mode.
+     * @return The coordinate of the pixel to read, or -1 if it must be read as zero.
+     */
+    int borderIndex(int i, int size, BorderMode border);
+
+
+    /**
+     * @brief Transformer node convolving images with an arbitrary (odd-sized) kernel.
+     *
+     * Rank-1 kernels are detected at construction and applied as two 1D passes (horizontal, then vertical),
+     * bringing the cost per pixel from kh * kw to kh + kw multiply-adds. Both passes accumulate whole rows
+     * of channels with SIMD multiply-adds, and images are processed in tiles on the shared ThreadPool.
+     *
+     * Channels are convolved as floats and the result is rounded and clamped to [0, bit_depth].
+     */
+    class Convolution : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        /// Kernel coefficients, kernel[row][column]; both dimensions must be odd
+        using Kernel = std::vector<std::vector<double>>;
+
+        Convolution(std::string node_name, Kernel kernel, BorderMode border = BorderMode::Clamp);
+
+        /**
+         * @brief True if the kernel is applied as two separable 1D passes.
+         */
+        bool isSeparable() const { return separable_; }
+
+        /**
+         * @brief Overrides the tiling used by this node (ImageTiling::defaultOptions() otherwise).
+         */
+        void setTilingOptions(const TilingOptions& options) {
+            tilingOptions_ = options;
+            hasTilingOptions_ = true;
+        }
+
+        /**
+         * @brief Filters a compact image (Image8 or Image16) with channels in [0, max_value].
+         *
+         * The channels are widened to float with the SIMD kernel of their type, filtered, then rounded and clamped
+         * back to [0, max_value].
+         * @throws InvalidOperation if max_value does not fit the channel type.
+         */
+        template <typename ChannelT>
+        ImageBuffer<ChannelT> apply(const ImageBuffer<ChannelT>& image, const int max_value) const {
+            checkChannelDepth<ChannelT>(max_value);
+            return fromFloatImage<ChannelT>(apply(toFloatImage(image), max_value), max_value);
+        }
+
+        /**
+         * @brief Filters a FloatImage; the result is neither rounded nor clamped (e.g. negative edge responses are kept).
+         */
+        FloatImage apply(const FloatImage& image, int /*max_value*/ = 0) const {
+            FloatImage result(image.width, image.height);
+            if (!image.data.empty()) {
+                convolveImage(image, result);
+            }
+            return result;
+        }
+
+    protected:
+        /**
+         * @brief Constructor for derived filters that implement convolveImage() without a single kernel.
+         */
+        Convolution(std::string node_name, BorderMode border);
+
+        /**
+         * @brief Filters src into dst (already allocated with the same size).
+         */
+        virtual void convolveImage(const FloatImage& src, FloatImage& dst) const;
+
+        void preProcessHook() const override {
+            maxValue_ = this->getMetadata()->bit_depth;
+        }
+
+        std::string typeName() const override {
+            return "Convolution";
+        }
+
+        const TilingOptions& tilingOptions() const {
+            return hasTilingOptions_ ? tilingOptions_ : ImageTiling::defaultOptions();
+        }
+
+        /**
+         * @brief Separable convolution: rowKernel along x, then columnKernel along y.
+         */
+        static void convolveSeparable(const FloatImage& src, FloatImage& dst, const std::vector<float>& rowKernel,
+                                      const std::vector<float>& columnKernel, BorderMode border, const TilingOptions& options);
+
+        /**
+         * @brief Direct 2D convolution, one kernel row at a time.
+         */
+        static void convolve2D(const FloatImage& src, FloatImage& dst, const std::vector<std::vector<float>>& kernel,
+                               BorderMode border, const TilingOptions& options);
+
+        /**
+         * @brief In-place box blur of the given radius, along x then y, with running sums.
+         *
+         * The cost per pixel does not depend on the radius.
+         */
+        static void boxBlur(FloatImage& image, int radius, BorderMode border, std::size_t maxThreads = 0);
+
+        const BorderMode border_;
+
+    private:
+        Kernel kernel_;
+        bool separable_ = false;
+        std::vector<float> rowKernel_;
+        std::vector<float> columnKernel_;
+        std::vector<std::vector<float>> kernel2D_;
+
+        TilingOptions tilingOptions_;
+        bool hasTilingOptions_ = false;
+        mutable int maxValue_ = 255;
+
+        PPM_Image applyConvolution(const PPM_Image& data) const;
+
+        /**
+         * @brief Factors the kernel as column * row (outer product), if it has rank 1.
+         */
+        static bool factorize(const Kernel& kernel, std::vector<float>& column, std::vector<float>& row);
+    };
+
+    /**
+     * @brief Convolution over compact images (Image8, Image16 or FloatImage), for typed pipelines.
+     *
+     * Filters ImageBuffer<ChannelT> with a Convolution (or one of its filters, used only as a description and shared
+     * by the copies of the node), so the images keep their channel type through the pipeline: integer channels are
+     * rounded and clamped to [0, bit_depth], float channels are kept as computed (see Convolution::apply).
+     */
+    template <typename ChannelT>
+    class ImageBufferConvolution : public Transformer<ImageBuffer<ChannelT>, ImageBuffer<ChannelT>, PPM_Metadata> {
+        using Base = Transformer<ImageBuffer<ChannelT>, ImageBuffer<ChannelT>, PPM_Metadata>;
+
+    public:
+        ImageBufferConvolution(std::string node_name, std::shared_ptr<const Convolution> filter)
+            : Base(std::move(node_name), [this] (ImageBuffer<ChannelT>& input) {
+                return filter_->apply(input, maxValue_);
+            }), filter_(std::move(filter)) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("ImageBufferConvolution(std::string, std::shared_ptr<const Convolution>)");
+        }
+
+        /**
+         * @brief Copy constructors: the copy filters with the same Convolution, at the bit depth of its own input.
+         */
+        ImageBufferConvolution(const ImageBufferConvolution& other)
+            : ImageBufferConvolution(other, other.getName() + "_copy") {
+        }
+
+        ImageBufferConvolution(const ImageBufferConvolution& other, std::string node_name)
+            : Base(std::move(node_name), [this] (ImageBuffer<ChannelT>& input) {
+                return filter_->apply(input, maxValue_);
+            }), filter_(other.filter_) {
+            this->setBatchParallelism(other.getBatchParallelism());
+            this->logLifeCycle("CopyConstructor(const ImageBufferConvolution&, std::string)");
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<ImageBufferConvolution>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<ImageBufferConvolution>(*this, std::move(node_name));
+        }
+
+        const Convolution& filter() const { return *filter_; }
+
+    protected:
+        /**
+         * @throws InvalidOperation if the bit depth of the incoming images does not fit ChannelT.
+         */
+        void preProcessHook() const override {
+            maxValue_ = this->getMetadata()->bit_depth;
+            checkChannelDepth<ChannelT>(maxValue_);
+        }
+
+        std::string typeName() const override {
+            return "ImageBufferConvolution";
+        }
+
+    private:
+        const std::shared_ptr<const Convolution> filter_;
+        mutable int maxValue_ = 255;
+    };
+
+
+    /**
+     * @brief The filter Filter (e.g. GaussianBlur, Sharpen) over compact images with channels of type ChannelT.
+     *
+     * Takes the arguments of the constructor of Filter, e.g.
+     * pipeline.addNode<TypedConvolution<GaussianBlur, std::uint8_t>>("Blur", 1.5).
+     */
+    template <typename Filter, typename ChannelT>
+    class TypedConvolution final : public ImageBufferConvolution<ChannelT> {
+    public:
+        template <typename... Args>
+        explicit TypedConvolution(std::string node_name, Args&&... args)
+            : ImageBufferConvolution<ChannelT>(node_name, std::make_shared<const Filter>(node_name, std::forward<Args>(args)...)) {
+        }
+
+        TypedConvolution(const TypedConvolution& other) = default;
+
+        TypedConvolution(const TypedConvolution& other, std::string node_name)
+            : ImageBufferConvolution<ChannelT>(other, std::move(node_name)) {
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<TypedConvolution>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<TypedConvolution>(*this, std::move(node_name));
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "TypedConvolution";
+        }
+    };
+}
+
+#endif //PIPEX_CONVOLUTION_H
@@ -0,0 +1,46 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_EDGEDETECT_H
+#define PIPEX_EDGEDETECT_H
+
+#include <cmath>
+#include <string>
+
+#include "PipeX/nodes/Image/Convolution.h"
+
+namespace PipeX {
+    /**
+     * @brief Sobel edge detector: every channel is replaced by the magnitude of its gradient.
+     *
+     * The two Sobel kernels are rank-1, so both gradients are computed with separable convolutions.
+     */
+    class EdgeDetect final : public Convolution {
+    public:
+        explicit EdgeDetect(std::string node_name, const BorderMode border = BorderMode::Clamp)
+            : Convolution(std::move(node_name), border) {
+            this->logLifeCycle("EdgeDetect");
+        }
+
+    protected:
+        void convolveImage(const FloatImage& src, FloatImage& dst) const override {
+            static const std::vector<float> derivative = {-1.0f, 0.0f, 1.0f};
+            static const std::vector<float> smoothing = {1.0f, 2.0f, 1.0f};
+
+            FloatImage gy(src.width, src.height);
+            convolveSeparable(src, dst, derivative, smoothing, border_, tilingOptions());
+            convolveSeparable(src, gy, smoothing, derivative, border_, tilingOptions());
+
+            for (std::size_t i = 0; i < dst.data.size(); ++i) {
+                dst.data[i] = std::sqrt(dst.data[i] * dst.data[i] + gy.data[i] * gy.data[i]);
+            }
+        }
+
+        std::string typeName() const override {
+            return "EdgeDetect";
+        }
+    };
+}
+
+#endif //PIPEX_EDGEDETECT_H
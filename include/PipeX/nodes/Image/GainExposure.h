@@ -7,40 +7,50 @@
 
 #include <cmath>
 #include <string>
+#include <vector>
 
-#include "PipeX/metadata/PPM_Metadata.h"
-#include "PipeX/nodes/primitives/Transformer.h"
-#include "PipeX/utils/image_utils.h"
+#include "PipeX/nodes/Image/PointOperation.h"
 
 namespace PipeX {
     /**
      * @brief Transformer node that adjusts exposure and contrast of PPM images.
      *
      * Applies a sigmoid-based exposure and contrast adjustment to each pixel channel.
+     * Since the output only depends on the channel value, the curve is evaluated once per possible
+     * channel value into a lookup table (rebuilt only when the image bit depth changes) and then
+     * applied to the pixels with a table gather.
      */
-    class GainExposure final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    class GainExposure final : public PointOperationCRTP<GainExposure> {
         public:
         GainExposure(std::string node_name, double gain, double contrast = 1.0)
-            : Transformer(std::move(node_name), [this, gain, contrast] (PPM_Image& input) {
-                return this->grayscale(input, gain, contrast);
-            }) {
+            : PointOperationCRTP(std::move(node_name)), gain_(gain), contrast_(contrast) {
             this->logLifeCycle("Gain Exposure");
         }
 
-    private:
-        PPM_Image grayscale(PPM_Image& data, const double gain, const double contrast) const {
-            static const auto& metadata = this->getMetadata();
-
-            for (auto& row: data) {
-                for (auto& pixel: row) {
-                    for (auto& channel: pixel) {
-                        channel = normalizeExposureWithSigmoid(channel, gain, contrast, metadata->bit_depth);
-                    }
+        std::vector<Stage> stages() const override {
+            const double gain = gain_;
+            const double contrast = contrast_;
+
+            return {[gain, contrast](PointOperationProgram& program) {
+                const int max_value = program.maxValue();
+
+                std::vector<int> lut(static_cast<std::size_t>(max_value) + 1);
+                for (int value = 0; value <= max_value; ++value) {
+                    lut[value] = normalizeExposureWithSigmoid(value, gain, contrast, max_value);
                 }
-            }
-            return data;
+                program.appendLUT(lut);
+            }};
         }
 
+    protected:
+        std::string typeName() const override {
+            return "GainExposure";
+        }
+
+    private:
+        const double gain_;
+        const double contrast_;
+
         static int normalizeExposureWithSigmoid(const int value, const double exposure, const double contrast, const int max_value) {
             double multiplier = pow(2.0, exposure);
 
@@ -51,10 +61,11 @@ namespace PipeX {
             double shifted = exposed - 0.5;
             double sigmoid = 1.0 / (1.0 + exp(-contrast * shifted));
 
-            return static_cast<uint8_t>(sigmoid * max_value);
+            // The sigmoid is in (0, 1): truncating keeps the result in [0, max_value] at any bit depth
+            return static_cast<int>(sigmoid * max_value);
         }
 
     };
 }
 
-#endif //PIPEX_GAINEXPOSURE_H
\ No newline at end of file
+#endif //PIPEX_GAINEXPOSURE_H
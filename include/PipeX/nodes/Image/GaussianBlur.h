@@ -0,0 +1,102 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_GAUSSIANBLUR_H
+#define PIPEX_GAUSSIANBLUR_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "PipeX/nodes/Image/Convolution.h"
+#include "PipeX/errors/InvalidOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Gaussian blur of standard deviation sigma (in pixels).
+     *
+     * Up to maxExactSigma the exact (truncated at 3 sigma) Gaussian kernel is applied as a separable convolution.
+     * Above it, the blur is approximated by three successive box blurs whose sizes match the Gaussian variance:
+     * each box blur uses running sums, so the cost per pixel does not depend on sigma.
+     */
+    class GaussianBlur final : public Convolution {
+    public:
+        /// Largest sigma blurred with the exact kernel (19 taps per pass)
+        static constexpr double maxExactSigma = 3.0;
+        static constexpr int boxPasses = 3;
+
+        GaussianBlur(std::string node_name, const double sigma, const BorderMode border = BorderMode::Clamp)
+            : Convolution(std::move(node_name), border), sigma_(sigma) {
+            if (!(sigma_ > 0.0)) {
+                throw InvalidOperation("GaussianBlur::GaussianBlur", "sigma must be positive");
+            }
+
+            if (sigma_ <= maxExactSigma) {
+                const int radius = static_cast<int>(std::ceil(3.0 * sigma_));
+                gaussianKernel_.resize(2 * radius + 1);
+                double sum = 0.0;
+                for (int i = -radius; i <= radius; ++i) {
+                    sum += gaussianKernel_[i + radius] = static_cast<float>(std::exp(-0.5 * i * i / (sigma_ * sigma_)));
+                }
+                for (auto& weight : gaussianKernel_) {
+                    weight = static_cast<float>(weight / sum);
+                }
+            } else {
+                boxRadii_ = boxBlurRadii(sigma_, boxPasses);
+            }
+
+            this->logLifeCycle("GaussianBlur");
+        }
+
+        /**
+         * @brief True if this blur is approximated with box blurs.
+         */
+        bool usesBoxApproximation() const { return !boxRadii_.empty(); }
+
+        /**
+         * @brief Radii of the n box blurs whose composition best matches a Gaussian of the given sigma.
+         */
+        static std::vector<int> boxBlurRadii(const double sigma, const int n) {
+            // Ideal (odd) box width, split between a lower (wl) and an upper (wl + 2) width to match the variance
+            const double idealWidth = std::sqrt(12.0 * sigma * sigma / n + 1.0);
+            int wl = static_cast<int>(std::floor(idealWidth));
+            if (wl % 2 == 0) {
+                --wl;
+            }
+            const int wu = wl + 2;
+            const double idealM = (12.0 * sigma * sigma - n * wl * wl - 4.0 * n * wl - 3.0 * n) / (-4.0 * wl - 4.0);
+            const int m = static_cast<int>(std::lround(idealM));
+
+            std::vector<int> radii;
+            for (int i = 0; i < n; ++i) {
+                radii.push_back(((i < m ? wl : wu) - 1) / 2);
+            }
+            return radii;
+        }
+
+    protected:
+        void convolveImage(const FloatImage& src, FloatImage& dst) const override {
+            if (!usesBoxApproximation()) {
+                convolveSeparable(src, dst, gaussianKernel_, gaussianKernel_, border_, tilingOptions());
+                return;
+            }
+
+            dst.data = src.data;
+            for (const int radius : boxRadii_) {
+                boxBlur(dst, radius, border_, tilingOptions().maxThreads);
+            }
+        }
+
+        std::string typeName() const override {
+            return "GaussianBlur";
+        }
+
+    private:
+        const double sigma_;
+        std::vector<float> gaussianKernel_;
+        std::vector<int> boxRadii_;
+    };
+}
+
+#endif //PIPEX_GAUSSIANBLUR_H
@@ -0,0 +1,133 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_IMAGEPYRAMID_H
+#define PIPEX_IMAGEPYRAMID_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Low-pass filter applied before each 2x decimation of an ImagePyramid.
+     */
+    enum class PyramidFilter {
+        Gaussian, ///< 5-tap binomial kernel [1 4 6 4 1] / 16 (Burt-Adelson)
+        Box       ///< Average of 2 x 2 pixels
+    };
+
+    /**
+     * @brief Multi-resolution representation of an image: level 0 is the image itself (as float channels) and each
+     * level is the previous one filtered and halved in both dimensions (rounding up), down to a side of 1 pixel.
+     *
+     * All levels live in one contiguous allocation (level after level, each row-major and RGB-interleaved like a
+     * FloatImage), so the whole pyramid is built with a single allocation and moved through the pipeline at no cost.
+     */
+    class ImagePyramid {
+    public:
+        struct Level {
+            int width;
+            int height;
+            std::size_t offset; ///< Index of the first channel of the level in the shared buffer
+        };
+
+        ImagePyramid() = default;
+
+        /**
+         * @brief Builds the pyramid of an image.
+         *
+         * Every level is computed from the previous one: a vertical SIMD pass over the source rows followed by
+         * the horizontal filter, on blocks of rows in parallel on the shared ThreadPool.
+         * @param maxLevels Maximum number of levels (0 = down to a side of 1 pixel)
+         * @param maxThreads Maximum number of threads (0 = whole thread pool)
+         */
+        static ImagePyramid build(const PPM_Image& image, int maxLevels = 0, PyramidFilter filter = PyramidFilter::Gaussian, std::size_t maxThreads = 0);
+
+        /**
+         * @brief Size along one axis of the given level of a pyramid whose level 0 has the given size.
+         */
+        static int levelSize(int size, int level);
+
+        /**
+         * @brief Number of levels of the pyramid of a width x height image (limited to maxLevels if not 0).
+         */
+        static int levelCount(int width, int height, int maxLevels = 0);
+
+        int levels() const { return static_cast<int>(levels_.size()); }
+        int width(const int level) const { return levels_[level].width; }
+        int height(const int level) const { return levels_[level].height; }
+        std::size_t stride(const int level) const { return static_cast<std::size_t>(levels_[level].width) * 3; }
+
+        float* row(const int level, const int y) { return data_.data() + levels_[level].offset + y * stride(level); }
+        const float* row(const int level, const int y) const { return data_.data() + levels_[level].offset + y * stride(level); }
+
+        /**
+         * @brief Copies a level to a PPM image, rounding and clamping the channels to [0, max_value].
+         */
+        PPM_Image levelImage(int level, int max_value) const;
+
+        /**
+         * @brief Copies a level to a FloatImage.
+         */
+        FloatImage levelFloatImage(int level) const;
+
+    private:
+        std::vector<Level> levels_;
+        std::vector<float> data_;
+
+        void reduce(int level, PyramidFilter filter, std::size_t maxThreads);
+    };
+
+
+    /**
+     * @brief Transformer node that builds the ImagePyramid of each image (the images of a batch in parallel).
+     *
+     * The metadata is forwarded unchanged: it describes level 0. Use PyramidLevel to get back the images of one level.
+     */
+    class PyramidBuilder final : public Transformer<PPM_Image, ImagePyramid, PPM_Metadata> {
+    public:
+        explicit PyramidBuilder(std::string node_name, int maxLevels = 0, PyramidFilter filter = PyramidFilter::Gaussian);
+
+    protected:
+        std::string typeName() const override {
+            return "PyramidBuilder";
+        }
+
+    private:
+        const int maxLevels_;
+        const PyramidFilter filter_;
+    };
+
+
+    /**
+     * @brief Transformer node that picks one level of each ImagePyramid, with the metadata updated to its size.
+     */
+    class PyramidLevel final : public Transformer<ImagePyramid, PPM_Image, PPM_Metadata> {
+    public:
+        PyramidLevel(std::string node_name, int level);
+
+    protected:
+        void preProcessHook() const override;
+        void postProcessHook() const override;
+
+        std::string typeName() const override {
+            return "PyramidLevel";
+        }
+
+    private:
+        const int level_;
+        mutable int maxValue_ = 255;
+
+        PPM_Image pick(const ImagePyramid& pyramid) const;
+    };
+}
+
+#endif //PIPEX_IMAGEPYRAMID_H
@@ -0,0 +1,237 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_IMAGEROI_H
+#define PIPEX_IMAGEROI_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/Image/PointOperation.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Region of interest of an image: a view on a rectangle of a (shared) parent image, without copying it.
+     *
+     * A view is the parent buffer plus an offset and a size; the rows of the region are read in place through row()
+     * (3 * width() contiguous channels each, the parent rows acting as the stride). Several views may share the same
+     * parent: mutating a view through mutableRow() first gives it its own copy of the region if the parent is shared
+     * (copy-on-write), so the other views never observe the change. A view that owns its parent mutates it in place.
+     */
+    class ImageROI {
+    public:
+        ImageROI() = default;
+
+        /**
+         * @brief View on a whole image (moved in, not copied).
+         */
+        explicit ImageROI(PPM_Image image)
+            : buffer_(std::make_shared<PPM_Image>(std::move(image))),
+              width_(buffer_->empty() ? 0 : static_cast<int>((*buffer_)[0].size())),
+              height_(static_cast<int>(buffer_->size())) {}
+
+        /**
+         * @brief View on a sub-rectangle of this view, sharing the same parent.
+         */
+        ImageROI crop(const int x, const int y, const int width, const int height) const {
+            if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > width_ || y + height > height_) {
+                throw InvalidOperation("ImageROI::crop", "the region must lie inside the image");
+            }
+            ImageROI view(*this);
+            view.x0_ += x;
+            view.y0_ += y;
+            view.width_ = width;
+            view.height_ = height;
+            return view;
+        }
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+        /// Position of the view in its parent buffer
+        int x0() const { return x0_; }
+        int y0() const { return y0_; }
+
+        /**
+         * @brief True if the parent buffer is referenced by other views (a mutation would copy the region first).
+         */
+        bool isShared() const { return buffer_.use_count() > 1; }
+
+        const int* row(const int y) const {
+            return (*buffer_)[y0_ + y].data()->data() + 3 * x0_;
+        }
+
+        /**
+         * @brief Row of the region, writable (copy-on-write: see detach()).
+         */
+        int* mutableRow(const int y) {
+            detach();
+            return (*buffer_)[y0_ + y].data()->data() + 3 * x0_;
+        }
+
+        /**
+         * @brief Gives this view its own copy of the region if the parent buffer is shared.
+         *
+         * Called by mutableRow(); call it once before writing rows from several threads.
+         */
+        void detach() {
+            if (isShared()) {
+                buffer_ = std::make_shared<PPM_Image>(toImage());
+                x0_ = 0;
+                y0_ = 0;
+            }
+        }
+
+        /**
+         * @brief Copies the region to a standalone image.
+         */
+        PPM_Image toImage() const {
+            PPM_Image image(height_, std::vector<channelsT>(width_));
+            if (width_ > 0) {
+                for (int y = 0; y < height_; ++y) {
+                    const auto& source = (*buffer_)[y0_ + y];
+                    std::copy(source.begin() + x0_, source.begin() + x0_ + width_, image[y].begin());
+                }
+            }
+            return image;
+        }
+
+        /**
+         * @brief Converts the view to a standalone image, moving the parent out instead of copying it when
+         * the view owns the whole of it.
+         */
+        PPM_Image release() {
+            if (buffer_ && !isShared() && x0_ == 0 && y0_ == 0
+                && height_ == static_cast<int>(buffer_->size()) && (height_ == 0 || width_ == static_cast<int>((*buffer_)[0].size()))) {
+                PPM_Image image = std::move(*buffer_);
+                buffer_.reset();
+                width_ = height_ = 0;
+                return image;
+            }
+            PPM_Image image = buffer_ ? toImage() : PPM_Image();
+            buffer_.reset();
+            width_ = height_ = x0_ = y0_ = 0;
+            return image;
+        }
+
+    private:
+        std::shared_ptr<PPM_Image> buffer_;
+        int x0_ = 0, y0_ = 0;
+        int width_ = 0, height_ = 0;
+    };
+
+
+    /**
+     * @brief Transformer node that crops every image to a rectangle, producing an ImageROI view (no pixel is copied).
+     *
+     * The output metadata carries the size of the region.
+     */
+    class Crop final : public Transformer<PPM_Image, ImageROI, PPM_Metadata> {
+    public:
+        Crop(std::string node_name, const int x, const int y, const int width, const int height)
+            : Transformer(std::move(node_name), [this](PPM_Image& input) {
+                return ImageROI(std::move(input)).crop(x_, y_, width_, height_);
+            }), x_(x), y_(y), width_(width), height_(height) {
+            if (x_ < 0 || y_ < 0 || width_ <= 0 || height_ <= 0) {
+                throw InvalidOperation("Crop::Crop", "the region must have a non-negative origin and a positive size");
+            }
+            this->logLifeCycle("Constructor(std::string, int, int, int, int)");
+        }
+
+    protected:
+        void postProcessHook() const override {
+            // The input metadata may be shared with upstream nodes: the output gets its own copy
+            auto metadata = std::make_shared<PPM_Metadata>(*this->getMetadata());
+            metadata->width = width_;
+            metadata->height = height_;
+            this->outputData->metadata = std::move(metadata);
+        }
+
+        std::string typeName() const override {
+            return "Crop";
+        }
+
+    private:
+        const int x_, y_;
+        const int width_, height_;
+    };
+
+
+    /**
+     * @brief Applies a PointOperation (or a chain of them, see FusedPointOperation) to image regions, in place.
+     *
+     * The operation is compiled into a PointOperationProgram exactly as by the PointOperation node, and run on the
+     * rows of each view in parallel: the region is processed where it lies in its parent buffer, copied only if
+     * the buffer is shared with other views (copy-on-write).
+     */
+    class ROI_PointOperation final : public Transformer<ImageROI, ImageROI, PPM_Metadata> {
+    public:
+        ROI_PointOperation(std::string node_name, const PointOperation& operation)
+            : Transformer(std::move(node_name), [this](ImageROI& input) {
+                return this->apply(input);
+            }), stages_(operation.stages()) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("Constructor(std::string, const PointOperation&)");
+        }
+
+    protected:
+        void preProcessHook() const override {
+            const int max_value = this->getMetadata()->bit_depth;
+            if (max_value != programMaxValue_) {
+                program_.reset(max_value);
+                for (const auto& stage : stages_) {
+                    stage(program_);
+                }
+                programMaxValue_ = max_value;
+            }
+        }
+
+        std::string typeName() const override {
+            return "ROI_PointOperation";
+        }
+
+    private:
+        const std::vector<PointOperation::Stage> stages_;
+        mutable PointOperationProgram program_;
+        mutable int programMaxValue_ = -1;
+
+        ImageROI apply(ImageROI& roi) const {
+            roi.detach();
+            ThreadPool::getThreadPool().parallelFor(0, roi.height(), [this, &roi](const std::size_t y) {
+                program_.apply(roi.mutableRow(static_cast<int>(y)), static_cast<std::size_t>(roi.width()));
+            }, 16);
+            return std::move(roi);
+        }
+    };
+
+
+    /**
+     * @brief Transformer node turning ImageROI views back into images (copying only the regions).
+     */
+    class MaterializeROI final : public Transformer<ImageROI, PPM_Image, PPM_Metadata> {
+    public:
+        explicit MaterializeROI(std::string node_name)
+            : Transformer(std::move(node_name), [](ImageROI& input) {
+                return input.release();
+            }) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("Constructor(std::string)");
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "MaterializeROI";
+        }
+    };
+}
+
+#endif //PIPEX_IMAGEROI_H
@@ -0,0 +1,190 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_IMAGESTATISTICS_H
+#define PIPEX_IMAGESTATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Aggregator.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Per-channel histograms of one or more images, with the statistics derived from them.
+     *
+     * Channels are counted in max_value + 1 bins (values out of range fall in the first/last bin).
+     * Histograms of different images (or of different parts of an image) are combined with merge().
+     */
+    class ImageHistogram {
+    public:
+        ImageHistogram() = default;
+
+        explicit ImageHistogram(const int max_value) : max_value_(max_value) {
+            for (auto& bins : bins_) {
+                bins.assign(static_cast<std::size_t>(max_value) + 1, 0);
+            }
+        }
+
+        /**
+         * @brief Computes the histogram of an image.
+         *
+         * The rows are split between the threads of the shared ThreadPool: each thread fills its own partial
+         * histogram, and the partial histograms are merged at the end.
+         */
+        static ImageHistogram compute(const PPM_Image& image, const int max_value, const std::size_t maxThreads = 0) {
+            constexpr std::size_t minRowsPerPart = 16;
+
+            auto& pool = ThreadPool::getThreadPool();
+            std::size_t nParts = std::min(pool.concurrency(), std::max<std::size_t>(image.size() / minRowsPerPart, 1));
+            if (maxThreads > 0) {
+                nParts = std::min(nParts, maxThreads);
+            }
+
+            std::vector<ImageHistogram> partials(nParts, ImageHistogram(max_value));
+            pool.parallelFor(0, nParts, [&](const std::size_t part) {
+                partials[part].addRows(image, image.size() * part / nParts, image.size() * (part + 1) / nParts);
+            });
+
+            for (std::size_t part = 1; part < nParts; ++part) {
+                partials[0].merge(partials[part]);
+            }
+            return std::move(partials[0]);
+        }
+
+        /**
+         * @brief Adds the counts of another histogram (with the same channel depth) to this one.
+         */
+        void merge(const ImageHistogram& other) {
+            if (other.max_value_ != max_value_) {
+                throw InvalidOperation("ImageHistogram::merge", "histograms have different channel depths");
+            }
+            for (int c = 0; c < 3; ++c) {
+                for (std::size_t v = 0; v < bins_[c].size(); ++v) {
+                    bins_[c][v] += other.bins_[c][v];
+                }
+            }
+            count_ += other.count_;
+        }
+
+        int maxValue() const { return max_value_; }
+
+        /**
+         * @brief Number of pixels counted.
+         */
+        std::uint64_t count() const { return count_; }
+
+        const std::vector<std::uint64_t>& histogram(const int channel) const { return bins_[channel]; }
+
+        int min(const int channel) const {
+            const auto& bins = bins_[channel];
+            for (std::size_t v = 0; v < bins.size(); ++v) {
+                if (bins[v]) {
+                    return static_cast<int>(v);
+                }
+            }
+            return 0;
+        }
+
+        int max(const int channel) const {
+            const auto& bins = bins_[channel];
+            for (std::size_t v = bins.size(); v-- > 0;) {
+                if (bins[v]) {
+                    return static_cast<int>(v);
+                }
+            }
+            return 0;
+        }
+
+        double mean(const int channel) const {
+            if (count_ == 0) {
+                return 0.0;
+            }
+            double sum = 0.0;
+            for (std::size_t v = 0; v < bins_[channel].size(); ++v) {
+                sum += static_cast<double>(v) * bins_[channel][v];
+            }
+            return sum / count_;
+        }
+
+        /**
+         * @brief Smallest channel value such that at least percent % of the pixels are less than or equal to it.
+         */
+        int percentile(const int channel, const double percent) const {
+            const auto& bins = bins_[channel];
+            const double target = std::min(std::max(percent, 0.0), 100.0) / 100.0 * count_;
+
+            std::uint64_t cumulative = 0;
+            for (std::size_t v = 0; v < bins.size(); ++v) {
+                cumulative += bins[v];
+                if (cumulative > 0 && cumulative >= target) {
+                    return static_cast<int>(v);
+                }
+            }
+            return max_value_;
+        }
+
+    private:
+        int max_value_ = 0;
+        std::uint64_t count_ = 0;
+        std::array<std::vector<std::uint64_t>, 3> bins_;
+
+        void addRows(const PPM_Image& image, const std::size_t y0, const std::size_t y1) {
+            std::uint64_t* r = bins_[0].data();
+            std::uint64_t* g = bins_[1].data();
+            std::uint64_t* b = bins_[2].data();
+
+            for (std::size_t y = y0; y < y1; ++y) {
+                for (const auto& pixel : image[y]) {
+                    ++r[clamp(pixel[0])];
+                    ++g[clamp(pixel[1])];
+                    ++b[clamp(pixel[2])];
+                }
+                count_ += image[y].size();
+            }
+        }
+
+        int clamp(const int v) const {
+            return v < 0 ? 0 : (v > max_value_ ? max_value_ : v);
+        }
+    };
+
+
+    /**
+     * @brief Aggregator node that reduces a batch of images to the histogram (and statistics) of all their pixels.
+     *
+     * The images keep their PPM_Metadata: the channel depth of the histogram is the bit_depth of the input.
+     */
+    class ImageStatistics final : public Aggregator<PPM_Image, ImageHistogram, PPM_Metadata> {
+    public:
+        explicit ImageStatistics(std::string node_name)
+            : Aggregator(std::move(node_name), [this](const std::vector<PPM_Image>& images) {
+                const int max_value = this->getMetadata()->bit_depth;
+
+                ImageHistogram result(max_value);
+                for (const auto& image : images) {
+                    result.merge(ImageHistogram::compute(image, max_value));
+                }
+                return result;
+            }) {
+            this->logLifeCycle("Constructor(std::string)");
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "ImageStatistics";
+        }
+    };
+}
+
+#endif //PIPEX_IMAGESTATISTICS_H
@@ -0,0 +1,43 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_INVERT_H
+#define PIPEX_INVERT_H
+
+#include <string>
+#include <vector>
+
+#include "PipeX/nodes/Image/PointOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Point operation that inverts every channel (negative image): v -> max_value - v.
+     */
+    class Invert final : public PointOperationCRTP<Invert> {
+    public:
+        explicit Invert(std::string node_name)
+            : PointOperationCRTP(std::move(node_name)) {
+            this->logLifeCycle("Invert");
+        }
+
+        std::vector<Stage> stages() const override {
+            return {[](PointOperationProgram& program) {
+                const int max_value = program.maxValue();
+
+                std::vector<int> lut(static_cast<std::size_t>(max_value) + 1);
+                for (int value = 0; value <= max_value; ++value) {
+                    lut[value] = max_value - value;
+                }
+                program.appendLUT(lut);
+            }};
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "Invert";
+        }
+    };
+}
+
+#endif //PIPEX_INVERT_H
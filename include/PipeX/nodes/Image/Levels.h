@@ -0,0 +1,62 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_LEVELS_H
+#define PIPEX_LEVELS_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "PipeX/nodes/Image/PointOperation.h"
+
+namespace PipeX {
+    /**
+     * @brief Point operation that remaps the channel range and applies a gamma curve.
+     *
+     * Input channels are normalized to [0, 1], stretched so that [blackPoint, whitePoint] maps to [0, 1]
+     * (values outside are clipped), raised to 1 / gamma and scaled back to the channel depth.
+     * All parameters are relative to the channel depth, so the same node works on 8 and 16 bit images.
+     */
+    class Levels final : public PointOperationCRTP<Levels> {
+    public:
+        Levels(std::string node_name, double blackPoint, double whitePoint, double gamma = 1.0)
+            : PointOperationCRTP(std::move(node_name)), blackPoint_(blackPoint), whitePoint_(whitePoint), gamma_(gamma) {
+            if (!(whitePoint_ > blackPoint_) || !(gamma_ > 0.0)) {
+                throw InvalidOperation("Levels::Levels", "whitePoint must be greater than blackPoint and gamma must be positive");
+            }
+            this->logLifeCycle("Levels");
+        }
+
+        std::vector<Stage> stages() const override {
+            const double blackPoint = blackPoint_;
+            const double whitePoint = whitePoint_;
+            const double invGamma = 1.0 / gamma_;
+
+            return {[blackPoint, whitePoint, invGamma](PointOperationProgram& program) {
+                const int max_value = program.maxValue();
+
+                std::vector<int> lut(static_cast<std::size_t>(max_value) + 1);
+                for (int value = 0; value <= max_value; ++value) {
+                    double x = (value / static_cast<double>(max_value) - blackPoint) / (whitePoint - blackPoint);
+                    x = x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x);
+                    lut[value] = static_cast<int>(std::round(std::pow(x, invGamma) * max_value));
+                }
+                program.appendLUT(lut);
+            }};
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "Levels";
+        }
+
+    private:
+        const double blackPoint_;
+        const double whitePoint_;
+        const double gamma_;
+    };
+}
+
+#endif //PIPEX_LEVELS_H
@@ -0,0 +1,68 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_MEDIANFILTER_H
+#define PIPEX_MEDIANFILTER_H
+
+#include <string>
+#include <utility>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/Image/Convolution.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Transformer node replacing every channel with its median over a (2 * radius + 1)^2 square window.
+     *
+     * 8-bit images (bit_depth up to 255) use the constant-time histogram algorithm of Perreault and Hébert:
+     * each tile keeps one histogram per column of the window, slid down one row at a time, and the window
+     * histogram is slid along the row by adding the entering column and subtracting the leaving one (SIMD).
+     * The median is found through a two-level (16 coarse x 16 fine bins) histogram, so the cost per pixel
+     * does not depend on the radius. Deeper images fall back to a selection over the window of each pixel.
+     *
+     * Images are processed in tiles on the shared ThreadPool; the radius is limited to maxRadius so that
+     * window counts fit in 16 bits.
+     */
+    class MedianFilter final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        static constexpr int maxRadius = 127;
+
+        MedianFilter(std::string node_name, int radius, BorderMode border = BorderMode::Clamp);
+
+        /**
+         * @brief Median of the (2 * radius + 1)^2 window around every pixel of an image with channels in [0, max_value].
+         */
+        static PPM_Image median(const PPM_Image& image, int radius, int max_value, BorderMode border, const TilingOptions& options);
+
+        /**
+         * @brief Overrides the tiling used by this node (ImageTiling::defaultOptions() otherwise).
+         */
+        void setTilingOptions(const TilingOptions& options) {
+            tilingOptions_ = options;
+            hasTilingOptions_ = true;
+        }
+
+    protected:
+        void preProcessHook() const override {
+            maxValue_ = this->getMetadata()->bit_depth;
+        }
+
+        std::string typeName() const override {
+            return "MedianFilter";
+        }
+
+    private:
+        const int radius_;
+        const BorderMode border_;
+
+        TilingOptions tilingOptions_;
+        bool hasTilingOptions_ = false;
+        mutable int maxValue_ = 255;
+    };
+}
+
+#endif //PIPEX_MEDIANFILTER_H
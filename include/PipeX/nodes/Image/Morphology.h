@@ -0,0 +1,75 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_MORPHOLOGY_H
+#define PIPEX_MORPHOLOGY_H
+
+#include <string>
+#include <utility>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/Image/Convolution.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Grayscale morphological operation applied (to every channel) by the Morphology node.
+     */
+    enum class MorphologyOperation {
+        Erode,  ///< Minimum over the structuring element
+        Dilate, ///< Maximum over the structuring element
+        Open,   ///< Erode, then dilate (removes bright details smaller than the structuring element)
+        Close   ///< Dilate, then erode (removes dark details smaller than the structuring element)
+    };
+
+    /**
+     * @brief Transformer node applying a morphological operation with a (2 * radiusX + 1) x (2 * radiusY + 1)
+     * rectangular structuring element.
+     *
+     * Minimum and maximum filters are separable: rows are filtered first (in parallel), then strips of columns.
+     * Each 1D pass uses the van Herk/Gil-Werman algorithm (prefix and suffix extrema over blocks of the window
+     * size), i.e. 3 comparisons per channel whatever the size of the structuring element; the vertical pass
+     * compares whole rows of channels with SIMD.
+     */
+    class Morphology final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        Morphology(std::string node_name, MorphologyOperation operation, int radius, BorderMode border = BorderMode::Clamp);
+        Morphology(std::string node_name, MorphologyOperation operation, int radiusX, int radiusY, BorderMode border = BorderMode::Clamp);
+
+        /**
+         * @brief In-place minimum (or maximum) filter over a (2 * radiusX + 1) x (2 * radiusY + 1) window.
+         */
+        static void minMaxFilter(PPM_Image& image, int radiusX, int radiusY, bool maximum, BorderMode border, std::size_t maxThreads = 0);
+
+        /**
+         * @brief Overrides the tiling used by this node (ImageTiling::defaultOptions() otherwise).
+         *
+         * Only maxThreads applies: the passes work on whole rows and strips of columns.
+         */
+        void setTilingOptions(const TilingOptions& options) {
+            tilingOptions_ = options;
+            hasTilingOptions_ = true;
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "Morphology";
+        }
+
+    private:
+        const MorphologyOperation operation_;
+        const int radiusX_;
+        const int radiusY_;
+        const BorderMode border_;
+
+        TilingOptions tilingOptions_;
+        bool hasTilingOptions_ = false;
+
+        PPM_Image apply(PPM_Image& image) const;
+    };
+}
+
+#endif //PIPEX_MORPHOLOGY_H
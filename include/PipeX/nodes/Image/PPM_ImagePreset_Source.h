@@ -7,43 +7,64 @@
 #define PIPEX_NODES_IMAGE_PPM_IMAGESAMPLE_SOURCE_H
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "PipeX/metadata/PPM_Metadata.h"
 #include "PipeX/nodes/primitives/Source.h"
 #include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
 #include "PipeX/errors/PipeXException.h"
+#include "my_extended_cpp_standard/my_memory.h"
 
 namespace PipeX {
 
     /**
      * @brief Source node that generates PPM images based on presets.
      *
-     * Can generate gradient, checkerboard, or color check patterns, or load from file.
+     * Can generate gradient, checkerboard, color check or noise patterns, or load from file.
+     * Presets are procedural and generated row-parallel, so they can be used as synthetic workloads
+     * of any size (from compressible to incompressible content) without touching the disk.
      */
-    class PPM_ImagePreset_Source final : public Source<PPM_Image, PPM_Metadata> {
+    class PPM_ImagePreset_Source final : public Source<PPM_Image, PPM_Metadata>, public ImageBatchIO<PPM_ImagePreset_Source> {
         public:
+            static constexpr int GRADIENT = 0;      ///< Red along x, green along y
+            static constexpr int CHECKERBOARD = 1;  ///< 8 x 8 black and white squares
+            static constexpr int COLOR_CHECK = 2;   ///< The 24 patches of a colour checker chart (sRGB), on a black background
+            static constexpr int NOISE = 3;         ///< Uniform white noise, different for every image of the batch (deterministic)
+
             PPM_ImagePreset_Source(std::string node_name, const int width, const int height, const int preset, const int count)
                     : Source(std::move(node_name), [this]() {
-                        this->createMetadata();
-                        this->setupPPMMetadata();
-
-                        auto images = std::vector<PPM_Image>();
-                        for (int i = 0; i < count_; ++i) {
-                            images.push_back(getImagePreset(width_, height_, preset_));
-                            auto& image = images.back();
-
-                            if (image.empty() || image[0].empty()) {
-                                PIPEX_PRINT_DEBUG_ERROR("[%s] \"%s\" {%p} :: Constructor() -> Error: Generated image is empty.\n", this->typeName().c_str(), this->getName().c_str(), this);
-                                throw PipeXException("[PPM_ImagePreset_Source::Constructor] Image is empty.");
-                            }
-                        }
-                        return images;
+                        return this->generate();
                     }), width_(width), height_(height), count_(count), preset_(preset) {
                 this->logLifeCycle("Constructor(width, height, sample, name)");
             }
 
+            /**
+             * @brief Copy constructors: the copy generates its images with its own settings and metadata.
+             */
+            PPM_ImagePreset_Source(const PPM_ImagePreset_Source& other)
+                    : PPM_ImagePreset_Source(other, other.getName() + "_copy") {
+            }
+
+            PPM_ImagePreset_Source(const PPM_ImagePreset_Source& other, std::string node_name)
+                    : Source(std::move(node_name), [this]() {
+                        return this->generate();
+                    }), ImageBatchIO(other), width_(other.width_), height_(other.height_), count_(other.count_), preset_(other.preset_) {
+                this->logLifeCycle("CopyConstructor(const PPM_ImagePreset_Source&, std::string)");
+            }
+
+            std::unique_ptr<INode> clone() const override {
+                this->logLifeCycle("clone()");
+                return extended_std::make_unique<PPM_ImagePreset_Source>(*this);
+            }
+
+            std::unique_ptr<INode> clone(std::string node_name) const override {
+                this->logLifeCycle("clone(std::string)");
+                return extended_std::make_unique<PPM_ImagePreset_Source>(*this, std::move(node_name));
+            }
+
     protected:
         std::string typeName() const override {
             return "PPM_ImageSample_Source";
@@ -55,20 +76,41 @@ namespace PipeX {
         const int count_;
         const int preset_;
 
+        std::vector<PPM_Image> generate() {
+            this->createMetadata();
+            this->setupPPMMetadata();
+
+            // Images are generated concurrently, each one in its own slot (the batch order is preserved)
+            auto images = std::vector<PPM_Image>(count_ > 0 ? count_ : 0);
+            ThreadPool::getThreadPool().parallelFor(0, images.size(), [this, &images](const std::size_t i) {
+                images[i] = getImagePreset(width_, height_, preset_, i);
+            }, 1, getBatchParallelism());
+
+            for (const auto& image : images) {
+                if (image.empty() || image[0].empty()) {
+                    PIPEX_PRINT_DEBUG_ERROR("[%s] \"%s\" {%p} :: Constructor() -> Error: Generated image is empty.\n", this->typeName().c_str(), this->getName().c_str(), this);
+                    throw PipeXException("[PPM_ImagePreset_Source::Constructor] Image is empty.");
+                }
+            }
+            return images;
+        }
+
         void setupPPMMetadata() const {
             sourceMetadata->width = width_;
             sourceMetadata->height = height_;
             sourceMetadata->bit_depth = 255; // 8 bits per channel
         }
 
-        PPM_Image getImagePreset(const int width, const int height, const int preset) const {
+        PPM_Image getImagePreset(const int width, const int height, const int preset, const std::size_t index) const {
             switch (preset) {
-            case 0:
+            case GRADIENT:
                 return gradientImage(width, height);
-            case 1:
+            case CHECKERBOARD:
                 return checkerboardImage(width, height);
-            case 2:
+            case COLOR_CHECK:
                 return colorCheckImage(width, height);
+            case NOISE:
+                return noiseImage(width, height, index);
             default:
                 return loadImageFile(preset);
             }
@@ -77,6 +119,7 @@ namespace PipeX {
         PPM_Image gradientImage(int width, int height) const;
         PPM_Image checkerboardImage(int width, int height) const;
         PPM_Image colorCheckImage(int width, int height) const;
+        PPM_Image noiseImage(int width, int height, std::size_t seed) const;
         PPM_Image loadImageFile(int sample) const;
     };
 }
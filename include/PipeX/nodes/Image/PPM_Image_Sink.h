@@ -6,53 +6,102 @@
 #define PIPEX_PPM_IMAGE_SINK_H
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "PipeX/metadata/PPM_Metadata.h"
 #include "PipeX/nodes/primitives/Sink.h"
 #include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/ppm_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
 #include "PipeX/errors/PipeX_IO_Exception.h"
+#include "my_extended_cpp_standard/my_memory.h"
 
 namespace PipeX {
     /**
      * @brief Sink node that saves PPM images to files.
      *
      * Writes each received image to a separate PPM file with an index suffix and adds the .ppm extension.
+     * Images are written as plain text (P3, the default) or binary (P6) PPM at the bit depth of the metadata:
+     * P6 uses 1 byte per channel up to a bit depth of 255 and 2 bytes (16 bits) above. Every file is encoded
+     * in memory and written with a single call, the images of a batch concurrently.
+     *
+     * ImageT is the type of the images received: PPM_Image (PPM_Image_Sink) or an ImageBuffer
+     * (PPM_ImageBuffer_Sink<ChannelT>), encoded straight from its channels; float channels are rounded.
      */
-    class PPM_Image_Sink final: public Sink<PPM_Image, PPM_Metadata> {
+    template <typename ImageT>
+    class BasicPPM_Image_Sink final: public Sink<ImageT, PPM_Metadata>, public ImageBatchIO<BasicPPM_Image_Sink<ImageT>> {
     public:
-        PPM_Image_Sink(std::string node_name, std::string filename)
-                : Sink(std::move(node_name), [this](const std::vector<PPM_Image>& images) {
-                    int index = 0;
-                    for (auto& image : images) {
-                        saveToFile(image, filename_ + "_" + std::to_string(index++) + ".ppm");
-                    }
-                }), filename_(std::move(filename)) {
+        BasicPPM_Image_Sink(std::string node_name, std::string filename, const PPM::Format format = PPM::Format::Plain)
+                : Sink<ImageT, PPM_Metadata>(std::move(node_name), [this](const std::vector<ImageT>& images) {
+                    this->save(images);
+                }), filename_(std::move(filename)), format_(format) {
             this->logLifeCycle("Constructor(filename, name)");
         }
 
+        /**
+         * @brief Copy constructors: the copy writes the same files, at the bit depth of its own input.
+         */
+        BasicPPM_Image_Sink(const BasicPPM_Image_Sink& other)
+                : BasicPPM_Image_Sink(other, other.getName() + "_copy") {
+        }
+
+        BasicPPM_Image_Sink(const BasicPPM_Image_Sink& other, std::string node_name)
+                : Sink<ImageT, PPM_Metadata>(std::move(node_name), [this](const std::vector<ImageT>& images) {
+                    this->save(images);
+                }), ImageBatchIO<BasicPPM_Image_Sink>(other), filename_(other.filename_), format_(other.format_) {
+            this->logLifeCycle("CopyConstructor(const PPM_Image_Sink&, std::string)");
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<BasicPPM_Image_Sink>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<BasicPPM_Image_Sink>(*this, std::move(node_name));
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "PPM_Image_Sink";
+        }
+
     private:
         const std::string filename_;
+        const PPM::Format format_;
+
+        void save(const std::vector<ImageT>& images) const {
+            ThreadPool::getThreadPool().parallelFor(0, images.size(), [this, &images](const std::size_t i) {
+                saveToFile(images[i], filename_ + "_" + std::to_string(i) + ".ppm");
+            }, 1, this->getBatchParallelism());
+        }
 
-        void saveToFile(const PPM_Image& image, const std::string& filename) const {
-            const auto&metadata = this->getMetadata();
+        void saveToFile(const ImageT& image, const std::string& filename) const {
+            const auto& metadata = this->getMetadata();
+            const std::vector<char> buffer = PPM::encode(image, metadata->bit_depth, format_);
 
-            std::ofstream file(filename);
+            std::ofstream file(filename, std::ios::binary);
             if (!file) {
                 throw PipeX_IO_Exception("[PPM_Image_Sink::saveToFile] Could not open file for writing: " + filename
                     + ", make sure the directory exists.");
             }
-
-            const int height = metadata->height;
-            const int width = metadata->width;
-            file << "P3\n" << width << " " << height << "\n" << metadata->bit_depth << "\n";
-            for (const auto& row : image) {
-                for (const auto& pixel : row) {
-                    file << pixel[0] << " " << pixel[1] << " " << pixel[2] << "\n";
-                }
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!file) {
+                throw PipeX_IO_Exception("[PPM_Image_Sink::saveToFile] Could not write file: " + filename);
             }
         }
     };
+
+    using PPM_Image_Sink = BasicPPM_Image_Sink<PPM_Image>;
+
+    /**
+     * @brief PPM Sink writing compact images (Image8, Image16 or FloatImage), for typed pipelines.
+     */
+    template <typename ChannelT>
+    using PPM_ImageBuffer_Sink = BasicPPM_Image_Sink<ImageBuffer<ChannelT>>;
 }
 
-#endif //PIPEX_PPM_IMAGE_SINK_H
\ No newline at end of file
+#endif //PIPEX_PPM_IMAGE_SINK_H
@@ -0,0 +1,170 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_PPM_IMAGE_SOURCE_H
+#define PIPEX_PPM_IMAGE_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Source.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/ppm_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+#include "my_extended_cpp_standard/my_memory.h"
+
+namespace PipeX {
+    /**
+     * @brief Source node that loads a batch of PPM images (P3 or P6, 8 or 16 bits per channel).
+     *
+     * Each file is read with a single call and decoded on the shared ThreadPool, the files of the batch
+     * concurrently. All the images of a batch must have the same size and maximum value, since they share
+     * one PPM_Metadata (bit_depth is the maximum value declared by the files). The (filename, count)
+     * constructor reads the files written by a PPM_Image_Sink with the same filename.
+     *
+     * With framesPerBlock > 0 the files are the frames of a sequence, streamed in blocks (see ImageFileStream): each
+     * run of the pipeline nodes receives the next framesPerBlock images, so a long sequence never has to be held in
+     * memory at once (e.g. through a TemporalFilter). With framesPerBlock == 0 every run loads the whole batch.
+     *
+     * ImageT is the type of the images produced: PPM_Image (PPM_Image_Source) or an ImageBuffer
+     * (PPM_ImageBuffer_Source<ChannelT>), decoded straight into its channels; the bit depth of the files must fit
+     * the channel type (InvalidOperation otherwise).
+     */
+    template <typename ImageT>
+    class BasicPPM_Image_Source final : public Source<ImageT, PPM_Metadata>, public ImageBatchIO<BasicPPM_Image_Source<ImageT>> {
+    public:
+        BasicPPM_Image_Source(std::string node_name, std::vector<std::string> filenames, const std::size_t framesPerBlock = 0)
+                : Source<ImageT, PPM_Metadata>(std::move(node_name), [this]() {
+                    return this->load();
+                }), filenames_(std::move(filenames)), stream_(framesPerBlock) {
+            this->logLifeCycle("Constructor(std::string, std::vector<std::string>, std::size_t)");
+        }
+
+        /**
+         * @brief Copy constructors: the copy reads the same files with its own metadata, from the start of the sequence.
+         */
+        BasicPPM_Image_Source(const BasicPPM_Image_Source& other)
+                : BasicPPM_Image_Source(other, other.getName() + "_copy") {
+        }
+
+        BasicPPM_Image_Source(const BasicPPM_Image_Source& other, std::string node_name)
+                : Source<ImageT, PPM_Metadata>(std::move(node_name), [this]() {
+                    return this->load();
+                }), ImageBatchIO<BasicPPM_Image_Source>(other), filenames_(other.filenames_), stream_(other.stream_.framesPerBlock()) {
+            this->logLifeCycle("CopyConstructor(const PPM_Image_Source&, std::string)");
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<BasicPPM_Image_Source>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<BasicPPM_Image_Source>(*this, std::move(node_name));
+        }
+
+        /**
+         * @brief Reads the files filename_0 to filename_<count - 1>.
+         *
+         * A template, so that a braced list of file names (which cannot deduce FilenameT) always selects the
+         * constructor taking the vector, instead of being read as an iterator range of std::string.
+         */
+        template <typename FilenameT, typename = typename std::enable_if<std::is_convertible<const FilenameT&, std::string>::value>::type>
+        BasicPPM_Image_Source(std::string node_name, const FilenameT& filename, const int count, const std::size_t framesPerBlock = 0)
+                : BasicPPM_Image_Source(std::move(node_name), indexedFilenames(filename, count), framesPerBlock) {}
+
+        bool hasPendingData() const override {
+            return stream_.hasPendingData(filenames_.size());
+        }
+
+        /**
+         * @brief Rewinds the sequence: the next run starts again from the first file.
+         */
+        void endOfStream() override {
+            stream_.rewind();
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "PPM_Image_Source";
+        }
+
+    private:
+        const std::vector<std::string> filenames_;
+        ImageFileStream stream_;
+
+        std::vector<ImageT> load() {
+            this->createMetadata();
+
+            std::size_t begin, end;
+            stream_.next(filenames_.size(), begin, end);
+            auto images = std::vector<ImageT>(end - begin);
+            std::vector<int> maxValues(images.size());
+            ThreadPool::getThreadPool().parallelFor(0, images.size(), [this, &images, &maxValues, begin](const std::size_t i) {
+                images[i] = loadFile(filenames_[begin + i], maxValues[i]);
+            }, 1, this->getBatchParallelism());
+
+            this->setupPPMMetadata(images, maxValues, begin);
+            return images;
+        }
+
+        static std::vector<std::string> indexedFilenames(const std::string& filename, const int count) {
+            std::vector<std::string> filenames;
+            for (int i = 0; i < count; ++i) {
+                filenames.push_back(filename + "_" + std::to_string(i) + ".ppm");
+            }
+            return filenames;
+        }
+
+        void setupPPMMetadata(const std::vector<ImageT>& images, const std::vector<int>& maxValues, const std::size_t begin) const {
+            const auto& metadata = this->sourceMetadata;
+            metadata->bit_depth = 255;
+            if (images.empty()) {
+                return;
+            }
+
+            metadata->bit_depth = maxValues[0];
+            metadata->height = imageHeight(images[0]);
+            metadata->width = imageWidth(images[0]);
+            for (std::size_t i = 1; i < images.size(); ++i) {
+                if (imageHeight(images[i]) != metadata->height || imageWidth(images[i]) != metadata->width || maxValues[i] != metadata->bit_depth) {
+                    throw PipeX_IO_Exception("[PPM_Image_Source] Images of a batch must have the same size and bit depth: " + filenames_[begin + i]);
+                }
+            }
+        }
+
+        static ImageT loadFile(const std::string& filename, int& max_value) {
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if (!file) {
+                throw PipeX_IO_Exception("[PPM_Image_Source::loadFile] Could not open file for reading: " + filename);
+            }
+
+            const std::streamsize size = file.tellg();
+            std::vector<std::uint8_t> buffer(size > 0 ? static_cast<std::size_t>(size) : 0);
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
+                throw PipeX_IO_Exception("[PPM_Image_Source::loadFile] Could not read file: " + filename);
+            }
+            return PPM::decodeImage<ImageT>(buffer.data(), buffer.size(), max_value);
+        }
+    };
+
+    using PPM_Image_Source = BasicPPM_Image_Source<PPM_Image>;
+
+    /**
+     * @brief PPM Source producing compact images (Image8, Image16 or FloatImage), for typed pipelines.
+     */
+    template <typename ChannelT>
+    using PPM_ImageBuffer_Source = BasicPPM_Image_Source<ImageBuffer<ChannelT>>;
+}
+
+#endif //PIPEX_PPM_IMAGE_SOURCE_H
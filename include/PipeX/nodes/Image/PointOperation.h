@@ -0,0 +1,561 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_POINTOPERATION_H
+#define PIPEX_POINTOPERATION_H
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/tiling_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
+#include "my_extended_cpp_standard/my_memory.h"
+
+namespace PipeX {
+    /**
+     * @brief Compiled form of a chain of point operations for a given channel depth.
+     *
+     * A program is made of a per-channel lookup table, an optional luma mix (RGB -> gray) and a
+     * second lookup table applied after the mix. Appending a lookup table composes it with the
+     * current one, so any chain of per-channel operations collapses into a single table and the
+     * whole chain is applied in one pass over the pixels.
+     */
+    class PointOperationProgram {
+    public:
+        /// A stage appends its contribution to the program, for the channel depth given by program.maxValue()
+        using Stage = std::function<void(PointOperationProgram& program)>;
+
+        explicit PointOperationProgram(const int max_value = 0) {
+            reset(max_value);
+        }
+
+        /**
+         * @brief Compiles a chain of stages, in application order, for channels in [0, max_value].
+         */
+        static PointOperationProgram compile(const std::vector<Stage>& stages, const int max_value) {
+            PointOperationProgram program(max_value);
+            for (const auto& stage : stages) {
+                stage(program);
+            }
+            return program;
+        }
+
+        /**
+         * @brief Resets the program to the identity for channels in [0, max_value].
+         */
+        void reset(const int max_value) {
+            max_value_ = max_value;
+            hasLumaMix_ = false;
+            preLUT_.resize(static_cast<std::size_t>(max_value) + 1);
+            for (int v = 0; v <= max_value; ++v) {
+                preLUT_[v] = v;
+            }
+            postLUT_ = preLUT_;
+            for (auto& table : lumaTables_) {
+                table.clear();
+            }
+        }
+
+        int maxValue() const { return max_value_; }
+        bool hasLumaMix() const { return hasLumaMix_; }
+
+        /**
+         * @brief Composes a per-channel lookup table (of maxValue() + 1 entries) after the current program.
+         */
+        void appendLUT(const std::vector<int>& lut) {
+            if (lut.size() != preLUT_.size()) {
+                throw InvalidOperation("PointOperationProgram::appendLUT", "lookup table size does not match the channel depth");
+            }
+
+            auto& target = hasLumaMix_ ? postLUT_ : preLUT_;
+            for (auto& value : target) {
+                value = lut[clamp(value)];
+            }
+        }
+
+        /**
+         * @brief Appends a luma mix: every channel of a pixel is replaced by round(wr * R + wg * G + wb * B).
+         *
+         * The current lookup table is folded into per-channel weight tables. Only one mix per program is supported.
+         */
+        void appendLumaMix(const double wr, const double wg, const double wb) {
+            if (hasLumaMix_) {
+                throw InvalidOperation("PointOperationProgram::appendLumaMix", "a program supports a single luma mix");
+            }
+
+            weights_ = {{wr, wg, wb}};
+            const std::array<double, 3>& weights = weights_;
+            for (int c = 0; c < 3; ++c) {
+                lumaTables_[c].resize(preLUT_.size());
+                for (std::size_t v = 0; v < preLUT_.size(); ++v) {
+                    lumaTables_[c][v] = weights[c] * preLUT_[v];
+                }
+            }
+            hasLumaMix_ = true;
+        }
+
+        /**
+         * @brief Runs the program over the core region of a tile of the image, in place.
+         */
+        void apply(PPM_Image& image, const ImageTile& tile) const {
+            for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                apply(image[y][tile.x0].data(), static_cast<std::size_t>(tile.width));
+            }
+        }
+
+        /**
+         * @brief Runs the program over a contiguous run of pixels (3 channels each), in place.
+         */
+        void apply(int* channels, const std::size_t pixels) const {
+            if (!hasLumaMix_) {
+                applyLUT(channels, pixels * 3, preLUT_);
+                return;
+            }
+
+            const double* tr = lumaTables_[0].data();
+            const double* tg = lumaTables_[1].data();
+            const double* tb = lumaTables_[2].data();
+            const int* post = postLUT_.data();
+
+            for (std::size_t x = 0; x < pixels; ++x, channels += 3) {
+                const double gray = tr[clamp(channels[0])] + tg[clamp(channels[1])] + tb[clamp(channels[2])];
+                const int value = post[clamp(static_cast<int>(std::round(gray)))];
+                channels[0] = value;
+                channels[1] = value;
+                channels[2] = value;
+            }
+        }
+
+        /**
+         * @brief Runs the program over the core region of a tile of a compact image, in place.
+         */
+        template <typename ChannelT>
+        void apply(ImageBuffer<ChannelT>& image, const ImageTile& tile) const {
+            for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                apply(image.row(y) + 3 * tile.x0, static_cast<std::size_t>(tile.width));
+            }
+        }
+
+        /**
+         * @brief Runs the program over a contiguous run of compact pixels, in place.
+         *
+         * Integer channels go through the lookup tables with the kernel of their width; float channels interpolate
+         * the tables between their entries and the luma mix is not rounded, so they stay unquantized.
+         */
+        template <typename ChannelT>
+        void apply(ChannelT* channels, const std::size_t pixels) const {
+            if (!hasLumaMix_) {
+                applyLUT(channels, pixels * 3, preLUT_);
+                return;
+            }
+
+            for (std::size_t x = 0; x < pixels; ++x, channels += 3) {
+                const ChannelT value = mixLuma(channels);
+                channels[0] = value;
+                channels[1] = value;
+                channels[2] = value;
+            }
+        }
+
+    private:
+        int max_value_ = 0;
+        bool hasLumaMix_ = false;
+        std::array<double, 3> weights_ = {{0.0, 0.0, 0.0}};
+
+        std::vector<int> preLUT_;
+        std::vector<int> postLUT_;
+        std::array<std::vector<double>, 3> lumaTables_;
+
+        int clamp(const int v) const {
+            return v < 0 ? 0 : (v > max_value_ ? max_value_ : v);
+        }
+
+        template <typename ChannelT>
+        ChannelT mixLuma(const ChannelT* pixel) const {
+            const double gray = lumaTables_[0][clamp(pixel[0])] + lumaTables_[1][clamp(pixel[1])] + lumaTables_[2][clamp(pixel[2])];
+            const int value = postLUT_[clamp(static_cast<int>(std::round(gray)))];
+            return static_cast<ChannelT>(value < 0 ? 0 : value);
+        }
+
+        float mixLuma(const float* pixel) const {
+            const double gray = weights_[0] * interpolateLUT(preLUT_, pixel[0]) + weights_[1] * interpolateLUT(preLUT_, pixel[1])
+                                + weights_[2] * interpolateLUT(preLUT_, pixel[2]);
+            return interpolateLUT(postLUT_, static_cast<float>(gray));
+        }
+    };
+
+
+    /**
+     * @brief Base class for image nodes whose output channel depends only on the input pixel.
+     *
+     * A point operation describes itself as a list of stages that append lookup tables (or a luma mix)
+     * to a PointOperationProgram. The program is compiled once per channel depth and cached.
+     * Adjacent point operations in a Pipeline are fused into a single FusedPointOperation node,
+     * so the whole chain is applied in one pass over the pixels. Each image is split into tiles
+     * (see ImageTiling) processed in parallel on the shared ThreadPool.
+     */
+    class PointOperation : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        using Stage = PointOperationProgram::Stage;
+
+        /**
+         * @brief Returns the stages implementing this operation, in application order.
+         */
+        virtual std::vector<Stage> stages() const = 0;
+
+        /**
+         * @brief Number of luma mixes performed by this operation (a fused program supports at most one).
+         */
+        virtual int lumaMixCount() const { return 0; }
+
+        bool canFuseWith(const INode& next) const override {
+            const auto* nextOperation = dynamic_cast<const PointOperation*>(&next);
+            return nextOperation && lumaMixCount() + nextOperation->lumaMixCount() <= 1;
+        }
+
+        std::unique_ptr<INode> fuseWith(const INode& next) const override;
+
+        /**
+         * @brief Overrides the tiling used by this node (ImageTiling::defaultOptions() otherwise).
+         */
+        void setTilingOptions(const TilingOptions& options) {
+            tilingOptions_ = options;
+            hasTilingOptions_ = true;
+        }
+
+        /**
+         * @brief Applies the operation in place to a compact image (Image8, Image16 or FloatImage) with channels in
+         * [0, max_value], tile by tile on the shared ThreadPool.
+         *
+         * The program is compiled for this call only, so apply() may run concurrently from several threads (with
+         * any channel depth), also while the node is processing in a pipeline.
+         * @throws InvalidOperation if max_value does not fit the channel type.
+         */
+        template <typename ChannelT>
+        void apply(ImageBuffer<ChannelT>& image, const int max_value) const {
+            checkChannelDepth<ChannelT>(max_value);
+            const PointOperationProgram program = PointOperationProgram::compile(stages(), max_value);
+            ImageTiling::forEachTile(image.width, image.height, tilingOptions(), [&program, &image](const ImageTile& tile) {
+                program.apply(image, tile);
+            });
+        }
+
+    protected:
+        explicit PointOperation(std::string node_name)
+            : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+                return this->applyProgram(input);
+            }) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("PointOperation(std::string)");
+        }
+
+        /**
+         * @brief Copy constructor: the copy runs its own program (compiled by its first run), not the one of other.
+         */
+        PointOperation(const PointOperation& other)
+            : PointOperation(other, other.getName() + "_copy") {
+        }
+
+        PointOperation(const PointOperation& other, std::string node_name)
+            : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+                return this->applyProgram(input);
+            }), tilingOptions_(other.tilingOptions_), hasTilingOptions_(other.hasTilingOptions_) {
+            this->setBatchParallelism(other.getBatchParallelism());
+            this->logLifeCycle("CopyConstructor(const PointOperation&, std::string)");
+        }
+
+        /**
+         * @brief Compiles the program for the bit depth of the incoming images, if not already cached.
+         */
+        void preProcessHook() const override {
+            compileProgram(this->getMetadata()->bit_depth);
+        }
+
+        std::string typeName() const override {
+            return "PointOperation";
+        }
+
+    private:
+        mutable PointOperationProgram program_;
+        mutable int programMaxValue_ = -1;
+        TilingOptions tilingOptions_;
+        bool hasTilingOptions_ = false;
+
+        const TilingOptions& tilingOptions() const {
+            return hasTilingOptions_ ? tilingOptions_ : ImageTiling::defaultOptions();
+        }
+
+        void compileProgram(const int max_value) const {
+            if (max_value != programMaxValue_) {
+                this->logLifeCycle("compileProgram()");
+
+                program_ = PointOperationProgram::compile(stages(), max_value);
+                programMaxValue_ = max_value;
+            }
+        }
+
+        PPM_Image applyProgram(PPM_Image& data) const {
+            if (!data.empty()) {
+                ImageTiling::forEachTile(static_cast<int>(data[0].size()), static_cast<int>(data.size()), tilingOptions(), [this, &data](const ImageTile& tile) {
+                    program_.apply(data, tile);
+                });
+            }
+            return std::move(data);
+        }
+    };
+
+
+    /**
+     * @brief Base of the concrete point operations: clones them as their own type.
+     *
+     * NodeCRTP::clone() would copy a point operation as a plain Transformer, whose function still runs the program of
+     * the original node; the clone is instead a Derived with its own program, so a copied Pipeline keeps its point
+     * operations (and their fusion).
+     */
+    template <typename Derived>
+    class PointOperationCRTP : public PointOperation {
+    public:
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<Derived>(static_cast<const Derived&>(*this));
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            auto copy = extended_std::make_unique<Derived>(static_cast<const Derived&>(*this));
+            copy->name = std::move(node_name);
+            return std::unique_ptr<INode>(std::move(copy));
+        }
+
+    protected:
+        explicit PointOperationCRTP(std::string node_name)
+            : PointOperation(std::move(node_name)) {
+        }
+
+        PointOperationCRTP(const PointOperationCRTP& other) = default;
+    };
+
+
+    /**
+     * @brief Point operation made of a chain of other point operations, applied in a single pass.
+     *
+     * Created by the Pipeline when adjacent point operations are found; it appears in the
+     * pipeline execution plan as a single node named "fused(A + B + ...)".
+     */
+    class FusedPointOperation final : public PointOperationCRTP<FusedPointOperation> {
+    public:
+        FusedPointOperation(std::string node_name, std::vector<Stage> stages, const int lumaMixCount)
+            : PointOperationCRTP(std::move(node_name)), stages_(std::move(stages)), lumaMixCount_(lumaMixCount) {
+            this->logLifeCycle("FusedPointOperation(std::string, std::vector<Stage>, int)");
+        }
+
+        std::vector<Stage> stages() const override { return stages_; }
+        int lumaMixCount() const override { return lumaMixCount_; }
+
+        /**
+         * @brief Name of the operations fused in this node, without the "fused(...)" decoration.
+         */
+        std::string fusedNames() const {
+            return this->getName().substr(6, this->getName().size() - 7);
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "FusedPointOperation";
+        }
+
+    private:
+        const std::vector<Stage> stages_;
+        const int lumaMixCount_;
+    };
+
+
+    inline std::unique_ptr<INode> PointOperation::fuseWith(const INode& next) const {
+        const auto& nextOperation = dynamic_cast<const PointOperation&>(next);
+
+        std::vector<Stage> fusedStages = stages();
+        const auto nextStages = nextOperation.stages();
+        fusedStages.insert(fusedStages.end(), nextStages.begin(), nextStages.end());
+
+        const auto* fusedThis = dynamic_cast<const FusedPointOperation*>(this);
+        const std::string fusedName = "fused(" + (fusedThis ? fusedThis->fusedNames() : this->getName()) + " + " + next.getName() + ")";
+
+        return extended_std::make_unique<FusedPointOperation>(fusedName, std::move(fusedStages), lumaMixCount() + nextOperation.lumaMixCount());
+    }
+
+    /**
+     * @brief Point operation over compact images (Image8, Image16 or FloatImage), for typed pipelines.
+     *
+     * Runs the stages of a point operation on ImageBuffer<ChannelT>, so the images keep their channel type through
+     * the pipeline. As in PointOperation, the program is compiled once per bit depth and applied tile by tile on the
+     * shared ThreadPool, and adjacent nodes with the same channel type are fused into a single one named
+     * "fused(A + B + ...)". Float channels interpolate the lookup tables (see PointOperationProgram::apply).
+     */
+    template <typename ChannelT>
+    class ImageBufferPointOperation : public Transformer<ImageBuffer<ChannelT>, ImageBuffer<ChannelT>, PPM_Metadata> {
+        using Base = Transformer<ImageBuffer<ChannelT>, ImageBuffer<ChannelT>, PPM_Metadata>;
+
+    public:
+        using Stage = PointOperationProgram::Stage;
+
+        ImageBufferPointOperation(std::string node_name, std::vector<Stage> stages, const int lumaMixCount)
+            : Base(std::move(node_name), [this] (ImageBuffer<ChannelT>& input) {
+                return this->applyProgram(input);
+            }), stages_(std::move(stages)), lumaMixCount_(lumaMixCount) {
+            this->setBatchParallelism(0);
+            this->logLifeCycle("ImageBufferPointOperation(std::string, std::vector<Stage>, int)");
+        }
+
+        /**
+         * @brief Runs the stages of operation (e.g. an Invert or a Levels node, used only as a description).
+         */
+        ImageBufferPointOperation(std::string node_name, const PointOperation& operation)
+            : ImageBufferPointOperation(std::move(node_name), operation.stages(), operation.lumaMixCount()) {
+        }
+
+        /**
+         * @brief Copy constructor: the copy runs its own program (compiled by its first run), not the one of other.
+         */
+        ImageBufferPointOperation(const ImageBufferPointOperation& other)
+            : ImageBufferPointOperation(other, other.getName() + "_copy") {
+        }
+
+        ImageBufferPointOperation(const ImageBufferPointOperation& other, std::string node_name)
+            : Base(std::move(node_name), [this] (ImageBuffer<ChannelT>& input) {
+                return this->applyProgram(input);
+            }), stages_(other.stages_), lumaMixCount_(other.lumaMixCount_), fusedNames_(other.fusedNames_),
+              tilingOptions_(other.tilingOptions_), hasTilingOptions_(other.hasTilingOptions_) {
+            this->setBatchParallelism(other.getBatchParallelism());
+            this->logLifeCycle("CopyConstructor(const ImageBufferPointOperation&, std::string)");
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<ImageBufferPointOperation>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<ImageBufferPointOperation>(*this, std::move(node_name));
+        }
+
+        const std::vector<Stage>& stages() const { return stages_; }
+        int lumaMixCount() const { return lumaMixCount_; }
+
+        bool canFuseWith(const INode& next) const override {
+            const auto* nextOperation = dynamic_cast<const ImageBufferPointOperation*>(&next);
+            return nextOperation && lumaMixCount_ + nextOperation->lumaMixCount_ <= 1;
+        }
+
+        std::unique_ptr<INode> fuseWith(const INode& next) const override {
+            const auto& nextOperation = dynamic_cast<const ImageBufferPointOperation&>(next);
+
+            std::vector<Stage> fusedStages = stages_;
+            fusedStages.insert(fusedStages.end(), nextOperation.stages_.begin(), nextOperation.stages_.end());
+
+            const std::string fusedNames = (fusedNames_.empty() ? this->getName() : fusedNames_) + " + " + next.getName();
+            auto fused = extended_std::make_unique<ImageBufferPointOperation>("fused(" + fusedNames + ")", std::move(fusedStages),
+                                                                              lumaMixCount_ + nextOperation.lumaMixCount_);
+            fused->fusedNames_ = fusedNames;
+            return std::unique_ptr<INode>(std::move(fused));
+        }
+
+        /**
+         * @brief Overrides the tiling used by this node (ImageTiling::defaultOptions() otherwise).
+         */
+        void setTilingOptions(const TilingOptions& options) {
+            tilingOptions_ = options;
+            hasTilingOptions_ = true;
+        }
+
+    protected:
+        /**
+         * @brief Compiles the program for the bit depth of the incoming images, if not already cached.
+         * @throws InvalidOperation if the bit depth does not fit ChannelT.
+         */
+        void preProcessHook() const override {
+            const int max_value = this->getMetadata()->bit_depth;
+            if (max_value != programMaxValue_) {
+                checkChannelDepth<ChannelT>(max_value);
+                this->logLifeCycle("compileProgram()");
+
+                program_ = PointOperationProgram::compile(stages_, max_value);
+                programMaxValue_ = max_value;
+            }
+        }
+
+        std::string typeName() const override {
+            return "ImageBufferPointOperation";
+        }
+
+    private:
+        const std::vector<Stage> stages_;
+        const int lumaMixCount_;
+        /// Names of the operations of a fused node, without the "fused(...)" decoration (empty if not fused)
+        std::string fusedNames_;
+
+        mutable PointOperationProgram program_;
+        mutable int programMaxValue_ = -1;
+        TilingOptions tilingOptions_;
+        bool hasTilingOptions_ = false;
+
+        const TilingOptions& tilingOptions() const {
+            return hasTilingOptions_ ? tilingOptions_ : ImageTiling::defaultOptions();
+        }
+
+        ImageBuffer<ChannelT> applyProgram(ImageBuffer<ChannelT>& image) const {
+            ImageTiling::forEachTile(image.width, image.height, tilingOptions(), [this, &image](const ImageTile& tile) {
+                program_.apply(image, tile);
+            });
+            return std::move(image);
+        }
+    };
+
+
+    /**
+     * @brief The point operation Operation (e.g. Invert, Levels) over compact images with channels of type ChannelT.
+     *
+     * Takes the arguments of the constructor of Operation, e.g.
+     * pipeline.addNode<TypedPointOperation<Levels, std::uint16_t>>("Levels", 0.1, 0.9).
+     */
+    template <typename Operation, typename ChannelT>
+    class TypedPointOperation final : public ImageBufferPointOperation<ChannelT> {
+    public:
+        template <typename... Args>
+        explicit TypedPointOperation(std::string node_name, Args&&... args)
+            : ImageBufferPointOperation<ChannelT>(node_name, Operation(node_name, std::forward<Args>(args)...)) {
+        }
+
+        TypedPointOperation(const TypedPointOperation& other) = default;
+
+        TypedPointOperation(const TypedPointOperation& other, std::string node_name)
+            : ImageBufferPointOperation<ChannelT>(other, std::move(node_name)) {
+        }
+
+        std::unique_ptr<INode> clone() const override {
+            this->logLifeCycle("clone()");
+            return extended_std::make_unique<TypedPointOperation>(*this);
+        }
+
+        std::unique_ptr<INode> clone(std::string node_name) const override {
+            this->logLifeCycle("clone(std::string)");
+            return extended_std::make_unique<TypedPointOperation>(*this, std::move(node_name));
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "TypedPointOperation";
+        }
+    };
+}
+
+#endif //PIPEX_POINTOPERATION_H
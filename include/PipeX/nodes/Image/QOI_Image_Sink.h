@@ -0,0 +1,76 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_QOI_IMAGE_SINK_H
+#define PIPEX_QOI_IMAGE_SINK_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Sink.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/qoi_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+namespace PipeX {
+    /**
+     * @brief Sink node that saves images to files in the lossless QOI format.
+     *
+     * Writes each received image to a separate file with an index suffix and adds the .qoi extension.
+     * Every image is encoded into a buffer preallocated for the worst case and written with a single call;
+     * the images of a batch are encoded and written concurrently on the shared ThreadPool.
+     * Only 8-bit (bit_depth 255) RGB images can be saved.
+     */
+    class QOI_Image_Sink final : public Sink<PPM_Image, PPM_Metadata>, public ImageBatchIO<QOI_Image_Sink> {
+    public:
+        QOI_Image_Sink(std::string node_name, std::string filename)
+                : Sink(std::move(node_name), [this](const std::vector<PPM_Image>& images) {
+                    const auto& metadata = this->getMetadata();
+                    if (metadata->bit_depth != 255 || metadata->color_space != ColorSpace::RGB) {
+                        throw InvalidOperation("QOI_Image_Sink", "QOI stores 8-bit RGB images only");
+                    }
+
+                    ThreadPool::getThreadPool().parallelFor(0, images.size(), [this, &images](const std::size_t i) {
+                        saveToFile(images[i], filename_ + "_" + std::to_string(i) + ".qoi");
+                    }, 1, getBatchParallelism());
+                }), filename_(std::move(filename)) {
+            this->logLifeCycle("Constructor(filename, name)");
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "QOI_Image_Sink";
+        }
+
+    private:
+        const std::string filename_;
+
+        static void saveToFile(const PPM_Image& image, const std::string& filename) {
+            const int height = static_cast<int>(image.size());
+            const int width = height > 0 ? static_cast<int>(image[0].size()) : 0;
+
+            // Not value-initialized: the worst case size is never touched entirely
+            std::unique_ptr<std::uint8_t[]> buffer(new std::uint8_t[QOI::maxEncodedSize(width, height)]);
+            const std::size_t size = QOI::encode(image, buffer.get());
+
+            std::ofstream file(filename, std::ios::binary);
+            if (!file) {
+                throw PipeX_IO_Exception("[QOI_Image_Sink::saveToFile] Could not open file for writing: " + filename
+                    + ", make sure the directory exists.");
+            }
+            file.write(reinterpret_cast<const char*>(buffer.get()), static_cast<std::streamsize>(size));
+            if (!file) {
+                throw PipeX_IO_Exception("[QOI_Image_Sink::saveToFile] Could not write file: " + filename);
+            }
+        }
+    };
+}
+
+#endif //PIPEX_QOI_IMAGE_SINK_H
@@ -0,0 +1,123 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_QOI_IMAGE_SOURCE_H
+#define PIPEX_QOI_IMAGE_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Source.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/qoi_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+namespace PipeX {
+    /**
+     * @brief Source node that loads a batch of QOI images.
+     *
+     * Each file is read with a single call and decoded on the shared ThreadPool, the files of the batch
+     * concurrently. All the images of a batch must have the same size, since they share one PPM_Metadata
+     * (8-bit RGB). The (filename, count) constructor reads the files written by a QOI_Image_Sink with the same filename.
+     *
+     * With framesPerBlock > 0 the files are the frames of a sequence, streamed in blocks (see ImageFileStream): each
+     * run of the pipeline nodes receives the next framesPerBlock images, so a long sequence never has to be held in
+     * memory at once (e.g. through a TemporalFilter). With framesPerBlock == 0 every run loads the whole batch.
+     */
+    class QOI_Image_Source final : public Source<PPM_Image, PPM_Metadata>, public ImageBatchIO<QOI_Image_Source> {
+    public:
+        QOI_Image_Source(std::string node_name, std::vector<std::string> filenames, const std::size_t framesPerBlock = 0)
+                : Source(std::move(node_name), [this]() {
+                    this->createMetadata();
+
+                    std::size_t begin, end;
+                    stream_.next(filenames_.size(), begin, end);
+                    auto images = std::vector<PPM_Image>(end - begin);
+                    ThreadPool::getThreadPool().parallelFor(0, images.size(), [this, &images, begin](const std::size_t i) {
+                        images[i] = loadFile(filenames_[begin + i]);
+                    }, 1, getBatchParallelism());
+
+                    this->setupPPMMetadata(images, begin);
+                    return images;
+                }), filenames_(std::move(filenames)), stream_(framesPerBlock) {
+            this->logLifeCycle("Constructor(std::string, std::vector<std::string>, std::size_t)");
+        }
+
+        /**
+         * @brief Reads the files filename_0 to filename_<count - 1>.
+         *
+         * A template, so that a braced list of file names (which cannot deduce FilenameT) always selects the
+         * constructor taking the vector, instead of being read as an iterator range of std::string.
+         */
+        template <typename FilenameT, typename = typename std::enable_if<std::is_convertible<const FilenameT&, std::string>::value>::type>
+        QOI_Image_Source(std::string node_name, const FilenameT& filename, const int count, const std::size_t framesPerBlock = 0)
+                : QOI_Image_Source(std::move(node_name), indexedFilenames(filename, count), framesPerBlock) {}
+
+        bool hasPendingData() const override {
+            return stream_.hasPendingData(filenames_.size());
+        }
+
+        /**
+         * @brief Rewinds the sequence: the next run starts again from the first file.
+         */
+        void endOfStream() override {
+            stream_.rewind();
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "QOI_Image_Source";
+        }
+
+    private:
+        const std::vector<std::string> filenames_;
+        ImageFileStream stream_;
+
+        static std::vector<std::string> indexedFilenames(const std::string& filename, const int count) {
+            std::vector<std::string> filenames;
+            for (int i = 0; i < count; ++i) {
+                filenames.push_back(filename + "_" + std::to_string(i) + ".qoi");
+            }
+            return filenames;
+        }
+
+        void setupPPMMetadata(const std::vector<PPM_Image>& images, const std::size_t begin) const {
+            sourceMetadata->bit_depth = 255;
+            if (images.empty()) {
+                return;
+            }
+
+            sourceMetadata->height = static_cast<int>(images[0].size());
+            sourceMetadata->width = static_cast<int>(images[0][0].size());
+            for (std::size_t i = 1; i < images.size(); ++i) {
+                if (static_cast<int>(images[i].size()) != sourceMetadata->height || static_cast<int>(images[i][0].size()) != sourceMetadata->width) {
+                    throw PipeX_IO_Exception("[QOI_Image_Source] Images of a batch must have the same size: " + filenames_[begin + i]);
+                }
+            }
+        }
+
+        static PPM_Image loadFile(const std::string& filename) {
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if (!file) {
+                throw PipeX_IO_Exception("[QOI_Image_Source::loadFile] Could not open file for reading: " + filename);
+            }
+
+            const std::streamsize size = file.tellg();
+            std::vector<std::uint8_t> buffer(size > 0 ? static_cast<std::size_t>(size) : 0);
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
+                throw PipeX_IO_Exception("[QOI_Image_Source::loadFile] Could not read file: " + filename);
+            }
+            return QOI::decode(buffer.data(), buffer.size());
+        }
+    };
+}
+
+#endif //PIPEX_QOI_IMAGE_SOURCE_H
@@ -0,0 +1,86 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_RESIZE_H
+#define PIPEX_RESIZE_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Resampling filter used by the Resize node.
+     */
+    enum class ResizeFilter {
+        Nearest,  ///< Nearest source pixel (exact copy, no interpolation)
+        Bilinear, ///< Linear interpolation of the 2 x 2 nearest source pixels (pixel centers aligned)
+        Area      ///< Average of the source pixels covered by the output pixel, weighted by coverage (best for shrinking)
+    };
+
+    /**
+     * @brief Resampling coefficients along one axis: output coordinate i reads the source coordinates
+     * index[first[i] .. first[i + 1]) with the corresponding weights (which sum to 1).
+     */
+    struct ResampleTable {
+        std::vector<int> first;
+        std::vector<int> index;
+        std::vector<float> weight;
+
+        int taps(const int i) const { return first[i + 1] - first[i]; }
+
+        static ResampleTable build(int sourceSize, int targetSize, ResizeFilter filter);
+    };
+
+
+    /**
+     * @brief Transformer node that resizes images, to a fixed size or by a scale factor.
+     *
+     * Each axis is resampled through a ResampleTable computed once per size change. Output rows are produced in
+     * parallel on the shared ThreadPool: every row is the weighted sum (SIMD) of the horizontally resampled source
+     * rows it depends on. The output metadata carries the new width and height.
+     */
+    class Resize final : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        Resize(std::string node_name, int width, int height, ResizeFilter filter = ResizeFilter::Bilinear);
+
+        /**
+         * @brief Resizes by a scale factor (e.g. 0.25 for a quarter of the width and height), rounding to at least 1 pixel.
+         */
+        Resize(std::string node_name, double scale, ResizeFilter filter = ResizeFilter::Bilinear);
+
+    protected:
+        void preProcessHook() const override;
+        void postProcessHook() const override;
+
+        std::string typeName() const override {
+            return "Resize";
+        }
+
+    private:
+        const int width_;
+        const int height_;
+        const double scale_;
+        const ResizeFilter filter_;
+
+        // Output size and coefficient tables of the current input size (recomputed only when it changes)
+        mutable int outputWidth_ = 0;
+        mutable int outputHeight_ = 0;
+        mutable int maxValue_ = 255;
+        mutable int sourceWidth_ = -1;
+        mutable int sourceHeight_ = -1;
+        mutable ResampleTable columns_;
+        mutable ResampleTable rows_;
+
+        PPM_Image resize(const PPM_Image& image) const;
+        void updateTables(int sourceWidth, int sourceHeight) const;
+    };
+}
+
+#endif //PIPEX_RESIZE_H
@@ -0,0 +1,32 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_SHARPEN_H
+#define PIPEX_SHARPEN_H
+
+#include <string>
+
+#include "PipeX/nodes/Image/Convolution.h"
+
+namespace PipeX {
+    /**
+     * @brief Sharpens images by subtracting amount times their Laplacian (3x3 kernel).
+     */
+    class Sharpen final : public Convolution {
+    public:
+        explicit Sharpen(std::string node_name, const double amount = 1.0, const BorderMode border = BorderMode::Clamp)
+            : Convolution(std::move(node_name), {{0.0,     -amount,              0.0},
+                                                 {-amount, 1.0 + 4.0 * amount, -amount},
+                                                 {0.0,     -amount,              0.0}}, border) {
+            this->logLifeCycle("Sharpen");
+        }
+
+    protected:
+        std::string typeName() const override {
+            return "Sharpen";
+        }
+    };
+}
+
+#endif //PIPEX_SHARPEN_H
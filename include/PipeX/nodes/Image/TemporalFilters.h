@@ -0,0 +1,187 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_TEMPORALFILTERS_H
+#define PIPEX_TEMPORALFILTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/image_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Fixed-capacity ring of the most recent frames of a sequence.
+     *
+     * Frames are stored as flat, contiguous channel buffers allocated once (on the first push after a reset) and then
+     * overwritten in turn: the memory used is bounded by the capacity, whatever the length of the sequence.
+     */
+    class FrameRing {
+    public:
+        explicit FrameRing(std::size_t capacity);
+
+        /**
+         * @brief Empties the ring and sets the size of its frames (the buffers are kept if the size is unchanged).
+         */
+        void reset(int width, int height);
+
+        std::size_t capacity() const { return slots_.size(); }
+        std::size_t size() const { return size_; }
+        bool full() const { return size_ == slots_.size(); }
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+        /// Number of channels of a frame (3 * width * height)
+        std::size_t frameSize() const { return static_cast<std::size_t>(width_) * height_ * 3; }
+
+        /**
+         * @brief Frame pushed age pushes ago (0 = most recent); age must be less than size().
+         */
+        const int* frame(std::size_t age) const;
+
+        /**
+         * @brief Makes room for a new frame (dropping the oldest one if the ring is full) and returns its buffer.
+         */
+        int* push();
+
+    private:
+        std::vector<std::vector<int>> slots_;
+        std::size_t next_ = 0;
+        std::size_t size_ = 0;
+        int width_ = 0;
+        int height_ = 0;
+    };
+
+
+    /**
+     * @brief Base class of the nodes that process the images of a batch as the consecutive frames of a sequence.
+     *
+     * Frames are processed one at a time, in order (batch parallelism must stay 1), and each output frame is written
+     * over its input frame. The state (a FrameRing of recent frames, plus whatever the node derives from them) survives
+     * between batches, so a long sequence can be streamed through the pipeline in several batches (e.g. from a
+     * PPM_Image_Source or QOI_Image_Source with framesPerBlock > 0); it is reset when the frame size or bit depth
+     * changes, at the end of the stream, or by reset(). The rows of a frame are processed in parallel on the shared
+     * ThreadPool.
+     */
+    class TemporalFilter : public Transformer<PPM_Image, PPM_Image, PPM_Metadata> {
+    public:
+        static constexpr std::size_t maxWindow = 1024;
+
+        /**
+         * @brief Forgets the frames seen so far: the next frame starts a new sequence.
+         */
+        void reset();
+
+        /**
+         * @brief Resets the filter: the next run of the pipeline starts a new sequence.
+         */
+        void endOfStream() override {
+            reset();
+        }
+
+    protected:
+        TemporalFilter(std::string node_name, std::size_t window);
+
+        void preProcessHook() const override;
+
+        /**
+         * @brief Processes row y of the current frame in place (channels: 3 * width values).
+         *
+         * When called, the current frame owns ring slot slot_, which still holds the frame it replaces if evicting_
+         * (the oldest one of a full ring) and must be overwritten with the input row; previous_ frames came before.
+         */
+        virtual void processRow(int y, int* channels) const = 0;
+
+        /**
+         * @brief Clears the state derived from the frames (the ring is already empty and sized for the new frames).
+         */
+        virtual void resetState() const {}
+
+        mutable FrameRing ring_;
+        mutable int maxValue_ = 255;
+
+        /// Ring slot of the current frame
+        mutable int* slot_ = nullptr;
+        /// Number of frames in the ring before the current one
+        mutable std::size_t previous_ = 0;
+        /// True if slot_ holds the oldest frame of a full ring, leaving it
+        mutable bool evicting_ = false;
+
+    private:
+        PPM_Image processFrame(PPM_Image& frame) const;
+        void restart(int width, int height) const;
+    };
+
+
+    /**
+     * @brief Average of the last window frames (fewer at the start of the sequence), rounded to nearest.
+     *
+     * Keeps a running sum per channel: the entering frame is added and the leaving one subtracted, so the cost
+     * per frame does not depend on the window length.
+     */
+    class TemporalAverage final : public TemporalFilter {
+    public:
+        TemporalAverage(std::string node_name, std::size_t window);
+
+    protected:
+        void processRow(int y, int* channels) const override;
+        void resetState() const override;
+
+        std::string typeName() const override {
+            return "TemporalAverage";
+        }
+
+    private:
+        mutable std::vector<std::int32_t> sums_;
+    };
+
+
+    /**
+     * @brief Absolute difference between every frame and the previous one (the first frame of a sequence gives black).
+     */
+    class FrameDifference final : public TemporalFilter {
+    public:
+        explicit FrameDifference(std::string node_name);
+
+    protected:
+        void processRow(int y, int* channels) const override;
+
+        std::string typeName() const override {
+            return "FrameDifference";
+        }
+    };
+
+
+    /**
+     * @brief Motion mask: a pixel is white (bit_depth on every channel) when any of its channels differs by more than
+     * threshold from the background, the average of the previous window frames; black otherwise.
+     *
+     * The background is kept as a running sum like in TemporalAverage. The first frame of a sequence has no
+     * background and gives a black mask.
+     */
+    class MotionDetection final : public TemporalFilter {
+    public:
+        MotionDetection(std::string node_name, int threshold, std::size_t window = 8);
+
+    protected:
+        void processRow(int y, int* channels) const override;
+        void resetState() const override;
+
+        std::string typeName() const override {
+            return "MotionDetection";
+        }
+
+    private:
+        const int threshold_;
+        mutable std::vector<std::int32_t> sums_;
+    };
+}
+
+#endif //PIPEX_TEMPORALFILTERS_H
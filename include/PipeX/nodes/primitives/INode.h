@@ -119,6 +119,55 @@ namespace PipeX {
         virtual bool isSource() const { return  false; }
         virtual bool isSink() const { return  false; }
 
+        /**
+         * @brief Checks whether this node can be fused with the node that follows it in a pipeline.
+         *
+         * Nodes that can merge their processing (e.g. chains of per-pixel operations) override this
+         * together with \c fuseWith. By default nodes are never fused.
+         *
+         * @param next The node that follows this one in the pipeline.
+         * @return true if \c fuseWith can produce a node equivalent to this node followed by \c next.
+         */
+        virtual bool canFuseWith(const INode& /*next*/) const { return false; }
+
+        /**
+         * @brief Creates a single node equivalent to this node followed by \c next.
+         *
+         * Only called when \c canFuseWith(next) returns true. Neither this node nor \c next are modified.
+         *
+         * @param next The node that follows this one in the pipeline.
+         * @return std::unique_ptr<INode> Owning pointer to the fused node.
+         */
+        virtual std::unique_ptr<INode> fuseWith(const INode& /*next*/) const { return nullptr; }
+
+        /**
+         * @brief Checks whether a streaming Source has more data to produce.
+         *
+         * Streaming sources emit their data in blocks, one block per process() call: while the Source of a
+         * pipeline returns true, Pipeline::run() runs the nodes again on the next block. Other nodes never
+         * have pending data.
+         *
+         * @return true if process() would produce another block.
+         */
+        virtual bool hasPendingData() const { return false; }
+
+        /**
+         * @brief Called by Pipeline::run() on every node once the last block of data has been processed.
+         *
+         * Nodes that keep state across blocks override it to finalize their work (e.g. a sink writing
+         * a file incrementally) and get ready for a new stream. By default it does nothing.
+         */
+        virtual void endOfStream() {}
+
+        /**
+         * @brief Real-time length, in seconds, of the block produced by the last process() call of a streaming Source.
+         *
+         * It is the deadline for processing the block when the pipeline runs in real-time mode (see
+         * Pipeline::setRealTimeMode): e.g. the frames of an audio block divided by the sample rate.
+         * Sources whose data is not timed, and all other nodes, return 0.
+         */
+        virtual double blockDuration() const { return 0.0; }
+
         std::string getName() const { return name; }
 
     protected:
@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "NodeCRTP.h"
+#include "PipeX/utils/thread_pool_utils.h"
 
 namespace PipeX {
     /**
@@ -59,7 +60,7 @@ namespace PipeX {
          * @brief Copy constructor.
          * @param other The Transformer to copy from
          */
-        Transformer(const Transformer& other) : Base(other), transformerFunction(other.transformerFunction) {
+        Transformer(const Transformer& other) : Base(other), transformerFunction(other.transformerFunction), batchParallelism(other.batchParallelism) {
             this->logLifeCycle("CopyConstructor(const Transformer&)");
         }
 
@@ -68,7 +69,7 @@ namespace PipeX {
          * @param other The Transformer to copy from
          * @param _name The name to assign to the new transformer
          */
-        Transformer(const Transformer&other, std::string _name) : Base(other, std::move(_name)), transformerFunction(other.transformerFunction) {
+        Transformer(const Transformer&other, std::string _name) : Base(other, std::move(_name)), transformerFunction(other.transformerFunction), batchParallelism(other.batchParallelism) {
             this->logLifeCycle("CopyConstructor(const Transformer&, std::string)");
         }
 
@@ -76,7 +77,7 @@ namespace PipeX {
          * @brief Move constructor.
          * @param other The Transformer to move from
          */
-        Transformer(Transformer&& other) noexcept : Base(other), transformerFunction(std::move(other.transformerFunction)) {
+        Transformer(Transformer&& other) noexcept : Base(other), transformerFunction(std::move(other.transformerFunction)), batchParallelism(other.batchParallelism) {
             this->logLifeCycle("MoveConstructor(Transformer&&)");
         }
 
@@ -90,6 +91,22 @@ namespace PipeX {
         virtual bool isSource() const final { return  false; }
         virtual bool isSink() const final { return  false; }
 
+        /**
+         * @brief Sets how many items of a batch may be transformed concurrently, on the shared ThreadPool.
+         *
+         * The output keeps the order of the input whatever the parallelism.
+         *
+         * @param maxThreads Maximum number of items transformed at the same time: 1 (default) transforms the batch
+         *                   serially, 0 uses the whole thread pool.
+         * @note The transformation function must be thread-safe when maxThreads != 1.
+         */
+        Transformer& setBatchParallelism(const std::size_t maxThreads) {
+            batchParallelism = maxThreads;
+            return *this;
+        }
+
+        std::size_t getBatchParallelism() const { return batchParallelism; }
+
     protected:
         /**
          * @brief Returns the type name of this node.
@@ -106,6 +123,9 @@ namespace PipeX {
         /// The transformation function applied to each input data item
         Function transformerFunction;
 
+        /// Maximum number of items transformed concurrently (1 = serial, 0 = whole thread pool)
+        std::size_t batchParallelism = 1;
+
         /**
          * @brief Process a batch of input items and produce transformed output items.
          *
@@ -127,6 +147,19 @@ namespace PipeX {
             auto output = extended_std::make_unique<std::vector<OutputT>>();
             output->reserve(input->size());
 
+            if (batchParallelism != 1 && input->size() > 1) {
+                // Transform items concurrently, then collect the results in input order
+                std::vector<std::unique_ptr<OutputT>> results(input->size());
+                ThreadPool::getThreadPool().parallelFor(0, input->size(), [this, &input, &results](const std::size_t i) {
+                    results[i] = extended_std::make_unique<OutputT>(transformerFunction((*input)[i]));
+                }, 1, batchParallelism);
+
+                for (auto& result : results) {
+                    output->push_back(std::move(*result));
+                }
+                return output;
+            }
+
             // Transform data
             for (auto& data : *input) {
                 output->push_back(transformerFunction(data));
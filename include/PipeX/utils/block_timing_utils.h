@@ -0,0 +1,70 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_BLOCK_TIMING_UTILS_H
+#define PIPEX_BLOCK_TIMING_UTILS_H
+
+#include <cstddef>
+#include <ostream>
+
+namespace PipeX {
+    /**
+     * @brief Processing times of the blocks of a pipeline run, measured against their deadlines.
+     *
+     * Filled by Pipeline::run() in real-time mode (see Pipeline::setRealTimeMode): one record() per block, from the
+     * Source producing it to the Sink consuming it. A block misses its deadline when it takes longer than the
+     * real-time length of its data (INode::blockDuration of the Source, times the budget of the pipeline).
+     */
+    struct BlockTimingReport {
+        std::size_t blocks = 0;
+        /// Blocks that had a deadline (a timed Source) and took longer
+        std::size_t deadlineMisses = 0;
+        /// Processing time of all the blocks
+        double totalSeconds = 0.0;
+        /// Processing time of the slowest block
+        double worstSeconds = 0.0;
+        /// Sum of the deadlines: the real-time length of the stream, within the budget
+        double deadlineSeconds = 0.0;
+        /// Largest fraction of its deadline used by a block (> 1 for a miss)
+        double worstLoad = 0.0;
+
+        /**
+         * @brief Records a block processed in the given time, with the given deadline (0 = no deadline).
+         * @return true if the block missed its deadline.
+         */
+        bool record(const double seconds, const double deadline) {
+            ++blocks;
+            totalSeconds += seconds;
+            worstSeconds = seconds > worstSeconds ? seconds : worstSeconds;
+            if (deadline <= 0.0) {
+                return false;
+            }
+
+            deadlineSeconds += deadline;
+            const double load = seconds / deadline;
+            worstLoad = load > worstLoad ? load : worstLoad;
+            if (seconds > deadline) {
+                ++deadlineMisses;
+                return true;
+            }
+            return false;
+        }
+
+        double meanSeconds() const { return blocks > 0 ? totalSeconds / static_cast<double>(blocks) : 0.0; }
+
+        /// Processing time over real-time length of the stream: the share of the budget used on average
+        double averageLoad() const { return deadlineSeconds > 0.0 ? totalSeconds / deadlineSeconds : 0.0; }
+
+        void reset() { *this = BlockTimingReport(); }
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const BlockTimingReport& report) {
+        os << report.blocks << " blocks, " << report.deadlineMisses << " deadline misses, mean " << report.meanSeconds() * 1e3
+           << " ms, worst " << report.worstSeconds * 1e3 << " ms, load " << report.averageLoad() * 100.0 << "% (worst "
+           << report.worstLoad * 100.0 << "%)";
+        return os;
+    }
+}
+
+#endif //PIPEX_BLOCK_TIMING_UTILS_H
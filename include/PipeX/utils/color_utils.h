@@ -0,0 +1,233 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_COLOR_UTILS_H
+#define PIPEX_COLOR_UTILS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "PipeX/utils/simd_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Fixed-point affine colour transform: out[k] = clamp(sum_j m[k][j] * in[j] + offset[k], 0, max_value).
+     *
+     * Coefficients are stored with \c shift fractional bits, the largest precision (up to 16 bits) for which
+     * no intermediate sum can overflow 32 bits at the given channel depth.
+     */
+    struct ColorMatrix {
+        std::array<std::int32_t, 9> coefficients{}; ///< Row-major 3x3 matrix
+        std::array<std::int32_t, 3> bias{};         ///< Offsets, rounding term included
+        int shift = 0;
+        int max_value = 0;
+
+        static ColorMatrix build(const std::array<double, 9>& matrix, const std::array<double, 3>& offset, const int max_value) {
+            double bound = 0.0;
+            for (int k = 0; k < 3; ++k) {
+                const double rowSum = std::fabs(matrix[3 * k]) + std::fabs(matrix[3 * k + 1]) + std::fabs(matrix[3 * k + 2]);
+                bound = std::max(bound, rowSum * max_value + std::fabs(offset[k]) + 1.0);
+            }
+
+            ColorMatrix result;
+            result.max_value = max_value;
+            result.shift = 16;
+            while (result.shift > 1 && bound * (1 << result.shift) >= 2147483647.0) {
+                --result.shift;
+            }
+
+            const double scale = static_cast<double>(1 << result.shift);
+            for (int i = 0; i < 9; ++i) {
+                result.coefficients[i] = static_cast<std::int32_t>(std::lround(matrix[i] * scale));
+            }
+            for (int k = 0; k < 3; ++k) {
+                result.bias[k] = static_cast<std::int32_t>(std::lround(offset[k] * scale)) + (1 << (result.shift - 1));
+            }
+            return result;
+        }
+    };
+
+    namespace detail {
+#if defined(PIPEX_SIMD_SSE2) && !defined(PIPEX_SIMD_AVX2)
+        // SSE2 has no 32-bit low multiply nor 32-bit min/max
+        inline __m128i mullo_epi32(const __m128i a, const __m128i b) {
+            const __m128i even = _mm_mul_epu32(a, b);
+            const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        }
+
+        inline __m128i clamp_epi32(const __m128i v, const __m128i lo, const __m128i hi) {
+            const __m128i belowLo = _mm_cmplt_epi32(v, lo);
+            const __m128i clampedLo = _mm_or_si128(_mm_and_si128(belowLo, lo), _mm_andnot_si128(belowLo, v));
+            const __m128i aboveHi = _mm_cmpgt_epi32(clampedLo, hi);
+            return _mm_or_si128(_mm_and_si128(aboveHi, hi), _mm_andnot_si128(aboveHi, clampedLo));
+        }
+#endif
+
+        /**
+         * @brief Applies a ColorMatrix to n pixels stored as three planes.
+         */
+        inline void transformPlanes(const std::int32_t* const in[3], std::int32_t* const out[3], const std::size_t n, const ColorMatrix& cm) {
+            const std::int32_t* m = cm.coefficients.data();
+            std::size_t i = 0;
+
+#if defined(PIPEX_SIMD_AVX2)
+            const __m128i shift = _mm_cvtsi32_si128(cm.shift);
+            const __m256i lo = _mm256_setzero_si256();
+            const __m256i hi = _mm256_set1_epi32(cm.max_value);
+            for (; i + 8 <= n; i += 8) {
+                const __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in[0] + i));
+                const __m256i c1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in[1] + i));
+                const __m256i c2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in[2] + i));
+                for (int k = 0; k < 3; ++k) {
+                    __m256i acc = _mm256_set1_epi32(cm.bias[k]);
+                    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(c0, _mm256_set1_epi32(m[3 * k])));
+                    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(c1, _mm256_set1_epi32(m[3 * k + 1])));
+                    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(c2, _mm256_set1_epi32(m[3 * k + 2])));
+                    acc = _mm256_min_epi32(_mm256_max_epi32(_mm256_sra_epi32(acc, shift), lo), hi);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out[k] + i), acc);
+                }
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            const __m128i shift = _mm_cvtsi32_si128(cm.shift);
+            const __m128i lo = _mm_setzero_si128();
+            const __m128i hi = _mm_set1_epi32(cm.max_value);
+            for (; i + 4 <= n; i += 4) {
+                const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in[0] + i));
+                const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in[1] + i));
+                const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in[2] + i));
+                for (int k = 0; k < 3; ++k) {
+                    __m128i acc = _mm_set1_epi32(cm.bias[k]);
+                    acc = _mm_add_epi32(acc, mullo_epi32(c0, _mm_set1_epi32(m[3 * k])));
+                    acc = _mm_add_epi32(acc, mullo_epi32(c1, _mm_set1_epi32(m[3 * k + 1])));
+                    acc = _mm_add_epi32(acc, mullo_epi32(c2, _mm_set1_epi32(m[3 * k + 2])));
+                    acc = clamp_epi32(_mm_sra_epi32(acc, shift), lo, hi);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out[k] + i), acc);
+                }
+            }
+#endif
+
+            for (; i < n; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    const std::int32_t acc = cm.bias[k] + m[3 * k] * in[0][i] + m[3 * k + 1] * in[1][i] + m[3 * k + 2] * in[2][i];
+                    const std::int32_t value = acc >> cm.shift;
+                    out[k][i] = value < 0 ? 0 : (value > cm.max_value ? cm.max_value : value);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Applies a ColorMatrix in place to a buffer of interleaved 3-channel pixels.
+     *
+     * Pixels are deinterleaved in small blocks (kept in L1) so that the matrix is applied with SIMD on whole planes.
+     */
+    inline void applyColorMatrix(int* channels, const std::size_t pixels, const ColorMatrix& cm) {
+        constexpr std::size_t blockSize = 64;
+        std::int32_t planes[3][blockSize];
+        std::int32_t results[3][blockSize];
+        const std::int32_t* const in[3] = {planes[0], planes[1], planes[2]};
+        std::int32_t* const out[3] = {results[0], results[1], results[2]};
+
+        for (std::size_t start = 0; start < pixels; start += blockSize) {
+            const std::size_t n = std::min(blockSize, pixels - start);
+            int* block = channels + 3 * start;
+
+            for (std::size_t i = 0; i < n; ++i) {
+                planes[0][i] = block[3 * i];
+                planes[1][i] = block[3 * i + 1];
+                planes[2][i] = block[3 * i + 2];
+            }
+            detail::transformPlanes(in, out, n, cm);
+            for (std::size_t i = 0; i < n; ++i) {
+                block[3 * i] = results[0][i];
+                block[3 * i + 1] = results[1][i];
+                block[3 * i + 2] = results[2][i];
+            }
+        }
+    }
+
+    /**
+     * @brief RGB -> YCbCr (BT.601 full range) matrix for channels in [0, max_value].
+     */
+    inline ColorMatrix rgbToYCbCrMatrix(const int max_value) {
+        const double chromaOffset = (max_value + 1) / 2;
+        return ColorMatrix::build({ 0.299,     0.587,     0.114,
+                                   -0.168736, -0.331264,  0.5,
+                                    0.5,      -0.418688, -0.081312},
+                                  {0.0, chromaOffset, chromaOffset}, max_value);
+    }
+
+    /**
+     * @brief YCbCr (BT.601 full range) -> RGB matrix for channels in [0, max_value].
+     */
+    inline ColorMatrix yCbCrToRGBMatrix(const int max_value) {
+        const double chromaOffset = (max_value + 1) / 2;
+        return ColorMatrix::build({1.0,  0.0,       1.402,
+                                   1.0, -0.344136, -0.714136,
+                                   1.0,  1.772,     0.0},
+                                  {-1.402 * chromaOffset, (0.344136 + 0.714136) * chromaOffset, -1.772 * chromaOffset}, max_value);
+    }
+
+    /**
+     * @brief Converts one RGB pixel to HSV in place (hue [0, 360) degrees mapped to [0, max_value]).
+     */
+    inline void rgbToHSV(int* pixel, const int max_value) {
+        const int r = pixel[0], g = pixel[1], b = pixel[2];
+        const int maxChannel = std::max(r, std::max(g, b));
+        const int minChannel = std::min(r, std::min(g, b));
+        const int delta = maxChannel - minChannel;
+
+        double hue = 0.0; // In sixths of a turn
+        if (delta > 0) {
+            if (maxChannel == r) {
+                hue = static_cast<double>(g - b) / delta;
+                if (hue < 0.0) {
+                    hue += 6.0;
+                }
+            } else if (maxChannel == g) {
+                hue = static_cast<double>(b - r) / delta + 2.0;
+            } else {
+                hue = static_cast<double>(r - g) / delta + 4.0;
+            }
+        }
+
+        pixel[0] = static_cast<int>(std::lround(hue / 6.0 * (max_value + 1))) % (max_value + 1);
+        pixel[1] = maxChannel > 0 ? static_cast<int>(std::lround(static_cast<double>(delta) * max_value / maxChannel)) : 0;
+        pixel[2] = maxChannel;
+    }
+
+    /**
+     * @brief Converts one HSV pixel (as produced by rgbToHSV) to RGB in place.
+     */
+    inline void hsvToRGB(int* pixel, const int max_value) {
+        const double hue = 6.0 * pixel[0] / (max_value + 1);
+        const double value = pixel[2];
+        const double chroma = value * pixel[1] / max_value;
+        const double x = chroma * (1.0 - std::fabs(std::fmod(hue, 2.0) - 1.0));
+        const double m = value - chroma;
+
+        double r = 0.0, g = 0.0, b = 0.0;
+        switch (static_cast<int>(hue) % 6) {
+        case 0: r = chroma; g = x; break;
+        case 1: r = x; g = chroma; break;
+        case 2: g = chroma; b = x; break;
+        case 3: g = x; b = chroma; break;
+        case 4: r = x; b = chroma; break;
+        default: r = chroma; b = x; break;
+        }
+
+        const auto toChannel = [max_value](const double v) {
+            return std::min(std::max(static_cast<int>(std::lround(v)), 0), max_value);
+        };
+        pixel[0] = toChannel(r + m);
+        pixel[1] = toChannel(g + m);
+        pixel[2] = toChannel(b + m);
+    }
+}
+
+#endif //PIPEX_COLOR_UTILS_H
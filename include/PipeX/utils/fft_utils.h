@@ -0,0 +1,75 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_FFT_UTILS_H
+#define PIPEX_FFT_UTILS_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace PipeX {
+    /**
+     * @brief Plan of a real FFT of a power-of-two size.
+     *
+     * A real transform of size n is computed as a complex transform of size n / 2 (even samples as real part, odd
+     * samples as imaginary part) followed by a split pass. The complex transform is an iterative decimation in time
+     * on split real/imaginary arrays: radix-4 passes (two radix-2 stages fused, one pass over the data) plus a
+     * radix-2 pass when log2(n / 2) is odd, with SIMD butterflies (SSE2/AVX2) across the contiguous twiddles of
+     * each stage. Twiddles and the bit-reversal permutation are computed once, in double, by the constructor.
+     *
+     * Plans are immutable, so one plan can be used by any number of threads at once: get them from plan(), which
+     * caches them by size for the whole process.
+     */
+    class FFT {
+    public:
+        /**
+         * @throws InvalidOperation if size is not a power of two greater than or equal to 2.
+         */
+        explicit FFT(std::size_t size);
+
+        /**
+         * @brief Shared plan of the given size, created on first use (thread-safe).
+         */
+        static std::shared_ptr<const FFT> plan(std::size_t size);
+
+        std::size_t size() const { return size_; }
+
+        /// Number of bins of the spectrum of a real signal: size / 2 + 1 (from 0 to the Nyquist frequency)
+        std::size_t bins() const { return size_ / 2 + 1; }
+
+        /**
+         * @brief Spectrum X[k] = sum x[j] e^(-2 pi i j k / size) of size real samples, for k in [0, bins()).
+         *
+         * @param in size samples.
+         * @param re, im bins() values each (imaginary parts of bins 0 and size / 2 are 0).
+         */
+        void forward(const float* in, float* re, float* im) const;
+
+        /**
+         * @brief Real signal of a spectrum, normalized: inverse(forward(x)) == x.
+         *
+         * @param re, im bins() values each, used as working memory (overwritten).
+         * @param out size samples.
+         */
+        void inverse(float* re, float* im, float* out) const;
+
+    private:
+        std::size_t size_;
+        /// Size of the complex transform
+        std::size_t half_;
+
+        std::vector<std::size_t> bitReverse_;
+        /// Twiddles e^(-2 pi i j / (2 m)) of the stage of span m, j in [0, m), for every stage: stage m starts at m - 1
+        std::vector<float> twiddleRe_;
+        std::vector<float> twiddleIm_;
+        /// Twiddles e^(-2 pi i k / size) of the split pass, k in [0, size / 4]
+        std::vector<float> splitRe_;
+        std::vector<float> splitIm_;
+
+        void transform(float* re, float* im, bool inverse) const;
+    };
+}
+
+#endif //PIPEX_FFT_UTILS_H
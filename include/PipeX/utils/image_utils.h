@@ -6,7 +6,16 @@
 #define PIPEX_IMAGE_UTILS_HPP
 
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
 #include <vector>
+#include <cstddef>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
 
 namespace PipeX {
     /**
@@ -18,6 +27,509 @@ namespace PipeX {
      * @brief Represents a PPM image as a 2D grid of pixels.
      */
     using PPM_Image = std::vector<std::vector<channelsT>>;
+
+    // Each image row is handled by the kernels as a flat, contiguous array of 3 * width channels
+    static_assert(sizeof(channelsT) == 3 * sizeof(int), "channelsT must be a tightly packed RGB triplet");
+
+    /**
+     * @brief Remaps every channel of a contiguous buffer through a lookup table.
+     *
+     * Values are clamped to [0, lut.size() - 1] before the lookup. Uses an AVX2 gather when available.
+     *
+     * @param channels Pointer to the first channel of the buffer (remapped in place).
+     * @param count Number of channels in the buffer.
+     * @param lut Lookup table indexed by the input channel value.
+     */
+    inline void applyLUT(int* channels, const std::size_t count, const std::vector<int>& lut) {
+        const int* table = lut.data();
+        const int maxIndex = static_cast<int>(lut.size()) - 1;
+        std::size_t i = 0;
+
+#ifdef PIPEX_SIMD_AVX2
+        const __m256i lo = _mm256_setzero_si256();
+        const __m256i hi = _mm256_set1_epi32(maxIndex);
+        for (; i + 8 <= count; i += 8) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(channels + i));
+            idx = _mm256_min_epi32(_mm256_max_epi32(idx, lo), hi);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(channels + i), _mm256_i32gather_epi32(table, idx, 4));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const int v = channels[i];
+            channels[i] = table[v < 0 ? 0 : (v > maxIndex ? maxIndex : v)];
+        }
+    }
+
+    /**
+     * @brief Remaps every channel of an image through a lookup table, row by row.
+     *
+     * @param image Image to remap in place.
+     * @param lut Lookup table indexed by the input channel value.
+     */
+    inline void applyLUT(PPM_Image& image, const std::vector<int>& lut) {
+        for (auto& row : image) {
+            if (!row.empty()) {
+                applyLUT(row.data()->data(), row.size() * 3, lut);
+            }
+        }
+    }
+
+    /**
+     * @brief Image with channels of type ChannelT stored as one contiguous, row-major, RGB-interleaved buffer.
+     *
+     * Compact working format of the image kernels: rows are addressed with row(y) and hold 3 * width channels.
+     * Image8 and Image16 hold 8 and 16-bit images in a quarter and a half of the memory of a PPM_Image (and as many
+     * more channels per SIMD register); FloatImage keeps channels unquantized, on the same [0, bit_depth] scale.
+     */
+    template <typename ChannelT>
+    struct ImageBuffer {
+        using channel_type = ChannelT;
+
+        int width = 0;
+        int height = 0;
+        std::vector<ChannelT> data;
+
+        ImageBuffer() = default;
+        ImageBuffer(const int _width, const int _height) : width(_width), height(_height), data(static_cast<std::size_t>(_width) * _height * 3, ChannelT(0)) {}
+
+        std::size_t stride() const { return static_cast<std::size_t>(width) * 3; }
+        ChannelT* row(const int y) { return data.data() + y * stride(); }
+        const ChannelT* row(const int y) const { return data.data() + y * stride(); }
+    };
+
+    using Image8 = ImageBuffer<std::uint8_t>;
+    using Image16 = ImageBuffer<std::uint16_t>;
+    using FloatImage = ImageBuffer<float>;
+
+    /**
+     * @brief Size and rows of a PPM_Image or an ImageBuffer, for code written once for both (e.g. the PPM codec).
+     *
+     * A row holds 3 * width contiguous channels; imageRow() must not be called on an image of width 0.
+     */
+    inline int imageWidth(const PPM_Image& image) { return image.empty() ? 0 : static_cast<int>(image[0].size()); }
+    inline int imageHeight(const PPM_Image& image) { return static_cast<int>(image.size()); }
+    inline int* imageRow(PPM_Image& image, const int y) { return image[y].data()->data(); }
+    inline const int* imageRow(const PPM_Image& image, const int y) { return image[y].data()->data(); }
+
+    template <typename ChannelT>
+    int imageWidth(const ImageBuffer<ChannelT>& image) { return image.width; }
+    template <typename ChannelT>
+    int imageHeight(const ImageBuffer<ChannelT>& image) { return image.height; }
+    template <typename ChannelT>
+    ChannelT* imageRow(ImageBuffer<ChannelT>& image, const int y) { return image.row(y); }
+    template <typename ChannelT>
+    const ChannelT* imageRow(const ImageBuffer<ChannelT>& image, const int y) { return image.row(y); }
+
+    /**
+     * @brief Converts a row of int channels to float.
+     */
+    inline void channelsToFloat(const int* src, float* dst, const std::size_t count) {
+        std::size_t i = 0;
+#ifdef PIPEX_SIMD_SSE2
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = static_cast<float>(src[i]);
+        }
+    }
+
+    /**
+     * @brief Converts a row of float channels to int, rounding to nearest and clamping to [0, max_value].
+     */
+    inline void floatToChannels(const float* src, int* dst, const std::size_t count, const int max_value) {
+        const float hi = static_cast<float>(max_value);
+        std::size_t i = 0;
+#ifdef PIPEX_SIMD_SSE2
+        const __m128 vlo = _mm_setzero_ps();
+        const __m128 vhi = _mm_set1_ps(hi);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), vlo), vhi);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(v));
+        }
+#endif
+        for (; i < count; ++i) {
+            const float v = src[i] < 0.0f ? 0.0f : (src[i] > hi ? hi : src[i]);
+            dst[i] = static_cast<int>(std::nearbyint(v));
+        }
+    }
+
+    /**
+     * @brief Converts a PPM image to a FloatImage.
+     */
+    inline FloatImage toFloatImage(const PPM_Image& image) {
+        FloatImage result(image.empty() ? 0 : static_cast<int>(image[0].size()), static_cast<int>(image.size()));
+        for (int y = 0; y < result.height; ++y) {
+            channelsToFloat(image[y].data()->data(), result.row(y), result.stride());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Converts a FloatImage to a PPM image, rounding and clamping channels to [0, max_value].
+     */
+    inline PPM_Image toPPMImage(const FloatImage& image, const int max_value) {
+        PPM_Image result(image.height, std::vector<channelsT>(image.width));
+        for (int y = 0; y < image.height; ++y) {
+            floatToChannels(image.row(y), result[y].data()->data(), image.stride(), max_value);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Remaps every channel of a contiguous 8-bit buffer through a lookup table (results saturated to 8 bits).
+     */
+    inline void applyLUT(std::uint8_t* channels, const std::size_t count, const std::vector<int>& lut) {
+        const int* table = lut.data();
+        const int maxIndex = static_cast<int>(lut.size()) - 1;
+        std::size_t i = 0;
+
+#ifdef PIPEX_SIMD_AVX2
+        const __m256i hi = _mm256_set1_epi32(maxIndex);
+        for (; i + 8 <= count; i += 8) {
+            const __m256i idx = _mm256_min_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(channels + i))), hi);
+            const __m256i v = _mm256_i32gather_epi32(table, idx, 4);
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(channels + i), _mm_packus_epi16(words, words));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const int v = table[channels[i] > maxIndex ? maxIndex : channels[i]];
+            channels[i] = static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+
+    /**
+     * @brief Remaps every channel of a contiguous 16-bit buffer through a lookup table (results saturated to 16 bits).
+     */
+    inline void applyLUT(std::uint16_t* channels, const std::size_t count, const std::vector<int>& lut) {
+        const int* table = lut.data();
+        const int maxIndex = static_cast<int>(lut.size()) - 1;
+        std::size_t i = 0;
+
+#ifdef PIPEX_SIMD_AVX2
+        const __m256i hi = _mm256_set1_epi32(maxIndex);
+        for (; i + 8 <= count; i += 8) {
+            const __m256i idx = _mm256_min_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(channels + i))), hi);
+            const __m256i v = _mm256_i32gather_epi32(table, idx, 4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(channels + i), _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const int v = table[channels[i] > maxIndex ? maxIndex : channels[i]];
+            channels[i] = static_cast<std::uint16_t>(v < 0 ? 0 : (v > 65535 ? 65535 : v));
+        }
+    }
+
+    /**
+     * @brief Value of a lookup table at a fractional index, interpolated linearly (index clamped to the table).
+     */
+    inline float interpolateLUT(const std::vector<int>& lut, const float index) {
+        const int last = static_cast<int>(lut.size()) - 1;
+        if (!(index > 0.0f)) {
+            return static_cast<float>(lut[0]);
+        }
+        if (index >= static_cast<float>(last)) {
+            return static_cast<float>(lut[last]);
+        }
+        const int k = static_cast<int>(index);
+        return static_cast<float>(lut[k]) + (index - static_cast<float>(k)) * static_cast<float>(lut[k + 1] - lut[k]);
+    }
+
+    /**
+     * @brief Remaps every channel of a contiguous float buffer through a lookup table, interpolating between its
+     * entries: float channels are not quantized to the integer levels of the table.
+     */
+    inline void applyLUT(float* channels, const std::size_t count, const std::vector<int>& lut) {
+        for (std::size_t i = 0; i < count; ++i) {
+            channels[i] = interpolateLUT(lut, channels[i]);
+        }
+    }
+
+    /**
+     * @brief Conversion kernels of a channel type of ImageBuffer, selected at compile time.
+     *
+     * Specialized for std::uint8_t, std::uint16_t and float. maxBitDepth() is the largest bit_depth (maximum
+     * channel value) the type holds exactly.
+     */
+    template <typename ChannelT>
+    struct ChannelTraits;
+
+    template <>
+    struct ChannelTraits<std::uint8_t> {
+        static int maxBitDepth() { return 255; }
+
+        static void toFloat(const std::uint8_t* src, float* dst, const std::size_t count) {
+            std::size_t i = 0;
+#if defined(PIPEX_SIMD_AVX2)
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)))));
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+            }
+#endif
+            for (; i < count; ++i) {
+                dst[i] = static_cast<float>(src[i]);
+            }
+        }
+
+        /// Rounds to nearest and clamps to [0, max_value]
+        static void fromFloat(const float* src, std::uint8_t* dst, const std::size_t count, const int max_value) {
+            const float hi = static_cast<float>(max_value);
+            std::size_t i = 0;
+#ifdef PIPEX_SIMD_SSE2
+            const __m128 vlo = _mm_setzero_ps();
+            const __m128 vhi = _mm_set1_ps(hi);
+            for (; i + 16 <= count; i += 16) {
+                __m128i v[4];
+                for (int k = 0; k < 4; ++k) {
+                    v[k] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4 * k), vlo), vhi));
+                }
+                const __m128i words = _mm_packs_epi32(v[0], v[1]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, _mm_packs_epi32(v[2], v[3])));
+            }
+#endif
+            for (; i < count; ++i) {
+                const float v = src[i] < 0.0f ? 0.0f : (src[i] > hi ? hi : src[i]);
+                dst[i] = static_cast<std::uint8_t>(std::nearbyint(v));
+            }
+        }
+    };
+
+    template <>
+    struct ChannelTraits<std::uint16_t> {
+        static int maxBitDepth() { return 65535; }
+
+        static void toFloat(const std::uint16_t* src, float* dst, const std::size_t count) {
+            std::size_t i = 0;
+#if defined(PIPEX_SIMD_AVX2)
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)))));
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8) {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)));
+            }
+#endif
+            for (; i < count; ++i) {
+                dst[i] = static_cast<float>(src[i]);
+            }
+        }
+
+        /// Rounds to nearest and clamps to [0, max_value]
+        static void fromFloat(const float* src, std::uint16_t* dst, const std::size_t count, const int max_value) {
+            const float hi = static_cast<float>(max_value);
+            std::size_t i = 0;
+#ifdef PIPEX_SIMD_SSE2
+            // SSE2 only packs with signed saturation: values are biased to [-32768, 32767] and the bias flipped back
+            const __m128 vlo = _mm_setzero_ps();
+            const __m128 vhi = _mm_set1_ps(hi);
+            const __m128i bias = _mm_set1_epi32(32768);
+            const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+            for (; i + 8 <= count; i += 8) {
+                const __m128i a = _mm_sub_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), vlo), vhi)), bias);
+                const __m128i b = _mm_sub_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), vlo), vhi)), bias);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(_mm_packs_epi32(a, b), flip));
+            }
+#endif
+            for (; i < count; ++i) {
+                const float v = src[i] < 0.0f ? 0.0f : (src[i] > hi ? hi : src[i]);
+                dst[i] = static_cast<std::uint16_t>(std::nearbyint(v));
+            }
+        }
+    };
+
+    template <>
+    struct ChannelTraits<float> {
+        /// Integers up to 2^24 are exact in float: any PPM depth fits
+        static int maxBitDepth() { return 65535; }
+
+        static void toFloat(const float* src, float* dst, const std::size_t count) {
+            std::memcpy(dst, src, count * sizeof(float));
+        }
+
+        /// Float channels keep their value: neither rounded nor clamped
+        static void fromFloat(const float* src, float* dst, const std::size_t count, int /*max_value*/) {
+            std::memcpy(dst, src, count * sizeof(float));
+        }
+    };
+
+    /**
+     * @brief Checks that channels in [0, max_value] fit the channel type.
+     * @throws InvalidOperation otherwise.
+     */
+    template <typename ChannelT>
+    void checkChannelDepth(const int max_value) {
+        if (max_value < 0 || max_value > ChannelTraits<ChannelT>::maxBitDepth()) {
+            throw InvalidOperation("ImageBuffer", "bit depth " + std::to_string(max_value) + " does not fit the channel type (max "
+                                   + std::to_string(ChannelTraits<ChannelT>::maxBitDepth()) + ")");
+        }
+    }
+
+    /**
+     * @brief Converts a PPM image to an ImageBuffer, for channels in [0, max_value] (out of range channels are clamped).
+     * @throws InvalidOperation if max_value does not fit the channel type.
+     */
+    template <typename ChannelT>
+    ImageBuffer<ChannelT> toImageBuffer(const PPM_Image& image, const int max_value) {
+        checkChannelDepth<ChannelT>(max_value);
+        ImageBuffer<ChannelT> result(image.empty() ? 0 : static_cast<int>(image[0].size()), static_cast<int>(image.size()));
+        for (int y = 0; y < result.height; ++y) {
+            const int* src = image[y].data()->data();
+            ChannelT* dst = result.row(y);
+            for (std::size_t i = 0; i < result.stride(); ++i) {
+                dst[i] = static_cast<ChannelT>(src[i] < 0 ? 0 : (src[i] > max_value ? max_value : src[i]));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Converts an ImageBuffer with integer channels to a PPM image.
+     */
+    template <typename ChannelT>
+    PPM_Image toPPMImage(const ImageBuffer<ChannelT>& image) {
+        static_assert(std::is_integral<ChannelT>::value, "float channels are rounded by toPPMImage(image, max_value)");
+        PPM_Image result(image.height, std::vector<channelsT>(image.width));
+        for (int y = 0; y < image.height; ++y) {
+            const ChannelT* src = image.row(y);
+            int* dst = result[y].data()->data();
+            for (std::size_t i = 0; i < image.stride(); ++i) {
+                dst[i] = src[i];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Converts an ImageBuffer to float channels, row by row with the kernel of its channel type.
+     */
+    template <typename ChannelT>
+    FloatImage toFloatImage(const ImageBuffer<ChannelT>& image) {
+        FloatImage result(image.width, image.height);
+        ChannelTraits<ChannelT>::toFloat(image.data.data(), result.data.data(), image.data.size());
+        return result;
+    }
+
+    /**
+     * @brief Converts float channels to an ImageBuffer: integer channels are rounded and clamped to [0, max_value],
+     * float channels are copied.
+     */
+    template <typename ChannelT>
+    ImageBuffer<ChannelT> fromFloatImage(const FloatImage& image, const int max_value) {
+        ImageBuffer<ChannelT> result(image.width, image.height);
+        ChannelTraits<ChannelT>::fromFloat(image.data.data(), result.data.data(), image.data.size(), max_value);
+        return result;
+    }
+
+    /**
+     * @brief Settings shared by the image Sources and Sinks.
+     */
+    class ImageIO {
+    public:
+        /**
+         * @brief Images of a batch read, generated or written concurrently by the image Sources and Sinks that were
+         * not given their own setBatchParallelism() (0 = whole thread pool, the default).
+         *
+         * Nodes built in place by Pipeline::addNode() take this value when they run.
+         * @note Must be changed only while no pipeline is running.
+         */
+        static std::size_t& defaultBatchParallelism() {
+            return default_batch_parallelism_;
+        }
+
+    private:
+        static std::size_t default_batch_parallelism_;
+    };
+
+    /**
+     * @brief Batch parallelism of an image Source or Sink (mixin, Derived is the node).
+     *
+     * Until set, the node follows ImageIO::defaultBatchParallelism().
+     */
+    template <typename Derived>
+    class ImageBatchIO {
+    public:
+        /**
+         * @brief Sets how many images of the batch may be read, generated or written concurrently (0 = whole thread pool).
+         */
+        Derived& setBatchParallelism(const std::size_t maxThreads) {
+            batchParallelism_ = maxThreads;
+            hasBatchParallelism_ = true;
+            return static_cast<Derived&>(*this);
+        }
+
+        std::size_t getBatchParallelism() const {
+            return hasBatchParallelism_ ? batchParallelism_ : ImageIO::defaultBatchParallelism();
+        }
+
+    protected:
+        ImageBatchIO() = default;
+        ImageBatchIO(const ImageBatchIO&) = default;
+        ImageBatchIO& operator=(const ImageBatchIO&) = default;
+        ~ImageBatchIO() = default;
+
+    private:
+        std::size_t batchParallelism_ = 0;
+        bool hasBatchParallelism_ = false;
+    };
+
+    /**
+     * @brief Position of a streaming image Source in its sequence of files.
+     *
+     * With framesPerBlock > 0 every run of the pipeline takes the next framesPerBlock files (fewer for the last
+     * block) and the Source has pending data until the sequence is exhausted (see INode::hasPendingData); rewind()
+     * restarts it, at the end of the stream. With framesPerBlock == 0 every run takes the whole sequence.
+     */
+    class ImageFileStream {
+    public:
+        explicit ImageFileStream(const std::size_t framesPerBlock) : framesPerBlock_(framesPerBlock) {}
+
+        std::size_t framesPerBlock() const { return framesPerBlock_; }
+
+        /**
+         * @brief Gives the files [begin, end) of the next block of a sequence of count files, and moves past them.
+         */
+        void next(const std::size_t count, std::size_t& begin, std::size_t& end) {
+            if (framesPerBlock_ == 0) {
+                begin = 0;
+                end = count;
+                return;
+            }
+            begin = position_ < count ? position_ : count;
+            end = count - begin > framesPerBlock_ ? begin + framesPerBlock_ : count;
+            position_ = end;
+        }
+
+        bool hasPendingData(const std::size_t count) const {
+            return position_ > 0 && position_ < count;
+        }
+
+        void rewind() {
+            position_ = 0;
+        }
+
+    private:
+        std::size_t framesPerBlock_;
+        /// Files already emitted
+        std::size_t position_ = 0;
+    };
 }
 
-#endif //PIPEX_IMAGE_UTILS_HPP
\ No newline at end of file
+#endif //PIPEX_IMAGE_UTILS_HPP
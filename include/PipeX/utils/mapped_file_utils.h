@@ -0,0 +1,50 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_MAPPED_FILE_UTILS_H
+#define PIPEX_MAPPED_FILE_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace PipeX {
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * The file is paged in by the OS as it is read, so even a file larger than the available memory can be
+     * processed: pages that are no longer needed can be handed back with discard(). The mapping is advised
+     * for sequential access.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @throws PipeX_IO_Exception if the file cannot be opened or mapped.
+         */
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::uint8_t* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+        /**
+         * @brief Tells the OS that the bytes [offset, offset + length) will not be read again, so their pages
+         * can be dropped from memory (a hint: reading them again remains valid).
+         */
+        void discard(std::size_t offset, std::size_t length) const;
+
+    private:
+        const std::uint8_t* data_ = nullptr;
+        std::size_t size_ = 0;
+#if defined(_WIN32)
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+}
+
+#endif //PIPEX_MAPPED_FILE_UTILS_H
@@ -0,0 +1,315 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_PPM_UTILS_H
+#define PIPEX_PPM_UTILS_H
+
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+namespace PipeX {
+    /**
+     * @brief Encoder/decoder for the PPM (Netpbm) formats, with any channel depth up to 16 bits.
+     */
+    namespace PPM {
+        constexpr int maxBitDepth = 65535;
+
+        /**
+         * @brief PPM variant written by the encoder.
+         */
+        enum class Format {
+            Plain, ///< P3: decimal text, one pixel per line
+            Binary ///< P6: 1 byte per channel if bit_depth < 256, otherwise 2 bytes (big-endian)
+        };
+
+        /**
+         * @brief Storage of one P6 channel; the sample type is picked at compile time from the channel depth.
+         *
+         * pack() and unpack() convert whole rows, from and to the channels of a PPM_Image (int) or of an ImageBuffer.
+         */
+        template <typename SampleT>
+        struct SampleTraits;
+
+        namespace detail {
+            /// Channel value written to a file: float channels are rounded, all channels clamped to [0, maxBitDepth]
+            inline int sampleValue(const int v) {
+                return v < 0 ? 0 : (v > maxBitDepth ? maxBitDepth : v);
+            }
+
+            inline int sampleValue(const std::uint8_t v) {
+                return v;
+            }
+
+            inline int sampleValue(const std::uint16_t v) {
+                return v;
+            }
+
+            inline int sampleValue(const float v) {
+                return !(v > 0.0f) ? 0 : (v > static_cast<float>(maxBitDepth) ? maxBitDepth : static_cast<int>(std::nearbyint(v)));
+            }
+        }
+
+        template <>
+        struct SampleTraits<std::uint8_t> {
+            static constexpr std::size_t bytes = 1;
+
+            template <typename ChannelT>
+            static void pack(const ChannelT* src, std::uint8_t* dst, const std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const int v = detail::sampleValue(src[i]);
+                    dst[i] = static_cast<std::uint8_t>(v > 255 ? 255 : v);
+                }
+            }
+
+            template <typename ChannelT>
+            static void unpack(const std::uint8_t* src, ChannelT* dst, const std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = static_cast<ChannelT>(src[i]);
+                }
+            }
+        };
+
+        template <>
+        struct SampleTraits<std::uint16_t> {
+            static constexpr std::size_t bytes = 2;
+
+            template <typename ChannelT>
+            static void pack(const ChannelT* src, std::uint8_t* dst, const std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const int v = detail::sampleValue(src[i]);
+                    dst[2 * i] = static_cast<std::uint8_t>(v >> 8);
+                    dst[2 * i + 1] = static_cast<std::uint8_t>(v);
+                }
+            }
+
+            template <typename ChannelT>
+            static void unpack(const std::uint8_t* src, ChannelT* dst, const std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = static_cast<ChannelT>((src[2 * i] << 8) | src[2 * i + 1]);
+                }
+            }
+        };
+
+        namespace detail {
+            inline std::string header(const char* magic, const int width, const int height, const int max_value) {
+                return std::string(magic) + "\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + std::to_string(max_value) + "\n";
+            }
+
+            /// Writes a non-negative integer in decimal, returns the position after it
+            inline char* writeDecimal(char* out, unsigned value) {
+                char digits[10];
+                int n = 0;
+                do {
+                    digits[n++] = static_cast<char>('0' + value % 10);
+                    value /= 10;
+                } while (value);
+                while (n) {
+                    *out++ = digits[--n];
+                }
+                return out;
+            }
+
+            template <typename SampleT, typename ImageT>
+            void encodeBinary(const ImageT& image, std::vector<char>& buffer, std::size_t offset) {
+                const std::size_t stride = static_cast<std::size_t>(imageWidth(image)) * 3;
+                for (int y = 0; y < imageHeight(image); ++y) {
+                    SampleTraits<SampleT>::pack(imageRow(image, y), reinterpret_cast<std::uint8_t*>(&buffer[offset]), stride);
+                    offset += stride * SampleTraits<SampleT>::bytes;
+                }
+            }
+
+            template <typename SampleT, typename ImageT>
+            void decodeBinary(const std::uint8_t* data, ImageT& image) {
+                const std::size_t stride = static_cast<std::size_t>(imageWidth(image)) * 3;
+                for (int y = 0; y < imageHeight(image); ++y) {
+                    SampleTraits<SampleT>::unpack(data, imageRow(image, y), stride);
+                    data += stride * SampleTraits<SampleT>::bytes;
+                }
+            }
+
+            /// Channel type of the decoded image, and its allocation once the header has been validated
+            template <typename ImageT>
+            struct ImageLayout;
+
+            template <>
+            struct ImageLayout<PPM_Image> {
+                using channel_type = int;
+
+                static PPM_Image allocate(const int width, const int height, int /*max_value*/) {
+                    return PPM_Image(height, std::vector<channelsT>(width));
+                }
+            };
+
+            template <typename ChannelT>
+            struct ImageLayout<ImageBuffer<ChannelT>> {
+                using channel_type = ChannelT;
+
+                static ImageBuffer<ChannelT> allocate(const int width, const int height, const int max_value) {
+                    checkChannelDepth<ChannelT>(max_value);
+                    return ImageBuffer<ChannelT>(width, height);
+                }
+            };
+
+            /// Skips whitespace and '#' comments, then reads a decimal integer
+            inline int readValue(const std::uint8_t* data, const std::size_t size, std::size_t& p) {
+                while (p < size && (std::isspace(data[p]) || data[p] == '#')) {
+                    if (data[p] == '#') {
+                        while (p < size && data[p] != '\n') {
+                            ++p;
+                        }
+                    } else {
+                        ++p;
+                    }
+                }
+                if (p >= size || !std::isdigit(data[p])) {
+                    throw PipeX_IO_Exception("[PPM::decode] Malformed or truncated PPM stream.");
+                }
+                long value = 0;
+                while (p < size && std::isdigit(data[p])) {
+                    value = value * 10 + (data[p++] - '0');
+                    if (value > 0x7fffffffL) {
+                        throw PipeX_IO_Exception("[PPM::decode] Malformed PPM stream.");
+                    }
+                }
+                return static_cast<int>(value);
+            }
+        }
+
+        /**
+         * @brief Encodes an image (channels clamped to [0, max_value]) into a buffer, in the given format.
+         *
+         * The buffer is sized once for the whole file, so the image can be written with a single call.
+         * The image is a PPM_Image or an ImageBuffer; float channels are rounded.
+         */
+        template <typename ImageT>
+        std::vector<char> encode(const ImageT& image, const int max_value, const Format format) {
+            const int width = imageWidth(image);
+            const int height = imageHeight(image);
+            if (max_value <= 0 || max_value > maxBitDepth) {
+                throw PipeX_IO_Exception("[PPM::encode] Unsupported bit depth: " + std::to_string(max_value));
+            }
+
+            const std::string head = detail::header(format == Format::Binary ? "P6" : "P3", width, height, max_value);
+            const std::size_t channels = static_cast<std::size_t>(width) * height * 3;
+            std::vector<char> buffer;
+
+            if (format == Format::Binary) {
+                const std::size_t bytes = max_value < 256 ? SampleTraits<std::uint8_t>::bytes : SampleTraits<std::uint16_t>::bytes;
+                buffer.resize(head.size() + channels * bytes);
+                std::memcpy(buffer.data(), head.data(), head.size());
+                if (channels > 0) {
+                    if (max_value < 256) {
+                        detail::encodeBinary<std::uint8_t>(image, buffer, head.size());
+                    } else {
+                        detail::encodeBinary<std::uint16_t>(image, buffer, head.size());
+                    }
+                }
+                return buffer;
+            }
+
+            // Plain: at most 5 digits and a separator per channel
+            buffer.resize(head.size() + channels * 6);
+            std::memcpy(buffer.data(), head.data(), head.size());
+            char* out = buffer.data() + head.size();
+            const std::size_t stride = static_cast<std::size_t>(width) * 3;
+            for (int y = 0; channels > 0 && y < height; ++y) {
+                const auto* row = imageRow(image, y);
+                for (std::size_t i = 0; i < stride; ++i) {
+                    const int v = detail::sampleValue(row[i]);
+                    out = detail::writeDecimal(out, static_cast<unsigned>(v > max_value ? max_value : v));
+                    *out++ = i % 3 < 2 ? ' ' : '\n';
+                }
+            }
+            buffer.resize(static_cast<std::size_t>(out - buffer.data()));
+            return buffer;
+        }
+
+        /**
+         * @brief Decodes a P3 or P6 stream (8 or 16 bits per channel).
+         *
+         * ImageT is PPM_Image or an ImageBuffer, whose channel type must hold the maximum value of the file.
+         *
+         * @param max_value Set to the maximum channel value declared by the file.
+         * @throws PipeX_IO_Exception if the stream is not a valid PPM image.
+         * @throws InvalidOperation if the maximum value does not fit the channels of an ImageBuffer.
+         */
+        template <typename ImageT>
+        ImageT decodeImage(const std::uint8_t* data, const std::size_t size, int& max_value) {
+            if (size < 2 || data[0] != 'P' || (data[1] != '3' && data[1] != '6')) {
+                throw PipeX_IO_Exception("[PPM::decode] Not a P3/P6 PPM stream.");
+            }
+            const bool binary = data[1] == '6';
+
+            std::size_t p = 2;
+            const int width = detail::readValue(data, size, p);
+            const int height = detail::readValue(data, size, p);
+            max_value = detail::readValue(data, size, p);
+            if (width <= 0 || height <= 0 || max_value <= 0 || max_value > maxBitDepth) {
+                throw PipeX_IO_Exception("[PPM::decode] Invalid PPM header.");
+            }
+
+            // The payload is checked against the size of the header before the image is allocated, so a corrupt
+            // header cannot request more memory than the stream could fill
+            if (static_cast<std::size_t>(width) > std::numeric_limits<std::size_t>::max() / 3 / static_cast<std::size_t>(height)) {
+                throw PipeX_IO_Exception("[PPM::decode] Invalid PPM header.");
+            }
+            const std::size_t channels = static_cast<std::size_t>(width) * height * 3;
+            const std::size_t bytes = binary ? (max_value < 256 ? SampleTraits<std::uint8_t>::bytes : SampleTraits<std::uint16_t>::bytes)
+                                             : 2; // Plain: at least a separator and a digit per channel
+            if (binary) {
+                ++p; // Single whitespace after the max value
+            }
+            if (p > size || (size - p) / bytes < channels) {
+                throw PipeX_IO_Exception("[PPM::decode] Truncated PPM stream.");
+            }
+
+            ImageT image = detail::ImageLayout<ImageT>::allocate(width, height, max_value);
+
+            if (binary) {
+                if (max_value < 256) {
+                    detail::decodeBinary<std::uint8_t>(data + p, image);
+                } else {
+                    detail::decodeBinary<std::uint16_t>(data + p, image);
+                }
+                return image;
+            }
+
+            for (int y = 0; y < height; ++y) {
+                auto* row = imageRow(image, y);
+                for (std::size_t i = 0; i < static_cast<std::size_t>(width) * 3; ++i) {
+                    const int v = detail::readValue(data, size, p);
+                    row[i] = static_cast<typename detail::ImageLayout<ImageT>::channel_type>(v > max_value ? max_value : v);
+                }
+            }
+            return image;
+        }
+
+        /**
+         * @brief Decodes a P3 or P6 stream (8 or 16 bits per channel) into a PPM_Image.
+         */
+        inline PPM_Image decode(const std::uint8_t* data, const std::size_t size, int& max_value) {
+            return decodeImage<PPM_Image>(data, size, max_value);
+        }
+
+        /**
+         * @brief Decodes a P3 or P6 stream into an ImageBuffer (Image8, Image16 or FloatImage).
+         * @throws InvalidOperation if the maximum value of the file does not fit ChannelT.
+         */
+        template <typename ChannelT>
+        ImageBuffer<ChannelT> decode(const std::uint8_t* data, const std::size_t size, int& max_value) {
+            return decodeImage<ImageBuffer<ChannelT>>(data, size, max_value);
+        }
+    }
+}
+
+#endif //PIPEX_PPM_UTILS_H
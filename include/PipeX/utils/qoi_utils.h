@@ -0,0 +1,228 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_QOI_UTILS_H
+#define PIPEX_QOI_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+namespace PipeX {
+    /**
+     * @brief Encoder/decoder for the QOI ("Quite OK Image") lossless format, 8-bit RGB only.
+     *
+     * The stream is a 14-byte header followed by one chunk per pixel or per run of pixels (a run of equal pixels,
+     * a reference to one of the 64 recently seen colours, a small difference from the previous pixel or a full
+     * RGB value) and an 8-byte end marker. Encoding is a single pass over the rows with no entropy coding, which
+     * makes it much faster than PNG-class codecs while usually halving (or better) the size of a binary PPM.
+     */
+    namespace QOI {
+        constexpr std::size_t headerSize = 14;
+        constexpr std::size_t paddingSize = 8;
+
+        namespace detail {
+            constexpr std::uint8_t OP_INDEX = 0x00;
+            constexpr std::uint8_t OP_DIFF = 0x40;
+            constexpr std::uint8_t OP_LUMA = 0x80;
+            constexpr std::uint8_t OP_RUN = 0xc0;
+            constexpr std::uint8_t OP_RGB = 0xfe;
+            constexpr std::uint8_t OP_RGBA = 0xff;
+            constexpr std::uint8_t MASK_2 = 0xc0;
+            constexpr int maxRun = 62;
+
+            /// Pixels are packed as 0xAARRGGBB (alpha always opaque) so that they can be compared as integers
+            inline std::uint32_t pack(const int r, const int g, const int b) {
+                return 0xff000000u | (static_cast<std::uint32_t>(r & 0xff) << 16) | (static_cast<std::uint32_t>(g & 0xff) << 8) | static_cast<std::uint32_t>(b & 0xff);
+            }
+
+            inline int colorHash(const std::uint32_t px) {
+                const std::uint32_t r = (px >> 16) & 0xff, g = (px >> 8) & 0xff, b = px & 0xff, a = px >> 24;
+                return static_cast<int>((r * 3 + g * 5 + b * 7 + a * 11) % 64);
+            }
+
+            inline void write32(std::uint8_t* out, const std::uint32_t v) {
+                out[0] = static_cast<std::uint8_t>(v >> 24);
+                out[1] = static_cast<std::uint8_t>(v >> 16);
+                out[2] = static_cast<std::uint8_t>(v >> 8);
+                out[3] = static_cast<std::uint8_t>(v);
+            }
+
+            inline std::uint32_t read32(const std::uint8_t* in) {
+                return (static_cast<std::uint32_t>(in[0]) << 24) | (static_cast<std::uint32_t>(in[1]) << 16) | (static_cast<std::uint32_t>(in[2]) << 8) | in[3];
+            }
+        }
+
+        /**
+         * @brief Upper bound of the encoded size of a width x height image (the size of the buffer to preallocate).
+         */
+        inline std::size_t maxEncodedSize(const int width, const int height) {
+            return static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4 + headerSize + paddingSize;
+        }
+
+        /**
+         * @brief Encodes an 8-bit RGB image into a buffer of at least maxEncodedSize() bytes.
+         *
+         * Channel values are clamped to [0, 255].
+         * @return The number of bytes written.
+         */
+        inline std::size_t encode(const PPM_Image& image, std::uint8_t* out) {
+            using namespace detail;
+
+            const int height = static_cast<int>(image.size());
+            const int width = height > 0 ? static_cast<int>(image[0].size()) : 0;
+
+            std::uint8_t* p = out;
+            *p++ = 'q'; *p++ = 'o'; *p++ = 'i'; *p++ = 'f';
+            write32(p, static_cast<std::uint32_t>(width));
+            write32(p + 4, static_cast<std::uint32_t>(height));
+            p += 8;
+            *p++ = 3; // Channels
+            *p++ = 0; // sRGB with linear alpha
+
+            std::uint32_t index[64] = {};
+            std::uint32_t prev = pack(0, 0, 0);
+            int run = 0;
+
+            const auto clampChannel = [](const int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); };
+
+            for (int y = 0; y < height && width > 0; ++y) {
+                const int* row = image[y].data()->data();
+                for (int x = 0; x < width; ++x) {
+                    const int* c = row + 3 * x;
+                    const std::uint32_t px = pack(clampChannel(c[0]), clampChannel(c[1]), clampChannel(c[2]));
+
+                    if (px == prev) {
+                        if (++run == maxRun) {
+                            *p++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+                            run = 0;
+                        }
+                        continue;
+                    }
+                    if (run > 0) {
+                        *p++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+                        run = 0;
+                    }
+
+                    const int hash = colorHash(px);
+                    if (index[hash] == px) {
+                        *p++ = static_cast<std::uint8_t>(OP_INDEX | hash);
+                    } else {
+                        index[hash] = px;
+
+                        // Differences wrap around like the 8-bit channels
+                        const auto delta = [](const std::uint32_t a, const std::uint32_t b, const int shift) {
+                            return static_cast<int>(static_cast<std::int8_t>(static_cast<std::uint8_t>((a >> shift) - (b >> shift))));
+                        };
+                        const int vr = delta(px, prev, 16);
+                        const int vg = delta(px, prev, 8);
+                        const int vb = delta(px, prev, 0);
+                        const int vgr = vr - vg;
+                        const int vgb = vb - vg;
+
+                        if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                            *p++ = static_cast<std::uint8_t>(OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                        } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                            *p++ = static_cast<std::uint8_t>(OP_LUMA | (vg + 32));
+                            *p++ = static_cast<std::uint8_t>((vgr + 8) << 4 | (vgb + 8));
+                        } else {
+                            *p++ = OP_RGB;
+                            *p++ = static_cast<std::uint8_t>(px >> 16);
+                            *p++ = static_cast<std::uint8_t>(px >> 8);
+                            *p++ = static_cast<std::uint8_t>(px);
+                        }
+                    }
+                    prev = px;
+                }
+            }
+            if (run > 0) {
+                *p++ = static_cast<std::uint8_t>(OP_RUN | (run - 1));
+            }
+
+            for (std::size_t i = 0; i < paddingSize - 1; ++i) {
+                *p++ = 0;
+            }
+            *p++ = 1;
+            return static_cast<std::size_t>(p - out);
+        }
+
+        /**
+         * @brief Decodes a QOI stream into an RGB image (the alpha channel of 4-channel images is dropped).
+         *
+         * @throws PipeX_IO_Exception if the stream is not a valid QOI image.
+         */
+        inline PPM_Image decode(const std::uint8_t* data, const std::size_t size) {
+            using namespace detail;
+
+            if (size < headerSize + paddingSize || data[0] != 'q' || data[1] != 'o' || data[2] != 'i' || data[3] != 'f') {
+                throw PipeX_IO_Exception("[QOI::decode] Not a QOI stream.");
+            }
+            const std::uint32_t width = read32(data + 4);
+            const std::uint32_t height = read32(data + 8);
+            const int channels = data[12];
+            if (width == 0 || height == 0 || (channels != 3 && channels != 4) || width > 0x7fffffffu / height) {
+                throw PipeX_IO_Exception("[QOI::decode] Invalid QOI header.");
+            }
+
+            PPM_Image image(height, std::vector<channelsT>(width));
+
+            std::uint32_t index[64] = {};
+            std::uint8_t r = 0, g = 0, b = 0, a = 255;
+            int run = 0;
+
+            // Chunks are at most 5 bytes long and the stream ends with 8 bytes of padding: reads never overflow
+            const std::size_t chunksEnd = size - paddingSize;
+            std::size_t p = headerSize;
+
+            for (std::uint32_t y = 0; y < height; ++y) {
+                int* row = image[y].data()->data();
+                for (std::uint32_t x = 0; x < width; ++x) {
+                    if (run > 0) {
+                        --run;
+                    } else {
+                        if (p >= chunksEnd) {
+                            throw PipeX_IO_Exception("[QOI::decode] Truncated QOI stream.");
+                        }
+                        const std::uint8_t b1 = data[p++];
+                        if (b1 == OP_RGB) {
+                            r = data[p++]; g = data[p++]; b = data[p++];
+                        } else if (b1 == OP_RGBA) {
+                            r = data[p++]; g = data[p++]; b = data[p++]; a = data[p++];
+                        } else if ((b1 & MASK_2) == OP_INDEX) {
+                            const std::uint32_t px = index[b1];
+                            a = static_cast<std::uint8_t>(px >> 24);
+                            r = static_cast<std::uint8_t>(px >> 16);
+                            g = static_cast<std::uint8_t>(px >> 8);
+                            b = static_cast<std::uint8_t>(px);
+                        } else if ((b1 & MASK_2) == OP_DIFF) {
+                            r = static_cast<std::uint8_t>(r + ((b1 >> 4) & 0x03) - 2);
+                            g = static_cast<std::uint8_t>(g + ((b1 >> 2) & 0x03) - 2);
+                            b = static_cast<std::uint8_t>(b + (b1 & 0x03) - 2);
+                        } else if ((b1 & MASK_2) == OP_LUMA) {
+                            const std::uint8_t b2 = data[p++];
+                            const int vg = (b1 & 0x3f) - 32;
+                            r = static_cast<std::uint8_t>(r + vg - 8 + ((b2 >> 4) & 0x0f));
+                            g = static_cast<std::uint8_t>(g + vg);
+                            b = static_cast<std::uint8_t>(b + vg - 8 + (b2 & 0x0f));
+                        } else {
+                            run = b1 & 0x3f;
+                        }
+                        const std::uint32_t px = (static_cast<std::uint32_t>(a) << 24) | (static_cast<std::uint32_t>(r) << 16) | (static_cast<std::uint32_t>(g) << 8) | b;
+                        index[colorHash(px)] = px;
+                    }
+                    row[3 * x] = r;
+                    row[3 * x + 1] = g;
+                    row[3 * x + 2] = b;
+                }
+            }
+            return image;
+        }
+    }
+}
+
+#endif //PIPEX_QOI_UTILS_H
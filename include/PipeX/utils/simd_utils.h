@@ -0,0 +1,112 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_SIMD_UTILS_H
+#define PIPEX_SIMD_UTILS_H
+
+/**
+ * @brief Compile-time detection of the SIMD instruction sets available to the PipeX kernels.
+ *
+ * Kernels must always provide a scalar fallback: the macros below only enable the vectorized paths
+ * when the compiler is allowed to emit the corresponding instructions (e.g. -mavx2 or /arch:AVX2,
+ * see the PIPEX_ENABLE_AVX2 CMake option).
+ */
+
+#if defined(__AVX2__)
+    #define PIPEX_SIMD_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define PIPEX_SIMD_SSE2 1
+#endif
+
+#if defined(PIPEX_SIMD_AVX2) || defined(PIPEX_SIMD_SSE2)
+    #include <immintrin.h>
+#endif
+
+#include <cstddef>
+
+namespace PipeX {
+    /**
+     * @brief acc[i] += w * src[i] for i in [0, n).
+     *
+     * Building block of the filter kernels (convolutions, running sums, FIR taps).
+     */
+    inline void addScaled(float* acc, const float* src, const float w, const std::size_t n) {
+        std::size_t i = 0;
+
+#if defined(PIPEX_SIMD_AVX2)
+        const __m256 vw = _mm256_set1_ps(w);
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(vw, _mm256_loadu_ps(src + i))));
+        }
+#elif defined(PIPEX_SIMD_SSE2)
+        const __m128 vw = _mm_set1_ps(w);
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(vw, _mm_loadu_ps(src + i))));
+        }
+#endif
+
+        for (; i < n; ++i) {
+            acc[i] += w * src[i];
+        }
+    }
+
+    /**
+     * @brief dst[i] *= src[i] for i in [0, n).
+     *
+     * Applies gains, envelopes and windows computed into a separate buffer.
+     */
+    inline void multiply(float* dst, const float* src, const std::size_t n) {
+        std::size_t i = 0;
+
+#if defined(PIPEX_SIMD_AVX2)
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+        }
+#elif defined(PIPEX_SIMD_SSE2)
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+        }
+#endif
+
+        for (; i < n; ++i) {
+            dst[i] *= src[i];
+        }
+    }
+
+    /**
+     * @brief Inner product sum(a[i] * b[i]) for i in [0, n).
+     *
+     * Evaluates the taps of a FIR filter at one output sample.
+     */
+    inline float dot(const float* a, const float* b, const std::size_t n) {
+        std::size_t i = 0;
+        float sum = 0.0f;
+
+#if defined(PIPEX_SIMD_AVX2)
+        __m256 acc = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        sum = _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+#elif defined(PIPEX_SIMD_SSE2)
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        sum = _mm_cvtss_f32(_mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1)));
+#endif
+
+        for (; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+}
+
+#endif //PIPEX_SIMD_UTILS_H
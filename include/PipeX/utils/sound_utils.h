@@ -5,24 +5,229 @@
 #ifndef PIPEX_SOUND_UTILS_H
 #define PIPEX_SOUND_UTILS_H
 
+#include <cmath>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <ostream>
+
+#include "PipeX/utils/simd_utils.h"
 
 namespace PipeX {
     /**
-     * @brief Type used for audio sample data (32-bit integer).
+     * @brief Type used for integer PCM samples (32-bit integer), as stored in WAV files.
      */
     using bit_depth_t = std::int32_t;
 
     /**
-     * @brief Represents a buffer of audio samples.
+     * @brief Type used for audio samples inside pipelines: float32, full scale [-1, 1).
+     *
+     * Samples are converted from/to the integer PCM of the files only by the sources and sinks,
+     * so the DSP nodes never quantize intermediate results.
+     */
+    using audio_sample_t = float;
+
+    /**
+     * @brief Memory layout of the channels of an audio buffer.
      */
-    using WAV_AudioBuffer = std::vector<bit_depth_t>;
+    enum class AudioLayout {
+        Planar,     ///< Channels one after the other: channel c is a contiguous run of numFrames samples (default)
+        Interleaved ///< Frames one after the other, as in WAV files: sample n of channel c is at n * numChannels + c
+    };
+
+    /**
+     * @brief Interleaves numChannels planes of numFrames samples (plane c starts at src + c * srcStride) into frames.
+     */
+    inline void interleave(const audio_sample_t* src, const std::size_t srcStride, const std::size_t numChannels, const std::size_t numFrames,
+                           audio_sample_t* dst) {
+        std::size_t n = 0;
+#ifdef PIPEX_SIMD_SSE2
+        if (numChannels == 2) {
+            const audio_sample_t* right = src + srcStride;
+            for (; n + 4 <= numFrames; n += 4) {
+                const __m128 l = _mm_loadu_ps(src + n);
+                const __m128 r = _mm_loadu_ps(right + n);
+                _mm_storeu_ps(dst + 2 * n, _mm_unpacklo_ps(l, r));
+                _mm_storeu_ps(dst + 2 * n + 4, _mm_unpackhi_ps(l, r));
+            }
+        }
+#endif
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            const audio_sample_t* plane = src + c * srcStride;
+            for (std::size_t i = n; i < numFrames; ++i) {
+                dst[i * numChannels + c] = plane[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Splits numFrames interleaved frames into numChannels planes (plane c starts at dst + c * dstStride).
+     */
+    inline void deinterleave(const audio_sample_t* src, const std::size_t numChannels, const std::size_t numFrames,
+                             audio_sample_t* dst, const std::size_t dstStride) {
+        std::size_t n = 0;
+#ifdef PIPEX_SIMD_SSE2
+        if (numChannels == 2) {
+            audio_sample_t* right = dst + dstStride;
+            for (; n + 4 <= numFrames; n += 4) {
+                const __m128 a = _mm_loadu_ps(src + 2 * n);
+                const __m128 b = _mm_loadu_ps(src + 2 * n + 4);
+                _mm_storeu_ps(dst + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(right + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+        }
+#endif
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            audio_sample_t* plane = dst + c * dstStride;
+            for (std::size_t i = n; i < numFrames; ++i) {
+                plane[i] = src[i * numChannels + c];
+            }
+        }
+    }
+
+    /// Samples generated by sineOscillator() between two reseeds of its recurrence
+    constexpr std::size_t oscillatorReseed = 512;
+
+    /**
+     * @brief out[n] = offset + amplitude * sin(phase + n * increment) for n in [0, count).
+     *
+     * Recurrence oscillator: 8 phasors, one per sample of a group of 8, are rotated by 8 * increment with float
+     * multiply-adds (one AVX2 or two SSE2 registers). The phasors are reseeded with sin/cos in double every
+     * oscillatorReseed samples, so rounding errors never accumulate over long buffers.
+     */
+    inline void sineOscillator(float* out, const std::size_t count, const double phase, const double increment, const float amplitude, const float offset) {
+        constexpr std::size_t lanes = 8;
+        const float rc = static_cast<float>(std::cos(lanes * increment));
+        const float rs = static_cast<float>(std::sin(lanes * increment));
+
+        for (std::size_t b = 0; b < count; b += oscillatorReseed) {
+            const std::size_t end = count - b < oscillatorReseed ? count : b + oscillatorReseed;
+            // Phasors scaled by the amplitude: the rotation preserves it
+            float s[lanes];
+            float c[lanes];
+            for (std::size_t k = 0; k < lanes; ++k) {
+                const double theta = phase + static_cast<double>(b + k) * increment;
+                s[k] = static_cast<float>(amplitude * std::sin(theta));
+                c[k] = static_cast<float>(amplitude * std::cos(theta));
+            }
+
+            std::size_t i = b;
+#if defined(PIPEX_SIMD_AVX2)
+            {
+                const __m256 vOffset = _mm256_set1_ps(offset);
+                const __m256 vrc = _mm256_set1_ps(rc);
+                const __m256 vrs = _mm256_set1_ps(rs);
+                __m256 vs = _mm256_loadu_ps(s);
+                __m256 vc = _mm256_loadu_ps(c);
+                for (; i + lanes <= end; i += lanes) {
+                    _mm256_storeu_ps(out + i, _mm256_add_ps(vOffset, vs));
+                    const __m256 ns = _mm256_add_ps(_mm256_mul_ps(vs, vrc), _mm256_mul_ps(vc, vrs));
+                    vc = _mm256_sub_ps(_mm256_mul_ps(vc, vrc), _mm256_mul_ps(vs, vrs));
+                    vs = ns;
+                }
+                _mm256_storeu_ps(s, vs);
+                _mm256_storeu_ps(c, vc);
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            {
+                const __m128 vOffset = _mm_set1_ps(offset);
+                const __m128 vrc = _mm_set1_ps(rc);
+                const __m128 vrs = _mm_set1_ps(rs);
+                __m128 vs0 = _mm_loadu_ps(s), vs1 = _mm_loadu_ps(s + 4);
+                __m128 vc0 = _mm_loadu_ps(c), vc1 = _mm_loadu_ps(c + 4);
+                for (; i + lanes <= end; i += lanes) {
+                    _mm_storeu_ps(out + i, _mm_add_ps(vOffset, vs0));
+                    _mm_storeu_ps(out + i + 4, _mm_add_ps(vOffset, vs1));
+                    const __m128 ns0 = _mm_add_ps(_mm_mul_ps(vs0, vrc), _mm_mul_ps(vc0, vrs));
+                    const __m128 ns1 = _mm_add_ps(_mm_mul_ps(vs1, vrc), _mm_mul_ps(vc1, vrs));
+                    vc0 = _mm_sub_ps(_mm_mul_ps(vc0, vrc), _mm_mul_ps(vs0, vrs));
+                    vc1 = _mm_sub_ps(_mm_mul_ps(vc1, vrc), _mm_mul_ps(vs1, vrs));
+                    vs0 = ns0;
+                    vs1 = ns1;
+                }
+                _mm_storeu_ps(s, vs0);
+                _mm_storeu_ps(s + 4, vs1);
+                _mm_storeu_ps(c, vc0);
+                _mm_storeu_ps(c + 4, vc1);
+            }
+#endif
+            for (; i < end; i += lanes) {
+                for (std::size_t k = 0; k < lanes && i + k < end; ++k) {
+                    out[i + k] = offset + s[k];
+                }
+                for (std::size_t k = 0; k < lanes; ++k) {
+                    const float ns = s[k] * rc + c[k] * rs;
+                    c[k] = c[k] * rc - s[k] * rs;
+                    s[k] = ns;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Multichannel buffer of audio samples.
+     *
+     * Holds numFrames frames of numChannels channels in a single contiguous array, planar by default so that
+     * the DSP nodes can process every channel as a contiguous run (and the channels in parallel); the sources
+     * and sinks convert from/to the interleaved frames of the WAV files.
+     */
+    struct WAV_AudioBuffer {
+        std::size_t numChannels = 1;
+        std::size_t numFrames = 0;
+        AudioLayout layout = AudioLayout::Planar;
+        std::vector<audio_sample_t> samples;
+
+        WAV_AudioBuffer() = default;
+        WAV_AudioBuffer(const std::size_t _numChannels, const std::size_t _numFrames, const AudioLayout _layout = AudioLayout::Planar)
+            : numChannels(_numChannels), numFrames(_numFrames), layout(_layout), samples(_numChannels * _numFrames, 0.0f) {}
+
+        std::size_t size() const { return samples.size(); }
+        bool empty() const { return samples.empty(); }
+        audio_sample_t* data() { return samples.data(); }
+        const audio_sample_t* data() const { return samples.data(); }
+
+        /// Distance between two consecutive samples of a channel: 1 in planar layout, numChannels when interleaved
+        std::size_t stride() const { return layout == AudioLayout::Planar ? 1 : numChannels; }
+
+        /// First sample of channel c (the following ones are stride() samples apart)
+        audio_sample_t* channel(const std::size_t c) { return samples.data() + (layout == AudioLayout::Planar ? c * numFrames : c); }
+        const audio_sample_t* channel(const std::size_t c) const { return samples.data() + (layout == AudioLayout::Planar ? c * numFrames : c); }
+
+        audio_sample_t& at(const std::size_t c, const std::size_t n) { return channel(c)[n * stride()]; }
+        audio_sample_t at(const std::size_t c, const std::size_t n) const { return channel(c)[n * stride()]; }
+
+        /**
+         * @brief Rearranges the samples in the given layout (no-op if the buffer already uses it).
+         */
+        void setLayout(const AudioLayout target) {
+            if (target == layout || numChannels == 1) {
+                layout = target;
+                return;
+            }
+            std::vector<audio_sample_t> converted(samples.size());
+            if (target == AudioLayout::Interleaved) {
+                interleave(samples.data(), numFrames, numChannels, numFrames, converted.data());
+            } else {
+                deinterleave(samples.data(), numChannels, numFrames, converted.data(), numFrames);
+            }
+            samples.swap(converted);
+            layout = target;
+        }
+
+        /// Buffers are equal when they hold the same samples in the same layout
+        bool operator==(const WAV_AudioBuffer& other) const {
+            return numChannels == other.numChannels && numFrames == other.numFrames && layout == other.layout && samples == other.samples;
+        }
+
+        bool operator!=(const WAV_AudioBuffer& other) const {
+            return !(*this == other);
+        }
+    };
 
     /**
      * @brief Overload operator<< for printing WAV_AudioBuffer.
      *
-     * Prints the audio buffer contents to an output stream.
+     * Prints the audio buffer contents to an output stream, channel by channel.
      *
      * @param os The output stream.
      * @param buf The audio buffer to print.
@@ -30,12 +235,15 @@ namespace PipeX {
      */
     inline std::ostream& operator<<(std::ostream& os, const WAV_AudioBuffer& buf) {
         os << '[';
-        for (std::size_t i = 0; i < buf.size(); ++i) {
-            if (i<buf.size()) os << ", ";
-            os << buf[i];
+        for (std::size_t c = 0; c < buf.numChannels; ++c) {
+            if (c > 0) os << "; ";
+            for (std::size_t n = 0; n < buf.numFrames; ++n) {
+                if (n > 0) os << ", ";
+                os << buf.at(c, n);
+            }
         }
         os << ']';
         return os;
     }
 }
-#endif //PIPEX_SOUND_UTILS_H
\ No newline at end of file
+#endif //PIPEX_SOUND_UTILS_H
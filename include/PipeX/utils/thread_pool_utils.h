@@ -0,0 +1,198 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_THREAD_POOL_UTILS_H
+#define PIPEX_THREAD_POOL_UTILS_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PipeX {
+    /**
+     * @brief Fixed-size pool of worker threads used by the data-parallel kernels of the nodes.
+     *
+     * Nodes never create threads themselves: they split their work with parallelFor(), which runs
+     * on the shared pool returned by getThreadPool(). The calling thread always takes part in the
+     * work, so parallelFor() can be safely nested or called from several pipelines at once.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @brief Creates a pool with the given number of worker threads.
+         * @param nThreads Number of workers; 0 means one less than the hardware concurrency
+         *                 (the thread calling parallelFor() is the remaining one).
+         */
+        explicit ThreadPool(std::size_t nThreads = 0) {
+            if (nThreads == 0) {
+                const std::size_t hw = std::thread::hardware_concurrency();
+                nThreads = hw > 1 ? hw - 1 : 1;
+            }
+
+            workers_.reserve(nThreads);
+            for (std::size_t i = 0; i < nThreads; ++i) {
+                workers_.emplace_back(&ThreadPool::workerLoop, this);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                const std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            for (auto& worker : workers_) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+        }
+
+        /**
+         * @brief Shared pool used by all the nodes (created on first use).
+         */
+        static ThreadPool& getThreadPool() {
+            std::call_once(thread_pool_once_, []() {
+                thread_pool_.reset(new ThreadPool());
+            });
+            return *thread_pool_;
+        }
+
+        /**
+         * @brief Number of threads that can work on a parallelFor() (workers plus the caller).
+         */
+        std::size_t concurrency() const {
+            return workers_.size() + 1;
+        }
+
+        /**
+         * @brief Runs body(i) for every i in [begin, end), in parallel, and waits for completion.
+         *
+         * Indices are handed out in chunks of \c grain consecutive indices. At most \c maxThreads
+         * threads (0 = no limit) work on the loop, the calling thread included.
+         * The first exception thrown by \c body is rethrown in the calling thread.
+         */
+        void parallelFor(const std::size_t begin, const std::size_t end, const std::function<void(std::size_t)>& body,
+                         std::size_t grain = 1, const std::size_t maxThreads = 0) {
+            if (end <= begin) {
+                return;
+            }
+            grain = std::max<std::size_t>(grain, 1);
+
+            const std::size_t nChunks = (end - begin + grain - 1) / grain;
+            std::size_t nThreads = std::min(nChunks, concurrency());
+            if (maxThreads > 0) {
+                nThreads = std::min(nThreads, maxThreads);
+            }
+
+            if (nThreads <= 1) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    body(i);
+                }
+                return;
+            }
+
+            auto loop = std::make_shared<LoopState>(begin, end, grain, nChunks, body);
+            for (std::size_t t = 1; t < nThreads; ++t) {
+                enqueue([loop]() { loop->run(); });
+            }
+            loop->run();
+            loop->wait();
+        }
+
+    private:
+        /// Shared state of a parallelFor(): helpers keep it alive even if they start after the loop is over
+        struct LoopState {
+            const std::size_t begin, end, grain, nChunks;
+            const std::function<void(std::size_t)> body;
+
+            std::atomic<std::size_t> nextChunk{0};
+            std::size_t doneChunks = 0;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+
+            LoopState(const std::size_t _begin, const std::size_t _end, const std::size_t _grain, const std::size_t _nChunks,
+                      std::function<void(std::size_t)> _body)
+                : begin(_begin), end(_end), grain(_grain), nChunks(_nChunks), body(std::move(_body)) {}
+
+            void run() {
+                std::size_t chunk;
+                while ((chunk = nextChunk.fetch_add(1)) < nChunks) {
+                    const std::size_t first = begin + chunk * grain;
+                    const std::size_t last = std::min(first + grain, end);
+                    try {
+                        for (std::size_t i = first; i < last; ++i) {
+                            body(i);
+                        }
+                    } catch (...) {
+                        const std::lock_guard<std::mutex> lock(mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    if (++doneChunks == nChunks) {
+                        done.notify_all();
+                    }
+                }
+            }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [this]() { return doneChunks == nChunks; });
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+
+        static std::unique_ptr<ThreadPool> thread_pool_; // Shared instance
+        static std::once_flag thread_pool_once_;
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_ = false;
+
+        void enqueue(std::function<void()> task) {
+            {
+                const std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            condition_.notify_one();
+        }
+
+        void workerLoop() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                    if (stopping_ && tasks_.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+    };
+}
+
+#endif //PIPEX_THREAD_POOL_UTILS_H
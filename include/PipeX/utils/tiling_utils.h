@@ -0,0 +1,114 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_TILING_UTILS_H
+#define PIPEX_TILING_UTILS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "PipeX/utils/thread_pool_utils.h"
+
+namespace PipeX {
+    /**
+     * @brief Rectangular region of an image processed by one kernel invocation.
+     *
+     * The core region [x0, x0 + width) x [y0, y0 + height) is the part of the image the kernel must produce.
+     * The halo region extends the core by the requested overlap (clamped to the image bounds) and is the
+     * part of the input a neighbourhood kernel may read.
+     */
+    struct ImageTile {
+        int x0 = 0, y0 = 0;
+        int width = 0, height = 0;
+
+        int haloX0 = 0, haloY0 = 0;
+        int haloWidth = 0, haloHeight = 0;
+    };
+
+    /**
+     * @brief Tiling configuration of the image kernels.
+     *
+     * The default tile (128 x 128 RGB pixels, 192 KiB with int channels) keeps a tile and its output in a
+     * typical L2 cache.
+     */
+    struct TilingOptions {
+        static constexpr int defaultTileSize = 128;
+
+        int tileWidth = defaultTileSize;
+        int tileHeight = defaultTileSize;
+        int halo = 0;               ///< Overlap (in pixels) around each tile, for neighbourhood kernels
+        std::size_t maxThreads = 0; ///< Max threads working on one image (0 = whole thread pool)
+
+        TilingOptions() = default;
+        TilingOptions(const int _tileWidth, const int _tileHeight, const int _halo = 0, const std::size_t _maxThreads = 0)
+            : tileWidth(_tileWidth), tileHeight(_tileHeight), halo(_halo), maxThreads(_maxThreads) {}
+    };
+
+    /**
+     * @brief Splits images into tiles and runs kernels on them across the shared ThreadPool.
+     */
+    class ImageTiling {
+    public:
+        /**
+         * @brief Tiling options used by the image nodes that were not given explicit ones.
+         *
+         * @note Must be changed only while no pipeline is running.
+         */
+        static TilingOptions& defaultOptions() {
+            return default_options_;
+        }
+
+        /**
+         * @brief Computes the tiles covering a width x height image, in row-major order.
+         */
+        static std::vector<ImageTile> makeTiles(const int width, const int height, const TilingOptions& options) {
+            std::vector<ImageTile> tiles;
+            if (width <= 0 || height <= 0) {
+                return tiles;
+            }
+
+            const int tileWidth = options.tileWidth > 0 ? options.tileWidth : width;
+            const int tileHeight = options.tileHeight > 0 ? options.tileHeight : height;
+            const int halo = std::max(options.halo, 0);
+
+            for (int y = 0; y < height; y += tileHeight) {
+                for (int x = 0; x < width; x += tileWidth) {
+                    ImageTile tile;
+                    tile.x0 = x;
+                    tile.y0 = y;
+                    tile.width = std::min(tileWidth, width - x);
+                    tile.height = std::min(tileHeight, height - y);
+
+                    tile.haloX0 = std::max(x - halo, 0);
+                    tile.haloY0 = std::max(y - halo, 0);
+                    tile.haloWidth = std::min(x + tile.width + halo, width) - tile.haloX0;
+                    tile.haloHeight = std::min(y + tile.height + halo, height) - tile.haloY0;
+
+                    tiles.push_back(tile);
+                }
+            }
+            return tiles;
+        }
+
+        /**
+         * @brief Runs kernel(tile) for every tile of a width x height image, in parallel on the shared ThreadPool.
+         *
+         * Kernels of different tiles run concurrently: they must only write to the core region of their tile.
+         */
+        static void forEachTile(const int width, const int height, const TilingOptions& options,
+                                const std::function<void(const ImageTile&)>& kernel) {
+            const auto tiles = makeTiles(width, height, options);
+            ThreadPool::getThreadPool().parallelFor(0, tiles.size(), [&tiles, &kernel](const std::size_t i) {
+                kernel(tiles[i]);
+            }, 1, options.maxThreads);
+        }
+
+    private:
+        static TilingOptions default_options_;
+    };
+}
+
+#endif //PIPEX_TILING_UTILS_H
@@ -0,0 +1,350 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_WAV_UTILS_H
+#define PIPEX_WAV_UTILS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/sound_utils.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+namespace PipeX {
+    /**
+     * @brief Parser, header writer and sample decoder/encoder for RIFF/WAVE files with integer PCM samples.
+     */
+    namespace WAV {
+        constexpr std::uint16_t formatPCM = 1;
+        constexpr std::uint16_t formatExtensible = 0xFFFE;
+
+        /**
+         * @brief Layout of a WAV file: the fields of its fmt chunk and the position of its data chunk.
+         */
+        struct Layout {
+            std::uint16_t numChannels = 0;
+            std::uint32_t sampleRate = 0;
+            std::uint16_t bitsPerSample = 0;
+            std::uint16_t blockAlign = 0;
+
+            /// Offset of the first sample in the file
+            std::size_t dataOffset = 0;
+            /// Size of the data chunk in bytes (truncated to the file size for incomplete files)
+            std::size_t dataSize = 0;
+
+            std::size_t numFrames() const { return blockAlign ? dataSize / blockAlign : 0; }
+        };
+
+        namespace detail {
+            inline std::uint16_t read16(const std::uint8_t* p) {
+                return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+            }
+
+            inline std::uint32_t read32(const std::uint8_t* p) {
+                return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+                     | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+            }
+        }
+
+        /**
+         * @brief Parses the RIFF chunks of a WAV file: reads the fmt chunk, locates the data chunk and skips any other chunk
+         * (LIST, fact, cue, ...).
+         *
+         * @throws PipeX_IO_Exception if the file is not a RIFF/WAVE file with 8, 16, 24 or 32-bit integer PCM samples.
+         */
+        inline Layout parse(const std::uint8_t* data, const std::size_t size) {
+            if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+                throw PipeX_IO_Exception("[WAV::parse] Not a RIFF/WAVE stream.");
+            }
+
+            Layout layout;
+            bool hasFormat = false;
+            std::size_t p = 12;
+            while (p + 8 <= size) {
+                const std::uint8_t* chunk = data + p;
+                const std::size_t chunkSize = detail::read32(chunk + 4);
+                p += 8;
+
+                if (std::memcmp(chunk, "fmt ", 4) == 0) {
+                    if (chunkSize < 16 || size - p < 16) {
+                        throw PipeX_IO_Exception("[WAV::parse] Truncated fmt chunk.");
+                    }
+                    std::uint16_t audioFormat = detail::read16(chunk + 8);
+                    if (audioFormat == formatExtensible && chunkSize >= 40 && size - p >= 40) {
+                        // The format code is the first field of the SubFormat GUID
+                        audioFormat = detail::read16(chunk + 8 + 24);
+                    }
+                    layout.numChannels = detail::read16(chunk + 10);
+                    layout.sampleRate = detail::read32(chunk + 12);
+                    layout.blockAlign = detail::read16(chunk + 20);
+                    layout.bitsPerSample = detail::read16(chunk + 22);
+
+                    if (audioFormat != formatPCM) {
+                        throw PipeX_IO_Exception("[WAV::parse] Unsupported audio format " + std::to_string(audioFormat) + " (integer PCM only).");
+                    }
+                    if (layout.bitsPerSample != 8 && layout.bitsPerSample != 16 && layout.bitsPerSample != 24 && layout.bitsPerSample != 32) {
+                        throw PipeX_IO_Exception("[WAV::parse] Unsupported bits per sample: " + std::to_string(layout.bitsPerSample));
+                    }
+                    if (layout.numChannels == 0 || layout.blockAlign != layout.numChannels * (layout.bitsPerSample / 8)) {
+                        throw PipeX_IO_Exception("[WAV::parse] Invalid fmt chunk.");
+                    }
+                    hasFormat = true;
+                } else if (std::memcmp(chunk, "data", 4) == 0) {
+                    if (!hasFormat) {
+                        throw PipeX_IO_Exception("[WAV::parse] data chunk before the fmt chunk.");
+                    }
+                    layout.dataOffset = p;
+                    // Recordings interrupted before the header was finalized declare a wrong size
+                    layout.dataSize = chunkSize < size - p ? chunkSize : size - p;
+                    layout.dataSize -= layout.dataSize % layout.blockAlign;
+                    return layout;
+                }
+
+                // Chunks are padded to an even size
+                const std::size_t skip = chunkSize + (chunkSize & 1);
+                if (skip > size - p) {
+                    break;
+                }
+                p += skip;
+            }
+            throw PipeX_IO_Exception("[WAV::parse] Missing fmt or data chunk.");
+        }
+
+        /**
+         * @brief Unpacks count little-endian PCM samples to integers (8-bit samples are unsigned, centered on 128).
+         */
+        inline void unpack(const std::uint8_t* src, const std::size_t count, const int bitsPerSample, bit_depth_t* dst) {
+            switch (bitsPerSample) {
+            case 8:
+                for (std::size_t i = 0; i < count; ++i) {
+                    dst[i] = static_cast<bit_depth_t>(src[i]) - 128;
+                }
+                break;
+            case 16:
+                for (std::size_t i = 0; i < count; ++i, src += 2) {
+                    dst[i] = static_cast<std::int16_t>(detail::read16(src));
+                }
+                break;
+            case 24:
+                for (std::size_t i = 0; i < count; ++i, src += 3) {
+                    // Sign extension through the top byte of a 32-bit value
+                    dst[i] = static_cast<bit_depth_t>(static_cast<std::uint32_t>(src[0] << 8 | src[1] << 16 | src[2] << 24)) >> 8;
+                }
+                break;
+            default:
+                for (std::size_t i = 0; i < count; ++i, src += 4) {
+                    dst[i] = static_cast<bit_depth_t>(detail::read32(src));
+                }
+                break;
+            }
+        }
+
+        /**
+         * @brief Packs count integer samples as little-endian PCM of the given depth, saturated to its range (8-bit samples
+         * are stored unsigned, 24-bit samples packed in 3 bytes).
+         */
+        inline void pack(const bit_depth_t* src, const std::size_t count, const int bitsPerSample, std::uint8_t* dst) {
+            std::size_t i = 0;
+            switch (bitsPerSample) {
+            case 8:
+                for (; i < count; ++i) {
+                    const bit_depth_t v = src[i] < -128 ? -128 : (src[i] > 127 ? 127 : src[i]);
+                    dst[i] = static_cast<std::uint8_t>(v + 128);
+                }
+                break;
+            case 16:
+#if defined(PIPEX_SIMD_SSE2)
+                // Signed saturation is exactly the clamp to the 16-bit range
+                for (; i + 8 <= count; i += 8) {
+                    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_packs_epi32(lo, hi));
+                }
+#endif
+                for (; i < count; ++i) {
+                    const bit_depth_t v = src[i] < -32768 ? -32768 : (src[i] > 32767 ? 32767 : src[i]);
+                    dst[2 * i] = static_cast<std::uint8_t>(v);
+                    dst[2 * i + 1] = static_cast<std::uint8_t>(v >> 8);
+                }
+                break;
+            case 24:
+                for (; i < count; ++i, dst += 3) {
+                    const bit_depth_t v = src[i] < -8388608 ? -8388608 : (src[i] > 8388607 ? 8388607 : src[i]);
+                    dst[0] = static_cast<std::uint8_t>(v);
+                    dst[1] = static_cast<std::uint8_t>(v >> 8);
+                    dst[2] = static_cast<std::uint8_t>(v >> 16);
+                }
+                break;
+            default:
+                for (; i < count; ++i, dst += 4) {
+                    const auto v = static_cast<std::uint32_t>(src[i]);
+                    dst[0] = static_cast<std::uint8_t>(v);
+                    dst[1] = static_cast<std::uint8_t>(v >> 8);
+                    dst[2] = static_cast<std::uint8_t>(v >> 16);
+                    dst[3] = static_cast<std::uint8_t>(v >> 24);
+                }
+                break;
+            }
+        }
+
+        namespace detail {
+            /// Full scale of an integer sample: a float sample of 1.0 corresponds to this value
+            inline float sampleScale(const int bitsPerSample) {
+                return bitsPerSample == 8 ? 128.0f : (bitsPerSample == 16 ? 32768.0f : (bitsPerSample == 24 ? 8388608.0f : 2147483648.0f));
+            }
+
+            /// Largest integer sample, as a float (2^31 - 1 is not representable: the largest float below 2^31 is used)
+            inline float sampleMax(const int bitsPerSample) {
+                return bitsPerSample == 32 ? 2147483520.0f : sampleScale(bitsPerSample) - 1.0f;
+            }
+
+            /// Samples converted at a time through a stack buffer
+            constexpr std::size_t chunkSize = 256;
+
+            /**
+             * @brief dst[i] = src[i] * inverse.
+             */
+            inline void intToFloat(const bit_depth_t* src, const std::size_t count, const float inverse, float* dst) {
+                std::size_t i = 0;
+#if defined(PIPEX_SIMD_AVX2)
+                const __m256 vInverse = _mm256_set1_ps(inverse);
+                for (; i + 8 <= count; i += 8) {
+                    const __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+                    _mm256_storeu_ps(dst + i, _mm256_mul_ps(v, vInverse));
+                }
+#elif defined(PIPEX_SIMD_SSE2)
+                const __m128 vInverse = _mm_set1_ps(inverse);
+                for (; i + 4 <= count; i += 4) {
+                    const __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                    _mm_storeu_ps(dst + i, _mm_mul_ps(v, vInverse));
+                }
+#endif
+                for (; i < count; ++i) {
+                    dst[i] = static_cast<float>(src[i]) * inverse;
+                }
+            }
+
+            /**
+             * @brief dst[i] = src[i] * scale, clamped to [-scale, maxValue] (NaN gives -scale) and rounded to nearest even.
+             */
+            inline void floatToInt(const float* src, const std::size_t count, const float scale, const float maxValue, bit_depth_t* dst) {
+                std::size_t i = 0;
+#if defined(PIPEX_SIMD_AVX2)
+                const __m256 vScale = _mm256_set1_ps(scale);
+                const __m256 vMin = _mm256_set1_ps(-scale);
+                const __m256 vMax = _mm256_set1_ps(maxValue);
+                for (; i + 8 <= count; i += 8) {
+                    const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), vScale), vMin), vMax);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtps_epi32(v));
+                }
+#elif defined(PIPEX_SIMD_SSE2)
+                const __m128 vScale = _mm_set1_ps(scale);
+                const __m128 vMin = _mm_set1_ps(-scale);
+                const __m128 vMax = _mm_set1_ps(maxValue);
+                for (; i + 4 <= count; i += 4) {
+                    const __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), vScale), vMin), vMax);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(v));
+                }
+#endif
+                for (; i < count; ++i) {
+                    // Same operand order as max/min above, so that NaN gives the same result
+                    float v = src[i] * scale;
+                    v = v > -scale ? v : -scale;
+                    v = v < maxValue ? v : maxValue;
+                    dst[i] = static_cast<bit_depth_t>(std::lrint(v));
+                }
+            }
+        }
+
+        /**
+         * @brief Decodes count little-endian PCM samples to float samples in [-1, 1).
+         */
+        inline void decode(const std::uint8_t* src, const std::size_t count, const int bitsPerSample, float* dst) {
+            const std::size_t bytes = static_cast<std::size_t>(bitsPerSample / 8);
+            const float inverse = 1.0f / detail::sampleScale(bitsPerSample);
+            bit_depth_t chunk[detail::chunkSize];
+            for (std::size_t i = 0; i < count; i += detail::chunkSize) {
+                const std::size_t n = count - i < detail::chunkSize ? count - i : detail::chunkSize;
+                unpack(src + i * bytes, n, bitsPerSample, chunk);
+                detail::intToFloat(chunk, n, inverse, dst + i);
+            }
+        }
+
+        /**
+         * @brief Encodes count float samples (full scale [-1, 1), saturated) as little-endian PCM of the given depth.
+         */
+        inline void encode(const float* src, const std::size_t count, const int bitsPerSample, std::uint8_t* dst) {
+            const std::size_t bytes = static_cast<std::size_t>(bitsPerSample / 8);
+            const float scale = detail::sampleScale(bitsPerSample);
+            const float maxValue = detail::sampleMax(bitsPerSample);
+            bit_depth_t chunk[detail::chunkSize];
+            for (std::size_t i = 0; i < count; i += detail::chunkSize) {
+                const std::size_t n = count - i < detail::chunkSize ? count - i : detail::chunkSize;
+                detail::floatToInt(src + i, n, scale, maxValue, chunk);
+                pack(chunk, n, bitsPerSample, dst + i * bytes);
+            }
+        }
+
+        /// Size of the header written by writeHeader()
+        constexpr std::size_t headerSize = 44;
+
+        /**
+         * @brief Writes the canonical 44-byte header of a PCM WAV file (RIFF, fmt and data chunk headers) whose data chunk
+         * holds dataSize bytes (plus a padding byte if dataSize is odd, counted in the RIFF size only).
+         */
+        inline void writeHeader(std::uint8_t* out, const std::uint16_t numChannels, const std::uint32_t sampleRate, const std::uint16_t bitsPerSample,
+                                const std::uint32_t dataSize) {
+            const auto put16 = [&out](const std::uint32_t v) {
+                *out++ = static_cast<std::uint8_t>(v);
+                *out++ = static_cast<std::uint8_t>(v >> 8);
+            };
+            const auto put32 = [&put16](const std::uint32_t v) {
+                put16(v & 0xffff);
+                put16(v >> 16);
+            };
+            const auto tag = [&out](const char* name) {
+                std::memcpy(out, name, 4);
+                out += 4;
+            };
+            const std::uint16_t blockAlign = static_cast<std::uint16_t>(numChannels * (bitsPerSample / 8));
+
+            tag("RIFF");
+            put32(static_cast<std::uint32_t>(headerSize - 8) + dataSize + (dataSize & 1));
+            tag("WAVE");
+            tag("fmt ");
+            put32(16);
+            put16(formatPCM);
+            put16(numChannels);
+            put32(sampleRate);
+            put32(sampleRate * blockAlign);
+            put16(blockAlign);
+            put16(bitsPerSample);
+            tag("data");
+            put32(dataSize);
+        }
+
+        /**
+         * @brief Sets the WAV parameters of metadata from a file layout.
+         */
+        inline void fillMetadata(const Layout& layout, WAV_Metadata& metadata) {
+            metadata.numChannels = layout.numChannels;
+            metadata.sampleRate = layout.sampleRate;
+            metadata.bitsPerSample = layout.bitsPerSample;
+            metadata.bytesPerSample = static_cast<uint16_t>(layout.bitsPerSample / 8);
+            metadata.blockAlign = layout.blockAlign;
+            metadata.byteRate = layout.sampleRate * layout.blockAlign;
+            metadata.numSamples = static_cast<uint32_t>(layout.numFrames());
+            metadata.dataSize = static_cast<uint32_t>(layout.dataSize);
+            metadata.riffSize = 36 + metadata.dataSize;
+            metadata.durationSec = layout.sampleRate ? metadata.numSamples / layout.sampleRate : 0;
+        }
+    }
+}
+
+#endif //PIPEX_WAV_UTILS_H
@@ -0,0 +1,248 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Audio/ParametricEQ.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace PipeX {
+    constexpr std::size_t ParametricEQ::lanes;
+    constexpr std::size_t ParametricEQ::blockFrames;
+
+    ParametricEQ::ParametricEQ(std::string node_name, std::vector<EQ_Band> bands)
+        : Processor(std::move(node_name), [this](std::vector<WAV_AudioBuffer>& batch) {
+            return this->applyEQ(batch);
+        }), bands_(std::move(bands)) {
+        this->logLifeCycle("Constructor(std::string, std::vector<EQ_Band>)");
+    }
+
+    ParametricEQ& ParametricEQ::setBands(std::vector<EQ_Band> bands) {
+        if (bands.size() != bands_.size()) {
+            streams_.clear();
+        }
+        bands_ = std::move(bands);
+        dirty_ = true;
+        return *this;
+    }
+
+    ParametricEQ& ParametricEQ::setBand(const std::size_t index, const EQ_Band& band) {
+        if (index >= bands_.size()) {
+            throw InvalidOperation("ParametricEQ::setBand", "band " + std::to_string(index) + " out of range");
+        }
+        bands_[index] = band;
+        dirty_ = true;
+        return *this;
+    }
+
+    void ParametricEQ::preProcessHook() const {
+        const std::uint32_t sampleRate = this->getMetadata()->sampleRate;
+        if (dirty_ || sampleRate != sampleRate_) {
+            coefficients_.clear();
+            for (const auto& band : bands_) {
+                coefficients_.push_back(design(band, sampleRate));
+            }
+            sampleRate_ = sampleRate;
+            dirty_ = false;
+        }
+    }
+
+    ParametricEQ::Coefficients ParametricEQ::design(const EQ_Band& band, const double sampleRate) {
+        if (!(band.frequency > 0.0 && band.frequency < sampleRate / 2.0) || !(band.q > 0.0)) {
+            throw InvalidOperation("ParametricEQ", "band frequency must be in (0, sampleRate / 2) and q > 0");
+        }
+
+        const double A = std::pow(10.0, band.gainDB / 40.0);
+        const double w0 = 2.0 * M_PI * band.frequency / sampleRate;
+        const double cosw = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * band.q);
+        const double shelf = 2.0 * std::sqrt(A) * alpha;
+
+        double b0, b1, b2, a0, a1, a2;
+        switch (band.type) {
+        case EQ_Band::Type::Peaking:
+            b0 = 1 + alpha * A;
+            b1 = -2 * cosw;
+            b2 = 1 - alpha * A;
+            a0 = 1 + alpha / A;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha / A;
+            break;
+        case EQ_Band::Type::LowShelf:
+            b0 = A * ((A + 1) - (A - 1) * cosw + shelf);
+            b1 = 2 * A * ((A - 1) - (A + 1) * cosw);
+            b2 = A * ((A + 1) - (A - 1) * cosw - shelf);
+            a0 = (A + 1) + (A - 1) * cosw + shelf;
+            a1 = -2 * ((A - 1) + (A + 1) * cosw);
+            a2 = (A + 1) + (A - 1) * cosw - shelf;
+            break;
+        case EQ_Band::Type::HighShelf:
+            b0 = A * ((A + 1) + (A - 1) * cosw + shelf);
+            b1 = -2 * A * ((A - 1) + (A + 1) * cosw);
+            b2 = A * ((A + 1) + (A - 1) * cosw - shelf);
+            a0 = (A + 1) - (A - 1) * cosw + shelf;
+            a1 = 2 * ((A - 1) - (A + 1) * cosw);
+            a2 = (A + 1) - (A - 1) * cosw - shelf;
+            break;
+        case EQ_Band::Type::LowPass:
+            b0 = (1 - cosw) / 2;
+            b1 = 1 - cosw;
+            b2 = (1 - cosw) / 2;
+            a0 = 1 + alpha;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha;
+            break;
+        default:
+            b0 = (1 + cosw) / 2;
+            b1 = -(1 + cosw);
+            b2 = (1 + cosw) / 2;
+            a0 = 1 + alpha;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha;
+            break;
+        }
+
+        return {static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+                static_cast<float>(a1 / a0), static_cast<float>(a2 / a0)};
+    }
+
+    std::vector<WAV_AudioBuffer> ParametricEQ::applyEQ(std::vector<WAV_AudioBuffer>& batch) const {
+        const bool streamStart = this->getMetadata()->blockStart == 0;
+        if (streams_.size() < batch.size()) {
+            streams_.resize(batch.size());
+        }
+
+        const std::size_t stateSize = bands_.size() * 2;
+        std::vector<Signal> signals;
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            WAV_AudioBuffer& audio = batch[i];
+            audio.setLayout(AudioLayout::Planar);
+
+            StreamState& stream = streams_[i];
+            if (streamStart || stream.numChannels != audio.numChannels) {
+                stream.numChannels = audio.numChannels;
+                stream.state.assign(audio.numChannels * stateSize, 0.0f);
+            }
+            for (std::size_t c = 0; c < audio.numChannels; ++c) {
+                signals.push_back({audio.channel(c), audio.numFrames, stream.state.data() + c * stateSize});
+            }
+        }
+        if (bands_.empty()) {
+            return std::move(batch);
+        }
+
+        // Groups of up to lanes signals of the same length (the lanes of a group advance together)
+        std::stable_sort(signals.begin(), signals.end(), [](const Signal& a, const Signal& b) {
+            return a.numFrames < b.numFrames;
+        });
+        std::vector<std::pair<std::size_t, std::size_t>> groups;
+        for (std::size_t first = 0; first < signals.size();) {
+            std::size_t count = 1;
+            while (count < lanes && first + count < signals.size() && signals[first + count].numFrames == signals[first].numFrames) {
+                ++count;
+            }
+            groups.emplace_back(first, count);
+            first += count;
+        }
+
+        ThreadPool::getThreadPool().parallelFor(0, groups.size(), [this, &signals, &groups](const std::size_t g) {
+            filterGroup(signals.data() + groups[g].first, groups[g].second);
+        });
+        return std::move(batch);
+    }
+
+    void ParametricEQ::filterGroup(const Signal* signals, const std::size_t count) const {
+        const std::size_t numFrames = signals[0].numFrames;
+
+        // s1, s2 of every band, one lane per signal (unused lanes filter silence)
+        std::vector<float> state(coefficients_.size() * 2 * lanes, 0.0f);
+        for (std::size_t l = 0; l < count; ++l) {
+            for (std::size_t b = 0; b < coefficients_.size(); ++b) {
+                state[b * 2 * lanes + l] = signals[l].state[b * 2];
+                state[b * 2 * lanes + lanes + l] = signals[l].state[b * 2 + 1];
+            }
+        }
+
+        // Frame n of the block holds sample n of the signals of the group
+        float block[blockFrames * lanes] = {};
+        for (std::size_t n0 = 0; n0 < numFrames; n0 += blockFrames) {
+            const std::size_t frames = numFrames - n0 < blockFrames ? numFrames - n0 : blockFrames;
+            for (std::size_t l = 0; l < count; ++l) {
+                const audio_sample_t* samples = signals[l].samples + n0;
+                for (std::size_t n = 0; n < frames; ++n) {
+                    block[n * lanes + l] = samples[n];
+                }
+            }
+
+            for (std::size_t b = 0; b < coefficients_.size(); ++b) {
+                const Coefficients& k = coefficients_[b];
+                float* s1 = state.data() + b * 2 * lanes;
+                float* s2 = s1 + lanes;
+                std::size_t n = 0;
+
+                // Transposed direct form II: y = b0 x + s1, s1 = b1 x - a1 y + s2, s2 = b2 x - a2 y
+#if defined(PIPEX_SIMD_AVX2)
+                const __m256 b0 = _mm256_set1_ps(k.b0), b1 = _mm256_set1_ps(k.b1), b2 = _mm256_set1_ps(k.b2);
+                const __m256 a1 = _mm256_set1_ps(k.a1), a2 = _mm256_set1_ps(k.a2);
+                __m256 vs1 = _mm256_loadu_ps(s1);
+                __m256 vs2 = _mm256_loadu_ps(s2);
+                for (; n < frames; ++n) {
+                    const __m256 x = _mm256_loadu_ps(block + n * lanes);
+                    const __m256 y = _mm256_add_ps(_mm256_mul_ps(b0, x), vs1);
+                    vs1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), vs2);
+                    vs2 = _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+                    _mm256_storeu_ps(block + n * lanes, y);
+                }
+                _mm256_storeu_ps(s1, vs1);
+                _mm256_storeu_ps(s2, vs2);
+#elif defined(PIPEX_SIMD_SSE2)
+                const __m128 b0 = _mm_set1_ps(k.b0), b1 = _mm_set1_ps(k.b1), b2 = _mm_set1_ps(k.b2);
+                const __m128 a1 = _mm_set1_ps(k.a1), a2 = _mm_set1_ps(k.a2);
+                __m128 vs1 = _mm_loadu_ps(s1);
+                __m128 vs2 = _mm_loadu_ps(s2);
+                for (; n < frames; ++n) {
+                    const __m128 x = _mm_loadu_ps(block + n * lanes);
+                    const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), vs1);
+                    vs1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), vs2);
+                    vs2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+                    _mm_storeu_ps(block + n * lanes, y);
+                }
+                _mm_storeu_ps(s1, vs1);
+                _mm_storeu_ps(s2, vs2);
+#endif
+                for (; n < frames; ++n) {
+                    float* v = block + n * lanes;
+                    for (std::size_t l = 0; l < lanes; ++l) {
+                        const float x = v[l];
+                        const float y = k.b0 * x + s1[l];
+                        s1[l] = (k.b1 * x - k.a1 * y) + s2[l];
+                        s2[l] = k.b2 * x - k.a2 * y;
+                        v[l] = y;
+                    }
+                }
+            }
+
+            for (std::size_t l = 0; l < count; ++l) {
+                audio_sample_t* samples = signals[l].samples + n0;
+                for (std::size_t n = 0; n < frames; ++n) {
+                    samples[n] = block[n * lanes + l];
+                }
+            }
+        }
+
+        for (std::size_t l = 0; l < count; ++l) {
+            for (std::size_t b = 0; b < coefficients_.size(); ++b) {
+                signals[l].state[b * 2] = state[b * 2 * lanes + l];
+                signals[l].state[b * 2 + 1] = state[b * 2 * lanes + lanes + l];
+            }
+        }
+    }
+}
@@ -0,0 +1,211 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Audio/PartitionedConvolution.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/mapped_file_utils.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/utils/wav_utils.h"
+
+namespace PipeX {
+    namespace {
+        /**
+         * @brief acc += x * h over n complex values stored as split real/imaginary arrays.
+         */
+        void multiplyAccumulate(float* accRe, float* accIm, const float* xRe, const float* xIm, const float* hRe, const float* hIm, const std::size_t n) {
+            std::size_t k = 0;
+#if defined(PIPEX_SIMD_AVX2)
+            for (; k + 8 <= n; k += 8) {
+                const __m256 xr = _mm256_loadu_ps(xRe + k), xi = _mm256_loadu_ps(xIm + k);
+                const __m256 hr = _mm256_loadu_ps(hRe + k), hi = _mm256_loadu_ps(hIm + k);
+                const __m256 re = _mm256_sub_ps(_mm256_mul_ps(xr, hr), _mm256_mul_ps(xi, hi));
+                const __m256 im = _mm256_add_ps(_mm256_mul_ps(xr, hi), _mm256_mul_ps(xi, hr));
+                _mm256_storeu_ps(accRe + k, _mm256_add_ps(_mm256_loadu_ps(accRe + k), re));
+                _mm256_storeu_ps(accIm + k, _mm256_add_ps(_mm256_loadu_ps(accIm + k), im));
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            for (; k + 4 <= n; k += 4) {
+                const __m128 xr = _mm_loadu_ps(xRe + k), xi = _mm_loadu_ps(xIm + k);
+                const __m128 hr = _mm_loadu_ps(hRe + k), hi = _mm_loadu_ps(hIm + k);
+                const __m128 re = _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi));
+                const __m128 im = _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr));
+                _mm_storeu_ps(accRe + k, _mm_add_ps(_mm_loadu_ps(accRe + k), re));
+                _mm_storeu_ps(accIm + k, _mm_add_ps(_mm_loadu_ps(accIm + k), im));
+            }
+#endif
+            for (; k < n; ++k) {
+                accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+                accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+            }
+        }
+
+        void checkPartitionSize(const std::size_t partitionSize) {
+            if (partitionSize == 0 || (partitionSize & (partitionSize - 1)) != 0) {
+                throw InvalidOperation("PartitionedConvolution", "partitionSize must be a power of two, got " + std::to_string(partitionSize));
+            }
+        }
+    }
+
+    PartitionedConvolution::PartitionedConvolution(std::string node_name, WAV_AudioBuffer impulseResponse, const std::size_t partitionSize, const std::uint32_t sampleRate)
+        : Processor(std::move(node_name), [this](std::vector<WAV_AudioBuffer>& batch) {
+            return this->convolve(batch);
+        }), partitionSize_(partitionSize), sampleRate_(sampleRate) {
+        checkPartitionSize(partitionSize_);
+        prepare(std::move(impulseResponse));
+        this->logLifeCycle("Constructor(std::string, WAV_AudioBuffer, std::size_t, std::uint32_t)");
+    }
+
+    PartitionedConvolution::PartitionedConvolution(std::string node_name, const std::string& impulseResponseFile, const std::size_t partitionSize)
+        : Processor(std::move(node_name), [this](std::vector<WAV_AudioBuffer>& batch) {
+            return this->convolve(batch);
+        }), partitionSize_(partitionSize), sampleRate_(0) {
+        checkPartitionSize(partitionSize_);
+
+        const MappedFile file(impulseResponseFile);
+        const WAV::Layout layout = WAV::parse(file.data(), file.size());
+        WAV_AudioBuffer impulseResponse(layout.numChannels, layout.numFrames(), AudioLayout::Interleaved);
+        WAV::decode(file.data() + layout.dataOffset, impulseResponse.size(), layout.bitsPerSample, impulseResponse.data());
+        sampleRate_ = layout.sampleRate;
+        prepare(std::move(impulseResponse));
+        this->logLifeCycle("Constructor(std::string, std::string, std::size_t)");
+    }
+
+    void PartitionedConvolution::prepare(WAV_AudioBuffer impulseResponse) {
+        if (impulseResponse.empty()) {
+            throw InvalidOperation("PartitionedConvolution", "empty impulse response");
+        }
+        impulseResponse.setLayout(AudioLayout::Planar);
+
+        plan_ = FFT::plan(2 * partitionSize_);
+        const std::size_t bins = plan_->bins();
+        irChannels_ = impulseResponse.numChannels;
+        partitions_ = (impulseResponse.numFrames + partitionSize_ - 1) / partitionSize_;
+        irRe_.assign(irChannels_ * partitions_ * bins, 0.0f);
+        irIm_.assign(irRe_.size(), 0.0f);
+
+        // Each partition zero-padded to 2 * partitionSize, so its circular convolution with a window of two input
+        // partitions is the linear one on the second half of the window
+        std::vector<float> padded(2 * partitionSize_);
+        for (std::size_t c = 0; c < irChannels_; ++c) {
+            const audio_sample_t* samples = impulseResponse.channel(c);
+            for (std::size_t p = 0; p < partitions_; ++p) {
+                const std::size_t first = p * partitionSize_;
+                const std::size_t count = impulseResponse.numFrames - first < partitionSize_ ? impulseResponse.numFrames - first : partitionSize_;
+                std::fill(padded.begin(), padded.end(), 0.0f);
+                std::memcpy(padded.data(), samples + first, count * sizeof(float));
+                const std::size_t offset = (c * partitions_ + p) * bins;
+                plan_->forward(padded.data(), irRe_.data() + offset, irIm_.data() + offset);
+            }
+        }
+    }
+
+    void PartitionedConvolution::preProcessHook() const {
+        const std::uint32_t sampleRate = this->getMetadata()->sampleRate;
+        if (sampleRate_ != 0 && sampleRate != sampleRate_) {
+            throw InvalidOperation("PartitionedConvolution", "impulse response sampled at " + std::to_string(sampleRate_) +
+                                   " Hz applied to audio at " + std::to_string(sampleRate) + " Hz");
+        }
+    }
+
+    std::vector<WAV_AudioBuffer> PartitionedConvolution::convolve(std::vector<WAV_AudioBuffer>& batch) const {
+        const bool streamStart = this->getMetadata()->blockStart == 0;
+        if (streams_.size() < batch.size()) {
+            streams_.resize(batch.size());
+        }
+
+        // (stream, channel) of every task
+        std::vector<std::pair<std::size_t, std::size_t>> tasks;
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            WAV_AudioBuffer& audio = batch[i];
+            if (irChannels_ != 1 && irChannels_ != audio.numChannels) {
+                throw InvalidOperation("PartitionedConvolution", "impulse response with " + std::to_string(irChannels_) +
+                                       " channels applied to audio with " + std::to_string(audio.numChannels));
+            }
+            audio.setLayout(AudioLayout::Planar);
+
+            StreamState& stream = streams_[i];
+            if (streamStart || stream.numChannels != audio.numChannels) {
+                stream.numChannels = audio.numChannels;
+                stream.channels.resize(audio.numChannels);
+                for (auto& channel : stream.channels) {
+                    resetChannel(channel);
+                }
+            }
+            for (std::size_t c = 0; c < audio.numChannels; ++c) {
+                tasks.emplace_back(i, c);
+            }
+        }
+
+        ThreadPool::getThreadPool().parallelFor(0, tasks.size(), [this, &batch, &tasks](const std::size_t t) {
+            const std::size_t i = tasks[t].first, c = tasks[t].second;
+            convolveChannel(batch[i].channel(c), batch[i].numFrames, irChannels_ == 1 ? 0 : c, streams_[i].channels[c]);
+        });
+        return std::move(batch);
+    }
+
+    void PartitionedConvolution::resetChannel(ChannelState& state) const {
+        const std::size_t bins = plan_->bins();
+        state.window.assign(2 * partitionSize_, 0.0f);
+        state.fill = 0;
+        state.delayRe.assign((partitions_ - 1) * bins, 0.0f);
+        state.delayIm.assign(state.delayRe.size(), 0.0f);
+        state.head = 0;
+        state.pastRe.assign(bins, 0.0f);
+        state.pastIm.assign(bins, 0.0f);
+    }
+
+    void PartitionedConvolution::convolveChannel(audio_sample_t* samples, const std::size_t numFrames, const std::size_t irChannel, ChannelState& state) const {
+        const std::size_t B = partitionSize_;
+        const std::size_t bins = plan_->bins();
+        const std::size_t ring = partitions_ - 1;
+        const float* hRe = irRe_.data() + irChannel * partitions_ * bins;
+        const float* hIm = irIm_.data() + irChannel * partitions_ * bins;
+
+        std::vector<float> xRe(bins), xIm(bins), yRe(bins), yIm(bins), output(2 * B);
+        for (std::size_t pos = 0; pos < numFrames;) {
+            const std::size_t take = numFrames - pos < B - state.fill ? numFrames - pos : B - state.fill;
+            std::memcpy(state.window.data() + B + state.fill, samples + pos, take * sizeof(float));
+            state.fill += take;
+
+            // Output of the current partition: previous partitions plus the (possibly partial) current one
+            plan_->forward(state.window.data(), xRe.data(), xIm.data());
+            std::copy(state.pastRe.begin(), state.pastRe.end(), yRe.begin());
+            std::copy(state.pastIm.begin(), state.pastIm.end(), yIm.begin());
+            multiplyAccumulate(yRe.data(), yIm.data(), xRe.data(), xIm.data(), hRe, hIm, bins);
+            plan_->inverse(yRe.data(), yIm.data(), output.data());
+            std::memcpy(samples + pos, output.data() + B + state.fill - take, take * sizeof(float));
+            pos += take;
+
+            if (state.fill < B) {
+                break;
+            }
+
+            // Partition complete: slide the window and push its spectrum in the delay line
+            std::memcpy(state.window.data(), state.window.data() + B, B * sizeof(float));
+            std::fill(state.window.begin() + static_cast<std::ptrdiff_t>(B), state.window.end(), 0.0f);
+            state.fill = 0;
+            if (ring == 0) {
+                continue;
+            }
+            state.head = (state.head + ring - 1) % ring;
+            std::copy(xRe.begin(), xRe.end(), state.delayRe.begin() + static_cast<std::ptrdiff_t>(state.head * bins));
+            std::copy(xIm.begin(), xIm.end(), state.delayIm.begin() + static_cast<std::ptrdiff_t>(state.head * bins));
+
+            // Contribution of the delay line to the next partition: input partition i - p times response partition p
+            std::fill(state.pastRe.begin(), state.pastRe.end(), 0.0f);
+            std::fill(state.pastIm.begin(), state.pastIm.end(), 0.0f);
+            for (std::size_t p = 1; p < partitions_; ++p) {
+                const std::size_t slot = (state.head + p - 1) % ring;
+                multiplyAccumulate(state.pastRe.data(), state.pastIm.data(), state.delayRe.data() + slot * bins, state.delayIm.data() + slot * bins,
+                                   hRe + p * bins, hIm + p * bins, bins);
+            }
+        }
+    }
+}
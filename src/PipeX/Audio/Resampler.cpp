@@ -0,0 +1,234 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Audio/Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace PipeX {
+    namespace {
+        struct QualityParameters {
+            std::size_t taps;   ///< Taps per output sample (at the lower rate)
+            double beta;        ///< Kaiser window parameter
+            double cutoff;      ///< Cutoff (center of the transition band), as a fraction of the lower Nyquist frequency
+        };
+
+        QualityParameters parameters(const ResamplerQuality quality) {
+            switch (quality) {
+            case ResamplerQuality::Fast:
+                return {16, 5.65, 0.77};
+            case ResamplerQuality::High:
+                return {64, 10.06, 0.90};
+            default:
+                return {32, 7.86, 0.84};
+            }
+        }
+
+        /// Largest table of phases (floats): bounds the memory used by ratios that do not reduce
+        constexpr std::uint64_t maxTableSize = std::uint64_t{1} << 24;
+
+        std::uint64_t gcd(std::uint64_t a, std::uint64_t b) {
+            while (b != 0) {
+                const std::uint64_t r = a % b;
+                a = b;
+                b = r;
+            }
+            return a;
+        }
+
+        /// Modified Bessel function of the first kind, order 0 (series expansion)
+        double besselI0(const double x) {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        }
+    }
+
+    Resampler::Resampler(std::string node_name, const std::uint32_t targetRate, const ResamplerQuality quality)
+        : Processor(std::move(node_name), [this](std::vector<WAV_AudioBuffer>& batch) {
+            return this->resample(batch);
+        }), targetRate_(targetRate), quality_(quality) {
+        if (targetRate_ == 0) {
+            throw InvalidOperation("Resampler::Resampler", "targetRate must be greater than 0");
+        }
+        this->logLifeCycle("Constructor(std::string, std::uint32_t, ResamplerQuality)");
+    }
+
+    void Resampler::preProcessHook() const {
+        const std::uint32_t sampleRate = this->getMetadata()->sampleRate;
+        if (sampleRate == 0) {
+            throw InvalidOperation("Resampler", "unknown input sample rate");
+        }
+        if (sampleRate != sampleRate_) {
+            design(sampleRate);
+        }
+    }
+
+    void Resampler::postProcessHook() const {
+        // The input metadata may be shared with upstream nodes: the output gets its own copy
+        auto metadata = std::make_shared<WAV_Metadata>(*this->getMetadata());
+        metadata->sampleRate = targetRate_;
+        metadata->blockStart = static_cast<std::uint32_t>(outputsBefore(metadata->blockStart));
+        metadata->numSamples = static_cast<std::uint32_t>(outputLength(metadata->numSamples));
+        metadata->byteRate = metadata->sampleRate * metadata->blockAlign;
+        metadata->dataSize = metadata->numSamples * metadata->blockAlign;
+        metadata->riffSize = 36 + metadata->dataSize;
+        this->outputData->metadata = std::move(metadata);
+    }
+
+    void Resampler::design(const std::uint32_t sampleRate) const {
+        this->logLifeCycle("design()");
+        const std::uint64_t divisor = gcd(targetRate_, sampleRate);
+        const std::uint64_t up = targetRate_ / divisor;
+        const std::uint64_t down = sampleRate / divisor;
+        if (up == down) {
+            // Same rate: buffers pass through
+            phases_.clear();
+            streams_.clear();
+            up_ = down_ = 1;
+            taps_ = 0;
+            delay_ = 0;
+            sampleRate_ = sampleRate;
+            return;
+        }
+
+        const QualityParameters quality = parameters(quality_);
+        const std::size_t taps = quality.taps * static_cast<std::size_t>(down > up ? (down + up - 1) / up : 1);
+        if (up * taps > maxTableSize) {
+            throw InvalidOperation("Resampler", "ratio " + std::to_string(targetRate_) + " / " + std::to_string(sampleRate) + " needs too large a filter");
+        }
+
+        // Prototype at the upsampled rate: length up * taps, centered on up * taps / 2
+        const std::size_t length = static_cast<std::size_t>(up) * taps;
+        const double center = static_cast<double>(length) / 2.0;
+        const double fc = quality.cutoff * 0.5 / static_cast<double>(std::max(up, down));
+        const double windowNorm = besselI0(quality.beta);
+        std::vector<double> prototype(length);
+        for (std::size_t n = 0; n < length; ++n) {
+            const double t = static_cast<double>(n) - center;
+            const double sinc = t == 0.0 ? 2.0 * fc : std::sin(2.0 * M_PI * fc * t) / (M_PI * t);
+            const double r = t / center;
+            prototype[n] = sinc * besselI0(quality.beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / windowNorm;
+        }
+
+        // Phase p uses the prototype taps p, p + up, p + 2 up, ... on the input samples from the newest one backwards:
+        // stored reversed so the inner product runs forwards over the input
+        phases_.assign(length, 0.0f);
+        for (std::size_t p = 0; p < up; ++p) {
+            double sum = 0.0;
+            for (std::size_t k = 0; k < taps; ++k) {
+                sum += prototype[p + k * up];
+            }
+            for (std::size_t k = 0; k < taps; ++k) {
+                phases_[p * taps + (taps - 1 - k)] = static_cast<float>(prototype[p + k * up] / sum);
+            }
+        }
+
+        if (taps != taps_) {
+            streams_.clear();
+        }
+        up_ = up;
+        down_ = down;
+        taps_ = taps;
+        delay_ = length / 2;
+        sampleRate_ = sampleRate;
+    }
+
+    std::uint64_t Resampler::outputsBefore(const std::uint64_t end) const {
+        // Output j needs the inputs up to (j * down + delay) / up: the outputs before end are the j with j * down + delay < end * up
+        const std::uint64_t limit = end * up_;
+        return limit <= delay_ ? 0 : (limit - delay_ + down_ - 1) / down_;
+    }
+
+    std::uint64_t Resampler::outputLength(const std::uint64_t length) const {
+        return (length * up_ + down_ - 1) / down_;
+    }
+
+    std::vector<WAV_AudioBuffer> Resampler::resample(std::vector<WAV_AudioBuffer>& batch) const {
+        if (up_ == down_) {
+            return std::move(batch);
+        }
+        if (streams_.size() < batch.size()) {
+            streams_.resize(batch.size());
+        }
+
+        const auto metadata = this->getMetadata();
+        const std::uint64_t start = metadata->blockStart;
+        const std::uint64_t first = outputsBefore(start);
+        const std::size_t history = taps_ - 1;
+
+        std::vector<WAV_AudioBuffer> outputs;
+        outputs.reserve(batch.size());
+        // (stream, channel) of every task
+        std::vector<std::pair<std::size_t, std::size_t>> tasks;
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            WAV_AudioBuffer& data = batch[i];
+            const std::uint64_t end = start + data.numFrames;
+            const bool last = metadata->numSamples == 0 || end >= metadata->numSamples;
+            const std::uint64_t stop = std::max(first, last ? outputLength(end) : outputsBefore(end));
+
+            StreamState& stream = streams_[i];
+            if (start == 0 || stream.numChannels != data.numChannels) {
+                stream.numChannels = data.numChannels;
+                stream.history.assign(data.numChannels * history, 0.0f);
+            }
+
+            outputs.emplace_back(data.numChannels, static_cast<std::size_t>(stop - first));
+            if (outputs.back().numFrames == 0 && data.numFrames == 0) {
+                continue;
+            }
+            data.setLayout(AudioLayout::Planar);
+            for (std::size_t c = 0; c < data.numChannels; ++c) {
+                tasks.emplace_back(i, c);
+            }
+        }
+
+        ThreadPool::getThreadPool().parallelFor(0, tasks.size(), [this, &batch, &outputs, &tasks, history](const std::size_t t) {
+            const std::size_t i = tasks[t].first, c = tasks[t].second;
+            resampleChannel(batch[i], c, streams_[i].history.data() + c * history, outputs[i]);
+        });
+        return outputs;
+    }
+
+    void Resampler::resampleChannel(const WAV_AudioBuffer& data, const std::size_t channel, float* kept, WAV_AudioBuffer& output) const {
+        const std::uint64_t start = this->getMetadata()->blockStart;
+        const std::uint64_t end = start + data.numFrames;
+        const std::uint64_t first = outputsBefore(start);
+        const std::uint64_t stop = first + output.numFrames;
+        const std::size_t history = taps_ - 1;
+
+        // Inputs past the end of the stream read as silence
+        const std::uint64_t needed = stop > first ? ((stop - 1) * down_ + delay_) / up_ + 1 : end;
+        const std::size_t padding = needed > end ? static_cast<std::size_t>(needed - end) : 0;
+
+        // Input samples from start - history: the kept history, the buffer, then the padding
+        std::vector<float> input(history + data.numFrames + padding, 0.0f);
+        std::copy(kept, kept + history, input.begin());
+        std::copy(data.channel(channel), data.channel(channel) + data.numFrames, input.begin() + static_cast<std::ptrdiff_t>(history));
+
+        audio_sample_t* out = output.channel(channel);
+        std::uint64_t position = first * down_ + delay_;
+        for (std::uint64_t j = first; j < stop; ++j, position += down_) {
+            const std::size_t phase = static_cast<std::size_t>(position % up_);
+            const std::size_t newest = static_cast<std::size_t>(position / up_ - start);
+            *out++ = dot(phases_.data() + phase * taps_, input.data() + newest, taps_);
+        }
+
+        std::copy(input.begin() + static_cast<std::ptrdiff_t>(data.numFrames), input.begin() + static_cast<std::ptrdiff_t>(data.numFrames + history), kept);
+    }
+}
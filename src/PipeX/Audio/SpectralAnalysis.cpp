@@ -0,0 +1,333 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Audio/SpectralAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace PipeX {
+    namespace {
+        /// Frames (rows of bins) processed by a task of the spectrum nodes
+        constexpr std::size_t rowsPerTask = 16;
+
+        /// Power corresponding to -200 dB, the floor of SpectrumScale::Decibels
+        constexpr float powerFloor = 1e-20f;
+
+        /// |X[k]|^2 of a value in the given scale
+        inline float toPower(const float value, const SpectrumScale scale) {
+            switch (scale) {
+            case SpectrumScale::Magnitude:
+                return value * value;
+            case SpectrumScale::Power:
+                return value;
+            default:
+                return std::pow(10.0f, value / 10.0f);
+            }
+        }
+
+        /// |X[k]| of a value in the given scale
+        inline float toMagnitude(const float value, const SpectrumScale scale) {
+            return scale == SpectrumScale::Magnitude ? value : std::sqrt(toPower(value, scale));
+        }
+    }
+
+    constexpr std::size_t STFT::framesPerTask;
+
+    STFT::STFT(std::string node_name, const std::size_t fftSize, const std::size_t hopSize)
+        : Processor(std::move(node_name), [this](std::vector<WAV_AudioBuffer>& batch) {
+            return this->analyse(batch);
+        }), plan_(FFT::plan(fftSize)), hopSize_(hopSize), window_(fftSize) {
+        if (hopSize_ == 0) {
+            throw InvalidOperation("STFT::STFT", "hopSize must be greater than 0");
+        }
+        // Periodic Hann window: overlapping windows at hop fftSize / 2 (or / 4) sum to a constant
+        for (std::size_t n = 0; n < fftSize; ++n) {
+            window_[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * static_cast<double>(n) / static_cast<double>(fftSize)));
+        }
+        this->logLifeCycle("Constructor(std::string, std::size_t, std::size_t)");
+    }
+
+    std::uint64_t STFT::completeFrames(const std::uint64_t end) const {
+        const std::uint64_t fftSize = plan_->size();
+        return end < fftSize ? 0 : (end - fftSize) / hopSize_ + 1;
+    }
+
+    std::uint64_t STFT::frameCount(const std::uint64_t length) const {
+        const std::uint64_t fftSize = plan_->size();
+        return length == 0 ? 0 : (length <= fftSize ? 1 : 1 + (length - fftSize + hopSize_ - 1) / hopSize_);
+    }
+
+    std::vector<ComplexSpectrogram> STFT::analyse(std::vector<WAV_AudioBuffer>& batch) const {
+        const std::size_t fftSize = plan_->size();
+        const auto metadata = this->getMetadata();
+        const std::uint64_t start = metadata->blockStart;
+        if (streams_.size() < batch.size()) {
+            streams_.resize(batch.size());
+        }
+
+        std::vector<ComplexSpectrogram> spectra(batch.size());
+        // (stream, channel, first frame of the spectrum) of every task
+        struct Task {
+            std::size_t stream, channel, firstFrame;
+        };
+        std::vector<Task> tasks;
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            WAV_AudioBuffer& data = batch[i];
+            data.setLayout(AudioLayout::Planar);
+
+            StreamState& stream = streams_[i];
+            if (start == 0 || stream.numChannels != data.numChannels || stream.offset + stream.length != start) {
+                stream.numChannels = data.numChannels;
+                stream.nextFrame = (start + hopSize_ - 1) / hopSize_;
+                stream.offset = start;
+                stream.length = 0;
+            }
+
+            // Kept samples followed by the buffer
+            const std::size_t length = stream.length + data.numFrames;
+            std::vector<float> samples(data.numChannels * length);
+            for (std::size_t c = 0; c < data.numChannels; ++c) {
+                std::copy(stream.samples.begin() + static_cast<std::ptrdiff_t>(c * stream.length),
+                          stream.samples.begin() + static_cast<std::ptrdiff_t>((c + 1) * stream.length), samples.begin() + static_cast<std::ptrdiff_t>(c * length));
+                std::copy(data.channel(c), data.channel(c) + data.numFrames, samples.begin() + static_cast<std::ptrdiff_t>(c * length + stream.length));
+            }
+            stream.samples.swap(samples);
+            stream.length = length;
+
+            const std::uint64_t end = start + data.numFrames;
+            const bool last = metadata->numSamples == 0 || end >= metadata->numSamples;
+            const std::uint64_t stop = std::max(stream.nextFrame, last ? frameCount(end) : completeFrames(end));
+
+            ComplexSpectrogram& spectrum = spectra[i];
+            spectrum.numChannels = data.numChannels;
+            spectrum.numFrames = static_cast<std::size_t>(stop - stream.nextFrame);
+            spectrum.numBins = plan_->bins();
+            spectrum.fftSize = fftSize;
+            spectrum.hopSize = hopSize_;
+            spectrum.sampleRate = metadata->sampleRate;
+            spectrum.re.resize(spectrum.numChannels * spectrum.numFrames * spectrum.numBins);
+            spectrum.im.resize(spectrum.re.size());
+            for (std::size_t c = 0; c < spectrum.numChannels; ++c) {
+                for (std::size_t t = 0; t < spectrum.numFrames; t += framesPerTask) {
+                    tasks.push_back({i, c, t});
+                }
+            }
+        }
+
+        ThreadPool::getThreadPool().parallelFor(0, tasks.size(), [&](const std::size_t task) {
+            const Task& current = tasks[task];
+            const StreamState& stream = streams_[current.stream];
+            ComplexSpectrogram& spectrum = spectra[current.stream];
+            const std::size_t lastFrame = current.firstFrame + framesPerTask < spectrum.numFrames ? current.firstFrame + framesPerTask : spectrum.numFrames;
+            const float* samples = stream.samples.data() + current.channel * stream.length;
+
+            std::vector<float> frame(fftSize);
+            for (std::size_t t = current.firstFrame; t < lastFrame; ++t) {
+                const std::size_t first = static_cast<std::size_t>((stream.nextFrame + t) * hopSize_ - stream.offset);
+                const std::size_t available = first >= stream.length ? 0 : (stream.length - first < fftSize ? stream.length - first : fftSize);
+                std::memcpy(frame.data(), samples + first, available * sizeof(float));
+                std::fill(frame.begin() + static_cast<std::ptrdiff_t>(available), frame.end(), 0.0f);
+                multiply(frame.data(), window_.data(), fftSize);
+                plan_->forward(frame.data(), spectrum.real(current.channel, t), spectrum.imag(current.channel, t));
+            }
+        });
+
+        // Keep the samples from the next frame on (none past the end of the buffer)
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            StreamState& stream = streams_[i];
+            stream.nextFrame += spectra[i].numFrames;
+            const std::uint64_t end = stream.offset + stream.length;
+            const std::uint64_t keepFrom = std::min(stream.nextFrame * hopSize_, end);
+            const std::size_t drop = static_cast<std::size_t>(keepFrom - stream.offset);
+            const std::size_t length = stream.length - drop;
+            if (drop > 0) {
+                for (std::size_t c = 0; c < stream.numChannels; ++c) {
+                    std::copy(stream.samples.begin() + static_cast<std::ptrdiff_t>(c * stream.length + drop),
+                              stream.samples.begin() + static_cast<std::ptrdiff_t>((c + 1) * stream.length), stream.samples.begin() + static_cast<std::ptrdiff_t>(c * length));
+                }
+                stream.samples.resize(stream.numChannels * length);
+            }
+            stream.offset = keepFrom;
+            stream.length = length;
+        }
+        return spectra;
+    }
+
+
+    MagnitudeSpectrum::MagnitudeSpectrum(std::string node_name, const SpectrumScale scale)
+        : Transformer(std::move(node_name), [this](ComplexSpectrogram& input) {
+            return this->magnitude(input);
+        }), scale_(scale) {
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, SpectrumScale)");
+    }
+
+    Spectrogram MagnitudeSpectrum::magnitude(const ComplexSpectrogram& spectrum) const {
+        Spectrogram out;
+        out.numChannels = spectrum.numChannels;
+        out.numFrames = spectrum.numFrames;
+        out.numBins = spectrum.numBins;
+        out.fftSize = spectrum.fftSize;
+        out.hopSize = spectrum.hopSize;
+        out.sampleRate = spectrum.sampleRate;
+        out.scale = scale_;
+        out.values.resize(spectrum.re.size());
+
+        const std::size_t rows = spectrum.numChannels * spectrum.numFrames;
+        ThreadPool::getThreadPool().parallelFor(0, (rows + rowsPerTask - 1) / rowsPerTask, [&](const std::size_t task) {
+            const std::size_t begin = task * rowsPerTask * out.numBins;
+            const std::size_t end = (task + 1) * rowsPerTask < rows ? (task + 1) * rowsPerTask * out.numBins : rows * out.numBins;
+            const float* re = spectrum.re.data();
+            const float* im = spectrum.im.data();
+            float* values = out.values.data();
+
+            std::size_t i = begin;
+#if defined(PIPEX_SIMD_AVX2)
+            for (; i + 8 <= end; i += 8) {
+                const __m256 r = _mm256_loadu_ps(re + i);
+                const __m256 m = _mm256_loadu_ps(im + i);
+                const __m256 power = _mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(m, m));
+                _mm256_storeu_ps(values + i, scale_ == SpectrumScale::Magnitude ? _mm256_sqrt_ps(power) : power);
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            for (; i + 4 <= end; i += 4) {
+                const __m128 r = _mm_loadu_ps(re + i);
+                const __m128 m = _mm_loadu_ps(im + i);
+                const __m128 power = _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m));
+                _mm_storeu_ps(values + i, scale_ == SpectrumScale::Magnitude ? _mm_sqrt_ps(power) : power);
+            }
+#endif
+            for (; i < end; ++i) {
+                const float power = re[i] * re[i] + im[i] * im[i];
+                values[i] = scale_ == SpectrumScale::Magnitude ? std::sqrt(power) : power;
+            }
+
+            if (scale_ == SpectrumScale::Decibels) {
+                for (i = begin; i < end; ++i) {
+                    values[i] = 10.0f * std::log10(values[i] > powerFloor ? values[i] : powerFloor);
+                }
+            }
+        });
+        return out;
+    }
+
+
+    SpectralShape::SpectralShape(std::string node_name, const double rolloffPercent)
+        : Transformer(std::move(node_name), [this](Spectrogram& input) {
+            return this->shape(input);
+        }), rolloffPercent_(rolloffPercent) {
+        if (!(rolloffPercent_ > 0.0 && rolloffPercent_ <= 1.0)) {
+            throw InvalidOperation("SpectralShape::SpectralShape", "rolloffPercent must be in (0, 1]");
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, double)");
+    }
+
+    SpectralFeatures SpectralShape::shape(const Spectrogram& spectrum) const {
+        SpectralFeatures features;
+        features.numChannels = spectrum.numChannels;
+        features.numFrames = spectrum.numFrames;
+        features.hopSize = spectrum.hopSize;
+        features.sampleRate = spectrum.sampleRate;
+        features.names = {"centroid", "rolloff"};
+        features.values.resize(spectrum.numChannels * spectrum.numFrames * features.names.size());
+
+        const std::size_t rows = spectrum.numChannels * spectrum.numFrames;
+        ThreadPool::getThreadPool().parallelFor(0, (rows + rowsPerTask - 1) / rowsPerTask, [&](const std::size_t task) {
+            const std::size_t end = (task + 1) * rowsPerTask < rows ? (task + 1) * rowsPerTask : rows;
+            for (std::size_t row = task * rowsPerTask; row < end; ++row) {
+                const float* bins = spectrum.values.data() + row * spectrum.numBins;
+                float* out = features.values.data() + row * features.names.size();
+
+                double weighted = 0.0, magnitude = 0.0, totalPower = 0.0;
+                for (std::size_t k = 0; k < spectrum.numBins; ++k) {
+                    const double m = toMagnitude(bins[k], spectrum.scale);
+                    weighted += m * spectrum.binFrequency(k);
+                    magnitude += m;
+                    totalPower += m * m;
+                }
+                out[0] = magnitude > 0.0 ? static_cast<float>(weighted / magnitude) : 0.0f;
+
+                out[1] = 0.0f;
+                if (totalPower > 0.0) {
+                    const double threshold = rolloffPercent_ * totalPower;
+                    double cumulative = 0.0;
+                    for (std::size_t k = 0; k < spectrum.numBins; ++k) {
+                        cumulative += toPower(bins[k], spectrum.scale);
+                        if (cumulative >= threshold) {
+                            out[1] = static_cast<float>(spectrum.binFrequency(k));
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+        return features;
+    }
+
+
+    BandEnergy::BandEnergy(std::string node_name, std::vector<double> edgesHz)
+        : Transformer(std::move(node_name), [this](Spectrogram& input) {
+            return this->bandEnergy(input);
+        }), edgesHz_(std::move(edgesHz)) {
+        if (edgesHz_.size() < 2 || edgesHz_.front() < 0.0) {
+            throw InvalidOperation("BandEnergy::BandEnergy", "at least 2 band edges >= 0 are required");
+        }
+        for (std::size_t b = 0; b + 1 < edgesHz_.size(); ++b) {
+            if (!(edgesHz_[b] < edgesHz_[b + 1])) {
+                throw InvalidOperation("BandEnergy::BandEnergy", "band edges must be increasing");
+            }
+            std::ostringstream name;
+            name << edgesHz_[b] << '-' << edgesHz_[b + 1] << "Hz";
+            names_.push_back(name.str());
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, std::vector<double>)");
+    }
+
+    SpectralFeatures BandEnergy::bandEnergy(const Spectrogram& spectrum) const {
+        SpectralFeatures features;
+        features.numChannels = spectrum.numChannels;
+        features.numFrames = spectrum.numFrames;
+        features.hopSize = spectrum.hopSize;
+        features.sampleRate = spectrum.sampleRate;
+        features.names = names_;
+        features.values.resize(spectrum.numChannels * spectrum.numFrames * names_.size());
+
+        // Bins [first[b], first[b + 1]) fall in band b
+        std::vector<std::size_t> first(edgesHz_.size());
+        for (std::size_t b = 0; b < edgesHz_.size(); ++b) {
+            const double bin = std::ceil(edgesHz_[b] * static_cast<double>(spectrum.fftSize) / spectrum.sampleRate);
+            first[b] = bin < static_cast<double>(spectrum.numBins) ? static_cast<std::size_t>(bin) : spectrum.numBins;
+        }
+
+        const std::size_t rows = spectrum.numChannels * spectrum.numFrames;
+        ThreadPool::getThreadPool().parallelFor(0, (rows + rowsPerTask - 1) / rowsPerTask, [&](const std::size_t task) {
+            const std::size_t end = (task + 1) * rowsPerTask < rows ? (task + 1) * rowsPerTask : rows;
+            for (std::size_t row = task * rowsPerTask; row < end; ++row) {
+                const float* bins = spectrum.values.data() + row * spectrum.numBins;
+                float* out = features.values.data() + row * names_.size();
+                for (std::size_t b = 0; b < names_.size(); ++b) {
+                    double energy = 0.0;
+                    for (std::size_t k = first[b]; k < first[b + 1]; ++k) {
+                        energy += toPower(bins[k], spectrum.scale);
+                    }
+                    out[b] = static_cast<float>(energy);
+                }
+            }
+        });
+        return features;
+    }
+}
@@ -3,8 +3,12 @@
 //
 
 #include "PipeX/nodes/Audio/WAV_AudioPreset_Source.h"
-#include "PipeX/errors/PipeXException.h"
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+#include "PipeX/utils/mapped_file_utils.h"
+#include "PipeX/utils/wav_utils.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -14,69 +18,91 @@
 #endif
 
 namespace PipeX {
+    constexpr int WAV_SoundPreset_Source::SINE;
+    constexpr int WAV_SoundPreset_Source::WHITE_NOISE;
+    constexpr int WAV_SoundPreset_Source::PINK_NOISE;
+    constexpr int WAV_SoundPreset_Source::WAV_FILE;
 
     WAV_AudioBuffer WAV_SoundPreset_Source::sinusoidalWave() const{
-        WAV_AudioBuffer audio;
-        audio.resize(this->sourceMetadata->numSamples);
-        for (bit_depth_t i = 0; i < this->sourceMetadata->numSamples; ++i) {
+        WAV_AudioBuffer audio(this->sourceMetadata->numChannels, this->sourceMetadata->numSamples);
+        for (uint32_t i = 0; i < this->sourceMetadata->numSamples; ++i) {
             constexpr double frequency = 440.0; // A4 note
             const double t = static_cast<double>(i) / this->sourceMetadata->sampleRate;
-            audio[i] = static_cast<bit_depth_t>(32767 * sin(2 * M_PI * frequency * t));
+            audio.at(0, i) = static_cast<audio_sample_t>(32767.0 / 32768.0 * sin(2 * M_PI * frequency * t));
+        }
+        for (std::size_t c = 1; c < audio.numChannels; ++c) {
+            std::copy(audio.channel(0), audio.channel(0) + audio.numFrames, audio.channel(c));
         }
 
         return audio;
     }
 
     WAV_AudioBuffer WAV_SoundPreset_Source::whiteNoise() const {
-        WAV_AudioBuffer audio;
-        audio.resize(this->sourceMetadata->numSamples);
-        for (bit_depth_t i = 0; i < this->sourceMetadata->numSamples; ++i) {
+        WAV_AudioBuffer audio(this->sourceMetadata->numChannels, this->sourceMetadata->numSamples);
+        for (std::size_t i = 0; i < audio.size(); ++i) {
             double u = (rand() + 1.0) / (RAND_MAX + 1.0);
             double v = (rand() + 1.0) / (RAND_MAX + 1.0);
             double gaussian = sqrt(-2 * log(u)) * cos(2 * M_PI * v);
-            int16_t sample = (int16_t)(gaussian * 10000);
-
-            audio[i] = static_cast<bit_depth_t>(sample);
+            // Same level as a 16-bit signal of standard deviation 10000 (rare peaks saturate in the sink)
+            audio.samples[i] = static_cast<audio_sample_t>(gaussian * 10000 / 32768);
         }
 
         return audio;
     }
 
     WAV_AudioBuffer WAV_SoundPreset_Source::pinkNoise() const {
-        WAV_AudioBuffer audio;
-        audio.resize(this->sourceMetadata->numSamples);
+        WAV_AudioBuffer audio(this->sourceMetadata->numChannels, this->sourceMetadata->numSamples);
         std::srand((unsigned)time(nullptr));
 
         const int NUM_ROWS = 16;
-        int rows[NUM_ROWS] = {0};
-        int runningSum = 0;
-        unsigned long counter = 0;
+        for (std::size_t channel = 0; channel < audio.numChannels; ++channel) {
+            int rows[NUM_ROWS] = {0};
+            int runningSum = 0;
+            unsigned long counter = 0;
 
-        for (uint32_t i = 0; i < this->sourceMetadata->numSamples; ++i) {
-            int index = 0;
-            unsigned long c = ++counter;
+            for (uint32_t i = 0; i < this->sourceMetadata->numSamples; ++i) {
+                int index = 0;
+                unsigned long c = ++counter;
 
-            while ((c & 1) == 0) {
-                c >>= 1;
-                index++;
-            }
+                while ((c & 1) == 0) {
+                    c >>= 1;
+                    index++;
+                }
 
-            if (index < NUM_ROWS) {
-                runningSum -= rows[index];
-                rows[index] = (rand() % 65536) - 32768;
-                runningSum += rows[index];
-            }
+                if (index < NUM_ROWS) {
+                    runningSum -= rows[index];
+                    rows[index] = (rand() % 65536) - 32768;
+                    runningSum += rows[index];
+                }
 
-            int16_t sample = runningSum / NUM_ROWS;
+                int16_t sample = runningSum / NUM_ROWS;
 
-            audio[i] = static_cast<bit_depth_t>(sample);
+                audio.at(channel, i) = static_cast<audio_sample_t>(sample) / 32768.0f;
+            }
         }
 
         return audio;
     }
 
     WAV_AudioBuffer WAV_SoundPreset_Source::loadWAVFile(const int sample) const{
-        throw PipeXException("WAV_SoundPreset_Source::loadWAVFile NOT IMPLEMENTED");
-        return {};
+        if (preset != WAV_FILE) {
+            throw InvalidOperation("WAV_SoundPreset_Source::loadWAVFile", "unknown preset " + std::to_string(preset));
+        }
+
+        const std::string path = filename + "_" + std::to_string(sample) + ".wav";
+        const MappedFile file(path);
+        const WAV::Layout layout = WAV::parse(file.data(), file.size());
+
+        if (sample == 0) {
+            WAV::fillMetadata(layout, *this->sourceMetadata);
+        } else if (layout.numChannels != this->sourceMetadata->numChannels || layout.sampleRate != this->sourceMetadata->sampleRate
+                   || layout.bitsPerSample != this->sourceMetadata->bitsPerSample || layout.numFrames() != this->sourceMetadata->numSamples) {
+            throw PipeX_IO_Exception("[WAV_SoundPreset_Source::loadWAVFile] Tracks of a batch must have the same format and length: " + path);
+        }
+
+        WAV_AudioBuffer audio(layout.numChannels, layout.numFrames(), AudioLayout::Interleaved);
+        WAV::decode(file.data() + layout.dataOffset, audio.size(), layout.bitsPerSample, audio.data());
+        audio.setLayout(AudioLayout::Planar);
+        return audio;
     }
 }
@@ -0,0 +1,73 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Audio/WAV_Audio_Source.h"
+
+#include <algorithm>
+
+#include "PipeX/utils/thread_pool_utils.h"
+
+namespace PipeX {
+    WAV_Audio_Source::WAV_Audio_Source(std::string node_name, std::string filename, const std::size_t blockFrames)
+        : Source(std::move(node_name), [this]() {
+            return this->nextBlock();
+        }), filename_(std::move(filename)), blockFrames_(blockFrames) {
+        this->logLifeCycle("Constructor(std::string, std::string, std::size_t)");
+    }
+
+    bool WAV_Audio_Source::hasPendingData() const {
+        return file_ && position_ < layout_.numFrames();
+    }
+
+    void WAV_Audio_Source::endOfStream() {
+        file_.reset();
+        position_ = 0;
+    }
+
+    double WAV_Audio_Source::blockDuration() const {
+        return layout_.sampleRate > 0 ? static_cast<double>(lastBlockFrames_) / layout_.sampleRate : 0.0;
+    }
+
+    std::vector<WAV_AudioBuffer> WAV_Audio_Source::nextBlock() {
+        if (!file_) {
+            file_ = std::make_shared<MappedFile>(filename_);
+            layout_ = WAV::parse(file_->data(), file_->size());
+            position_ = 0;
+        }
+
+        this->createMetadata();
+        WAV::fillMetadata(layout_, *sourceMetadata);
+        sourceMetadata->blockStart = static_cast<uint32_t>(position_);
+
+        const std::size_t remaining = layout_.numFrames() - position_;
+        const std::size_t frames = blockFrames_ > 0 ? std::min(blockFrames_, remaining) : remaining;
+        lastBlockFrames_ = frames;
+        const std::size_t begin = layout_.dataOffset + position_ * layout_.blockAlign;
+
+        std::vector<WAV_AudioBuffer> blocks(1, WAV_AudioBuffer(layout_.numChannels, frames));
+        WAV_AudioBuffer& audio = blocks[0];
+
+        // Decoding is bandwidth bound: large blocks are split over the thread pool. Each task decodes its frames
+        // into a scratch buffer and splits them into the channel planes
+        constexpr std::size_t samplesPerTask = 1 << 16;
+        const std::size_t framesPerTask = (samplesPerTask + layout_.numChannels - 1) / layout_.numChannels;
+        const std::size_t nTasks = (frames + framesPerTask - 1) / framesPerTask;
+        ThreadPool::getThreadPool().parallelFor(0, nTasks, [&](const std::size_t task) {
+            const std::size_t n0 = task * framesPerTask;
+            const std::size_t count = std::min(framesPerTask, frames - n0);
+            const uint8_t* src = file_->data() + begin + n0 * layout_.blockAlign;
+            if (layout_.numChannels == 1) {
+                WAV::decode(src, count, layout_.bitsPerSample, audio.data() + n0);
+                return;
+            }
+            std::vector<audio_sample_t> interleaved(count * layout_.numChannels);
+            WAV::decode(src, interleaved.size(), layout_.bitsPerSample, interleaved.data());
+            deinterleave(interleaved.data(), layout_.numChannels, count, audio.data() + n0, frames);
+        });
+
+        file_->discard(begin, frames * layout_.blockAlign);
+        position_ += frames;
+        return blocks;
+    }
+}
@@ -0,0 +1,296 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/utils/fft_utils.h"
+
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace PipeX {
+    namespace {
+        /// Vector operations used by the butterflies: one float, or a SIMD register of floats
+        struct ScalarOps {
+            using V = float;
+            static constexpr std::size_t width = 1;
+            static V load(const float* p) { return *p; }
+            static void store(float* p, const V v) { *p = v; }
+            static V add(const V a, const V b) { return a + b; }
+            static V sub(const V a, const V b) { return a - b; }
+            static V mul(const V a, const V b) { return a * b; }
+            static V neg(const V a) { return -a; }
+        };
+
+#if defined(PIPEX_SIMD_AVX2)
+        struct VectorOps {
+            using V = __m256;
+            static constexpr std::size_t width = 8;
+            static V load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, const V v) { _mm256_storeu_ps(p, v); }
+            static V add(const V a, const V b) { return _mm256_add_ps(a, b); }
+            static V sub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+            static V mul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+            static V neg(const V a) { return _mm256_sub_ps(_mm256_setzero_ps(), a); }
+        };
+#elif defined(PIPEX_SIMD_SSE2)
+        struct VectorOps {
+            using V = __m128;
+            static constexpr std::size_t width = 4;
+            static V load(const float* p) { return _mm_loadu_ps(p); }
+            static void store(float* p, const V v) { _mm_storeu_ps(p, v); }
+            static V add(const V a, const V b) { return _mm_add_ps(a, b); }
+            static V sub(const V a, const V b) { return _mm_sub_ps(a, b); }
+            static V mul(const V a, const V b) { return _mm_mul_ps(a, b); }
+            static V neg(const V a) { return _mm_sub_ps(_mm_setzero_ps(), a); }
+        };
+#else
+        using VectorOps = ScalarOps;
+#endif
+
+        /**
+         * @brief (outRe, outIm) = (ar, ai) * w, or * conj(w) for the inverse transform.
+         */
+        template <typename Ops, bool Inverse>
+        inline void complexMultiply(const typename Ops::V ar, const typename Ops::V ai, const typename Ops::V wr, const typename Ops::V wi,
+                                    typename Ops::V& outRe, typename Ops::V& outIm) {
+            if (Inverse) {
+                outRe = Ops::add(Ops::mul(ar, wr), Ops::mul(ai, wi));
+                outIm = Ops::sub(Ops::mul(ai, wr), Ops::mul(ar, wi));
+            } else {
+                outRe = Ops::sub(Ops::mul(ar, wr), Ops::mul(ai, wi));
+                outIm = Ops::add(Ops::mul(ar, wi), Ops::mul(ai, wr));
+            }
+        }
+
+        /**
+         * @brief Radix-2 stage of span m over n points: x[k + j], x[k + j + m] = x[k + j] +- w^j x[k + j + m].
+         */
+        template <typename Ops, bool Inverse>
+        void radix2Pass(float* re, float* im, const std::size_t n, const std::size_t m, const float* wr, const float* wi) {
+            using V = typename Ops::V;
+            for (std::size_t k = 0; k < n; k += 2 * m) {
+                for (std::size_t j = 0; j < m; j += Ops::width) {
+                    const std::size_t p = k + j, q = p + m;
+                    V br, bi;
+                    complexMultiply<Ops, Inverse>(Ops::load(re + q), Ops::load(im + q), Ops::load(wr + j), Ops::load(wi + j), br, bi);
+                    const V ar = Ops::load(re + p), ai = Ops::load(im + p);
+                    Ops::store(re + p, Ops::add(ar, br));
+                    Ops::store(im + p, Ops::add(ai, bi));
+                    Ops::store(re + q, Ops::sub(ar, br));
+                    Ops::store(im + q, Ops::sub(ai, bi));
+                }
+            }
+        }
+
+        /**
+         * @brief Radix-2 stages of span m and 2m fused in a single pass (radix-4 butterflies over groups of 4m points).
+         *
+         * w1 are the twiddles of the stage of span m, w2 those of the stage of span 2m (the second half of which is
+         * the first one times -i, +i for the inverse transform).
+         */
+        template <typename Ops, bool Inverse>
+        void radix4Pass(float* re, float* im, const std::size_t n, const std::size_t m,
+                        const float* w1r, const float* w1i, const float* w2r, const float* w2i) {
+            using V = typename Ops::V;
+            for (std::size_t k = 0; k < n; k += 4 * m) {
+                for (std::size_t j = 0; j < m; j += Ops::width) {
+                    float* r = re + k + j;
+                    float* i = im + k + j;
+                    const V t1r = Ops::load(w1r + j), t1i = Ops::load(w1i + j);
+                    const V t2r = Ops::load(w2r + j), t2i = Ops::load(w2i + j);
+
+                    // Stage of span m
+                    const V ar = Ops::load(r), ai = Ops::load(i);
+                    const V cr = Ops::load(r + 2 * m), ci = Ops::load(i + 2 * m);
+                    V br, bi, dr, di;
+                    complexMultiply<Ops, Inverse>(Ops::load(r + m), Ops::load(i + m), t1r, t1i, br, bi);
+                    complexMultiply<Ops, Inverse>(Ops::load(r + 3 * m), Ops::load(i + 3 * m), t1r, t1i, dr, di);
+                    const V a1r = Ops::add(ar, br), a1i = Ops::add(ai, bi);
+                    const V b1r = Ops::sub(ar, br), b1i = Ops::sub(ai, bi);
+                    const V c1r = Ops::add(cr, dr), c1i = Ops::add(ci, di);
+                    const V d1r = Ops::sub(cr, dr), d1i = Ops::sub(ci, di);
+
+                    // Stage of span 2m
+                    V er, ei, fr, fi;
+                    complexMultiply<Ops, Inverse>(c1r, c1i, t2r, t2i, er, ei);
+                    complexMultiply<Ops, Inverse>(d1r, d1i, t2r, t2i, fr, fi);
+                    // f * -i = (fi, -fr) for the forward transform, f * i = (-fi, fr) for the inverse one
+                    const V gr = Inverse ? Ops::neg(fi) : fi;
+                    const V gi = Inverse ? fr : Ops::neg(fr);
+
+                    Ops::store(r, Ops::add(a1r, er));
+                    Ops::store(i, Ops::add(a1i, ei));
+                    Ops::store(r + 2 * m, Ops::sub(a1r, er));
+                    Ops::store(i + 2 * m, Ops::sub(a1i, ei));
+                    Ops::store(r + m, Ops::add(b1r, gr));
+                    Ops::store(i + m, Ops::add(b1i, gi));
+                    Ops::store(r + 3 * m, Ops::sub(b1r, gr));
+                    Ops::store(i + 3 * m, Ops::sub(b1i, gi));
+                }
+            }
+        }
+    }
+
+    FFT::FFT(const std::size_t size) : size_(size), half_(size / 2) {
+        if (size < 2 || (size & (size - 1)) != 0) {
+            throw InvalidOperation("FFT", "size must be a power of two >= 2, got " + std::to_string(size));
+        }
+
+        std::size_t bits = 0;
+        while ((std::size_t{1} << bits) < half_) {
+            ++bits;
+        }
+        bitReverse_.resize(half_);
+        for (std::size_t j = 0; j < half_; ++j) {
+            std::size_t r = 0;
+            for (std::size_t b = 0; b < bits; ++b) {
+                r |= ((j >> b) & 1) << (bits - 1 - b);
+            }
+            bitReverse_[j] = r;
+        }
+
+        twiddleRe_.resize(half_ > 1 ? half_ - 1 : 0);
+        twiddleIm_.resize(twiddleRe_.size());
+        for (std::size_t m = 1; m < half_; m *= 2) {
+            for (std::size_t j = 0; j < m; ++j) {
+                const double angle = -M_PI * static_cast<double>(j) / static_cast<double>(m);
+                twiddleRe_[m - 1 + j] = static_cast<float>(std::cos(angle));
+                twiddleIm_[m - 1 + j] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        splitRe_.resize(size_ / 4 + 1);
+        splitIm_.resize(size_ / 4 + 1);
+        for (std::size_t k = 0; k < splitRe_.size(); ++k) {
+            const double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size_);
+            splitRe_[k] = static_cast<float>(std::cos(angle));
+            splitIm_[k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    std::shared_ptr<const FFT> FFT::plan(const std::size_t size) {
+        static std::mutex mutex;
+        static std::map<std::size_t, std::shared_ptr<const FFT>> plans;
+
+        const std::lock_guard<std::mutex> lock(mutex);
+        auto& cached = plans[size];
+        if (!cached) {
+            cached = std::make_shared<const FFT>(size);
+        }
+        return cached;
+    }
+
+    void FFT::transform(float* re, float* im, const bool inverse) const {
+        const std::size_t n = half_;
+        std::size_t m = 1;
+
+        const auto radix2 = [&](const std::size_t span) {
+            const float* wr = twiddleRe_.data() + span - 1;
+            const float* wi = twiddleIm_.data() + span - 1;
+            if (span >= VectorOps::width) {
+                inverse ? radix2Pass<VectorOps, true>(re, im, n, span, wr, wi) : radix2Pass<VectorOps, false>(re, im, n, span, wr, wi);
+            } else {
+                inverse ? radix2Pass<ScalarOps, true>(re, im, n, span, wr, wi) : radix2Pass<ScalarOps, false>(re, im, n, span, wr, wi);
+            }
+        };
+        const auto radix4 = [&](const std::size_t span) {
+            const float* w1r = twiddleRe_.data() + span - 1;
+            const float* w1i = twiddleIm_.data() + span - 1;
+            const float* w2r = twiddleRe_.data() + 2 * span - 1;
+            const float* w2i = twiddleIm_.data() + 2 * span - 1;
+            if (span >= VectorOps::width) {
+                inverse ? radix4Pass<VectorOps, true>(re, im, n, span, w1r, w1i, w2r, w2i) : radix4Pass<VectorOps, false>(re, im, n, span, w1r, w1i, w2r, w2i);
+            } else {
+                inverse ? radix4Pass<ScalarOps, true>(re, im, n, span, w1r, w1i, w2r, w2i) : radix4Pass<ScalarOps, false>(re, im, n, span, w1r, w1i, w2r, w2i);
+            }
+        };
+
+        // An odd number of stages starts with a radix-2 pass, the others are fused two by two
+        std::size_t stages = 0;
+        while ((std::size_t{1} << stages) < n) {
+            ++stages;
+        }
+        if (stages & 1) {
+            radix2(m);
+            m *= 2;
+        }
+        for (; m < n; m *= 4) {
+            radix4(m);
+        }
+    }
+
+    void FFT::forward(const float* in, float* re, float* im) const {
+        // Even samples as real part, odd samples as imaginary part, in bit-reversed order
+        for (std::size_t j = 0; j < half_; ++j) {
+            re[bitReverse_[j]] = in[2 * j];
+            im[bitReverse_[j]] = in[2 * j + 1];
+        }
+        transform(re, im, false);
+
+        // Split pass: X[k] = E[k] + W^k O[k] and X[half - k] = conj(E[k] - W^k O[k]), where E and O are the spectra of
+        // the even and odd samples, E[k] = (Z[k] + conj(Z[half - k])) / 2 and O[k] = (Z[k] - conj(Z[half - k])) / 2i
+        const float z0r = re[0], z0i = im[0];
+        re[0] = z0r + z0i;
+        im[0] = 0.0f;
+        re[half_] = z0r - z0i;
+        im[half_] = 0.0f;
+        for (std::size_t k = 1; k <= half_ / 2; ++k) {
+            const std::size_t h = half_ - k;
+            const float er = 0.5f * (re[k] + re[h]);
+            const float ei = 0.5f * (im[k] - im[h]);
+            const float orr = 0.5f * (im[k] + im[h]);
+            const float oi = -0.5f * (re[k] - re[h]);
+            const float wr = splitRe_[k] * orr - splitIm_[k] * oi;
+            const float wi = splitRe_[k] * oi + splitIm_[k] * orr;
+            re[k] = er + wr;
+            im[k] = ei + wi;
+            re[h] = er - wr;
+            im[h] = wi - ei;
+        }
+    }
+
+    void FFT::inverse(float* re, float* im, float* out) const {
+        // Inverse split pass: Z[k] = E[k] + i O[k], with E[k] = (X[k] + conj(X[half - k])) / 2
+        // and O[k] = conj(W^k) (X[k] - conj(X[half - k])) / 2
+        const float x0 = re[0], xh = re[half_];
+        for (std::size_t k = 1; k <= half_ / 2; ++k) {
+            const std::size_t h = half_ - k;
+            const float er = 0.5f * (re[k] + re[h]);
+            const float ei = 0.5f * (im[k] - im[h]);
+            const float dr = 0.5f * (re[k] - re[h]);
+            const float di = 0.5f * (im[k] + im[h]);
+            const float orr = splitRe_[k] * dr + splitIm_[k] * di;
+            const float oi = splitRe_[k] * di - splitIm_[k] * dr;
+            re[k] = er - oi;
+            im[k] = ei + orr;
+            re[h] = er + oi;
+            im[h] = orr - ei;
+        }
+        re[0] = 0.5f * (x0 + xh);
+        im[0] = 0.5f * (x0 - xh);
+
+        for (std::size_t j = 0; j < half_; ++j) {
+            const std::size_t r = bitReverse_[j];
+            if (j < r) {
+                std::swap(re[j], re[r]);
+                std::swap(im[j], im[r]);
+            }
+        }
+        transform(re, im, true);
+
+        const float scale = 1.0f / static_cast<float>(half_);
+        for (std::size_t j = 0; j < half_; ++j) {
+            out[2 * j] = re[j] * scale;
+            out[2 * j + 1] = im[j] * scale;
+        }
+    }
+}
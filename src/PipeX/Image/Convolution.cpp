@@ -0,0 +1,310 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/Convolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+
+
+namespace PipeX {
+    namespace {
+        /**
+         * @brief Copies the pixels [x0 - radius, x0 + width + radius) of a row into a contiguous buffer,
+         * resolving the pixels outside the image with the border mode.
+         */
+        void loadPaddedRow(const FloatImage& src, const int y, const int x0, const int width, const int radius,
+                           const BorderMode border, float* padded) {
+            const float* row = src.row(y);
+            const int first = x0 - radius;
+            const int last = x0 + width + radius;
+
+            // Pixels inside the image are copied in a single block
+            const int inFirst = std::max(first, 0);
+            const int inLast = std::min(last, src.width);
+            if (inLast > inFirst) {
+                std::memcpy(padded + 3 * (inFirst - first), row + 3 * inFirst, sizeof(float) * 3 * (inLast - inFirst));
+            }
+
+            for (int x = first; x < last; ++x) {
+                if (x >= inFirst && x < inLast) {
+                    x = inLast - 1;
+                    continue;
+                }
+                float* pixel = padded + 3 * (x - first);
+                const int sx = borderIndex(x, src.width, border);
+                if (sx < 0) {
+                    pixel[0] = pixel[1] = pixel[2] = 0.0f;
+                } else {
+                    std::memcpy(pixel, row + 3 * sx, sizeof(float) * 3);
+                }
+            }
+        }
+
+        std::vector<float> toFloatVector(const std::vector<double>& values) {
+            return std::vector<float>(values.begin(), values.end());
+        }
+    }
+
+
+    int borderIndex(int i, const int size, const BorderMode border) {
+        if (i >= 0 && i < size) {
+            return i;
+        }
+
+        switch (border) {
+        case BorderMode::Clamp:
+            return i < 0 ? 0 : size - 1;
+        case BorderMode::Mirror: {
+            if (size == 1) {
+                return 0;
+            }
+            const int period = 2 * (size - 1);
+            i %= period;
+            if (i < 0) {
+                i += period;
+            }
+            return i < size ? i : period - i;
+        }
+        case BorderMode::Zero:
+        default:
+            return -1;
+        }
+    }
+
+
+    Convolution::Convolution(std::string node_name, Kernel kernel, const BorderMode border)
+        : Convolution(std::move(node_name), border) {
+        if (kernel.empty() || kernel[0].empty()) {
+            throw InvalidOperation("Convolution::Convolution", "kernel is empty");
+        }
+        for (const auto& row : kernel) {
+            if (row.size() != kernel[0].size()) {
+                throw InvalidOperation("Convolution::Convolution", "kernel rows must have the same size");
+            }
+        }
+        if (kernel.size() % 2 == 0 || kernel[0].size() % 2 == 0) {
+            throw InvalidOperation("Convolution::Convolution", "kernel dimensions must be odd");
+        }
+
+        kernel_ = std::move(kernel);
+        separable_ = factorize(kernel_, columnKernel_, rowKernel_);
+        if (!separable_) {
+            for (const auto& row : kernel_) {
+                kernel2D_.push_back(toFloatVector(row));
+            }
+        }
+
+        this->logLifeCycle("Constructor(std::string, Kernel, BorderMode)");
+    }
+
+    Convolution::Convolution(std::string node_name, const BorderMode border)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return this->applyConvolution(input);
+        }), border_(border) {
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, BorderMode)");
+    }
+
+    PPM_Image Convolution::applyConvolution(const PPM_Image& data) const {
+        if (data.empty() || data[0].empty()) {
+            return data;
+        }
+
+        const FloatImage src = toFloatImage(data);
+        FloatImage dst(src.width, src.height);
+        convolveImage(src, dst);
+        return toPPMImage(dst, maxValue_);
+    }
+
+    void Convolution::convolveImage(const FloatImage& src, FloatImage& dst) const {
+        if (separable_) {
+            convolveSeparable(src, dst, rowKernel_, columnKernel_, border_, tilingOptions());
+        } else {
+            convolve2D(src, dst, kernel2D_, border_, tilingOptions());
+        }
+    }
+
+    bool Convolution::factorize(const Kernel& kernel, std::vector<float>& column, std::vector<float>& row) {
+        // The largest coefficient is the most stable pivot: kernel = kernel[.][pc] * (kernel[pr][.] / kernel[pr][pc])
+        std::size_t pr = 0, pc = 0;
+        double maxAbs = 0.0;
+        for (std::size_t r = 0; r < kernel.size(); ++r) {
+            for (std::size_t c = 0; c < kernel[r].size(); ++c) {
+                if (std::fabs(kernel[r][c]) > maxAbs) {
+                    maxAbs = std::fabs(kernel[r][c]);
+                    pr = r;
+                    pc = c;
+                }
+            }
+        }
+        if (maxAbs == 0.0) {
+            return false;
+        }
+
+        std::vector<double> columnD(kernel.size()), rowD(kernel[0].size());
+        for (std::size_t r = 0; r < kernel.size(); ++r) {
+            columnD[r] = kernel[r][pc];
+        }
+        for (std::size_t c = 0; c < kernel[0].size(); ++c) {
+            rowD[c] = kernel[pr][c] / kernel[pr][pc];
+        }
+
+        const double tolerance = 1e-9 * maxAbs;
+        for (std::size_t r = 0; r < kernel.size(); ++r) {
+            for (std::size_t c = 0; c < kernel[r].size(); ++c) {
+                if (std::fabs(kernel[r][c] - columnD[r] * rowD[c]) > tolerance) {
+                    return false;
+                }
+            }
+        }
+
+        column = toFloatVector(columnD);
+        row = toFloatVector(rowD);
+        return true;
+    }
+
+    void Convolution::convolveSeparable(const FloatImage& src, FloatImage& dst, const std::vector<float>& rowKernel,
+                                        const std::vector<float>& columnKernel, const BorderMode border, const TilingOptions& options) {
+        const int rx = static_cast<int>(rowKernel.size() / 2);
+        const int ry = static_cast<int>(columnKernel.size() / 2);
+
+        ImageTiling::forEachTile(src.width, src.height, options, [&](const ImageTile& tile) {
+            const std::size_t n = static_cast<std::size_t>(tile.width) * 3;
+            const int rows = tile.height + 2 * ry;
+
+            std::vector<float> padded(static_cast<std::size_t>(tile.width + 2 * rx) * 3);
+            std::vector<float> horizontal(static_cast<std::size_t>(rows) * n, 0.0f);
+
+            // Horizontal pass over the tile rows and the rows above/below needed by the vertical pass
+            for (int r = 0; r < rows; ++r) {
+                const int sy = borderIndex(tile.y0 - ry + r, src.height, border);
+                if (sy < 0) {
+                    continue;
+                }
+                loadPaddedRow(src, sy, tile.x0, tile.width, rx, border, padded.data());
+
+                float* out = horizontal.data() + r * n;
+                for (std::size_t k = 0; k < rowKernel.size(); ++k) {
+                    addScaled(out, padded.data() + 3 * k, rowKernel[k], n);
+                }
+            }
+
+            // Vertical pass, straight into the tile of the output image
+            for (int y = 0; y < tile.height; ++y) {
+                float* out = dst.row(tile.y0 + y) + 3 * tile.x0;
+                std::fill(out, out + n, 0.0f);
+                for (std::size_t k = 0; k < columnKernel.size(); ++k) {
+                    addScaled(out, horizontal.data() + (y + k) * n, columnKernel[k], n);
+                }
+            }
+        });
+    }
+
+    void Convolution::convolve2D(const FloatImage& src, FloatImage& dst, const std::vector<std::vector<float>>& kernel,
+                                 const BorderMode border, const TilingOptions& options) {
+        const int rx = static_cast<int>(kernel[0].size() / 2);
+        const int ry = static_cast<int>(kernel.size() / 2);
+
+        ImageTiling::forEachTile(src.width, src.height, options, [&](const ImageTile& tile) {
+            const std::size_t n = static_cast<std::size_t>(tile.width) * 3;
+            const std::size_t paddedSize = static_cast<std::size_t>(tile.width + 2 * rx) * 3;
+            const int rows = tile.height + 2 * ry;
+
+            // Padded copy of the input rows read by the tile (rows outside a zero border stay black)
+            std::vector<float> padded(static_cast<std::size_t>(rows) * paddedSize, 0.0f);
+            for (int r = 0; r < rows; ++r) {
+                const int sy = borderIndex(tile.y0 - ry + r, src.height, border);
+                if (sy >= 0) {
+                    loadPaddedRow(src, sy, tile.x0, tile.width, rx, border, padded.data() + r * paddedSize);
+                }
+            }
+
+            for (int y = 0; y < tile.height; ++y) {
+                float* out = dst.row(tile.y0 + y) + 3 * tile.x0;
+                std::fill(out, out + n, 0.0f);
+                for (std::size_t ky = 0; ky < kernel.size(); ++ky) {
+                    const float* in = padded.data() + (y + ky) * paddedSize;
+                    for (std::size_t kx = 0; kx < kernel[ky].size(); ++kx) {
+                        if (kernel[ky][kx] != 0.0f) {
+                            addScaled(out, in + 3 * kx, kernel[ky][kx], n);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    void Convolution::boxBlur(FloatImage& image, const int radius, const BorderMode border, const std::size_t maxThreads) {
+        if (radius <= 0 || image.data.empty()) {
+            return;
+        }
+
+        const int window = 2 * radius + 1;
+        const float scale = 1.0f / static_cast<float>(window);
+        auto& pool = ThreadPool::getThreadPool();
+
+        // Horizontal pass, in place, one running sum per channel
+        pool.parallelFor(0, image.height, [&](const std::size_t y) {
+            std::vector<float> padded(static_cast<std::size_t>(image.width + window) * 3, 0.0f);
+            loadPaddedRow(image, static_cast<int>(y), 0, image.width, radius, border, padded.data());
+
+            double sum[3] = {0.0, 0.0, 0.0};
+            for (int k = 0; k < window; ++k) {
+                for (int c = 0; c < 3; ++c) {
+                    sum[c] += padded[3 * k + c];
+                }
+            }
+
+            float* row = image.row(static_cast<int>(y));
+            for (int x = 0; x < image.width; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    row[3 * x + c] = static_cast<float>(sum[c]) * scale;
+                    sum[c] += padded[3 * (x + window) + c] - padded[3 * x + c];
+                }
+            }
+        }, 16, maxThreads);
+
+        // Vertical pass, out of place, on strips of columns: each strip slides a row of running sums down the image
+        constexpr std::size_t stripSize = 3 * 64;
+        const std::size_t stride = image.stride();
+        const std::size_t nStrips = (stride + stripSize - 1) / stripSize;
+        FloatImage result(image.width, image.height);
+
+        pool.parallelFor(0, nStrips, [&](const std::size_t strip) {
+            const std::size_t i0 = strip * stripSize;
+            const std::size_t n = std::min(stripSize, stride - i0);
+            std::vector<float> sum(n, 0.0f);
+
+            for (int k = -radius; k <= radius; ++k) {
+                const int sy = borderIndex(k, image.height, border);
+                if (sy >= 0) {
+                    addScaled(sum.data(), image.row(sy) + i0, 1.0f, n);
+                }
+            }
+
+            for (int y = 0; y < image.height; ++y) {
+                float* out = result.row(y) + i0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = sum[i] * scale;
+                }
+
+                const int entering = borderIndex(y + radius + 1, image.height, border);
+                const int leaving = borderIndex(y - radius, image.height, border);
+                if (entering >= 0) {
+                    addScaled(sum.data(), image.row(entering) + i0, 1.0f, n);
+                }
+                if (leaving >= 0) {
+                    addScaled(sum.data(), image.row(leaving) + i0, -1.0f, n);
+                }
+            }
+        }, 1, maxThreads);
+
+        image.data.swap(result.data);
+    }
+}
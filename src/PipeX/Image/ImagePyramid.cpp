@@ -0,0 +1,202 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/ImagePyramid.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+
+namespace PipeX {
+    namespace {
+        constexpr std::size_t rowsPerTask = 16;
+
+        constexpr int gaussianTaps = 5;
+        constexpr float gaussianWeights[gaussianTaps] = {0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f};
+
+        int clampIndex(const int i, const int size) {
+            return i < 0 ? 0 : (i >= size ? size - 1 : i);
+        }
+
+        /**
+         * @brief Horizontal [1 4 6 4 1] / 16 filter of a row, evaluated only at the even pixels kept by the decimation.
+         */
+        void gaussianDecimateRow(const float* in, const int sourceWidth, float* out, const int width) {
+            for (int x = 0; x < width; ++x) {
+                const int center = 2 * x;
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+                if (center >= 2 && center + 2 < sourceWidth) {
+                    const float* pixel = in + 3 * (center - 2);
+                    for (int k = 0; k < gaussianTaps; ++k, pixel += 3) {
+                        r += gaussianWeights[k] * pixel[0];
+                        g += gaussianWeights[k] * pixel[1];
+                        b += gaussianWeights[k] * pixel[2];
+                    }
+                } else {
+                    for (int k = 0; k < gaussianTaps; ++k) {
+                        const float* pixel = in + 3 * clampIndex(center + k - 2, sourceWidth);
+                        r += gaussianWeights[k] * pixel[0];
+                        g += gaussianWeights[k] * pixel[1];
+                        b += gaussianWeights[k] * pixel[2];
+                    }
+                }
+                out[3 * x] = r;
+                out[3 * x + 1] = g;
+                out[3 * x + 2] = b;
+            }
+        }
+
+        /**
+         * @brief Average of the pairs of pixels (2x, 2x + 1) of a row (the last pixel of an odd row is repeated).
+         */
+        void boxDecimateRow(const float* in, const int sourceWidth, float* out, const int width) {
+            for (int x = 0; x < width; ++x) {
+                const float* p0 = in + 3 * (2 * x);
+                const float* p1 = in + 3 * std::min(2 * x + 1, sourceWidth - 1);
+                out[3 * x] = 0.5f * (p0[0] + p1[0]);
+                out[3 * x + 1] = 0.5f * (p0[1] + p1[1]);
+                out[3 * x + 2] = 0.5f * (p0[2] + p1[2]);
+            }
+        }
+    }
+
+
+    int ImagePyramid::levelSize(int size, const int level) {
+        for (int l = 0; l < level; ++l) {
+            size = (size + 1) / 2;
+        }
+        return size;
+    }
+
+    int ImagePyramid::levelCount(int width, int height, const int maxLevels) {
+        if (width <= 0 || height <= 0) {
+            return 0;
+        }
+        int count = 1;
+        while (std::min(width, height) > 1 && (maxLevels <= 0 || count < maxLevels)) {
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+            ++count;
+        }
+        return count;
+    }
+
+    ImagePyramid ImagePyramid::build(const PPM_Image& image, const int maxLevels, const PyramidFilter filter, const std::size_t maxThreads) {
+        ImagePyramid pyramid;
+        const int width = image.empty() ? 0 : static_cast<int>(image[0].size());
+        const int height = static_cast<int>(image.size());
+        const int count = levelCount(width, height, maxLevels);
+        if (count == 0) {
+            return pyramid;
+        }
+
+        // Layout of all the levels, then a single allocation for the whole pyramid
+        std::size_t size = 0;
+        for (int level = 0; level < count; ++level) {
+            const Level info = {levelSize(width, level), levelSize(height, level), size};
+            pyramid.levels_.push_back(info);
+            size += static_cast<std::size_t>(info.width) * info.height * 3;
+        }
+        pyramid.data_.resize(size);
+
+        auto& pool = ThreadPool::getThreadPool();
+        pool.parallelFor(0, height, [&](const std::size_t y) {
+            channelsToFloat(image[y].data()->data(), pyramid.row(0, static_cast<int>(y)), pyramid.stride(0));
+        }, rowsPerTask, maxThreads);
+
+        for (int level = 1; level < count; ++level) {
+            pyramid.reduce(level, filter, maxThreads);
+        }
+        return pyramid;
+    }
+
+    void ImagePyramid::reduce(const int level, const PyramidFilter filter, const std::size_t maxThreads) {
+        const int sourceWidth = width(level - 1);
+        const int sourceHeight = height(level - 1);
+        const std::size_t n = stride(level - 1);
+        const std::size_t nChunks = (height(level) + rowsPerTask - 1) / rowsPerTask;
+
+        ThreadPool::getThreadPool().parallelFor(0, nChunks, [&](const std::size_t chunk) {
+            std::vector<float> vertical(n);
+            const int y0 = static_cast<int>(chunk * rowsPerTask);
+            const int y1 = std::min(y0 + static_cast<int>(rowsPerTask), height(level));
+
+            for (int y = y0; y < y1; ++y) {
+                // Vertical filter of the source rows around 2y (SIMD), then horizontal filter and decimation
+                std::fill(vertical.begin(), vertical.end(), 0.0f);
+                if (filter == PyramidFilter::Gaussian) {
+                    for (int k = 0; k < gaussianTaps; ++k) {
+                        addScaled(vertical.data(), row(level - 1, clampIndex(2 * y + k - 2, sourceHeight)), gaussianWeights[k], n);
+                    }
+                    gaussianDecimateRow(vertical.data(), sourceWidth, row(level, y), width(level));
+                } else {
+                    addScaled(vertical.data(), row(level - 1, 2 * y), 0.5f, n);
+                    addScaled(vertical.data(), row(level - 1, std::min(2 * y + 1, sourceHeight - 1)), 0.5f, n);
+                    boxDecimateRow(vertical.data(), sourceWidth, row(level, y), width(level));
+                }
+            }
+        }, 1, maxThreads);
+    }
+
+    PPM_Image ImagePyramid::levelImage(const int level, const int max_value) const {
+        PPM_Image result(height(level), std::vector<channelsT>(width(level)));
+        for (int y = 0; y < height(level); ++y) {
+            floatToChannels(row(level, y), result[y].data()->data(), stride(level), max_value);
+        }
+        return result;
+    }
+
+    FloatImage ImagePyramid::levelFloatImage(const int level) const {
+        FloatImage result(width(level), height(level));
+        std::memcpy(result.data.data(), row(level, 0), sizeof(float) * result.data.size());
+        return result;
+    }
+
+
+    PyramidBuilder::PyramidBuilder(std::string node_name, const int maxLevels, const PyramidFilter filter)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return ImagePyramid::build(input, maxLevels_, filter_);
+        }), maxLevels_(maxLevels), filter_(filter) {
+        if (maxLevels_ < 0) {
+            throw InvalidOperation("PyramidBuilder::PyramidBuilder", "maxLevels must be non-negative");
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, int, PyramidFilter)");
+    }
+
+
+    PyramidLevel::PyramidLevel(std::string node_name, const int level)
+        : Transformer(std::move(node_name), [this] (ImagePyramid& input) {
+            return this->pick(input);
+        }), level_(level) {
+        if (level_ < 0) {
+            throw InvalidOperation("PyramidLevel::PyramidLevel", "level must be non-negative");
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, int)");
+    }
+
+    void PyramidLevel::preProcessHook() const {
+        maxValue_ = this->getMetadata()->bit_depth;
+    }
+
+    void PyramidLevel::postProcessHook() const {
+        // The input metadata may be shared with upstream nodes: the output gets its own copy
+        auto metadata = std::make_shared<PPM_Metadata>(*this->getMetadata());
+        metadata->width = ImagePyramid::levelSize(metadata->width, level_);
+        metadata->height = ImagePyramid::levelSize(metadata->height, level_);
+        this->outputData->metadata = std::move(metadata);
+    }
+
+    PPM_Image PyramidLevel::pick(const ImagePyramid& pyramid) const {
+        if (level_ >= pyramid.levels()) {
+            throw InvalidOperation("PyramidLevel::pick", "the pyramid has only " + std::to_string(pyramid.levels()) + " levels");
+        }
+        return pyramid.levelImage(level_, maxValue_);
+    }
+}
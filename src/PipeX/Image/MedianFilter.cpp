@@ -0,0 +1,192 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/MedianFilter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+
+
+namespace PipeX {
+    namespace {
+        // Two-level histogram of one channel: 256 fine bins followed by 16 coarse bins (one per 16 fine bins)
+        constexpr int fineBins = 256;
+        constexpr int coarseBins = 16;
+        constexpr int coarseShift = 4;
+        constexpr int channelBins = fineBins + coarseBins;
+        constexpr std::size_t histogramSize = 3 * channelBins;
+
+        static_assert(histogramSize % 16 == 0, "histograms must be a whole number of SIMD registers");
+
+        /**
+         * @brief acc[i] += add[i] - sub[i] for the histogramSize bins of a pixel, with 16-bit wrap-around (sub may be null).
+         */
+        void slideHistogram(std::uint16_t* acc, const std::uint16_t* add, const std::uint16_t* sub) {
+#if defined(PIPEX_SIMD_AVX2)
+            for (std::size_t i = 0; i < histogramSize; i += 16) {
+                __m256i v = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add + i)));
+                if (sub) {
+                    v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub + i)));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), v);
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            for (std::size_t i = 0; i < histogramSize; i += 8) {
+                __m128i v = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(add + i)));
+                if (sub) {
+                    v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub + i)));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), v);
+            }
+#else
+            for (std::size_t i = 0; i < histogramSize; ++i) {
+                acc[i] = static_cast<std::uint16_t>(acc[i] + add[i] - (sub ? sub[i] : 0));
+            }
+#endif
+        }
+
+        /**
+         * @brief Value of rank target (1-based) of a two-level channel histogram.
+         */
+        int histogramRank(const std::uint16_t* histogram, int target) {
+            const std::uint16_t* coarse = histogram + fineBins;
+            int bucket = 0;
+            while (bucket < coarseBins - 1 && coarse[bucket] < target) {
+                target -= coarse[bucket++];
+            }
+
+            int value = bucket << coarseShift;
+            const int last = value + (1 << coarseShift) - 1;
+            while (value < last && histogram[value] < target) {
+                target -= histogram[value++];
+            }
+            return value;
+        }
+
+        /**
+         * @brief Constant-time median of one tile (channels in [0, 255]).
+         */
+        void medianTileHistogram(const PPM_Image& src, PPM_Image& dst, const ImageTile& tile, const int radius, const BorderMode border) {
+            const int width = static_cast<int>(src[0].size());
+            const int height = static_cast<int>(src.size());
+            const int window = 2 * radius + 1;
+            const int columns = tile.width + 2 * radius;
+            const int target = (window * window + 1) / 2;
+            static const int zero[3] = {0, 0, 0};
+
+            std::vector<int> columnX(columns);
+            for (int i = 0; i < columns; ++i) {
+                columnX[i] = borderIndex(tile.x0 - radius + i, width, border);
+            }
+
+            // One histogram per window column, covering the rows [y - radius, y + radius]
+            std::vector<std::uint16_t> columnHistograms(static_cast<std::size_t>(columns) * histogramSize, 0);
+            std::vector<std::uint16_t> kernel(histogramSize);
+
+            const auto update = [&](const int column, const int y, const std::uint16_t delta) {
+                const int sx = columnX[column];
+                const int sy = borderIndex(y, height, border);
+                const int* pixel = sx < 0 || sy < 0 ? zero : src[sy][sx].data();
+                std::uint16_t* histogram = columnHistograms.data() + column * histogramSize;
+                for (int c = 0; c < 3; ++c, histogram += channelBins) {
+                    const int v = pixel[c] < 0 ? 0 : (pixel[c] > fineBins - 1 ? fineBins - 1 : pixel[c]);
+                    histogram[v] = static_cast<std::uint16_t>(histogram[v] + delta);
+                    histogram[fineBins + (v >> coarseShift)] = static_cast<std::uint16_t>(histogram[fineBins + (v >> coarseShift)] + delta);
+                }
+            };
+            const auto column = [&](const int i) { return columnHistograms.data() + i * histogramSize; };
+
+            for (int i = 0; i < columns; ++i) {
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    update(i, tile.y0 + dy, 1);
+                }
+            }
+
+            for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                if (y > tile.y0) {
+                    for (int i = 0; i < columns; ++i) {
+                        update(i, y - 1 - radius, static_cast<std::uint16_t>(0xffff));
+                        update(i, y + radius, 1);
+                    }
+                }
+
+                std::fill(kernel.begin(), kernel.end(), 0);
+                for (int i = 0; i < window; ++i) {
+                    slideHistogram(kernel.data(), column(i), nullptr);
+                }
+
+                int* out = dst[y][tile.x0].data();
+                for (int x = 0; x < tile.width; ++x, out += 3) {
+                    if (x > 0) {
+                        slideHistogram(kernel.data(), column(x + window - 1), column(x - 1));
+                    }
+                    for (int c = 0; c < 3; ++c) {
+                        out[c] = histogramRank(kernel.data() + c * channelBins, target);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Median of one tile by selection over the window of every pixel (any channel depth).
+         */
+        void medianTileSelect(const PPM_Image& src, PPM_Image& dst, const ImageTile& tile, const int radius, const BorderMode border) {
+            const int width = static_cast<int>(src[0].size());
+            const int height = static_cast<int>(src.size());
+            const int window = 2 * radius + 1;
+            const std::size_t middle = static_cast<std::size_t>(window * window) / 2;
+            std::vector<int> values(static_cast<std::size_t>(window) * window);
+
+            for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                for (int x = tile.x0; x < tile.x0 + tile.width; ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        std::size_t n = 0;
+                        for (int dy = -radius; dy <= radius; ++dy) {
+                            const int sy = borderIndex(y + dy, height, border);
+                            for (int dx = -radius; dx <= radius; ++dx) {
+                                const int sx = borderIndex(x + dx, width, border);
+                                values[n++] = sx < 0 || sy < 0 ? 0 : src[sy][sx][c];
+                            }
+                        }
+                        std::nth_element(values.begin(), values.begin() + middle, values.end());
+                        dst[y][x][c] = values[middle];
+                    }
+                }
+            }
+        }
+    }
+
+
+    MedianFilter::MedianFilter(std::string node_name, const int radius, const BorderMode border)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return median(input, radius_, maxValue_, border_, hasTilingOptions_ ? tilingOptions_ : ImageTiling::defaultOptions());
+        }), radius_(radius), border_(border) {
+        if (radius_ < 0 || radius_ > maxRadius) {
+            throw InvalidOperation("MedianFilter::MedianFilter", "radius must be in [0, " + std::to_string(maxRadius) + "]");
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, int, BorderMode)");
+    }
+
+    PPM_Image MedianFilter::median(const PPM_Image& image, const int radius, const int max_value, const BorderMode border, const TilingOptions& options) {
+        if (radius == 0 || image.empty() || image[0].empty()) {
+            return image;
+        }
+
+        PPM_Image result(image.size(), std::vector<channelsT>(image[0].size()));
+        const bool histogram = max_value < fineBins;
+        ImageTiling::forEachTile(static_cast<int>(image[0].size()), static_cast<int>(image.size()), options, [&](const ImageTile& tile) {
+            if (histogram) {
+                medianTileHistogram(image, result, tile, radius, border);
+            } else {
+                medianTileSelect(image, result, tile, radius, border);
+            }
+        });
+        return result;
+    }
+}
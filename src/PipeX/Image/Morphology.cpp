@@ -0,0 +1,187 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/Morphology.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+
+namespace PipeX {
+    namespace {
+        /**
+         * @brief out[i] = max(a[i], b[i]) (or min) for i in [0, n); out may alias a or b.
+         */
+        void extremum(int* out, const int* a, const int* b, const std::size_t n, const bool maximum) {
+            std::size_t i = 0;
+
+#if defined(PIPEX_SIMD_AVX2)
+            for (; i + 8 <= n; i += 8) {
+                const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), maximum ? _mm256_max_epi32(va, vb) : _mm256_min_epi32(va, vb));
+            }
+#elif defined(PIPEX_SIMD_SSE2)
+            // SSE2 has no 32-bit min/max: select through a comparison mask
+            for (; i + 4 <= n; i += 4) {
+                const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                const __m128i takeA = maximum ? _mm_cmpgt_epi32(va, vb) : _mm_cmplt_epi32(va, vb);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(_mm_and_si128(takeA, va), _mm_andnot_si128(takeA, vb)));
+            }
+#endif
+
+            for (; i < n; ++i) {
+                out[i] = maximum ? std::max(a[i], b[i]) : std::min(a[i], b[i]);
+            }
+        }
+
+        /**
+         * @brief van Herk/Gil-Werman extremum of a row over windows of 2 * radius + 1 pixels.
+         */
+        void filterRow(int* row, const int width, const int radius, const bool maximum, const BorderMode border,
+                       std::vector<int>& padded, std::vector<int>& prefix, std::vector<int>& suffix) {
+            const int window = 2 * radius + 1;
+            const int length = width + 2 * radius;
+
+            for (int i = 0; i < length; ++i) {
+                const int sx = borderIndex(i - radius, width, border);
+                if (sx < 0) {
+                    padded[3 * i] = padded[3 * i + 1] = padded[3 * i + 2] = 0;
+                } else {
+                    std::memcpy(&padded[3 * i], row + 3 * sx, sizeof(int) * 3);
+                }
+            }
+
+            // prefix[i]: extremum from the start of the block of i to i; suffix[i]: from i to the end of its block
+            for (int i = 0; i < length; ++i) {
+                if (i % window == 0) {
+                    std::memcpy(&prefix[3 * i], &padded[3 * i], sizeof(int) * 3);
+                } else {
+                    extremum(&prefix[3 * i], &prefix[3 * (i - 1)], &padded[3 * i], 3, maximum);
+                }
+            }
+            for (int i = length - 1; i >= 0; --i) {
+                if (i == length - 1 || (i + 1) % window == 0) {
+                    std::memcpy(&suffix[3 * i], &padded[3 * i], sizeof(int) * 3);
+                } else {
+                    extremum(&suffix[3 * i], &suffix[3 * (i + 1)], &padded[3 * i], 3, maximum);
+                }
+            }
+
+            // The window [x, x + 2 * radius] of the padded row spans at most two blocks
+            extremum(row, suffix.data(), prefix.data() + 3 * (window - 1), static_cast<std::size_t>(width) * 3, maximum);
+        }
+    }
+
+
+    Morphology::Morphology(std::string node_name, const MorphologyOperation operation, const int radius, const BorderMode border)
+        : Morphology(std::move(node_name), operation, radius, radius, border) {}
+
+    Morphology::Morphology(std::string node_name, const MorphologyOperation operation, const int radiusX, const int radiusY, const BorderMode border)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return this->apply(input);
+        }), operation_(operation), radiusX_(radiusX), radiusY_(radiusY), border_(border) {
+        if (radiusX_ < 0 || radiusY_ < 0) {
+            throw InvalidOperation("Morphology::Morphology", "radius must be non-negative");
+        }
+        this->setBatchParallelism(0);
+        this->logLifeCycle("Constructor(std::string, MorphologyOperation, int, int, BorderMode)");
+    }
+
+    PPM_Image Morphology::apply(PPM_Image& image) const {
+        const std::size_t maxThreads = (hasTilingOptions_ ? tilingOptions_ : ImageTiling::defaultOptions()).maxThreads;
+
+        switch (operation_) {
+        case MorphologyOperation::Erode:
+            minMaxFilter(image, radiusX_, radiusY_, false, border_, maxThreads);
+            break;
+        case MorphologyOperation::Dilate:
+            minMaxFilter(image, radiusX_, radiusY_, true, border_, maxThreads);
+            break;
+        case MorphologyOperation::Open:
+            minMaxFilter(image, radiusX_, radiusY_, false, border_, maxThreads);
+            minMaxFilter(image, radiusX_, radiusY_, true, border_, maxThreads);
+            break;
+        case MorphologyOperation::Close:
+            minMaxFilter(image, radiusX_, radiusY_, true, border_, maxThreads);
+            minMaxFilter(image, radiusX_, radiusY_, false, border_, maxThreads);
+            break;
+        }
+        return std::move(image);
+    }
+
+    void Morphology::minMaxFilter(PPM_Image& image, const int radiusX, const int radiusY, const bool maximum, const BorderMode border, const std::size_t maxThreads) {
+        if (image.empty() || image[0].empty()) {
+            return;
+        }
+
+        const int width = static_cast<int>(image[0].size());
+        const int height = static_cast<int>(image.size());
+        auto& pool = ThreadPool::getThreadPool();
+
+        // Horizontal pass, in place, row by row
+        if (radiusX > 0) {
+            constexpr std::size_t rowsPerTask = 16;
+            const std::size_t length = static_cast<std::size_t>(width + 2 * radiusX) * 3;
+            const std::size_t nChunks = (height + rowsPerTask - 1) / rowsPerTask;
+
+            pool.parallelFor(0, nChunks, [&](const std::size_t chunk) {
+                std::vector<int> padded(length), prefix(length), suffix(length);
+                const std::size_t y1 = std::min((chunk + 1) * rowsPerTask, static_cast<std::size_t>(height));
+                for (std::size_t y = chunk * rowsPerTask; y < y1; ++y) {
+                    filterRow(image[y].data()->data(), width, radiusX, maximum, border, padded, prefix, suffix);
+                }
+            }, 1, maxThreads);
+        }
+
+        // Vertical pass on strips of columns: the prefix/suffix extrema are computed on whole strip rows (SIMD)
+        if (radiusY > 0) {
+            constexpr std::size_t stripSize = 3 * 32;
+            const int window = 2 * radiusY + 1;
+            const int length = height + 2 * radiusY;
+            const std::size_t stride = static_cast<std::size_t>(width) * 3;
+            const std::size_t nStrips = (stride + stripSize - 1) / stripSize;
+            const std::vector<int> zero(stripSize, 0);
+
+            pool.parallelFor(0, nStrips, [&](const std::size_t strip) {
+                const std::size_t i0 = strip * stripSize;
+                const std::size_t n = std::min(stripSize, stride - i0);
+                std::vector<int> prefix(static_cast<std::size_t>(length) * n), suffix(static_cast<std::size_t>(length) * n);
+
+                const auto padded = [&](const int i) -> const int* {
+                    const int sy = borderIndex(i - radiusY, height, border);
+                    return sy < 0 ? zero.data() : image[sy].data()->data() + i0;
+                };
+
+                for (int i = 0; i < length; ++i) {
+                    int* out = prefix.data() + i * n;
+                    if (i % window == 0) {
+                        std::memcpy(out, padded(i), sizeof(int) * n);
+                    } else {
+                        extremum(out, out - n, padded(i), n, maximum);
+                    }
+                }
+                for (int i = length - 1; i >= 0; --i) {
+                    int* out = suffix.data() + i * n;
+                    if (i == length - 1 || (i + 1) % window == 0) {
+                        std::memcpy(out, padded(i), sizeof(int) * n);
+                    } else {
+                        extremum(out, out + n, padded(i), n, maximum);
+                    }
+                }
+
+                // Every input row of the strip has been read: the result can be written in place
+                for (int y = 0; y < height; ++y) {
+                    extremum(image[y].data()->data() + i0, suffix.data() + y * n, prefix.data() + (y + window - 1) * n, n, maximum);
+                }
+            }, 1, maxThreads);
+        }
+    }
+}
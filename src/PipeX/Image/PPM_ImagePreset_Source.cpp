@@ -3,41 +3,180 @@
 //
 
 #include "PipeX/nodes/Image/PPM_ImagePreset_Source.h"
+
+#include <algorithm>
+#include <cstdint>
+
 #include "PipeX/errors/PipeXException.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
 
 
 namespace PipeX {
-    PPM_Image PPM_ImagePreset_Source::gradientImage(const int width, const int height) const {
-        PPM_Image image;
-        image.resize(height);
-        for (auto& column : image) {
-            column.reserve(width);
+    // Out-of-line definitions of the preset IDs (needed when they are bound to references, e.g. by Pipeline::addNode)
+    constexpr int PPM_ImagePreset_Source::GRADIENT;
+    constexpr int PPM_ImagePreset_Source::CHECKERBOARD;
+    constexpr int PPM_ImagePreset_Source::COLOR_CHECK;
+    constexpr int PPM_ImagePreset_Source::NOISE;
+
+    namespace {
+        constexpr std::size_t rowsPerTask = 16;
+
+        /**
+         * @brief Builds an image whose rows are copies of template rows: row j is templates[rowTemplate(j)].
+         *
+         * Rows are allocated and filled in parallel (first touch by the filling thread).
+         */
+        template <typename RowTemplate>
+        PPM_Image fillFromTemplates(const int height, const std::vector<std::vector<channelsT>>& templates, const RowTemplate& rowTemplate) {
+            PPM_Image image(height);
+            ThreadPool::getThreadPool().parallelFor(0, height, [&](const std::size_t j) {
+                image[j] = templates[rowTemplate(static_cast<int>(j))];
+            }, rowsPerTask);
+            return image;
+        }
+
+        std::uint64_t splitmix64(std::uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
         }
-        for (int j = 0; j < height; j++) {
-            for (int i = 0; i < width; i++) {
-                const auto r = static_cast<double>(i) / (width-1);
-                const auto g = static_cast<double>(j) / (height-1);
-                constexpr auto b = 0.0;
 
-                const int ir = static_cast<int>(255.999 * r);
-                const int ig = static_cast<int>(255.999 * g);
-                constexpr int ib = static_cast<int>(255.999 * b);
+        /**
+         * @brief Fills count channels with uniform values in [0, 255] from 4 interleaved xorshift32 generators.
+         *
+         * The SIMD and scalar paths produce the same sequence.
+         */
+        void fillNoise(int* channels, const std::size_t count, std::uint32_t state[4]) {
+            std::size_t i = 0;
+
+#ifdef PIPEX_SIMD_SSE2
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+            for (; i + 4 <= count; i += 4) {
+                x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+                x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+                x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(channels + i), _mm_srli_epi32(x, 24));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(state), x);
+#endif
 
-                image[j].emplace_back(channelsT{ir, ig, ib});
+            for (; i < count; i += 4) {
+                for (std::size_t lane = 0; lane < 4; ++lane) {
+                    std::uint32_t& x = state[lane];
+                    x ^= x << 13;
+                    x ^= x >> 17;
+                    x ^= x << 5;
+                    if (i + lane < count) {
+                        channels[i + lane] = static_cast<int>(x >> 24);
+                    }
+                }
             }
         }
 
+        // sRGB values of the 24 patches of a colour checker chart, row by row
+        const channelsT colorCheckerPatches[24] = {
+            {115, 82, 68},   {194, 150, 130}, {98, 122, 157},  {87, 108, 67},   {133, 128, 177}, {103, 189, 170},
+            {214, 126, 44},  {80, 91, 166},   {193, 90, 99},   {94, 60, 108},   {157, 188, 64},  {224, 163, 46},
+            {56, 61, 150},   {70, 148, 73},   {175, 54, 60},   {231, 199, 31},  {187, 86, 149},  {8, 133, 161},
+            {243, 243, 242}, {200, 200, 200}, {160, 160, 160}, {122, 122, 121}, {85, 85, 85},    {52, 52, 52}
+        };
+    }
+
+
+    PPM_Image PPM_ImagePreset_Source::gradientImage(const int width, const int height) const {
+        // Red only depends on the column: computed once for all the rows
+        std::vector<int> red(width);
+        for (int i = 0; i < width; i++) {
+            const auto r = static_cast<double>(i) / (width-1);
+            red[i] = static_cast<int>(255.999 * r);
+        }
+
+        PPM_Image image(height);
+
+        // Rows are independent: they are allocated and filled in parallel on the shared thread pool
+        ThreadPool::getThreadPool().parallelFor(0, height, [&image, &red, width, height](const std::size_t j) {
+            const auto g = static_cast<double>(j) / (height-1);
+            const int ig = static_cast<int>(255.999 * g);
+            constexpr auto b = 0.0;
+            constexpr int ib = static_cast<int>(255.999 * b);
+
+            auto& row = image[j];
+            row.resize(width);
+            for (int i = 0; i < width; i++) {
+                row[i] = channelsT{red[i], ig, ib};
+            }
+        }, rowsPerTask);
+
         return image;
     }
 
     PPM_Image PPM_ImagePreset_Source::checkerboardImage(const int width, const int height) const {
-        throw PipeXException("PPM_ImagePreset_Source::checkerboardImage NOT IMPLEMENTED");
-        return {};
+        constexpr int squaresPerSide = 8;
+        const int square = std::max(1, std::min(width, height) / squaresPerSide);
+
+        // Only two different rows: starting with a white or with a black square
+        std::vector<std::vector<channelsT>> templates(2, std::vector<channelsT>(width));
+        for (int i = 0; i < width; i++) {
+            const bool white = (i / square) % 2 == 0;
+            templates[0][i] = white ? channelsT{255, 255, 255} : channelsT{0, 0, 0};
+            templates[1][i] = white ? channelsT{0, 0, 0} : channelsT{255, 255, 255};
+        }
+
+        return fillFromTemplates(height, templates, [square](const int j) {
+            return (j / square) % 2;
+        });
     }
 
     PPM_Image PPM_ImagePreset_Source::colorCheckImage(const int width, const int height) const {
-        throw PipeXException("PPM_ImagePreset_Source::colorCheckImage NOT IMPLEMENTED");
-        return {};
+        constexpr int columns = 6;
+        constexpr int rows = 4;
+        const int gap = std::max(1, std::min(width / columns, height / rows) / 10); // Black border around each patch
+
+        // Position of coordinate i in a grid of n cells over size pixels: cell index, or -1 inside the border
+        const auto cellOf = [gap](const int i, const int size, const int n) {
+            const int cell = static_cast<int>(static_cast<long long>(i) * n / size);
+            const int begin = static_cast<int>(static_cast<long long>(cell) * size / n);
+            const int end = static_cast<int>(static_cast<long long>(cell + 1) * size / n);
+            return (i - begin < gap / 2 || end - i <= gap - gap / 2) ? -1 : cell;
+        };
+
+        // One template per row of patches, plus a black one for the borders
+        std::vector<std::vector<channelsT>> templates(rows + 1, std::vector<channelsT>(width, channelsT{0, 0, 0}));
+        for (int r = 0; r < rows; r++) {
+            for (int i = 0; i < width; i++) {
+                const int column = cellOf(i, width, columns);
+                if (column >= 0) {
+                    templates[r][i] = colorCheckerPatches[r * columns + column];
+                }
+            }
+        }
+
+        return fillFromTemplates(height, templates, [&cellOf, height](const int j) {
+            const int row = cellOf(j, height, rows);
+            return row >= 0 ? row : rows;
+        });
+    }
+
+    PPM_Image PPM_ImagePreset_Source::noiseImage(const int width, const int height, const std::size_t seed) const {
+        PPM_Image image(height);
+
+        // Every row has its own generators, seeded from (seed, row): the content does not depend on the threads
+        ThreadPool::getThreadPool().parallelFor(0, height, [&image, width, height, seed](const std::size_t j) {
+            std::uint32_t state[4];
+            std::uint64_t key = splitmix64(static_cast<std::uint64_t>(seed) * static_cast<std::uint64_t>(height) + j);
+            for (auto& lane : state) {
+                key = splitmix64(key);
+                lane = static_cast<std::uint32_t>(key) | 1u; // xorshift state must not be zero
+            }
+
+            auto& row = image[j];
+            row.resize(width);
+            fillNoise(row.data()->data(), static_cast<std::size_t>(width) * 3, state);
+        }, rowsPerTask);
+
+        return image;
     }
 
     PPM_Image PPM_ImagePreset_Source::loadImageFile(const int sample) const {
@@ -0,0 +1,224 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/Resize.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/simd_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+
+namespace PipeX {
+    namespace {
+        /**
+         * @brief Resamples one source row horizontally into 3 * columns.first.size() - 3 float channels.
+         */
+        void resampleRow(const std::vector<channelsT>& source, const ResampleTable& columns, float* out) {
+            const int* src = source.data()->data();
+            const int width = static_cast<int>(columns.first.size()) - 1;
+
+            for (int x = 0; x < width; ++x) {
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+                for (int t = columns.first[x]; t < columns.first[x + 1]; ++t) {
+                    const float w = columns.weight[t];
+                    const int* pixel = src + 3 * columns.index[t];
+                    r += w * static_cast<float>(pixel[0]);
+                    g += w * static_cast<float>(pixel[1]);
+                    b += w * static_cast<float>(pixel[2]);
+                }
+                out[3 * x] = r;
+                out[3 * x + 1] = g;
+                out[3 * x + 2] = b;
+            }
+        }
+
+        int scaledSize(const int size, const double scale) {
+            return std::max(1, static_cast<int>(std::lround(size * scale)));
+        }
+    }
+
+
+    ResampleTable ResampleTable::build(const int sourceSize, const int targetSize, const ResizeFilter filter) {
+        ResampleTable table;
+        table.first.reserve(targetSize + 1);
+        const double scale = static_cast<double>(sourceSize) / targetSize;
+
+        const auto addTap = [&table](const int index, const double weight) {
+            table.index.push_back(index);
+            table.weight.push_back(static_cast<float>(weight));
+        };
+
+        for (int i = 0; i < targetSize; ++i) {
+            table.first.push_back(static_cast<int>(table.index.size()));
+
+            switch (filter) {
+            case ResizeFilter::Nearest:
+                addTap(std::min(static_cast<int>((i + 0.5) * scale), sourceSize - 1), 1.0);
+                break;
+
+            case ResizeFilter::Bilinear: {
+                const double position = std::max((i + 0.5) * scale - 0.5, 0.0);
+                const int i0 = static_cast<int>(position);
+                if (i0 >= sourceSize - 1) {
+                    addTap(sourceSize - 1, 1.0);
+                } else {
+                    const double w = position - i0;
+                    addTap(i0, 1.0 - w);
+                    if (w > 0.0) {
+                        addTap(i0 + 1, w);
+                    }
+                }
+                break;
+            }
+
+            case ResizeFilter::Area: {
+                // Output pixel i covers [start, end) in source coordinates
+                const double start = i * scale;
+                const double end = std::min((i + 1) * scale, static_cast<double>(sourceSize));
+                for (int s = static_cast<int>(start); s < end; ++s) {
+                    const double overlap = std::min(end, s + 1.0) - std::max(start, static_cast<double>(s));
+                    if (overlap > 1e-9) {
+                        addTap(s, overlap / (end - start));
+                    }
+                }
+                break;
+            }
+            }
+        }
+
+        table.first.push_back(static_cast<int>(table.index.size()));
+        return table;
+    }
+
+
+    Resize::Resize(std::string node_name, const int width, const int height, const ResizeFilter filter)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return this->resize(input);
+        }), width_(width), height_(height), scale_(0.0), filter_(filter) {
+        this->setBatchParallelism(0);
+        if (width_ <= 0 || height_ <= 0) {
+            throw InvalidOperation("Resize::Resize", "target width and height must be positive");
+        }
+        this->logLifeCycle("Constructor(std::string, int, int, ResizeFilter)");
+    }
+
+    Resize::Resize(std::string node_name, const double scale, const ResizeFilter filter)
+        : Transformer(std::move(node_name), [this] (PPM_Image& input) {
+            return this->resize(input);
+        }), width_(0), height_(0), scale_(scale), filter_(filter) {
+        this->setBatchParallelism(0);
+        if (!(scale_ > 0.0)) {
+            throw InvalidOperation("Resize::Resize", "scale must be positive");
+        }
+        this->logLifeCycle("Constructor(std::string, double, ResizeFilter)");
+    }
+
+    void Resize::preProcessHook() const {
+        const auto& metadata = this->getMetadata();
+        maxValue_ = metadata->bit_depth;
+        outputWidth_ = scale_ > 0.0 ? scaledSize(metadata->width, scale_) : width_;
+        outputHeight_ = scale_ > 0.0 ? scaledSize(metadata->height, scale_) : height_;
+        updateTables(metadata->width, metadata->height);
+    }
+
+    void Resize::postProcessHook() const {
+        // The input metadata may be shared with upstream nodes: the output gets its own copy
+        auto metadata = std::make_shared<PPM_Metadata>(*this->getMetadata());
+        metadata->width = outputWidth_;
+        metadata->height = outputHeight_;
+        this->outputData->metadata = std::move(metadata);
+    }
+
+    void Resize::updateTables(const int sourceWidth, const int sourceHeight) const {
+        if (sourceWidth <= 0 || sourceHeight <= 0) {
+            return;
+        }
+        if (sourceWidth == sourceWidth_ && sourceHeight == sourceHeight_
+            && static_cast<int>(columns_.first.size()) == outputWidth_ + 1 && static_cast<int>(rows_.first.size()) == outputHeight_ + 1) {
+            return;
+        }
+
+        this->logLifeCycle("updateTables()");
+        columns_ = ResampleTable::build(sourceWidth, outputWidth_, filter_);
+        rows_ = ResampleTable::build(sourceHeight, outputHeight_, filter_);
+        sourceWidth_ = sourceWidth;
+        sourceHeight_ = sourceHeight;
+    }
+
+    PPM_Image Resize::resize(const PPM_Image& image) const {
+        if (image.empty() || image[0].empty()) {
+            return image;
+        }
+
+        // Tables are built in preProcessHook() for the size in the metadata: images of another size get their own
+        // (images of a batch may be resized concurrently, so the cached tables are never modified here)
+        const int sourceWidth = static_cast<int>(image[0].size());
+        const int sourceHeight = static_cast<int>(image.size());
+        const bool cached = sourceWidth == sourceWidth_ && sourceHeight == sourceHeight_;
+        const ResampleTable localColumns = cached ? ResampleTable() : ResampleTable::build(sourceWidth, outputWidth_, filter_);
+        const ResampleTable localRows = cached ? ResampleTable() : ResampleTable::build(sourceHeight, outputHeight_, filter_);
+        const ResampleTable& columns = cached ? columns_ : localColumns;
+        const ResampleTable& rows = cached ? rows_ : localRows;
+
+        PPM_Image result(outputHeight_, std::vector<channelsT>(outputWidth_));
+        auto& pool = ThreadPool::getThreadPool();
+
+        if (filter_ == ResizeFilter::Nearest) {
+            pool.parallelFor(0, outputHeight_, [&](const std::size_t y) {
+                const auto& source = image[rows.index[rows.first[y]]];
+                auto& row = result[y];
+                for (int x = 0; x < outputWidth_; ++x) {
+                    row[x] = source[columns.index[columns.first[x]]];
+                }
+            }, 16);
+            return result;
+        }
+
+        // Output rows are produced in chunks: consecutive rows share most of their source rows,
+        // so each chunk keeps the last horizontally resampled rows in a small cache
+        constexpr std::size_t rowsPerChunk = 16;
+        const std::size_t n = static_cast<std::size_t>(outputWidth_) * 3;
+        const std::size_t nChunks = (outputHeight_ + rowsPerChunk - 1) / rowsPerChunk;
+
+        int maxTaps = 1;
+        for (int y = 0; y < outputHeight_; ++y) {
+            maxTaps = std::max(maxTaps, rows.taps(y));
+        }
+
+        pool.parallelFor(0, nChunks, [&](const std::size_t chunk) {
+            const std::size_t cacheSize = static_cast<std::size_t>(maxTaps) + 1;
+            std::vector<float> cache(cacheSize * n);
+            std::vector<int> cachedRow(cacheSize, -1);
+            std::size_t nextSlot = 0;
+            std::vector<float> accumulator(n);
+
+            const auto resampled = [&](const int sy) -> const float* {
+                for (std::size_t slot = 0; slot < cacheSize; ++slot) {
+                    if (cachedRow[slot] == sy) {
+                        return cache.data() + slot * n;
+                    }
+                }
+                const std::size_t slot = nextSlot;
+                nextSlot = (nextSlot + 1) % cacheSize;
+                cachedRow[slot] = sy;
+                resampleRow(image[sy], columns, cache.data() + slot * n);
+                return cache.data() + slot * n;
+            };
+
+            const int yEnd = static_cast<int>(std::min((chunk + 1) * rowsPerChunk, static_cast<std::size_t>(outputHeight_)));
+            for (int y = static_cast<int>(chunk * rowsPerChunk); y < yEnd; ++y) {
+                std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+                for (int t = rows.first[y]; t < rows.first[y + 1]; ++t) {
+                    addScaled(accumulator.data(), resampled(rows.index[t]), rows.weight[t], n);
+                }
+                floatToChannels(accumulator.data(), result[y].data()->data(), n, maxValue_);
+            }
+        });
+
+        return result;
+    }
+}
@@ -0,0 +1,170 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/nodes/Image/TemporalFilters.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/utils/thread_pool_utils.h"
+
+
+namespace PipeX {
+    constexpr std::size_t TemporalFilter::maxWindow;
+
+    FrameRing::FrameRing(const std::size_t capacity) : slots_(capacity) {}
+
+    void FrameRing::reset(const int width, const int height) {
+        width_ = width;
+        height_ = height;
+        next_ = 0;
+        size_ = 0;
+    }
+
+    const int* FrameRing::frame(const std::size_t age) const {
+        const std::size_t n = slots_.size();
+        return slots_[(next_ + n - 1 - age) % n].data();
+    }
+
+    int* FrameRing::push() {
+        auto& slot = slots_[next_];
+        // resize() keeps the allocation: buffers are only allocated for the first frames of a given size
+        slot.resize(frameSize());
+        next_ = (next_ + 1) % slots_.size();
+        size_ = std::min(size_ + 1, slots_.size());
+        return slot.data();
+    }
+
+
+    TemporalFilter::TemporalFilter(std::string node_name, const std::size_t window)
+        : Transformer(std::move(node_name), [this](PPM_Image& frame) {
+            return this->processFrame(frame);
+        }), ring_(window) {
+        if (window == 0 || window > maxWindow) {
+            throw InvalidOperation("TemporalFilter::TemporalFilter", "window must be in [1, " + std::to_string(maxWindow) + "]");
+        }
+        this->logLifeCycle("Constructor(std::string, std::size_t)");
+    }
+
+    void TemporalFilter::reset() {
+        restart(ring_.width(), ring_.height());
+    }
+
+    void TemporalFilter::restart(const int width, const int height) const {
+        ring_.reset(width, height);
+        resetState();
+    }
+
+    void TemporalFilter::preProcessHook() const {
+        const auto& metadata = *this->getMetadata();
+        if (metadata.width != ring_.width() || metadata.height != ring_.height() || metadata.bit_depth != maxValue_) {
+            maxValue_ = metadata.bit_depth;
+            restart(metadata.width, metadata.height);
+        }
+    }
+
+    PPM_Image TemporalFilter::processFrame(PPM_Image& frame) const {
+        const int height = static_cast<int>(frame.size());
+        const int width = height > 0 ? static_cast<int>(frame[0].size()) : 0;
+        if (width != ring_.width() || height != ring_.height()) {
+            throw InvalidOperation("TemporalFilter::processFrame", "every frame must have the size given by the metadata");
+        }
+
+        previous_ = ring_.size();
+        evicting_ = ring_.full();
+        slot_ = ring_.push();
+
+        ThreadPool::getThreadPool().parallelFor(0, frame.size(), [this, &frame](const std::size_t y) {
+            this->processRow(static_cast<int>(y), frame[y].data()->data());
+        }, 16);
+        return std::move(frame);
+    }
+
+
+    TemporalAverage::TemporalAverage(std::string node_name, const std::size_t window)
+        : TemporalFilter(std::move(node_name), window) {
+        this->logLifeCycle("Constructor(std::string, std::size_t)");
+    }
+
+    void TemporalAverage::resetState() const {
+        sums_.assign(ring_.frameSize(), 0);
+    }
+
+    void TemporalAverage::processRow(const int y, int* channels) const {
+        const std::size_t n = static_cast<std::size_t>(ring_.width()) * 3;
+        const std::size_t offset = static_cast<std::size_t>(y) * n;
+        int* slot = slot_ + offset;
+        std::int32_t* sums = sums_.data() + offset;
+
+        if (evicting_) {
+            for (std::size_t i = 0; i < n; ++i) {
+                sums[i] -= slot[i];
+            }
+        }
+        std::copy(channels, channels + n, slot);
+
+        const std::int32_t count = static_cast<std::int32_t>(previous_ + (evicting_ ? 0 : 1));
+        for (std::size_t i = 0; i < n; ++i) {
+            sums[i] += channels[i];
+            channels[i] = (2 * sums[i] + count) / (2 * count);
+        }
+    }
+
+
+    FrameDifference::FrameDifference(std::string node_name)
+        : TemporalFilter(std::move(node_name), 1) {
+        this->logLifeCycle("Constructor(std::string)");
+    }
+
+    void FrameDifference::processRow(const int y, int* channels) const {
+        const std::size_t n = static_cast<std::size_t>(ring_.width()) * 3;
+        // With a single slot, the slot of the current frame holds the previous one
+        int* slot = slot_ + static_cast<std::size_t>(y) * n;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const int current = channels[i];
+            channels[i] = previous_ > 0 ? std::abs(current - slot[i]) : 0;
+            slot[i] = current;
+        }
+    }
+
+
+    MotionDetection::MotionDetection(std::string node_name, const int threshold, const std::size_t window)
+        : TemporalFilter(std::move(node_name), window), threshold_(threshold) {
+        if (threshold_ < 0) {
+            throw InvalidOperation("MotionDetection::MotionDetection", "threshold must be non-negative");
+        }
+        this->logLifeCycle("Constructor(std::string, int, std::size_t)");
+    }
+
+    void MotionDetection::resetState() const {
+        sums_.assign(ring_.frameSize(), 0);
+    }
+
+    void MotionDetection::processRow(const int y, int* channels) const {
+        const int width = ring_.width();
+        const std::size_t offset = static_cast<std::size_t>(y) * width * 3;
+        int* slot = slot_ + offset;
+        std::int32_t* sums = sums_.data() + offset;
+
+        // Compared without dividing: |v - sum / count| > threshold  <=>  |v * count - sum| > threshold * count
+        const std::int32_t count = static_cast<std::int32_t>(previous_);
+        const std::int64_t limit = static_cast<std::int64_t>(threshold_) * count;
+
+        for (int x = 0; x < width; ++x, channels += 3, slot += 3, sums += 3) {
+            bool moving = false;
+            for (int c = 0; c < 3; ++c) {
+                const std::int64_t difference = static_cast<std::int64_t>(channels[c]) * count - sums[c];
+                if (count > 0 && (difference > limit || -difference > limit)) {
+                    moving = true;
+                }
+                // The background of the next frame: add this frame, drop the one leaving the window
+                sums[c] += channels[c] - (evicting_ ? slot[c] : 0);
+                slot[c] = channels[c];
+            }
+            channels[0] = channels[1] = channels[2] = moving ? maxValue_ : 0;
+        }
+    }
+}
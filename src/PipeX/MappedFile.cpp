@@ -0,0 +1,111 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include "PipeX/utils/mapped_file_utils.h"
+
+#include "PipeX/errors/PipeX_IO_Exception.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PipeX {
+#if defined(_WIN32)
+    MappedFile::MappedFile(const std::string& filename) {
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            file_ = nullptr;
+            throw PipeX_IO_Exception("[MappedFile] Could not open file for reading: " + filename);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) {
+            CloseHandle(file_);
+            throw PipeX_IO_Exception("[MappedFile] Could not read the size of: " + filename);
+        }
+        size_ = static_cast<std::size_t>(size.QuadPart);
+        if (size_ == 0) {
+            return;
+        }
+
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping_ ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping_) {
+                CloseHandle(mapping_);
+            }
+            CloseHandle(file_);
+            throw PipeX_IO_Exception("[MappedFile] Could not map file: " + filename);
+        }
+        data_ = static_cast<const std::uint8_t*>(view);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_) {
+            CloseHandle(file_);
+        }
+    }
+
+    void MappedFile::discard(std::size_t, std::size_t) const {
+        // Pages of a read-only view are reclaimed by the OS when needed
+    }
+#else
+    MappedFile::MappedFile(const std::string& filename) {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw PipeX_IO_Exception("[MappedFile] Could not open file for reading: " + filename);
+        }
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw PipeX_IO_Exception("[MappedFile] Could not read the size of: " + filename);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ == 0) {
+            close(fd);
+            return;
+        }
+
+        void* view = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        close(fd);
+        if (view == MAP_FAILED) {
+            throw PipeX_IO_Exception("[MappedFile] Could not map file: " + filename);
+        }
+        madvise(view, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const std::uint8_t*>(view);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            munmap(const_cast<std::uint8_t*>(data_), size_);
+        }
+    }
+
+    void MappedFile::discard(const std::size_t offset, const std::size_t length) const {
+        if (!data_ || offset >= size_) {
+            return;
+        }
+        // Only whole pages can be released
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t begin = (offset + page - 1) / page * page;
+        const std::size_t end = (offset + length < size_ ? offset + length : size_) / page * page;
+        if (begin < end) {
+            madvise(const_cast<std::uint8_t*>(data_) + begin, end - begin, MADV_DONTNEED);
+        }
+    }
+#endif
+}
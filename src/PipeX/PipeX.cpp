@@ -4,6 +4,9 @@
 
 #include "PipeX/PipeXEngine.h"
 #include "PipeX/utils/Console_threadsafe_utils.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/thread_pool_utils.h"
+#include "PipeX/utils/tiling_utils.h"
 #include <mutex>
 
 namespace PipeX {
@@ -12,4 +15,14 @@ namespace PipeX {
 
     // Definition of the mutex instance used in header files to prevent multiple definition over different translation units
     std::mutex Console_threadsafe::console_mutex;
+
+    // Definition of the shared thread pool used by the data-parallel node kernels
+    std::unique_ptr<ThreadPool> ThreadPool::thread_pool_;
+    std::once_flag ThreadPool::thread_pool_once_;
+
+    // Definition of the default tiling options of the image nodes
+    TilingOptions ImageTiling::default_options_;
+
+    // Definition of the default batch parallelism of the image Sources and Sinks
+    std::size_t ImageIO::default_batch_parallelism_ = 0;
 } // PipeX
\ No newline at end of file
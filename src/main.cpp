@@ -231,6 +231,7 @@ void WAV_audioDemo() {
     constexpr int bitsPerSample = 16;
     constexpr int durationSec = 5; // duration of each audio file in seconds
     constexpr int preset = 2; // 0: sinusoidal wave, 1: white noise, 2: pink noise
+    constexpr int numChannels = 2; // stereo: independent noise on each channel
 
     // EQ Bell Curve parameters
     constexpr double centerFrequency = 831.0; // Hz
@@ -244,7 +245,7 @@ void WAV_audioDemo() {
     constexpr double depth_2 = 0.4; // Modulation depth (0.0 to 1.0)
 
     pipexEngine->newPipeline("WAV Audio generation with Amplitude Modulation")
-            .addNode<PipeX::WAV_SoundPreset_Source>("WAV Audio Sample Source", nStreams, sampleRate, bitsPerSample, durationSec, preset)
+            .addNode<PipeX::WAV_SoundPreset_Source>("WAV Audio Sample Source", nStreams, sampleRate, bitsPerSample, durationSec, preset, numChannels)
             .addNode<PipeX::EQ_BellCurve>("EQ Bell Curve", centerFrequency, qFactor, gainDB)
             .addNode<PipeX::AmplitudeModulation>("Amplitude Modulation 1", rateHz_1, depth_1)
             .addNode<PipeX::AmplitudeModulation>("Amplitude Modulation 2", rateHz_2, depth_2)
@@ -266,7 +267,7 @@ void PPM_imageDemo() {
     // PPM image generation parameters
     constexpr int width = 1024;
     constexpr int height = 1024;
-    constexpr int preset = 0; // 0: gradient, 1: checkerboard, 2: color checkerboard || only 0 (gradient) is implemented for now
+    constexpr int preset = PipeX::PPM_ImagePreset_Source::GRADIENT; // GRADIENT, CHECKERBOARD, COLOR_CHECK or NOISE
     constexpr int count = 1; // number of images to generate
 
     // Gain Exposure parameters
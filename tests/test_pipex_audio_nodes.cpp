@@ -0,0 +1,1402 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PipeX/Pipeline.h"
+#include "PipeX/errors/InvalidOperation.h"
+#include "PipeX/errors/PipeX_IO_Exception.h"
+#include "PipeX/errors/PipeXException.h"
+#include "PipeX/metadata/WAV_Metadata.h"
+#include "PipeX/nodes/Audio/AmplitudeModulation.h"
+#include "PipeX/nodes/Audio/EQ_BellCurve.h"
+#include "PipeX/nodes/Audio/ParametricEQ.h"
+#include "PipeX/nodes/Audio/PartitionedConvolution.h"
+#include "PipeX/nodes/Audio/Resampler.h"
+#include "PipeX/nodes/Audio/SpectralAnalysis.h"
+#include "PipeX/nodes/Audio/WAV_AudioPreset_Source.h"
+#include "PipeX/nodes/Audio/WAV_Audio_Sink.h"
+#include "PipeX/nodes/Audio/WAV_Audio_Source.h"
+#include "PipeX/nodes/primitives/Sink.h"
+#include "PipeX/nodes/primitives/Transformer.h"
+#include "PipeX/utils/fft_utils.h"
+#include "PipeX/utils/node_utils.h"
+#include "PipeX/utils/sound_utils.h"
+#include "PipeX/utils/wav_utils.h"
+#include "my_extended_cpp_standard/my_memory.h"
+#include "test_pipex_utils.h"
+
+
+using namespace PipeX;
+
+static void put16(std::vector<std::uint8_t>& bytes, const std::uint32_t v) {
+    bytes.push_back(static_cast<std::uint8_t>(v));
+    bytes.push_back(static_cast<std::uint8_t>(v >> 8));
+}
+
+static void put32(std::vector<std::uint8_t>& bytes, const std::uint32_t v) {
+    put16(bytes, v & 0xffff);
+    put16(bytes, v >> 16);
+}
+
+/**
+ * @brief Writes interleaved samples as a PCM WAV file, with a LIST chunk (odd size, padded) before the fmt chunk
+ * and a custom chunk between fmt and data, which a reader must skip.
+ */
+static void writeWAVFile(const std::string& filename, const std::vector<bit_depth_t>& samples, const int numChannels, const int sampleRate, const int bitsPerSample) {
+    const std::uint32_t bytesPerSample = bitsPerSample / 8;
+    const std::uint32_t dataSize = static_cast<std::uint32_t>(samples.size()) * bytesPerSample;
+
+    std::vector<std::uint8_t> bytes;
+    bytes.insert(bytes.end(), {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'});
+    bytes.insert(bytes.end(), {'L', 'I', 'S', 'T'});
+    put32(bytes, 5);
+    bytes.insert(bytes.end(), {'I', 'N', 'F', 'O', '!', 0});
+
+    bytes.insert(bytes.end(), {'f', 'm', 't', ' '});
+    put32(bytes, 16);
+    put16(bytes, 1);
+    put16(bytes, numChannels);
+    put32(bytes, sampleRate);
+    put32(bytes, sampleRate * numChannels * bytesPerSample);
+    put16(bytes, numChannels * bytesPerSample);
+    put16(bytes, bitsPerSample);
+
+    bytes.insert(bytes.end(), {'j', 'u', 'n', 'k'});
+    put32(bytes, 4);
+    bytes.insert(bytes.end(), {1, 2, 3, 4});
+
+    bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+    put32(bytes, dataSize);
+    for (const auto sample : samples) {
+        const std::uint32_t v = bitsPerSample == 8 ? static_cast<std::uint32_t>(sample + 128) : static_cast<std::uint32_t>(sample);
+        for (std::uint32_t b = 0; b < bytesPerSample; ++b) {
+            bytes.push_back(static_cast<std::uint8_t>(v >> (8 * b)));
+        }
+    }
+
+    const std::uint32_t riffSize = static_cast<std::uint32_t>(bytes.size()) - 8;
+    for (int b = 0; b < 4; ++b) {
+        bytes[4 + b] = static_cast<std::uint8_t>(riffSize >> (8 * b));
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+/**
+ * @brief Integer PCM samples covering both signs and the extremes of the range of the given depth.
+ */
+static std::vector<bit_depth_t> makeRamp(const std::size_t count, const int bitsPerSample) {
+    const bit_depth_t range = bitsPerSample == 32 ? 0x7fffffff : (1 << (bitsPerSample - 1)) - 1;
+    std::vector<bit_depth_t> samples(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::int64_t v = (static_cast<std::int64_t>(i) * 7919) % (2 * static_cast<std::int64_t>(range) + 1) - range;
+        samples[i] = static_cast<bit_depth_t>(v);
+    }
+    return samples;
+}
+
+/**
+ * @brief Float samples (full scale [-1, 1)) of integer PCM samples of the given depth.
+ */
+static std::vector<audio_sample_t> toFloat(const std::vector<bit_depth_t>& samples, const int bitsPerSample) {
+    const float inverse = 1.0f / static_cast<float>(std::ldexp(1.0, bitsPerSample - 1));
+    std::vector<audio_sample_t> audio(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        audio[i] = static_cast<float>(samples[i]) * inverse;
+    }
+    return audio;
+}
+
+/**
+ * @brief Planar buffer of interleaved frames, built sample by sample.
+ */
+static WAV_AudioBuffer toPlanar(const std::vector<audio_sample_t>& frames, const std::size_t numChannels) {
+    WAV_AudioBuffer audio(numChannels, frames.size() / numChannels);
+    for (std::size_t n = 0; n < audio.numFrames; ++n) {
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            audio.samples[c * audio.numFrames + n] = frames[n * numChannels + c];
+        }
+    }
+    return audio;
+}
+
+/**
+ * @brief Appends the frames of a buffer, interleaved, whatever its layout.
+ */
+static void appendFrames(std::vector<audio_sample_t>& frames, const WAV_AudioBuffer& audio) {
+    for (std::size_t n = 0; n < audio.numFrames; ++n) {
+        for (std::size_t c = 0; c < audio.numChannels; ++c) {
+            frames.push_back(audio.at(c, n));
+        }
+    }
+}
+
+/**
+ * @brief Wraps a single buffer with its WAV metadata, as a node input (numSamples 0: the buffer is the whole stream).
+ */
+static std::unique_ptr<IData> wrapAudio(const WAV_AudioBuffer& audio, const uint32_t sampleRate, const uint32_t blockStart = 0, const uint32_t numSamples = 0) {
+    auto wrappedInput = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(1, audio));
+    auto metadata = std::make_shared<WAV_Metadata>();
+    metadata->setParameters(static_cast<uint16_t>(audio.numChannels), sampleRate, 16, 0);
+    metadata->numSamples = numSamples != 0 ? numSamples : static_cast<uint32_t>(audio.numFrames);
+    metadata->blockStart = blockStart;
+    wrappedInput->metadata = metadata;
+    return wrappedInput;
+}
+
+/**
+ * @brief Runs an audio node on a single buffer.
+ */
+static WAV_AudioBuffer runAudioNode(INode& node, const WAV_AudioBuffer& audio, const uint32_t sampleRate, const uint32_t blockStart = 0) {
+    auto outputData = node.process(wrapAudio(audio, sampleRate, blockStart));
+    return std::move(extractData<WAV_AudioBuffer>(outputData)->at(0));
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, WAVReader) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: WAVReader" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const TemporaryDirectory directory;
+
+    const std::string filename = directory.path("test_reader.wav");
+
+    for (const int bits : {8, 16, 24, 32}) {
+        // Stereo, 1000 frames
+        const std::vector<bit_depth_t> samples = makeRamp(2000, bits);
+        writeWAVFile(filename, samples, 2, 22050, bits);
+
+        WAV_Audio_Source source("Source", filename);
+        auto output = source.process(nullptr);
+        const auto metadata = std::dynamic_pointer_cast<WAV_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->numChannels, 2);
+        EXPECT_EQ(metadata->sampleRate, 22050u);
+        EXPECT_EQ(metadata->bitsPerSample, bits);
+        EXPECT_EQ(metadata->blockAlign, 2 * bits / 8);
+        EXPECT_EQ(metadata->numSamples, 1000u);
+        EXPECT_EQ(metadata->dataSize, 2000u * bits / 8);
+        EXPECT_FALSE(source.hasPendingData());
+
+        const auto results = extractData<WAV_AudioBuffer>(output);
+        ASSERT_EQ(results->size(), 1u);
+        EXPECT_EQ((*results)[0], toPlanar(toFloat(samples, bits), 2)) << bits << " bits";
+    }
+
+    {
+        // Streaming: blocks of 300 frames, the last one shorter
+        const std::vector<bit_depth_t> samples = makeRamp(2000, 16);
+        writeWAVFile(filename, samples, 2, 8000, 16);
+
+        WAV_Audio_Source source("Source", filename, 300);
+        std::vector<audio_sample_t> streamed;
+        std::uint32_t expectedStart = 0;
+        do {
+            auto output = source.process(nullptr);
+            const auto metadata = std::dynamic_pointer_cast<WAV_Metadata>(output->metadata);
+            ASSERT_NE(metadata, nullptr);
+            EXPECT_EQ(metadata->blockStart, expectedStart);
+            EXPECT_EQ(metadata->numSamples, 1000u);
+
+            const auto results = extractData<WAV_AudioBuffer>(output);
+            ASSERT_EQ(results->size(), 1u);
+            EXPECT_EQ((*results)[0].numFrames, std::min<std::size_t>(300, 1000 - expectedStart));
+            appendFrames(streamed, (*results)[0]);
+            expectedStart += 300;
+        } while (source.hasPendingData());
+        EXPECT_EQ(streamed, toFloat(samples, 16));
+
+        // In a pipeline the nodes run once per block, then the source rewinds for the next run
+        std::vector<WAV_AudioBuffer> blocks;
+        Pipeline pipeline("Streaming");
+        pipeline.addNode<WAV_Audio_Source>("Source", filename, 300)
+                .addNode<Sink<WAV_AudioBuffer, WAV_Metadata>>("Sink", [&blocks](std::vector<WAV_AudioBuffer>& audio) {
+                    blocks.push_back(std::move(audio[0]));
+                });
+        pipeline.run();
+        ASSERT_EQ(blocks.size(), 4u);
+        pipeline.run();
+        ASSERT_EQ(blocks.size(), 8u);
+
+        streamed.clear();
+        for (std::size_t i = 4; i < blocks.size(); ++i) {
+            appendFrames(streamed, blocks[i]);
+        }
+        EXPECT_EQ(streamed, toFloat(samples, 16));
+    }
+
+    {
+        // Preset source: a batch of files written with the sink naming convention
+        const std::vector<bit_depth_t> first = makeRamp(500, 16);
+        const std::vector<bit_depth_t> second(first.rbegin(), first.rend());
+        writeWAVFile(directory.path("test_preset_0.wav"), first, 1, 44100, 16);
+        writeWAVFile(directory.path("test_preset_1.wav"), second, 1, 44100, 16);
+
+        WAV_SoundPreset_Source source("Source", 2, directory.path("test_preset"));
+        auto output = source.process(nullptr);
+        const auto metadata = std::dynamic_pointer_cast<WAV_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->numSamples, 500u);
+        EXPECT_EQ(metadata->sampleRate, 44100u);
+
+        const auto results = extractData<WAV_AudioBuffer>(output);
+        ASSERT_EQ(results->size(), 2u);
+        EXPECT_EQ((*results)[0], toPlanar(toFloat(first, 16), 1));
+        EXPECT_EQ((*results)[1], toPlanar(toFloat(second, 16), 1));
+    }
+
+    {
+        std::ofstream(filename, std::ios::binary) << "RIFF....WAVEfmt ";
+        WAV_Audio_Source source("Source", filename);
+        EXPECT_THROW(source.process(nullptr), PipeX_IO_Exception);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, WAVWriter) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: WAVWriter" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const TemporaryDirectory directory;
+
+    const auto readFile = [](const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    const auto runSink = [](WAV_Sound_Sink& sink, const WAV_AudioBuffer& samples, const std::shared_ptr<WAV_Metadata>& metadata) {
+        auto wrappedInput = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(1, samples));
+        wrappedInput->metadata = metadata;
+        sink.process(std::move(wrappedInput));
+    };
+
+    {
+        // Round trip through the sink and the reader, with an odd number of samples (padded data chunk for 8 bits)
+        for (const int bits : {8, 16, 24, 32}) {
+            const std::vector<audio_sample_t> samples = toFloat(makeRamp(1001, bits), bits);
+            auto metadata = std::make_shared<WAV_Metadata>();
+            metadata->setParameters(1, 8000, static_cast<uint16_t>(bits), 0);
+            metadata->numSamples = 1001;
+
+            WAV_Sound_Sink sink("Sink", directory.path("test_writer"));
+            runSink(sink, toPlanar(samples, 1), metadata);
+
+            const auto bytes = readFile(directory.path("test_writer_0.wav"));
+            const std::size_t dataSize = 1001 * (bits / 8);
+            ASSERT_EQ(bytes.size(), WAV::headerSize + dataSize + (dataSize & 1)) << bits << " bits";
+
+            const WAV::Layout layout = WAV::parse(bytes.data(), bytes.size());
+            EXPECT_EQ(layout.dataSize, dataSize);
+            EXPECT_EQ(layout.bitsPerSample, bits);
+            EXPECT_EQ(WAV::detail::read32(bytes.data() + 4), bytes.size() - 8);
+
+            std::vector<audio_sample_t> decoded(layout.numFrames());
+            WAV::decode(bytes.data() + layout.dataOffset, decoded.size(), bits, decoded.data());
+            if (bits < 32) {
+                EXPECT_EQ(decoded, samples) << bits << " bits";
+            } else {
+                // +1.0 is not representable in 32-bit PCM: it saturates to the largest float below it
+                for (std::size_t i = 0; i < samples.size(); ++i) {
+                    ASSERT_NEAR(decoded[i], samples[i], 1e-7) << i;
+                }
+            }
+        }
+
+        // 24-bit samples are packed in 3 bytes, little-endian, saturated to the 24-bit range
+        const std::vector<audio_sample_t> samples = {-1.0f / 8388608, 0x123456 / 8388608.0f, -1.0f, 1.5f, -1.5f};
+        std::uint8_t packed[15];
+        WAV::encode(samples.data(), samples.size(), 24, packed);
+        const std::vector<std::uint8_t> expected = {0xff, 0xff, 0xff, 0x56, 0x34, 0x12, 0x00, 0x00, 0x80, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x80};
+        EXPECT_EQ(std::vector<std::uint8_t>(packed, packed + 15), expected);
+
+        // 16-bit samples saturate instead of wrapping around
+        const float lsb = 1.0f / 32768;
+        const std::vector<audio_sample_t> loud = {1.25f, -1.25f, lsb, -lsb, 32767 * lsb, -1.0f, 3.0f, -3.0f, 12 * lsb};
+        std::uint8_t packed16[18];
+        WAV::encode(loud.data(), loud.size(), 16, packed16);
+        std::vector<audio_sample_t> clamped(loud.size());
+        WAV::decode(packed16, loud.size(), 16, clamped.data());
+        EXPECT_EQ(clamped, toFloat({32767, -32768, 1, -1, 32767, -32768, 32767, -32768, 12}, 16));
+    }
+
+    {
+        // The batch parallelism is a constructor argument, so a sink built in place by a Pipeline can be made serial.
+        // The file of the second buffer is taken by a directory: written serially, the third file is never written
+        const std::string prefix = directory.path("test_parallelism");
+        ASSERT_EQ(makeDirectory(prefix + "_1.wav"), 0);
+        EXPECT_EQ(WAV_Sound_Sink("Sink", prefix).getBatchParallelism(), 0u);
+
+        auto metadata = std::make_shared<WAV_Metadata>();
+        metadata->setParameters(1, 8000, 16, 0);
+        metadata->numSamples = 100;
+        auto wrappedInput = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(3, WAV_AudioBuffer(1, 100)));
+        wrappedInput->metadata = metadata;
+        WAV_Sound_Sink sink("Sink", prefix, 1);
+        EXPECT_EQ(sink.getBatchParallelism(), 1u);
+        EXPECT_THROW(sink.process(std::move(wrappedInput)), PipeX_IO_Exception);
+        EXPECT_TRUE(std::ifstream(prefix + "_0.wav").good());
+        EXPECT_FALSE(std::ifstream(prefix + "_2.wav").good());
+    }
+
+    {
+        // Streaming copy: blocks appended to the same file, header patched at the end of the stream
+        const std::vector<bit_depth_t> samples = makeRamp(2 * 12345, 24);
+        writeWAVFile(directory.path("test_stream_in.wav"), samples, 2, 48000, 24);
+
+        Pipeline pipeline("Streaming copy");
+        pipeline.addNode<WAV_Audio_Source>("Source", directory.path("test_stream_in.wav"), 1000)
+                .addNode<WAV_Sound_Sink>("Sink", directory.path("test_stream_out"));
+        pipeline.run();
+
+        const auto bytes = readFile(directory.path("test_stream_out_0.wav"));
+        ASSERT_EQ(bytes.size(), WAV::headerSize + samples.size() * 3);
+        EXPECT_EQ(WAV::detail::read32(bytes.data() + 4), bytes.size() - 8);
+        const WAV::Layout layout = WAV::parse(bytes.data(), bytes.size());
+        EXPECT_EQ(layout.numChannels, 2);
+        EXPECT_EQ(layout.sampleRate, 48000u);
+        EXPECT_EQ(layout.numFrames(), 12345u);
+
+        std::vector<audio_sample_t> decoded(samples.size());
+        WAV::decode(bytes.data() + layout.dataOffset, decoded.size(), 24, decoded.data());
+        EXPECT_EQ(decoded, toFloat(samples, 24));
+
+        // A node throwing in the middle of the stream: the source and the sink are still told that the stream ended,
+        // so the next run starts from the beginning of the file and writes a whole new one
+        int block = 0;
+        bool failing = true;
+        Pipeline failingPipeline("Failing copy");
+        failingPipeline.addNode<WAV_Audio_Source>("Source", directory.path("test_stream_in.wav"), 1000)
+                .addNode<Transformer<WAV_AudioBuffer, WAV_AudioBuffer, WAV_Metadata>>("Failing", [&](WAV_AudioBuffer& audio) {
+                    if (failing && ++block == 2) {
+                        throw PipeXException("failure on block 2");
+                    }
+                    return audio;
+                })
+                .addNode<WAV_Sound_Sink>("Sink", directory.path("test_failing_out"));
+        EXPECT_THROW(failingPipeline.run(), PipeXException);
+        failing = false;
+        failingPipeline.run();
+        EXPECT_EQ(readFile(directory.path("test_failing_out_0.wav")), bytes);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, Multichannel) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: Multichannel" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const TemporaryDirectory directory;
+
+    {
+        // Layout conversions, with frame counts exercising the vectorized and the scalar paths
+        for (const std::size_t numChannels : {1, 2, 3, 6}) {
+            const std::size_t numFrames = 37;
+            const std::vector<audio_sample_t> frames = toFloat(makeRamp(numChannels * numFrames, 16), 16);
+            const WAV_AudioBuffer planar = toPlanar(frames, numChannels);
+
+            WAV_AudioBuffer audio = planar;
+            audio.setLayout(AudioLayout::Interleaved);
+            EXPECT_EQ(audio.samples, frames) << numChannels << " channels";
+            for (std::size_t c = 0; c < numChannels; ++c) {
+                EXPECT_EQ(audio.at(c, 5), planar.at(c, 5));
+            }
+            audio.setLayout(AudioLayout::Planar);
+            EXPECT_EQ(audio, planar) << numChannels << " channels";
+        }
+    }
+
+    {
+        // 5.1 surround file: read as a planar buffer, written back as interleaved frames whatever the layout
+        const std::vector<bit_depth_t> pcm = makeRamp(6 * 1001, 16);
+        writeWAVFile(directory.path("test_surround.wav"), pcm, 6, 48000, 16);
+
+        WAV_Audio_Source source("Source", directory.path("test_surround.wav"));
+        auto output = source.process(nullptr);
+        const auto metadata = std::dynamic_pointer_cast<WAV_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->numChannels, 6);
+        EXPECT_EQ(metadata->numSamples, 1001u);
+
+        const WAV_AudioBuffer audio = extractData<WAV_AudioBuffer>(output)->at(0);
+        EXPECT_EQ(audio.layout, AudioLayout::Planar);
+        EXPECT_EQ(audio, toPlanar(toFloat(pcm, 16), 6));
+
+        const auto readData = [](const std::string& filename) {
+            std::ifstream file(filename, std::ios::binary);
+            const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            const WAV::Layout layout = WAV::parse(bytes.data(), bytes.size());
+            EXPECT_EQ(layout.numChannels, 6);
+            return std::vector<std::uint8_t>(bytes.begin() + static_cast<std::ptrdiff_t>(layout.dataOffset), bytes.end());
+        };
+        const std::vector<std::uint8_t> expected = readData(directory.path("test_surround.wav"));
+
+        for (const AudioLayout layout : {AudioLayout::Planar, AudioLayout::Interleaved}) {
+            WAV_AudioBuffer copy = audio;
+            copy.setLayout(layout);
+            auto wrappedInput = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(1, copy));
+            wrappedInput->metadata = metadata;
+            WAV_Sound_Sink sink("Sink", directory.path("test_surround_out"));
+            sink.process(std::move(wrappedInput));
+            EXPECT_EQ(readData(directory.path("test_surround_out_0.wav")), expected);
+        }
+
+        // The number of channels of the buffers must match the metadata
+        auto wrappedInput = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(1, WAV_AudioBuffer(2, 10)));
+        wrappedInput->metadata = metadata;
+        WAV_Sound_Sink sink("Sink", directory.path("test_surround_out"));
+        EXPECT_THROW(sink.process(std::move(wrappedInput)), PipeXException);
+    }
+
+    {
+        // Every channel is processed on its own, whatever the layout of the buffer
+        const WAV_AudioBuffer stereo = toPlanar(toFloat(makeRamp(2 * 4000, 16), 16), 2);
+        for (const int node : {0, 1}) {
+            const auto makeNode = [node]() -> std::unique_ptr<INode> {
+                if (node == 0) {
+                    return extended_std::make_unique<EQ_BellCurve>("EQ", 1000.0, 0.7, 6.0);
+                }
+                return extended_std::make_unique<AmplitudeModulation>("AM", 5.0, 0.8);
+            };
+
+            const WAV_AudioBuffer processed = runAudioNode(*makeNode(), stereo, 44100);
+            ASSERT_EQ(processed.numChannels, 2u);
+            ASSERT_EQ(processed.numFrames, 4000u);
+            for (std::size_t c = 0; c < 2; ++c) {
+                WAV_AudioBuffer mono(1, stereo.numFrames);
+                std::copy(stereo.channel(c), stereo.channel(c) + stereo.numFrames, mono.data());
+                const WAV_AudioBuffer expected = runAudioNode(*makeNode(), mono, 44100);
+                EXPECT_TRUE(std::equal(expected.samples.begin(), expected.samples.end(), processed.channel(c))) << "node " << node << ", channel " << c;
+            }
+
+            WAV_AudioBuffer interleaved = stereo;
+            interleaved.setLayout(AudioLayout::Interleaved);
+            EXPECT_EQ(runAudioNode(*makeNode(), interleaved, 44100), processed) << "node " << node;
+        }
+    }
+
+    {
+        // Multichannel presets: the sine is the same on every channel, the noise channels are independent
+        WAV_SoundPreset_Source sine("Sine", 1, 8000, 16, 1, WAV_SoundPreset_Source::SINE, 2);
+        auto output = sine.process(nullptr);
+        const auto metadata = std::dynamic_pointer_cast<WAV_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->numChannels, 2);
+        EXPECT_EQ(metadata->blockAlign, 4);
+        const WAV_AudioBuffer tone = extractData<WAV_AudioBuffer>(output)->at(0);
+        ASSERT_EQ(tone.numChannels, 2u);
+        ASSERT_EQ(tone.numFrames, 8000u);
+        EXPECT_TRUE(std::equal(tone.channel(0), tone.channel(0) + tone.numFrames, tone.channel(1)));
+
+        WAV_SoundPreset_Source noise("Noise", 1, 8000, 16, 1, WAV_SoundPreset_Source::WHITE_NOISE, 2);
+        const WAV_AudioBuffer hiss = extractData<WAV_AudioBuffer>(noise.process(nullptr))->at(0);
+        EXPECT_FALSE(std::equal(hiss.channel(0), hiss.channel(0) + hiss.numFrames, hiss.channel(1)));
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, AmplitudeModulation) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: AmplitudeModulation" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // The recurrence oscillator stays accurate over long buffers (reseeded every oscillatorReseed samples)
+        const std::size_t count = 100003;
+        const double increment = 2.0 * M_PI * 440.0 / 44100.0;
+        std::vector<float> tone(count);
+        sineOscillator(tone.data(), count, 1.0, increment, 0.7f, 0.2f);
+        double maxError = 0.0;
+        for (std::size_t n = 0; n < count; ++n) {
+            maxError = std::max(maxError, std::abs(tone[n] - (0.2 + 0.7 * std::sin(1.0 + static_cast<double>(n) * increment))));
+        }
+        EXPECT_LT(maxError, 1e-5);
+    }
+
+    {
+        // Modulation of a constant signal gives the modulator, (1 + depth * sin(2 pi rate n / sampleRate)) / 2
+        constexpr double rateHz = 7.0;
+        constexpr double depth = 0.6;
+        WAV_AudioBuffer constant(2, 70001);
+        std::fill(constant.samples.begin(), constant.samples.end(), 1.0f);
+        AmplitudeModulation modulation("AM", rateHz, depth);
+        const WAV_AudioBuffer modulated = runAudioNode(modulation, constant, 44100);
+        double maxError = 0.0;
+        for (std::size_t c = 0; c < 2; ++c) {
+            for (std::size_t n = 0; n < constant.numFrames; ++n) {
+                const double expected = (1.0 + depth * std::sin(2.0 * M_PI * rateHz * static_cast<double>(n) / 44100.0)) / 2.0;
+                maxError = std::max(maxError, std::abs(modulated.at(c, n) - expected));
+            }
+        }
+        EXPECT_LT(maxError, 1e-5);
+
+        // Streaming: blocks modulated with their position in the stream continue the same modulator
+        std::vector<audio_sample_t> streamed;
+        for (std::size_t start = 0; start < constant.numFrames; start += 999) {
+            const std::size_t frames = std::min<std::size_t>(999, constant.numFrames - start);
+            WAV_AudioBuffer block(2, frames);
+            std::fill(block.samples.begin(), block.samples.end(), 1.0f);
+            appendFrames(streamed, runAudioNode(modulation, block, 44100, static_cast<uint32_t>(start)));
+        }
+        std::vector<audio_sample_t> whole;
+        appendFrames(whole, modulated);
+        ASSERT_EQ(streamed.size(), whole.size());
+        for (std::size_t i = 0; i < whole.size(); ++i) {
+            ASSERT_NEAR(streamed[i], whole[i], 1e-5) << i;
+        }
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, ParametricEQ) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: ParametricEQ" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    constexpr uint32_t sampleRate = 48000;
+    const auto makeTone = [](const std::size_t numChannels, const std::size_t numFrames, const double frequency) {
+        WAV_AudioBuffer tone(numChannels, numFrames);
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            for (std::size_t n = 0; n < numFrames; ++n) {
+                tone.at(c, n) = static_cast<float>(0.25 * std::sin(2.0 * M_PI * frequency * static_cast<double>(n) / sampleRate + static_cast<double>(c)));
+            }
+        }
+        return tone;
+    };
+    // Gain of the steady state (second half of the buffer) of a channel
+    const auto gain = [](const WAV_AudioBuffer& output, const WAV_AudioBuffer& input, const std::size_t c) {
+        float outPeak = 0.0f, inPeak = 0.0f;
+        for (std::size_t n = input.numFrames / 2; n < input.numFrames; ++n) {
+            outPeak = std::max(outPeak, std::abs(output.at(c, n)));
+            inPeak = std::max(inPeak, std::abs(input.at(c, n)));
+        }
+        return outPeak / inPeak;
+    };
+
+    {
+        // Frequency response of each type of band
+        struct Case { EQ_Band band; double frequency; double expectedGain; double tolerance; };
+        const std::vector<Case> cases = {
+            {EQ_Band::peaking(1000.0, 2.0, 6.0), 1000.0, std::pow(10.0, 6.0 / 20.0), 0.02},
+            {EQ_Band::peaking(1000.0, 2.0, -12.0), 1000.0, std::pow(10.0, -12.0 / 20.0), 0.01},
+            {EQ_Band::lowShelf(300.0, 0.7071, 9.0), 40.0, std::pow(10.0, 9.0 / 20.0), 0.05},
+            {EQ_Band::highShelf(3000.0, 0.7071, -9.0), 18000.0, std::pow(10.0, -9.0 / 20.0), 0.02},
+            {EQ_Band::lowPass(1000.0, 0.7071), 100.0, 1.0, 0.01},
+            {EQ_Band::lowPass(1000.0, 0.7071), 10000.0, 0.0, 0.015},
+            {EQ_Band::highPass(1000.0, 0.7071), 10000.0, 1.0, 0.01},
+            {EQ_Band::highPass(1000.0, 0.7071), 1000.0, std::sqrt(0.5), 0.01},
+        };
+        for (const auto& test : cases) {
+            ParametricEQ eq("EQ", {test.band});
+            const WAV_AudioBuffer tone = makeTone(1, 24000, test.frequency);
+            EXPECT_NEAR(gain(runAudioNode(eq, tone, sampleRate), tone, 0), test.expectedGain, test.tolerance) << test.frequency << " Hz";
+        }
+    }
+
+    const std::vector<EQ_Band> bands = {EQ_Band::highPass(40.0, 0.7071), EQ_Band::lowShelf(200.0, 0.7071, 4.0), EQ_Band::peaking(1000.0, 1.5, -6.0),
+                                        EQ_Band::peaking(3500.0, 4.0, 5.0), EQ_Band::highShelf(8000.0, 0.7071, -3.0)};
+
+    {
+        // The cascade matches a serial reference in double (direct form I, one band after the other)
+        WAV_AudioBuffer noise(1, 5000);
+        std::uint32_t seed = 12345;
+        for (auto& sample : noise.samples) {
+            seed = seed * 1664525u + 1013904223u;
+            sample = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+        }
+
+        std::vector<double> reference(noise.samples.begin(), noise.samples.end());
+        for (const auto& band : bands) {
+            const double A = std::pow(10.0, band.gainDB / 40.0);
+            const double w0 = 2.0 * M_PI * band.frequency / sampleRate;
+            const double alpha = std::sin(w0) / (2.0 * band.q);
+            const double cosw = std::cos(w0);
+            const double shelf = 2.0 * std::sqrt(A) * alpha;
+            double b[3], a[3];
+            switch (band.type) {
+            case EQ_Band::Type::Peaking:
+                b[0] = 1 + alpha * A; b[1] = -2 * cosw; b[2] = 1 - alpha * A; a[0] = 1 + alpha / A; a[1] = -2 * cosw; a[2] = 1 - alpha / A;
+                break;
+            case EQ_Band::Type::LowShelf:
+                b[0] = A * ((A + 1) - (A - 1) * cosw + shelf); b[1] = 2 * A * ((A - 1) - (A + 1) * cosw); b[2] = A * ((A + 1) - (A - 1) * cosw - shelf);
+                a[0] = (A + 1) + (A - 1) * cosw + shelf; a[1] = -2 * ((A - 1) + (A + 1) * cosw); a[2] = (A + 1) + (A - 1) * cosw - shelf;
+                break;
+            case EQ_Band::Type::HighShelf:
+                b[0] = A * ((A + 1) + (A - 1) * cosw + shelf); b[1] = -2 * A * ((A - 1) + (A + 1) * cosw); b[2] = A * ((A + 1) + (A - 1) * cosw - shelf);
+                a[0] = (A + 1) - (A - 1) * cosw + shelf; a[1] = 2 * ((A - 1) - (A + 1) * cosw); a[2] = (A + 1) - (A - 1) * cosw - shelf;
+                break;
+            default:
+                b[0] = (1 + cosw) / 2; b[1] = -(1 + cosw); b[2] = (1 + cosw) / 2; a[0] = 1 + alpha; a[1] = -2 * cosw; a[2] = 1 - alpha;
+                break;
+            }
+            double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+            for (auto& v : reference) {
+                const double y = (b[0] * v + b[1] * x1 + b[2] * x2 - a[1] * y1 - a[2] * y2) / a[0];
+                x2 = x1; x1 = v; y2 = y1; y1 = y;
+                v = y;
+            }
+        }
+
+        ParametricEQ eq("EQ", bands);
+        const WAV_AudioBuffer output = runAudioNode(eq, noise, sampleRate);
+        for (std::size_t n = 0; n < reference.size(); ++n) {
+            ASSERT_NEAR(output.samples[n], reference[n], 1e-4) << n;
+        }
+    }
+
+    {
+        // Channels are independent, whatever their SIMD lane; a stream in blocks is filtered as a single buffer
+        const WAV_AudioBuffer input = makeTone(11, 3000, 440.0);
+        ParametricEQ eq("EQ", bands);
+        const WAV_AudioBuffer output = runAudioNode(eq, input, sampleRate);
+        for (const std::size_t c : {0, 3, 4, 7, 8, 10}) {
+            WAV_AudioBuffer mono(1, input.numFrames);
+            std::copy(input.channel(c), input.channel(c) + input.numFrames, mono.data());
+            const WAV_AudioBuffer expected = runAudioNode(eq, mono, sampleRate);
+            EXPECT_TRUE(std::equal(expected.samples.begin(), expected.samples.end(), output.channel(c))) << "channel " << c;
+        }
+
+        std::vector<audio_sample_t> streamed;
+        for (std::size_t start = 0; start < input.numFrames; start += 1000) {
+            WAV_AudioBuffer block(input.numChannels, 1000);
+            for (std::size_t c = 0; c < input.numChannels; ++c) {
+                std::copy(input.channel(c) + start, input.channel(c) + start + 1000, block.channel(c));
+            }
+            appendFrames(streamed, runAudioNode(eq, block, sampleRate, static_cast<uint32_t>(start)));
+        }
+        std::vector<audio_sample_t> whole;
+        appendFrames(whole, output);
+        EXPECT_EQ(streamed, whole);
+    }
+
+    {
+        // The streams of a batch share the SIMD lanes (mono streams, a stream with more channels, a shorter stream)
+        // and keep their own state: each matches the same stream filtered alone
+        std::vector<WAV_AudioBuffer> inputs;
+        for (std::size_t i = 0; i < 20; ++i) {
+            inputs.push_back(makeTone(i == 12 ? 3 : 1, i == 7 ? 1400 : 3000, 100.0 + 250.0 * static_cast<double>(i)));
+        }
+
+        ParametricEQ eq("EQ", bands);
+        std::vector<std::vector<audio_sample_t>> streamed(inputs.size());
+        for (uint32_t start = 0; start < 3000; start += 1500) {
+            std::vector<WAV_AudioBuffer> batch;
+            for (const auto& input : inputs) {
+                const std::size_t frames = input.numFrames / 2;
+                WAV_AudioBuffer block(input.numChannels, frames);
+                for (std::size_t c = 0; c < input.numChannels; ++c) {
+                    std::copy(input.channel(c) + start * frames / 1500, input.channel(c) + start * frames / 1500 + frames, block.channel(c));
+                }
+                batch.push_back(std::move(block));
+            }
+            auto wrapped = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(std::move(batch)));
+            auto metadata = std::make_shared<WAV_Metadata>();
+            metadata->setParameters(1, sampleRate, 16, 0);
+            metadata->blockStart = start;
+            wrapped->metadata = metadata;
+            auto outputData = eq.process(std::move(wrapped));
+            const auto outputs = extractData<WAV_AudioBuffer>(outputData);
+            ASSERT_EQ(outputs->size(), inputs.size());
+            for (std::size_t i = 0; i < inputs.size(); ++i) {
+                appendFrames(streamed[i], outputs->at(i));
+            }
+        }
+
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            ParametricEQ alone("EQ", bands);
+            std::vector<audio_sample_t> expected;
+            appendFrames(expected, runAudioNode(alone, inputs[i], sampleRate));
+            EXPECT_EQ(streamed[i], expected) << "stream " << i;
+        }
+    }
+
+    {
+        // Band changes take effect on the next run
+        const WAV_AudioBuffer tone = makeTone(1, 24000, 1000.0);
+        ParametricEQ eq("EQ", {EQ_Band::peaking(1000.0, 2.0, 0.0)});
+        EXPECT_NEAR(gain(runAudioNode(eq, tone, sampleRate), tone, 0), 1.0, 0.01);
+        eq.setBand(0, EQ_Band::peaking(1000.0, 2.0, 12.0));
+        EXPECT_NEAR(gain(runAudioNode(eq, tone, sampleRate), tone, 0), std::pow(10.0, 12.0 / 20.0), 0.05);
+        EXPECT_THROW(eq.setBand(1, EQ_Band()), InvalidOperation);
+
+        ParametricEQ invalid("EQ", {EQ_Band::lowPass(30000.0, 0.7071)});
+        EXPECT_THROW(runAudioNode(invalid, tone, sampleRate), PipeXException);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, FFT) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: FFT" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    for (const std::size_t n : {2, 4, 8, 16, 32, 64, 512, 2048}) {
+        std::vector<float> signal(n);
+        std::uint32_t seed = static_cast<std::uint32_t>(n);
+        for (auto& sample : signal) {
+            seed = seed * 1664525u + 1013904223u;
+            sample = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+        }
+
+        const auto plan = FFT::plan(n);
+        ASSERT_EQ(plan->size(), n);
+        ASSERT_EQ(plan->bins(), n / 2 + 1);
+        std::vector<float> re(plan->bins()), im(plan->bins());
+        plan->forward(signal.data(), re.data(), im.data());
+
+        // Naive DFT in double
+        const double tolerance = 1e-6 * static_cast<double>(n);
+        for (std::size_t k = 0; k < plan->bins(); ++k) {
+            double sumRe = 0.0, sumIm = 0.0;
+            for (std::size_t j = 0; j < n; ++j) {
+                const double angle = -2.0 * M_PI * static_cast<double>((j * k) % n) / static_cast<double>(n);
+                sumRe += signal[j] * std::cos(angle);
+                sumIm += signal[j] * std::sin(angle);
+            }
+            ASSERT_NEAR(re[k], sumRe, tolerance) << "n " << n << ", bin " << k;
+            ASSERT_NEAR(im[k], sumIm, tolerance) << "n " << n << ", bin " << k;
+        }
+
+        std::vector<float> roundTrip(n);
+        plan->inverse(re.data(), im.data(), roundTrip.data());
+        for (std::size_t j = 0; j < n; ++j) {
+            ASSERT_NEAR(roundTrip[j], signal[j], 1e-6) << "n " << n << ", sample " << j;
+        }
+    }
+
+    // Plans are cached by size, for every thread
+    const auto plan = FFT::plan(1024);
+    EXPECT_EQ(FFT::plan(1024), plan);
+    EXPECT_NE(FFT::plan(256), plan);
+    std::vector<std::shared_ptr<const FFT>> plans(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < plans.size(); ++t) {
+        threads.emplace_back([&plans, t] { plans[t] = FFT::plan(1024); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& p : plans) {
+        EXPECT_EQ(p, plan);
+    }
+
+    EXPECT_THROW(FFT(0), InvalidOperation);
+    EXPECT_THROW(FFT(1), InvalidOperation);
+    EXPECT_THROW(FFT::plan(1000), InvalidOperation);
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, SpectralAnalysis) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: SpectralAnalysis" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    constexpr uint32_t sampleRate = 48000;
+    constexpr std::size_t fftSize = 1024;
+    constexpr std::size_t hopSize = 256;
+    // Tones centered on bins 32 (1500 Hz) and 128 (6000 Hz), one per channel
+    const std::size_t toneBins[2] = {32, 128};
+    WAV_AudioBuffer tones(2, 10000);
+    for (std::size_t c = 0; c < 2; ++c) {
+        const double frequency = static_cast<double>(toneBins[c]) * sampleRate / fftSize;
+        for (std::size_t n = 0; n < tones.numFrames; ++n) {
+            tones.at(c, n) = static_cast<float>(0.5 * std::sin(2.0 * M_PI * frequency * static_cast<double>(n) / sampleRate));
+        }
+    }
+
+    STFT stft("STFT", fftSize, hopSize);
+    MagnitudeSpectrum magnitude("Magnitude");
+    auto spectrumData = magnitude.process(stft.process(wrapAudio(tones, sampleRate)));
+    const Spectrogram spectrum = extractData<Spectrogram>(spectrumData)->at(0);
+
+    ASSERT_EQ(spectrum.numChannels, 2u);
+    ASSERT_EQ(spectrum.numFrames, 1 + (tones.numFrames - fftSize + hopSize - 1) / hopSize);
+    ASSERT_EQ(spectrum.numBins, fftSize / 2 + 1);
+    EXPECT_EQ(spectrum.sampleRate, sampleRate);
+    EXPECT_DOUBLE_EQ(spectrum.binFrequency(toneBins[0]), 1500.0);
+
+    for (std::size_t c = 0; c < 2; ++c) {
+        // Every full frame peaks on the bin of the tone: 0.5 * sum(hann) / 2 = fftSize / 8 with the Hann window
+        for (std::size_t t = 0; t + 1 < spectrum.numFrames; ++t) {
+            const float* bins = spectrum.frame(c, t);
+            const std::size_t peak = static_cast<std::size_t>(std::max_element(bins, bins + spectrum.numBins) - bins);
+            ASSERT_EQ(peak, toneBins[c]) << "channel " << c << ", frame " << t;
+            ASSERT_NEAR(bins[peak], fftSize / 8.0, 1e-2 * fftSize);
+        }
+    }
+
+    {
+        // Frames span the blocks of a stream: blocks smaller than fftSize give the frames of the whole stream, each
+        // stream of the batch with its own samples
+        auto wholeData = stft.process(wrapAudio(tones, sampleRate));
+        const ComplexSpectrogram whole = extractData<ComplexSpectrogram>(wholeData)->at(0);
+        WAV_AudioBuffer reversed(2, tones.numFrames);
+        for (std::size_t c = 0; c < 2; ++c) {
+            std::reverse_copy(tones.channel(c), tones.channel(c) + tones.numFrames, reversed.channel(c));
+        }
+        auto reversedData = stft.process(wrapAudio(reversed, sampleRate));
+        const ComplexSpectrogram wholeReversed = extractData<ComplexSpectrogram>(reversedData)->at(0);
+
+        STFT streaming("STFT", fftSize, hopSize);
+        std::size_t frames = 0;
+        for (std::size_t start = 0; start < tones.numFrames; start += 300) {
+            const std::size_t count = std::min<std::size_t>(300, tones.numFrames - start);
+            std::vector<WAV_AudioBuffer> batch(2, WAV_AudioBuffer(2, count));
+            for (std::size_t c = 0; c < 2; ++c) {
+                std::copy(tones.channel(c) + start, tones.channel(c) + start + count, batch[0].channel(c));
+                std::copy(reversed.channel(c) + start, reversed.channel(c) + start + count, batch[1].channel(c));
+            }
+            auto wrapped = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(std::move(batch)));
+            auto metadata = std::make_shared<WAV_Metadata>();
+            metadata->setParameters(2, sampleRate, 16, 0);
+            metadata->numSamples = static_cast<uint32_t>(tones.numFrames);
+            metadata->blockStart = static_cast<uint32_t>(start);
+            wrapped->metadata = metadata;
+            auto outputData = streaming.process(std::move(wrapped));
+            const auto outputs = extractData<ComplexSpectrogram>(outputData);
+            ASSERT_EQ(outputs->size(), 2u);
+            if (start == 0) {
+                EXPECT_EQ(outputs->at(0).numFrames, 0u);
+            }
+            ASSERT_EQ(outputs->at(1).numFrames, outputs->at(0).numFrames);
+            ASSERT_LE(frames + outputs->at(0).numFrames, whole.numFrames);
+            for (std::size_t c = 0; c < 2; ++c) {
+                for (std::size_t t = 0; t < outputs->at(0).numFrames; ++t) {
+                    ASSERT_TRUE(std::equal(whole.real(c, frames + t), whole.real(c, frames + t) + whole.numBins, outputs->at(0).real(c, t))) << "frame " << frames + t;
+                    ASSERT_TRUE(std::equal(whole.imag(c, frames + t), whole.imag(c, frames + t) + whole.numBins, outputs->at(0).imag(c, t))) << "frame " << frames + t;
+                    ASSERT_TRUE(std::equal(wholeReversed.real(c, frames + t), wholeReversed.real(c, frames + t) + whole.numBins, outputs->at(1).real(c, t)))
+                        << "frame " << frames + t;
+                }
+            }
+            frames += outputs->at(0).numFrames;
+        }
+        EXPECT_EQ(frames, whole.numFrames);
+    }
+
+    {
+        // Centroid and rolloff of a tone are its frequency (the Hann window spreads it on the 2 neighbouring bins)
+        SpectralShape shape("Shape", 0.85);
+        auto featuresData = shape.process(magnitude.process(stft.process(wrapAudio(tones, sampleRate))));
+        const SpectralFeatures features = extractData<SpectralFeatures>(featuresData)->at(0);
+        ASSERT_EQ(features.names, (std::vector<std::string>{"centroid", "rolloff"}));
+        for (std::size_t c = 0; c < 2; ++c) {
+            const double frequency = spectrum.binFrequency(toneBins[c]);
+            const double binWidth = static_cast<double>(sampleRate) / fftSize;
+            for (std::size_t t = 0; t + 1 < features.numFrames; ++t) {
+                EXPECT_NEAR(features.frame(c, t)[0], frequency, 0.05 * binWidth);
+                EXPECT_NEAR(features.frame(c, t)[1], frequency, binWidth + 1e-3);
+            }
+        }
+
+        // Silence has no centroid
+        auto silenceData = shape.process(magnitude.process(stft.process(wrapAudio(WAV_AudioBuffer(1, 100), sampleRate))));
+        const SpectralFeatures silence = extractData<SpectralFeatures>(silenceData)->at(0);
+        ASSERT_EQ(silence.numFrames, 1u);
+        EXPECT_EQ(silence.frame(0, 0)[0], 0.0f);
+        EXPECT_EQ(silence.frame(0, 0)[1], 0.0f);
+    }
+
+    {
+        // The power of each tone falls in its band, whatever the scale of the spectrum
+        BandEnergy bands("Bands", {0.0, 1000.0, 4000.0, 24000.0});
+        ASSERT_THROW(BandEnergy("Invalid", {1000.0}), InvalidOperation);
+        ASSERT_THROW(BandEnergy("Invalid", {1000.0, 500.0}), InvalidOperation);
+
+        std::vector<SpectralFeatures> results;
+        for (const auto scale : {SpectrumScale::Magnitude, SpectrumScale::Power, SpectrumScale::Decibels}) {
+            MagnitudeSpectrum scaled("Scaled", scale);
+            auto energyData = bands.process(scaled.process(stft.process(wrapAudio(tones, sampleRate))));
+            results.push_back(extractData<SpectralFeatures>(energyData)->at(0));
+        }
+
+        const SpectralFeatures& energy = results[0];
+        ASSERT_EQ(energy.names, (std::vector<std::string>{"0-1000Hz", "1000-4000Hz", "4000-24000Hz"}));
+        const std::size_t expectedBand[2] = {1, 2};
+        for (std::size_t c = 0; c < 2; ++c) {
+            const float* frame = energy.frame(c, 0);
+            const float total = frame[0] + frame[1] + frame[2];
+            EXPECT_GT(frame[expectedBand[c]], 0.999f * total) << "channel " << c;
+            for (std::size_t s = 1; s < results.size(); ++s) {
+                for (std::size_t b = 0; b < 3; ++b) {
+                    EXPECT_NEAR(results[s].frame(c, 0)[b], frame[b], 1e-3 * total) << "scale " << s << ", band " << b;
+                }
+            }
+        }
+    }
+
+    EXPECT_THROW(STFT("Invalid", 1000, 256), InvalidOperation);
+    EXPECT_THROW(STFT("Invalid", 1024, 0), InvalidOperation);
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, PartitionedConvolution) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: PartitionedConvolution" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    constexpr uint32_t sampleRate = 48000;
+    std::uint32_t seed = 2024;
+    const auto makeNoise = [&seed](const std::size_t numChannels, const std::size_t numFrames, const float amplitude) {
+        WAV_AudioBuffer noise(numChannels, numFrames);
+        for (auto& sample : noise.samples) {
+            seed = seed * 1664525u + 1013904223u;
+            sample = amplitude * (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f);
+        }
+        return noise;
+    };
+    // Direct convolution in double, truncated to the length of the input
+    const auto reference = [](const WAV_AudioBuffer& audio, const WAV_AudioBuffer& ir) {
+        WAV_AudioBuffer out(audio.numChannels, audio.numFrames);
+        for (std::size_t c = 0; c < audio.numChannels; ++c) {
+            const std::size_t h = ir.numChannels == 1 ? 0 : c;
+            for (std::size_t n = 0; n < audio.numFrames; ++n) {
+                double sum = 0.0;
+                for (std::size_t k = 0; k < ir.numFrames && k <= n; ++k) {
+                    sum += static_cast<double>(ir.at(h, k)) * audio.at(c, n - k);
+                }
+                out.at(c, n) = static_cast<float>(sum);
+            }
+        }
+        return out;
+    };
+    const auto expectNear = [](const WAV_AudioBuffer& output, const WAV_AudioBuffer& expected, const double tolerance) {
+        ASSERT_EQ(output.numChannels, expected.numChannels);
+        ASSERT_EQ(output.numFrames, expected.numFrames);
+        for (std::size_t c = 0; c < expected.numChannels; ++c) {
+            for (std::size_t n = 0; n < expected.numFrames; ++n) {
+                ASSERT_NEAR(output.at(c, n), expected.at(c, n), tolerance) << "channel " << c << ", frame " << n;
+            }
+        }
+    };
+
+    const WAV_AudioBuffer input = makeNoise(2, 6000, 1.0f);
+    {
+        // Impulse responses shorter than, equal to and longer than a partition, mono and stereo
+        for (const std::size_t irFrames : {1, 37, 128, 1000}) {
+            for (const std::size_t irChannels : {1, 2}) {
+                WAV_AudioBuffer ir = makeNoise(irChannels, irFrames, 0.2f);
+                PartitionedConvolution convolution("Convolution", ir, 128);
+                ASSERT_EQ(convolution.partitions(), (irFrames + 127) / 128);
+                expectNear(runAudioNode(convolution, input, sampleRate), reference(input, ir), 2e-4);
+            }
+        }
+
+        // A unit impulse delayed by 300 samples delays the signal
+        WAV_AudioBuffer delay(1, 301);
+        delay.at(0, 300) = 1.0f;
+        PartitionedConvolution convolution("Delay", delay, 64);
+        const WAV_AudioBuffer output = runAudioNode(convolution, input, sampleRate);
+        for (std::size_t n = 0; n < input.numFrames; ++n) {
+            ASSERT_NEAR(output.at(1, n), n < 300 ? 0.0f : input.at(1, n - 300), 1e-5);
+        }
+    }
+
+    const WAV_AudioBuffer ir = makeNoise(1, 2500, 0.1f);
+    const WAV_AudioBuffer expected = reference(input, ir);
+    {
+        // Blocks of any size, aligned or not to the partitions, are convolved as a single stream
+        PartitionedConvolution convolution("Convolution", ir, 256);
+        WAV_AudioBuffer streamed(input.numChannels, 0);
+        std::vector<audio_sample_t> frames;
+        const std::size_t blockSizes[] = {1, 255, 256, 700, 31, 1024, 2000};
+        std::size_t start = 0;
+        for (std::size_t b = 0; start < input.numFrames; ++b) {
+            const std::size_t count = std::min(blockSizes[b % 7], input.numFrames - start);
+            WAV_AudioBuffer block(input.numChannels, count);
+            for (std::size_t c = 0; c < input.numChannels; ++c) {
+                std::copy(input.channel(c) + start, input.channel(c) + start + count, block.channel(c));
+            }
+            appendFrames(frames, runAudioNode(convolution, block, sampleRate, static_cast<uint32_t>(start)));
+            start += count;
+        }
+        expectNear(toPlanar(frames, input.numChannels), expected, 2e-4);
+
+        // A new stream restarts from silence
+        expectNear(runAudioNode(convolution, input, sampleRate), expected, 2e-4);
+    }
+
+    {
+        // The streams of a batch have their own state
+        PartitionedConvolution convolution("Convolution", ir, 512);
+        const WAV_AudioBuffer other = makeNoise(2, input.numFrames, 0.5f);
+        const WAV_AudioBuffer expectedOther = reference(other, ir);
+        for (uint32_t start = 0; start < input.numFrames; start += 1500) {
+            std::vector<WAV_AudioBuffer> batch(2, WAV_AudioBuffer(2, 1500));
+            for (std::size_t c = 0; c < 2; ++c) {
+                std::copy(input.channel(c) + start, input.channel(c) + start + 1500, batch[0].channel(c));
+                std::copy(other.channel(c) + start, other.channel(c) + start + 1500, batch[1].channel(c));
+            }
+            auto wrapped = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(std::move(batch)));
+            auto metadata = std::make_shared<WAV_Metadata>();
+            metadata->setParameters(2, sampleRate, 16, 0);
+            metadata->blockStart = start;
+            wrapped->metadata = metadata;
+            auto outputData = convolution.process(std::move(wrapped));
+            const auto outputs = extractData<WAV_AudioBuffer>(outputData);
+            for (std::size_t c = 0; c < 2; ++c) {
+                for (std::size_t n = 0; n < 1500; n += 7) {
+                    ASSERT_NEAR(outputs->at(0).at(c, n), expected.at(c, start + n), 2e-4);
+                    ASSERT_NEAR(outputs->at(1).at(c, n), expectedOther.at(c, start + n), 2e-4);
+                }
+            }
+        }
+    }
+
+    {
+        // Impulse response read from a WAV file, with its sample rate
+        const TemporaryDirectory directory;
+        const std::vector<bit_depth_t> pcm = makeRamp(400, 16);
+        writeWAVFile(directory.path("ir.wav"), pcm, 1, sampleRate, 16);
+        WAV_AudioBuffer irFromFile(1, pcm.size());
+        const std::vector<audio_sample_t> samples = toFloat(pcm, 16);
+        std::copy(samples.begin(), samples.end(), irFromFile.data());
+
+        PartitionedConvolution convolution("FileIR", directory.path("ir.wav"), 128);
+        EXPECT_EQ(convolution.impulseResponseChannels(), 1u);
+        const WAV_AudioBuffer shortInput = makeNoise(1, 1000, 0.1f);
+        expectNear(runAudioNode(convolution, shortInput, sampleRate), reference(shortInput, irFromFile), 2e-4);
+        EXPECT_THROW(runAudioNode(convolution, shortInput, 44100), PipeXException);
+        EXPECT_THROW(PartitionedConvolution("Missing", directory.path("missing_ir.wav")), PipeXException);
+    }
+
+    EXPECT_THROW(PartitionedConvolution("Invalid", WAV_AudioBuffer(1, 0)), InvalidOperation);
+    EXPECT_THROW(PartitionedConvolution("Invalid", ir, 100), InvalidOperation);
+    PartitionedConvolution stereo("Stereo", makeNoise(2, 10, 1.0f), 64);
+    EXPECT_THROW(runAudioNode(stereo, makeNoise(3, 100, 1.0f), sampleRate), PipeXException);
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, Resampler) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: Resampler" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const auto makeTone = [](const std::size_t numChannels, const std::size_t numFrames, const double frequency, const double sampleRate) {
+        WAV_AudioBuffer tone(numChannels, numFrames);
+        for (std::size_t c = 0; c < numChannels; ++c) {
+            for (std::size_t n = 0; n < numFrames; ++n) {
+                tone.at(c, n) = static_cast<float>(0.5 * std::sin(2.0 * M_PI * frequency * static_cast<double>(n) / sampleRate + static_cast<double>(c)));
+            }
+        }
+        return tone;
+    };
+    // Largest error against the tone at the output rate, away from the edges of the stream
+    const auto toneError = [](const WAV_AudioBuffer& output, const double frequency, const double sampleRate) {
+        double error = 0.0;
+        for (std::size_t c = 0; c < output.numChannels; ++c) {
+            for (std::size_t n = 200; n + 200 < output.numFrames; ++n) {
+                const double expected = 0.5 * std::sin(2.0 * M_PI * frequency * static_cast<double>(n) / sampleRate + static_cast<double>(c));
+                error = std::max(error, std::abs(output.at(c, n) - expected));
+            }
+        }
+        return error;
+    };
+    const auto resample = [](Resampler& resampler, const WAV_AudioBuffer& audio, const uint32_t sampleRate, WAV_Metadata& metadata,
+                             const uint32_t blockStart = 0, const uint32_t numSamples = 0) {
+        auto outputData = resampler.process(wrapAudio(audio, sampleRate, blockStart, numSamples));
+        metadata = *std::dynamic_pointer_cast<WAV_Metadata>(outputData->metadata);
+        return std::move(extractData<WAV_AudioBuffer>(outputData)->at(0));
+    };
+
+    WAV_Metadata metadata;
+    const WAV_AudioBuffer tone = makeTone(2, 8820, 1000.0, 44100);
+    {
+        // 44.1 kHz -> 48 kHz (160 / 147): the tone is preserved and aligned, the metadata describes the output
+        double previousError = 1.0;
+        for (const auto quality : {ResamplerQuality::Fast, ResamplerQuality::Medium, ResamplerQuality::High}) {
+            Resampler resampler("Resampler", 48000, quality);
+            const WAV_AudioBuffer output = resample(resampler, tone, 44100, metadata);
+            ASSERT_EQ(output.numChannels, 2u);
+            ASSERT_EQ(output.numFrames, 9600u);
+            const double error = toneError(output, 1000.0, 48000);
+            EXPECT_LT(error, 2e-3);
+            EXPECT_LE(error, previousError);
+            previousError = error;
+        }
+        EXPECT_EQ(metadata.sampleRate, 48000u);
+        EXPECT_EQ(metadata.numSamples, 9600u);
+        EXPECT_EQ(metadata.blockStart, 0u);
+        EXPECT_EQ(metadata.byteRate, 48000u * 4);
+        EXPECT_EQ(metadata.dataSize, 9600u * 4);
+        EXPECT_EQ(metadata.riffSize, 36 + metadata.dataSize);
+    }
+
+    {
+        // 48 kHz -> 16 kHz: 1 kHz passes, 10 kHz (above the new Nyquist frequency) is filtered out
+        Resampler resampler("Downsampler", 16000, ResamplerQuality::Fast);
+        const WAV_AudioBuffer low = resample(resampler, makeTone(1, 9600, 1000.0, 48000), 48000, metadata);
+        ASSERT_EQ(low.numFrames, 3200u);
+        EXPECT_LT(toneError(low, 1000.0, 16000), 5e-3);
+
+        const WAV_AudioBuffer high = resample(resampler, makeTone(1, 9600, 10000.0, 48000), 48000, metadata);
+        float peak = 0.0f;
+        for (std::size_t n = 200; n + 200 < high.numFrames; ++n) {
+            peak = std::max(peak, std::abs(high.at(0, n)));
+        }
+        EXPECT_LT(peak, 0.5f * 1e-3f);
+    }
+
+    {
+        // A stream in blocks gives the samples of the whole stream, the output blocks following each other
+        Resampler resampler("Resampler", 48000, ResamplerQuality::Medium);
+        const WAV_AudioBuffer whole = resample(resampler, tone, 44100, metadata);
+
+        std::vector<audio_sample_t> streamed;
+        const std::size_t blockSizes[] = {7, 1000, 441, 2048, 1};
+        std::size_t start = 0;
+        std::size_t emitted = 0;
+        for (std::size_t b = 0; start < tone.numFrames; ++b) {
+            const std::size_t count = std::min(blockSizes[b % 5], tone.numFrames - start);
+            WAV_AudioBuffer block(tone.numChannels, count);
+            for (std::size_t c = 0; c < tone.numChannels; ++c) {
+                std::copy(tone.channel(c) + start, tone.channel(c) + start + count, block.channel(c));
+            }
+            const WAV_AudioBuffer output = resample(resampler, block, 44100, metadata, static_cast<uint32_t>(start), static_cast<uint32_t>(tone.numFrames));
+            EXPECT_EQ(metadata.blockStart, emitted);
+            EXPECT_EQ(metadata.numSamples, 9600u);
+            emitted += output.numFrames;
+            appendFrames(streamed, output);
+            start += count;
+        }
+        std::vector<audio_sample_t> expected;
+        appendFrames(expected, whole);
+        EXPECT_EQ(streamed, expected);
+
+        // Metadata without a length (numSamples == 0): the buffer is the whole stream, its tail is flushed
+        auto wrapped = wrapAudio(tone, 44100);
+        std::dynamic_pointer_cast<WAV_Metadata>(wrapped->metadata)->numSamples = 0;
+        auto outputData = resampler.process(std::move(wrapped));
+        EXPECT_EQ(extractData<WAV_AudioBuffer>(outputData)->at(0), whole);
+    }
+
+    {
+        // The streams of a batch have their own state
+        const WAV_AudioBuffer other = makeTone(2, tone.numFrames, 3000.0, 44100);
+        Resampler resampler("Resampler", 48000, ResamplerQuality::Medium);
+        std::vector<audio_sample_t> expected[2];
+        appendFrames(expected[0], resample(resampler, tone, 44100, metadata));
+        appendFrames(expected[1], resample(resampler, other, 44100, metadata));
+
+        std::vector<audio_sample_t> streamed[2];
+        for (uint32_t start = 0; start < tone.numFrames; start += 2205) {
+            std::vector<WAV_AudioBuffer> batch(2, WAV_AudioBuffer(2, 2205));
+            for (std::size_t c = 0; c < 2; ++c) {
+                std::copy(tone.channel(c) + start, tone.channel(c) + start + 2205, batch[0].channel(c));
+                std::copy(other.channel(c) + start, other.channel(c) + start + 2205, batch[1].channel(c));
+            }
+            auto wrapped = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(std::move(batch)));
+            auto inputMetadata = std::make_shared<WAV_Metadata>();
+            inputMetadata->setParameters(2, 44100, 16, 0);
+            inputMetadata->numSamples = static_cast<uint32_t>(tone.numFrames);
+            inputMetadata->blockStart = start;
+            wrapped->metadata = inputMetadata;
+            auto outputData = resampler.process(std::move(wrapped));
+            const auto outputs = extractData<WAV_AudioBuffer>(outputData);
+            ASSERT_EQ(outputs->size(), 2u);
+            EXPECT_EQ(outputs->at(0).numFrames, outputs->at(1).numFrames);
+            appendFrames(streamed[0], outputs->at(0));
+            appendFrames(streamed[1], outputs->at(1));
+        }
+        EXPECT_EQ(streamed[0], expected[0]);
+        EXPECT_EQ(streamed[1], expected[1]);
+    }
+
+    {
+        // Same rate: unchanged
+        Resampler resampler("Identity", 44100);
+        EXPECT_EQ(resample(resampler, tone, 44100, metadata), tone);
+        EXPECT_EQ(metadata.sampleRate, 44100u);
+        EXPECT_EQ(metadata.numSamples, tone.numFrames);
+    }
+
+    EXPECT_THROW(Resampler("Invalid", 0), InvalidOperation);
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(AudioNodeTest, RealTimeBlocks) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "AudioNodeTest test: RealTimeBlocks" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const TemporaryDirectory directory;
+
+    constexpr uint32_t sampleRate = 48000;
+    constexpr std::size_t numFrames = 10000;
+    WAV_AudioBuffer tone(2, numFrames);
+    for (std::size_t c = 0; c < tone.numChannels; ++c) {
+        for (std::size_t n = 0; n < numFrames; ++n) {
+            tone.at(c, n) = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 997.0 * static_cast<double>(n) / sampleRate + static_cast<double>(c)));
+        }
+    }
+
+    {
+        // The bell curve keeps its filter state across the blocks of a stream
+        EQ_BellCurve eq("EQ", 1000.0, 0.7, 6.0);
+        std::vector<audio_sample_t> whole;
+        appendFrames(whole, runAudioNode(eq, tone, sampleRate));
+
+        std::vector<audio_sample_t> streamed;
+        for (std::size_t start = 0; start < numFrames; start += 256) {
+            const std::size_t count = std::min<std::size_t>(256, numFrames - start);
+            WAV_AudioBuffer block(tone.numChannels, count);
+            for (std::size_t c = 0; c < tone.numChannels; ++c) {
+                std::copy(tone.channel(c) + start, tone.channel(c) + start + count, block.channel(c));
+            }
+            appendFrames(streamed, runAudioNode(eq, block, sampleRate, static_cast<uint32_t>(start)));
+        }
+        EXPECT_EQ(streamed, whole);
+    }
+
+    {
+        // The streams of a batch keep their own filter state
+        WAV_AudioBuffer other(1, numFrames);
+        for (std::size_t n = 0; n < numFrames; ++n) {
+            other.at(0, n) = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 3000.0 * static_cast<double>(n) / sampleRate));
+        }
+        EQ_BellCurve alone("EQ", 1000.0, 0.7, 6.0);
+        std::vector<audio_sample_t> expected[2];
+        appendFrames(expected[0], runAudioNode(alone, tone, sampleRate));
+        appendFrames(expected[1], runAudioNode(alone, other, sampleRate));
+
+        EQ_BellCurve eq("EQ", 1000.0, 0.7, 6.0);
+        std::vector<audio_sample_t> streamed[2];
+        for (std::size_t start = 0; start < numFrames; start += 256) {
+            const std::size_t count = std::min<std::size_t>(256, numFrames - start);
+            std::vector<WAV_AudioBuffer> batch;
+            batch.emplace_back(tone.numChannels, count);
+            batch.emplace_back(1, count);
+            for (std::size_t c = 0; c < tone.numChannels; ++c) {
+                std::copy(tone.channel(c) + start, tone.channel(c) + start + count, batch[0].channel(c));
+            }
+            std::copy(other.channel(0) + start, other.channel(0) + start + count, batch[1].channel(0));
+
+            auto wrapped = wrapData<WAV_AudioBuffer>(extended_std::make_unique<std::vector<WAV_AudioBuffer>>(std::move(batch)));
+            auto metadata = std::make_shared<WAV_Metadata>();
+            metadata->setParameters(2, sampleRate, 16, 0);
+            metadata->blockStart = static_cast<uint32_t>(start);
+            wrapped->metadata = metadata;
+            auto outputData = eq.process(std::move(wrapped));
+            const auto outputs = extractData<WAV_AudioBuffer>(outputData);
+            appendFrames(streamed[0], outputs->at(0));
+            appendFrames(streamed[1], outputs->at(1));
+        }
+        EXPECT_EQ(streamed[0], expected[0]);
+        EXPECT_EQ(streamed[1], expected[1]);
+    }
+
+    {
+        // Blocks of 256 frames timed against their duration, the output equal to the processing of the whole file
+        std::vector<bit_depth_t> pcm;
+        for (std::size_t n = 0; n < numFrames; ++n) {
+            for (std::size_t c = 0; c < tone.numChannels; ++c) {
+                pcm.push_back(static_cast<bit_depth_t>(std::lround(tone.at(c, n) * 32767.0f)));
+            }
+        }
+        writeWAVFile(directory.path("test_realtime_in.wav"), pcm, 2, sampleRate, 16);
+        const auto readFile = [](const std::string& filename) {
+            std::ifstream file(filename, std::ios::binary);
+            return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        };
+
+        const auto makePipeline = [&directory](const std::size_t blockFrames, const std::string& output) {
+            Pipeline pipeline("Real-time");
+            pipeline.addNode<WAV_Audio_Source>("Source", directory.path("test_realtime_in.wav"), blockFrames)
+                    .addNode<EQ_BellCurve>("EQ", 1000.0, 0.7, 6.0)
+                    .addNode<AmplitudeModulation>("AM", 5.0, 0.5)
+                    .addNode<WAV_Sound_Sink>("Sink", output);
+            return pipeline;
+        };
+
+        Pipeline whole = makePipeline(0, directory.path("test_realtime_whole"));
+        whole.run();
+        EXPECT_EQ(whole.getBlockTimingReport().blocks, 0u);
+
+        Pipeline pipeline = makePipeline(256, directory.path("test_realtime_blocks"));
+        pipeline.setRealTimeMode(true, 1e6);
+        EXPECT_TRUE(pipeline.isRealTimeMode());
+        pipeline.run();
+        const std::size_t blocks = (numFrames + 255) / 256;
+        BlockTimingReport report = pipeline.getBlockTimingReport();
+        EXPECT_EQ(report.blocks, blocks);
+        EXPECT_EQ(report.deadlineMisses, 0u);
+        EXPECT_NEAR(report.deadlineSeconds, 1e6 * numFrames / sampleRate, 1e-3);
+        EXPECT_GT(report.totalSeconds, 0.0);
+        EXPECT_LE(report.worstSeconds, report.totalSeconds);
+        EXPECT_LT(report.worstLoad, 1.0);
+
+        // Every block misses a budget no block can meet; the report restarts with each run
+        pipeline.setRealTimeMode(true, 1e-12);
+        pipeline.run();
+        report = pipeline.getBlockTimingReport();
+        EXPECT_EQ(report.blocks, blocks);
+        EXPECT_EQ(report.deadlineMisses, blocks);
+        EXPECT_GT(report.worstLoad, 1.0);
+
+        // The modulator may round differently at block boundaries: equal within one least significant bit
+        const auto decode = [&readFile](const std::string& filename) {
+            const auto bytes = readFile(filename);
+            const WAV::Layout layout = WAV::parse(bytes.data(), bytes.size());
+            std::vector<audio_sample_t> samples(layout.numFrames() * layout.numChannels);
+            WAV::decode(bytes.data() + layout.dataOffset, samples.size(), layout.bitsPerSample, samples.data());
+            return samples;
+        };
+        const std::vector<audio_sample_t> streamed = decode(directory.path("test_realtime_blocks_0.wav"));
+        const std::vector<audio_sample_t> expected = decode(directory.path("test_realtime_whole_0.wav"));
+        ASSERT_EQ(streamed.size(), numFrames * tone.numChannels);
+        ASSERT_EQ(streamed.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_NEAR(streamed[i], expected[i], 1.0f / 32768.0f) << i;
+        }
+        EXPECT_THROW(pipeline.setRealTimeMode(true, 0.0), InvalidOperation);
+
+        // The source reports the duration of the last block it produced
+        WAV_Audio_Source source("Source", directory.path("test_realtime_in.wav"), 256);
+        EXPECT_EQ(source.blockDuration(), 0.0);
+        source.process(nullptr);
+        EXPECT_DOUBLE_EQ(source.blockDuration(), 256.0 / sampleRate);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
@@ -0,0 +1,1350 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PipeX/Pipeline.h"
+#include "PipeX/errors/PipeXException.h"
+#include "PipeX/metadata/PPM_Metadata.h"
+#include "PipeX/nodes/Image/AutoLevels.h"
+#include "PipeX/nodes/Image/Color2BlackWhite.h"
+#include "PipeX/nodes/Image/ColorConversion.h"
+#include "PipeX/nodes/Image/Convolution.h"
+#include "PipeX/nodes/Image/GainExposure.h"
+#include "PipeX/nodes/Image/GaussianBlur.h"
+#include "PipeX/nodes/Image/ImagePyramid.h"
+#include "PipeX/nodes/Image/ImageROI.h"
+#include "PipeX/nodes/Image/ImageStatistics.h"
+#include "PipeX/nodes/Image/Invert.h"
+#include "PipeX/nodes/Image/Levels.h"
+#include "PipeX/nodes/Image/MedianFilter.h"
+#include "PipeX/nodes/Image/Morphology.h"
+#include "PipeX/nodes/Image/PPM_ImagePreset_Source.h"
+#include "PipeX/nodes/Image/PPM_Image_Sink.h"
+#include "PipeX/nodes/Image/PPM_Image_Source.h"
+#include "PipeX/nodes/Image/QOI_Image_Sink.h"
+#include "PipeX/nodes/Image/QOI_Image_Source.h"
+#include "PipeX/nodes/Image/Resize.h"
+#include "PipeX/nodes/Image/Sharpen.h"
+#include "PipeX/nodes/Image/TemporalFilters.h"
+#include "PipeX/nodes/primitives/Sink.h"
+#include "PipeX/utils/image_utils.h"
+#include "PipeX/utils/node_utils.h"
+#include "my_extended_cpp_standard/my_memory.h"
+#include "test_pipex_utils.h"
+
+
+using namespace PipeX;
+
+static PPM_Image makeGradient(const int width, const int height, const int max_value) {
+    PPM_Image image(height, std::vector<channelsT>(width));
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            image[j][i] = channelsT{(i * max_value) / (width - 1), (j * max_value) / (height - 1), ((i + j) * 7) % (max_value + 1)};
+        }
+    }
+    return image;
+}
+
+static std::unique_ptr<std::vector<PPM_Image>> runImageNode(INode& node, const PPM_Image& image, const int max_value) {
+    auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(1, image));
+    wrappedInput->metadata = std::make_shared<PPM_Metadata>(max_value, static_cast<int>(image[0].size()), static_cast<int>(image.size()));
+
+    auto outputData = node.process(std::move(wrappedInput));
+    return extractData<PPM_Image>(outputData);
+}
+
+static int maxDifference(const PPM_Image& a, const PPM_Image& b) {
+    int difference = 0;
+    for (std::size_t j = 0; j < a.size(); ++j) {
+        for (std::size_t i = 0; i < a[j].size(); ++i) {
+            for (int c = 0; c < 3; ++c) {
+                difference = std::max(difference, std::abs(a[j][i][c] - b[j][i][c]));
+            }
+        }
+    }
+    return difference;
+}
+
+TEST(ImageNodeTest, GainExposureLUT) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: GainExposureLUT" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr double gain = 1.5;
+        constexpr double contrast = 0.8;
+
+        // 8 and 16 bits per channel; width not multiple of the vector length, to cover the scalar tail
+        for (const int max_value : {255, 65535}) {
+            const PPM_Image input = makeGradient(37, 11, max_value);
+
+            GainExposure gainExposure("GainExposure", gain, contrast);
+            const auto output = runImageNode(gainExposure, input, max_value);
+            ASSERT_EQ(output->size(), 1u);
+
+            int maxOutput = 0;
+            for (std::size_t j = 0; j < input.size(); ++j) {
+                for (std::size_t i = 0; i < input[j].size(); ++i) {
+                    for (int c = 0; c < 3; ++c) {
+                        // Reference: direct evaluation of the sigmoid curve
+                        const double exposed = input[j][i][c] / static_cast<double>(max_value) * std::pow(2.0, gain);
+                        const double sigmoid = 1.0 / (1.0 + std::exp(-contrast * (exposed - 0.5)));
+                        const int expected = static_cast<int>(sigmoid * max_value);
+
+                        EXPECT_EQ((*output)[0][j][i][c], expected);
+                        maxOutput = std::max(maxOutput, (*output)[0][j][i][c]);
+                    }
+                }
+            }
+            // The curve spans the whole channel range, not just its lowest 8 bits
+            EXPECT_GT(maxOutput, max_value / 2);
+        }
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =========================================================================================================
+
+TEST(ImageNodeTest, PointOperationFusion) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: PointOperationFusion" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        std::vector<PPM_Image> fusedOutput;
+        std::vector<PPM_Image> referenceOutput;
+
+        auto buildPipeline = [](const std::string& name, std::vector<PPM_Image>& output) {
+            Pipeline pipeline(name);
+            pipeline.addNode<PPM_ImagePreset_Source>("Source", 67, 45, 0, 2)
+                    .addNode<GainExposure>("Gain", 1.2, 0.7)
+                    .addNode<Invert>("Invert")
+                    .addNode<Color2BlackWhite>("Gray")
+                    .addNode<Levels>("Levels", 0.1, 0.9, 1.8)
+                    .addNode<Color2BlackWhite>("Gray2")
+                    .addNode<Sink<PPM_Image, PPM_Metadata>>("Sink", [&output](std::vector<PPM_Image>& images) {
+                        output = std::move(images);
+                    });
+            return pipeline;
+        };
+
+        Pipeline fused = buildPipeline("Fused", fusedOutput);
+        Pipeline reference = buildPipeline("Reference", referenceOutput);
+        reference.setNodeFusion(false);
+
+        // A fused program supports a single luma mix: the second grayscale starts a new group
+        const std::vector<std::string> expectedPlan = {"Source", "fused(Gain + Invert + Gray + Levels)", "Gray2", "Sink"};
+        EXPECT_EQ(fused.getExecutionPlan(), expectedPlan);
+        EXPECT_EQ(reference.getExecutionPlan().size(), 7u);
+
+        fused.run();
+        reference.run();
+
+        ASSERT_EQ(fusedOutput.size(), 2u);
+        EXPECT_EQ(fusedOutput, referenceOutput);
+    }
+
+    {
+        // Copies of point operations (and of a pipeline holding them) run their own program and still fuse
+        const PPM_Image image(3, std::vector<channelsT>(4, channelsT{100, 100, 100}));
+        Invert invert("Invert");
+        Color2BlackWhite gray("Gray");
+        const auto invertCopy = invert.clone();
+        const auto grayCopy = gray.clone("GrayCopy");
+        EXPECT_EQ(grayCopy->getName(), "GrayCopy");
+        EXPECT_TRUE(invertCopy->canFuseWith(*grayCopy));
+        EXPECT_EQ((*runImageNode(*invertCopy, image, 255))[0][0][0], (channelsT{155, 155, 155}));
+        EXPECT_EQ(*runImageNode(*grayCopy, makeGradient(4, 3, 255), 255), *runImageNode(gray, makeGradient(4, 3, 255), 255));
+
+        std::vector<PPM_Image> output;
+        Pipeline original("Original");
+        original.addNode<PPM_ImagePreset_Source>("Source", 67, 45, 0, 2)
+                .addNode<Invert>("Invert")
+                .addNode<Color2BlackWhite>("Gray")
+                .addNode<Sink<PPM_Image, PPM_Metadata>>("Sink", [&output](std::vector<PPM_Image>& images) {
+                    output = std::move(images);
+                });
+        Pipeline copied(original);
+        EXPECT_EQ(copied.getExecutionPlan().size(), 3u);
+        copied.run();
+        const std::vector<PPM_Image> copiedOutput = output;
+        original.run();
+        ASSERT_EQ(copiedOutput.size(), 2u);
+        EXPECT_EQ(copiedOutput, output);
+        EXPECT_NE(copiedOutput[0][0][0], (channelsT{0, 0, 0}));
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =========================================================================================================
+
+TEST(ImageNodeTest, ImageTiling) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ImageTiling" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr int width = 300;
+        constexpr int height = 70;
+        const TilingOptions options(128, 32, 3);
+
+        // Every pixel must belong to exactly one tile core, and halos must stay inside the image
+        std::vector<int> coverage(width * height, 0);
+        for (const auto& tile : ImageTiling::makeTiles(width, height, options)) {
+            EXPECT_GE(tile.haloX0, 0);
+            EXPECT_GE(tile.haloY0, 0);
+            EXPECT_LE(tile.haloX0 + tile.haloWidth, width);
+            EXPECT_LE(tile.haloY0 + tile.haloHeight, height);
+            EXPECT_LE(tile.haloX0, tile.x0);
+            EXPECT_GE(tile.haloX0 + tile.haloWidth, tile.x0 + tile.width);
+
+            for (int y = tile.y0; y < tile.y0 + tile.height; ++y) {
+                for (int x = tile.x0; x < tile.x0 + tile.width; ++x) {
+                    coverage[y * width + x]++;
+                }
+            }
+        }
+        EXPECT_TRUE(std::all_of(coverage.begin(), coverage.end(), [](const int count) { return count == 1; }));
+
+        // Tiled (parallel) point operation must match the single-tile result
+        const PPM_Image input = makeGradient(width, height, 255);
+
+        GainExposure tiled("Tiled", 0.8, 1.3);
+        tiled.setTilingOptions(TilingOptions(16, 8));
+        GainExposure untiled("Untiled", 0.8, 1.3);
+        untiled.setTilingOptions(TilingOptions(0, 0));
+
+        EXPECT_EQ(*runImageNode(tiled, input, 255), *runImageNode(untiled, input, 255));
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, Convolution) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: Convolution" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr int width = 45;
+        constexpr int height = 30;
+        PPM_Image input = makeGradient(width, height, 255);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                input[y][x][2] = (x * 37 + y * 91) % 256; // Some high frequency content
+            }
+        }
+
+        // Direct 2D correlation, used as reference
+        const auto reference = [&input](const Convolution::Kernel& kernel, const BorderMode border) {
+            const int ry = static_cast<int>(kernel.size() / 2);
+            const int rx = static_cast<int>(kernel[0].size() / 2);
+            PPM_Image output = input;
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        double sum = 0.0;
+                        for (int ky = -ry; ky <= ry; ++ky) {
+                            for (int kx = -rx; kx <= rx; ++kx) {
+                                const int sy = borderIndex(y + ky, height, border);
+                                const int sx = borderIndex(x + kx, width, border);
+                                if (sy >= 0 && sx >= 0) {
+                                    sum += kernel[ky + ry][kx + rx] * input[sy][sx][c];
+                                }
+                            }
+                        }
+                        output[y][x][c] = std::min(255, std::max(0, static_cast<int>(std::lround(sum))));
+                    }
+                }
+            }
+            return output;
+        };
+
+        const auto maxDifference = [](const PPM_Image& a, const PPM_Image& b) {
+            int diff = 0;
+            for (std::size_t y = 0; y < a.size(); ++y) {
+                for (std::size_t x = 0; x < a[y].size(); ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        diff = std::max(diff, std::abs(a[y][x][c] - b[y][x][c]));
+                    }
+                }
+            }
+            return diff;
+        };
+
+        const Convolution::Kernel separable = {{1.0 / 16, 2.0 / 16, 1.0 / 16},
+                                               {2.0 / 16, 4.0 / 16, 2.0 / 16},
+                                               {1.0 / 16, 2.0 / 16, 1.0 / 16}};
+        const Convolution::Kernel nonSeparable = {{0.0, 0.0, -1.0, 0.0, 0.0},
+                                                  {0.0, 0.5, 0.0, 0.0, 0.0},
+                                                  {0.2, 0.0, 1.0, 0.0, 0.3}};
+
+        for (const BorderMode border : {BorderMode::Clamp, BorderMode::Mirror, BorderMode::Zero}) {
+            Convolution blur("Blur", separable, border);
+            blur.setTilingOptions(TilingOptions(16, 8));
+            EXPECT_TRUE(blur.isSeparable());
+            EXPECT_LE(maxDifference((*runImageNode(blur, input, 255))[0], reference(separable, border)), 1);
+
+            Convolution generic("Generic", nonSeparable, border);
+            generic.setTilingOptions(TilingOptions(16, 8));
+            EXPECT_FALSE(generic.isSeparable());
+            EXPECT_LE(maxDifference((*runImageNode(generic, input, 255))[0], reference(nonSeparable, border)), 1);
+        }
+
+        Sharpen sharpen("Sharpen", 0.5);
+        EXPECT_FALSE(sharpen.isSeparable());
+
+        EXPECT_THROW(Convolution("Even", {{1.0, 1.0}}), InvalidOperation);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, GaussianBlurBoxApproximation) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: GaussianBlurBoxApproximation" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // The box blurs must reproduce the variance of the Gaussian
+        for (const double sigma : {4.0, 10.0, 37.5}) {
+            double variance = 0.0;
+            for (const int radius : GaussianBlur::boxBlurRadii(sigma, GaussianBlur::boxPasses)) {
+                const double width = 2.0 * radius + 1.0;
+                variance += (width * width - 1.0) / 12.0;
+            }
+            EXPECT_NEAR(std::sqrt(variance), sigma, 0.1 * sigma);
+        }
+
+        GaussianBlur small("Small", 1.5);
+        GaussianBlur large("Large", 25.0);
+        EXPECT_FALSE(small.usesBoxApproximation());
+        EXPECT_TRUE(large.usesBoxApproximation());
+
+        // A blur must leave a constant image unchanged, whatever the radius (mirror/clamp borders)
+        const PPM_Image flat(40, std::vector<channelsT>(60, channelsT{10, 128, 250}));
+        EXPECT_EQ((*runImageNode(large, flat, 255))[0], flat);
+        EXPECT_EQ((*runImageNode(small, flat, 255))[0], flat);
+
+        GaussianBlur mirrored("Mirrored", 80.0, BorderMode::Mirror);
+        EXPECT_EQ((*runImageNode(mirrored, flat, 255))[0], flat);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, Resize) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: Resize" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr int width = 64;
+        constexpr int height = 48;
+        const PPM_Image input = makeGradient(width, height, 255);
+
+        // Halving with the area filter averages 2 x 2 blocks
+        Resize area("Area", width / 2, height / 2, ResizeFilter::Area);
+        const PPM_Image halved = (*runImageNode(area, input, 255))[0];
+        ASSERT_EQ(halved.size(), static_cast<std::size_t>(height / 2));
+        ASSERT_EQ(halved[0].size(), static_cast<std::size_t>(width / 2));
+        for (int y = 0; y < height / 2; ++y) {
+            for (int x = 0; x < width / 2; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const double mean = (input[2 * y][2 * x][c] + input[2 * y][2 * x + 1][c] + input[2 * y + 1][2 * x][c] + input[2 * y + 1][2 * x + 1][c]) / 4.0;
+                    EXPECT_NEAR(halved[y][x][c], mean, 0.51);
+                }
+            }
+        }
+
+        // Nearest copies source pixels
+        Resize nearest("Nearest", 0.5, ResizeFilter::Nearest);
+        const PPM_Image sampled = (*runImageNode(nearest, input, 255))[0];
+        EXPECT_EQ(sampled[3][5], input[7][11]);
+
+        // Interpolating a constant image (up or down) leaves it unchanged
+        const PPM_Image flat(37, std::vector<channelsT>(53, channelsT{3, 77, 201}));
+        Resize upscale("Up", 131, 90, ResizeFilter::Bilinear);
+        Resize downscale("Down", 0.3, ResizeFilter::Area);
+        const PPM_Image up = (*runImageNode(upscale, flat, 255))[0];
+        EXPECT_EQ(up, PPM_Image(90, std::vector<channelsT>(131, channelsT{3, 77, 201})));
+        const PPM_Image down = (*runImageNode(downscale, flat, 255))[0];
+        EXPECT_EQ(down, PPM_Image(11, std::vector<channelsT>(16, channelsT{3, 77, 201})));
+
+        // Downstream nodes see the new size in the metadata
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(1, input));
+        const auto inputMetadata = std::make_shared<PPM_Metadata>(255, width, height);
+        wrappedInput->metadata = inputMetadata;
+        const auto outputData = area.process(std::move(wrappedInput));
+        const auto outputMetadata = std::dynamic_pointer_cast<PPM_Metadata>(outputData->metadata);
+        ASSERT_TRUE(outputMetadata);
+        EXPECT_EQ(outputMetadata->width, width / 2);
+        EXPECT_EQ(outputMetadata->height, height / 2);
+        EXPECT_EQ(inputMetadata->width, width);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ImageStatistics) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ImageStatistics" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr int width = 100;
+        constexpr int height = 200;
+        PPM_Image input(height, std::vector<channelsT>(width));
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                input[y][x] = channelsT{50 + x, 10, (y * width + x) % 256};
+            }
+        }
+
+        // The parallel (per-thread partial histograms) and serial results must match
+        const ImageHistogram parallel = ImageHistogram::compute(input, 255);
+        const ImageHistogram serial = ImageHistogram::compute(input, 255, 1);
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_EQ(parallel.histogram(c), serial.histogram(c));
+        }
+
+        EXPECT_EQ(parallel.count(), static_cast<std::uint64_t>(width * height));
+        EXPECT_EQ(parallel.min(0), 50);
+        EXPECT_EQ(parallel.max(0), 149);
+        EXPECT_DOUBLE_EQ(parallel.mean(0), 99.5);
+        EXPECT_EQ(parallel.min(1), 10);
+        EXPECT_EQ(parallel.max(1), 10);
+        EXPECT_EQ(parallel.percentile(0, 50.0), 99);
+        EXPECT_EQ(parallel.percentile(0, 0.0), 50);
+        EXPECT_EQ(parallel.percentile(0, 100.0), 149);
+
+        // The aggregator reduces the whole batch to one histogram
+        ImageStatistics statistics("Statistics");
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(3, input));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, width, height);
+        const auto outputData = statistics.process(std::move(wrappedInput));
+        const auto output = extractData<ImageHistogram>(outputData);
+        ASSERT_EQ(output->size(), 1u);
+        EXPECT_EQ((*output)[0].count(), 3u * width * height);
+        EXPECT_EQ((*output)[0].histogram(1)[10], 3u * width * height);
+
+        // AutoLevels stretches the red range [50, 149] to [0, 255]
+        AutoLevels autoLevels("AutoLevels", 0.0, true);
+        const PPM_Image stretched = (*runImageNode(autoLevels, input, 255))[0];
+        const ImageHistogram after = ImageHistogram::compute(stretched, 255);
+        EXPECT_EQ(after.min(0), 0);
+        EXPECT_EQ(after.max(0), 255);
+        EXPECT_EQ(stretched[0][0][1], 10); // Single-valued channel left unchanged
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ColorConversion) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ColorConversion" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        constexpr int width = 67;
+        constexpr int height = 40;
+        PPM_Image input = makeGradient(width, height, 255);
+        input[0][0] = channelsT{255, 255, 255};
+        input[0][1] = channelsT{255, 0, 0};
+        input[0][2] = channelsT{0, 0, 255};
+
+        // Runs a conversion node and returns the image and its output metadata
+        const auto convert = [](ColorConversion& node, const PPM_Image& image, const ColorSpace source) {
+            auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(1, image));
+            wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, static_cast<int>(image[0].size()), static_cast<int>(image.size()), source);
+            auto outputData = node.process(std::move(wrappedInput));
+            const auto metadata = std::dynamic_pointer_cast<PPM_Metadata>(outputData->metadata);
+            return std::make_pair((*extractData<PPM_Image>(outputData))[0], metadata->color_space);
+        };
+
+        const auto maxDifference = [](const PPM_Image& a, const PPM_Image& b) {
+            int diff = 0;
+            for (std::size_t y = 0; y < a.size(); ++y) {
+                for (std::size_t x = 0; x < a[y].size(); ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        diff = std::max(diff, std::abs(a[y][x][c] - b[y][x][c]));
+                    }
+                }
+            }
+            return diff;
+        };
+
+        ColorConversion toYCbCr("ToYCbCr", ColorSpace::YCbCr);
+        ColorConversion toHSV("ToHSV", ColorSpace::HSV);
+        ColorConversion toRGB("ToRGB", ColorSpace::RGB);
+
+        const auto ycbcr = convert(toYCbCr, input, ColorSpace::RGB);
+        EXPECT_EQ(ycbcr.second, ColorSpace::YCbCr);
+        EXPECT_EQ(ycbcr.first[0][0], (channelsT{255, 128, 128}));
+        EXPECT_EQ(ycbcr.first[0][1], (channelsT{76, 85, 255}));
+
+        // Reference values of the scalar formula, to check the SIMD path
+        for (int x = 0; x < width; ++x) {
+            const auto& rgb = input[5][x];
+            const double y = 0.299 * rgb[0] + 0.587 * rgb[1] + 0.114 * rgb[2];
+            EXPECT_NEAR(ycbcr.first[5][x][0], y, 1.0);
+        }
+
+        const auto backFromYCbCr = convert(toRGB, ycbcr.first, ColorSpace::YCbCr);
+        EXPECT_EQ(backFromYCbCr.second, ColorSpace::RGB);
+        EXPECT_LE(maxDifference(backFromYCbCr.first, input), 2);
+
+        // 8-bit hue has a resolution of 1.4 degrees: saturated colours may move by a few levels
+        const auto hsv = convert(toHSV, input, ColorSpace::RGB);
+        EXPECT_EQ(hsv.first[0][1], (channelsT{0, 255, 255}));
+        EXPECT_EQ(hsv.first[0][2], (channelsT{171, 255, 255}));
+        EXPECT_LE(maxDifference(convert(toRGB, hsv.first, ColorSpace::HSV).first, input), 3);
+
+        // YCbCr -> HSV goes through RGB
+        const auto hsvFromYCbCr = convert(toHSV, ycbcr.first, ColorSpace::YCbCr);
+        EXPECT_EQ(hsvFromYCbCr.second, ColorSpace::HSV);
+        EXPECT_LE(maxDifference(convert(toRGB, hsvFromYCbCr.first, ColorSpace::HSV).first, input), 4);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, BatchParallelism) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: BatchParallelism" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // Images generated and transformed concurrently must match the serial results, in order
+        std::vector<std::unique_ptr<std::vector<PPM_Image>>> results;
+        for (const std::size_t parallelism : {std::size_t(1), std::size_t(0)}) {
+            PPM_ImagePreset_Source source("Source", 97, 61, 0, 6);
+            source.setBatchParallelism(parallelism);
+            auto generated = source.process(nullptr);
+
+            GainExposure gain("Gain", 0.5, 1.2);
+            gain.setBatchParallelism(parallelism);
+            auto gained = gain.process(std::move(generated));
+
+            Resize resize("Resize", 0.5, ResizeFilter::Area);
+            resize.setBatchParallelism(parallelism);
+            results.push_back(extractData<PPM_Image>(resize.process(std::move(gained))));
+        }
+
+        ASSERT_EQ(results[0]->size(), 6u);
+        EXPECT_EQ(*results[0], *results[1]);
+        EXPECT_EQ((*results[1])[0].size(), 31u);
+    }
+
+    {
+        // The I/O nodes built in place by a Pipeline follow ImageIO::defaultBatchParallelism(). The file of the second
+        // image is taken by a directory: written serially, the batch stops there and the third file is never written
+        const TemporaryDirectory directory;
+        const std::string prefix = directory.path("test_io_parallelism");
+        const auto exists = [](const std::string& filename) { return std::ifstream(filename).good(); };
+        ASSERT_EQ(makeDirectory(prefix + "_1.qoi"), 0);
+
+        const std::size_t previous = ImageIO::defaultBatchParallelism();
+        for (const std::size_t parallelism : {std::size_t(1), std::size_t(0)}) {
+            ImageIO::defaultBatchParallelism() = parallelism;
+            EXPECT_EQ(QOI_Image_Sink("Sink", prefix).getBatchParallelism(), parallelism);
+
+            Pipeline pipeline("I/O parallelism");
+            pipeline.addNode<PPM_ImagePreset_Source>("Source", 16, 16, 0, 3)
+                    .addNode<QOI_Image_Sink>("Sink", prefix);
+            EXPECT_THROW(pipeline.run(), PipeX_IO_Exception);
+            EXPECT_TRUE(exists(prefix + "_0.qoi"));
+            if (parallelism == 1) {
+                EXPECT_FALSE(exists(prefix + "_2.qoi"));
+            } else if (ThreadPool::getThreadPool().concurrency() > 1) {
+                EXPECT_TRUE(exists(prefix + "_2.qoi"));
+            }
+            std::remove((prefix + "_0.qoi").c_str());
+            std::remove((prefix + "_2.qoi").c_str());
+        }
+        ImageIO::defaultBatchParallelism() = previous;
+
+        // An explicit setting overrides the default
+        PPM_Image_Source source("Source", std::vector<std::string>{"a.ppm"});
+        source.setBatchParallelism(2);
+        ImageIO::defaultBatchParallelism() = 1;
+        EXPECT_EQ(source.getBatchParallelism(), 2u);
+        ImageIO::defaultBatchParallelism() = previous;
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ImagePresets) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ImagePresets" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        const auto generate = [](const int width, const int height, const int preset, const int count) {
+            PPM_ImagePreset_Source source("Source", width, height, preset, count);
+            return extractData<PPM_Image>(source.process(nullptr));
+        };
+
+        // Checkerboard: 8 squares along the smallest side
+        const auto checkerboard = generate(160, 80, PPM_ImagePreset_Source::CHECKERBOARD, 1);
+        const PPM_Image& board = (*checkerboard)[0];
+        ASSERT_EQ(board.size(), 80u);
+        EXPECT_EQ(board[0][0], (channelsT{255, 255, 255}));
+        EXPECT_EQ(board[0][10], (channelsT{0, 0, 0}));
+        EXPECT_EQ(board[10][0], (channelsT{0, 0, 0}));
+        EXPECT_EQ(board[79][159], (channelsT{255, 255, 255}));
+
+        // Colour checker: patch centers have the chart colours, borders are black
+        const auto colorCheck = generate(600, 400, PPM_ImagePreset_Source::COLOR_CHECK, 1);
+        const PPM_Image& chart = (*colorCheck)[0];
+        EXPECT_EQ(chart[50][50], (channelsT{115, 82, 68}));
+        EXPECT_EQ(chart[350][550], (channelsT{52, 52, 52}));
+        EXPECT_EQ(chart[0][0], (channelsT{0, 0, 0}));
+        EXPECT_EQ(chart[100][300], (channelsT{0, 0, 0}));
+
+        // Noise: deterministic, different for every image of the batch, roughly uniform over [0, 255]
+        const auto noise = generate(257, 130, PPM_ImagePreset_Source::NOISE, 2);
+        EXPECT_EQ((*noise)[0], (*generate(257, 130, PPM_ImagePreset_Source::NOISE, 1))[0]);
+        EXPECT_NE((*noise)[0], (*noise)[1]);
+
+        const ImageHistogram histogram = ImageHistogram::compute((*noise)[0], 255);
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_EQ(histogram.min(c), 0);
+            EXPECT_EQ(histogram.max(c), 255);
+            EXPECT_NEAR(histogram.mean(c), 127.5, 2.0);
+        }
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, QOI) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: QOI" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // Codec round trip on smooth, flat and incompressible content (runs, index, diff, luma and RGB chunks)
+        for (const int preset : {PPM_ImagePreset_Source::GRADIENT, PPM_ImagePreset_Source::CHECKERBOARD,
+                                 PPM_ImagePreset_Source::COLOR_CHECK, PPM_ImagePreset_Source::NOISE}) {
+            PPM_ImagePreset_Source source("Source", 173, 97, preset, 1);
+            const PPM_Image image = (*extractData<PPM_Image>(source.process(nullptr)))[0];
+
+            std::vector<std::uint8_t> buffer(QOI::maxEncodedSize(173, 97));
+            const std::size_t size = QOI::encode(image, buffer.data());
+            ASSERT_LE(size, buffer.size());
+            EXPECT_EQ(QOI::decode(buffer.data(), size), image) << "preset " << preset;
+
+            // Compressible content is much smaller than a binary PPM (3 bytes per pixel)
+            if (preset != PPM_ImagePreset_Source::NOISE) {
+                EXPECT_LT(size, 173u * 97u * 3u / 2u) << "preset " << preset;
+            }
+        }
+
+        const PPM_Image image = makeGradient(64, 48, 255);
+        std::vector<std::uint8_t> buffer(QOI::maxEncodedSize(64, 48));
+        const std::size_t size = QOI::encode(image, buffer.data());
+        EXPECT_THROW(QOI::decode(buffer.data(), 10), PipeX_IO_Exception);
+        EXPECT_THROW(QOI::decode(buffer.data(), size / 2), PipeX_IO_Exception);
+
+        // Sink -> Source round trip through files
+        std::vector<PPM_Image> images = {image, makeGradient(64, 48, 255)};
+        for (auto& pixel : images[1][10]) {
+            pixel = channelsT{200, 10, 77};
+        }
+
+        const TemporaryDirectory directory;
+        QOI_Image_Sink sink("Sink", directory.path("qoi_test"));
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(images));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, 64, 48);
+        sink.process(std::move(wrappedInput));
+
+        QOI_Image_Source qoiSource("Source", directory.path("qoi_test"), 2);
+        auto loaded = qoiSource.process(nullptr);
+        const auto metadata = std::dynamic_pointer_cast<PPM_Metadata>(loaded->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->width, 64);
+        EXPECT_EQ(metadata->height, 48);
+        EXPECT_EQ(metadata->bit_depth, 255);
+        EXPECT_EQ(*extractData<PPM_Image>(loaded), images);
+
+        // Only 8-bit RGB images can be stored
+        QOI_Image_Sink deepSink("Sink", directory.path("qoi_test"));
+        auto deepInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(1, makeGradient(8, 8, 1023)));
+        deepInput->metadata = std::make_shared<PPM_Metadata>(1023, 8, 8);
+        EXPECT_THROW(deepSink.process(std::move(deepInput)), InvalidOperation);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ImagePyramid) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ImagePyramid" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        const PPM_Image image = makeGradient(67, 48, 255);
+
+        // 67x48, 34x24, 17x12, 9x6, 5x3, 3x2, 2x1, all in one buffer
+        const ImagePyramid box = ImagePyramid::build(image, 0, PyramidFilter::Box);
+        ASSERT_EQ(box.levels(), 7);
+        EXPECT_EQ(ImagePyramid::levelCount(67, 48, 3), 3);
+        EXPECT_EQ(box.width(6), 2);
+        EXPECT_EQ(box.height(6), 1);
+        for (int level = 1; level < box.levels(); ++level) {
+            EXPECT_EQ(box.row(level, 0), box.row(level - 1, 0) + box.stride(level - 1) * box.height(level - 1));
+        }
+
+        // Box levels are 2 x 2 averages (the last column of an odd width is repeated)
+        for (int y = 0; y < box.height(1); ++y) {
+            for (int x = 0; x < box.width(1); ++x) {
+                const int x1 = std::min(2 * x + 1, 66);
+                for (int c = 0; c < 3; ++c) {
+                    const float expected = (image[2 * y][2 * x][c] + image[2 * y][x1][c] + image[2 * y + 1][2 * x][c] + image[2 * y + 1][x1][c]) / 4.0f;
+                    ASSERT_FLOAT_EQ(box.row(1, y)[3 * x + c], expected);
+                }
+            }
+        }
+
+        // The Gaussian filter is normalized: a flat image stays flat at every level
+        const PPM_Image flat(30, std::vector<channelsT>(41, channelsT{10, 100, 250}));
+        const ImagePyramid gaussian = ImagePyramid::build(flat);
+        for (int level = 0; level < gaussian.levels(); ++level) {
+            EXPECT_EQ(gaussian.levelImage(level, 255), PPM_Image(gaussian.height(level), std::vector<channelsT>(gaussian.width(level), channelsT{10, 100, 250})));
+        }
+
+        // PyramidBuilder -> PyramidLevel on a batch
+        PyramidBuilder builder("Pyramid", 3);
+        PyramidLevel pick("Level 2", 2);
+
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(3, image));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, 67, 48);
+        auto output = pick.process(builder.process(std::move(wrappedInput)));
+
+        const auto metadata = std::dynamic_pointer_cast<PPM_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->width, 17);
+        EXPECT_EQ(metadata->height, 12);
+
+        const auto levels = extractData<PPM_Image>(output);
+        ASSERT_EQ(levels->size(), 3u);
+        EXPECT_EQ((*levels)[0], ImagePyramid::build(image, 3).levelImage(2, 255));
+        EXPECT_EQ((*levels)[2], (*levels)[0]);
+
+        PyramidLevel tooDeep("Level 5", 5);
+        auto deepInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(1, image));
+        deepInput->metadata = std::make_shared<PPM_Metadata>(255, 67, 48);
+        EXPECT_THROW(tooDeep.process(builder.process(std::move(deepInput))), InvalidOperation);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// Reference rank filter: value of rank `rank` (0 = min, window size - 1 = max) of every channel over its window
+static PPM_Image bruteForceRank(const PPM_Image& image, const int rx, const int ry, const BorderMode border, const int rank) {
+    const int height = static_cast<int>(image.size());
+    const int width = static_cast<int>(image[0].size());
+    PPM_Image result = image;
+    std::vector<int> values;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int c = 0; c < 3; ++c) {
+                values.clear();
+                for (int dy = -ry; dy <= ry; ++dy) {
+                    for (int dx = -rx; dx <= rx; ++dx) {
+                        const int sy = borderIndex(y + dy, height, border);
+                        const int sx = borderIndex(x + dx, width, border);
+                        values.push_back(sx < 0 || sy < 0 ? 0 : image[sy][sx][c]);
+                    }
+                }
+                std::nth_element(values.begin(), values.begin() + rank, values.end());
+                result[y][x][c] = values[rank];
+            }
+        }
+    }
+    return result;
+}
+
+TEST(ImageNodeTest, MedianAndMorphology) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: MedianAndMorphology" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        PPM_ImagePreset_Source source("Source", 45, 38, PPM_ImagePreset_Source::NOISE, 1);
+        const PPM_Image noise = (*extractData<PPM_Image>(source.process(nullptr)))[0];
+        PPM_Image deep = makeGradient(45, 38, 1023);
+        for (int y = 0; y < 38; y += 3) {
+            deep[y][(y * 7) % 45] = channelsT{1023, 0, 517};
+        }
+
+        const TilingOptions smallTiles(16, 12);
+        for (const BorderMode border : {BorderMode::Clamp, BorderMode::Mirror, BorderMode::Zero}) {
+            for (const int radius : {1, 4}) {
+                const int window = (2 * radius + 1) * (2 * radius + 1);
+
+                // Histogram (8-bit) and selection (deeper images) medians, across tile boundaries
+                EXPECT_EQ(MedianFilter::median(noise, radius, 255, border, smallTiles), bruteForceRank(noise, radius, radius, border, window / 2));
+                EXPECT_EQ(MedianFilter::median(deep, radius, 1023, border, smallTiles), bruteForceRank(deep, radius, radius, border, window / 2));
+
+                // Rectangular minimum and maximum filters
+                const int rx = radius, ry = radius + 2;
+                PPM_Image eroded = noise, dilated = noise;
+                Morphology::minMaxFilter(eroded, rx, ry, false, border);
+                Morphology::minMaxFilter(dilated, rx, ry, true, border);
+                EXPECT_EQ(eroded, bruteForceRank(noise, rx, ry, border, 0));
+                EXPECT_EQ(dilated, bruteForceRank(noise, rx, ry, border, (2 * rx + 1) * (2 * ry + 1) - 1));
+            }
+        }
+
+        // Opening and closing are idempotent; the nodes leave the metadata unchanged
+        for (const MorphologyOperation operation : {MorphologyOperation::Open, MorphologyOperation::Close}) {
+            Morphology morphology("Morphology", operation, 3, 2);
+            const auto once = runImageNode(morphology, noise, 255);
+            const auto twice = runImageNode(morphology, (*once)[0], 255);
+            EXPECT_EQ((*twice)[0], (*once)[0]);
+        }
+
+        MedianFilter medianNode("Median", 2);
+        medianNode.setTilingOptions(smallTiles);
+        EXPECT_EQ((*runImageNode(medianNode, noise, 255))[0], bruteForceRank(noise, 2, 2, BorderMode::Clamp, 12));
+        EXPECT_THROW(MedianFilter("Median", MedianFilter::maxRadius + 1), InvalidOperation);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, PPM16Bit) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: PPM16Bit" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // Codec round trip in both formats, 8 and 16 bits per channel
+        for (const int max_value : {255, 1023, 65535}) {
+            const PPM_Image image = makeGradient(29, 17, max_value);
+            for (const PPM::Format format : {PPM::Format::Plain, PPM::Format::Binary}) {
+                const std::vector<char> buffer = PPM::encode(image, max_value, format);
+                int decodedMax = 0;
+                EXPECT_EQ(PPM::decode(reinterpret_cast<const std::uint8_t*>(buffer.data()), buffer.size(), decodedMax), image);
+                EXPECT_EQ(decodedMax, max_value);
+
+                if (format == PPM::Format::Binary) {
+                    const std::size_t bytes = max_value < 256 ? 1 : 2;
+                    EXPECT_EQ(buffer.size(), std::string("P6\n29 17\n" + std::to_string(max_value) + "\n").size() + 29 * 17 * 3 * bytes);
+                }
+            }
+        }
+
+        // Header comments and 16-bit big-endian samples
+        const std::string handWritten = std::string("P6\n# comment\n1 1\n65535\n") + std::string("\x12\x34\x00\x01\xff\xff", 6);
+        int decodedMax = 0;
+        const PPM_Image pixel = PPM::decode(reinterpret_cast<const std::uint8_t*>(handWritten.data()), handWritten.size(), decodedMax);
+        EXPECT_EQ(pixel[0][0], (channelsT{0x1234, 1, 65535}));
+        EXPECT_THROW(PPM::decode(reinterpret_cast<const std::uint8_t*>(handWritten.data()), handWritten.size() - 1, decodedMax), PipeX_IO_Exception);
+
+        // Huge sizes in the header of a short stream are rejected before the image is allocated
+        for (const std::string& corrupt : {std::string("P6\n2000000000 2000000000\n65535\n\x12\x34"), std::string("P3\n100000 100000\n255\n1 2 3\n"),
+                                           std::string("P3\n1 2\n255\n1 2 3 4 5\n")}) {
+            EXPECT_THROW(PPM::decode(reinterpret_cast<const std::uint8_t*>(corrupt.data()), corrupt.size(), decodedMax), PipeX_IO_Exception) << corrupt;
+        }
+
+        // Sink -> Source round trip of a 16-bit batch: the bit depth travels with the files
+        const std::vector<PPM_Image> images = {makeGradient(31, 9, 65535), makeGradient(31, 9, 65535)};
+        const TemporaryDirectory directory;
+        for (const PPM::Format format : {PPM::Format::Plain, PPM::Format::Binary}) {
+            PPM_Image_Sink sink("Sink", directory.path("ppm16_test"), format);
+            auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(images));
+            wrappedInput->metadata = std::make_shared<PPM_Metadata>(65535, 31, 9);
+            sink.process(std::move(wrappedInput));
+
+            PPM_Image_Source ppmSource("Source", directory.path("ppm16_test"), 2);
+            auto loaded = ppmSource.process(nullptr);
+            const auto metadata = std::dynamic_pointer_cast<PPM_Metadata>(loaded->metadata);
+            ASSERT_NE(metadata, nullptr);
+            EXPECT_EQ(metadata->bit_depth, 65535);
+            EXPECT_EQ(metadata->width, 31);
+            EXPECT_EQ(metadata->height, 9);
+            EXPECT_EQ(*extractData<PPM_Image>(loaded), images);
+        }
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ChannelTypes) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ChannelTypes" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        // Compact storage round trips; 37 pixels wide to cover the scalar tails of the kernels
+        EXPECT_EQ(sizeof(Image8::channel_type), 1u);
+        EXPECT_EQ(sizeof(Image16::channel_type), 2u);
+        const PPM_Image image8 = makeGradient(37, 11, 255);
+        const PPM_Image image16 = makeGradient(37, 11, 65535);
+        EXPECT_EQ(toPPMImage(toImageBuffer<std::uint8_t>(image8, 255)), image8);
+        EXPECT_EQ(toPPMImage(toImageBuffer<std::uint16_t>(image16, 65535)), image16);
+        EXPECT_EQ(toPPMImage(toImageBuffer<float>(image16, 65535), 65535), image16);
+        EXPECT_THROW(toImageBuffer<std::uint8_t>(image16, 65535), InvalidOperation);
+
+        const Image16 wide = toImageBuffer<std::uint16_t>(image16, 65535);
+        const FloatImage widened = toFloatImage(wide);
+        for (std::size_t i = 0; i < wide.data.size(); ++i) {
+            ASSERT_EQ(widened.data[i], static_cast<float>(wide.data[i])) << i;
+        }
+
+        // Float to integer channels: rounded to nearest (ties to even), clamped to [0, max_value]
+        FloatImage values(37, 2);
+        for (std::size_t i = 0; i < values.data.size(); ++i) {
+            values.data[i] = static_cast<float>(i) * 1811.25f - 3000.5f;
+        }
+        for (const int max_value : {200, 65535}) {
+            const Image16 narrowed = fromFloatImage<std::uint16_t>(values, max_value);
+            const Image8 bytes = fromFloatImage<std::uint8_t>(values, std::min(max_value, 255));
+            for (std::size_t i = 0; i < values.data.size(); ++i) {
+                const auto expected = [&values, i](const int hi) {
+                    return static_cast<int>(std::nearbyint(std::min(std::max(values.data[i], 0.0f), static_cast<float>(hi))));
+                };
+                ASSERT_EQ(narrowed.data[i], expected(max_value)) << i;
+                ASSERT_EQ(bytes.data[i], expected(std::min(max_value, 255))) << i;
+            }
+        }
+    }
+
+    {
+        // Point operations: integer channels give the PPM_Image results, float channels follow the same curve
+        const std::vector<int> depths = {255, 1023};
+        for (const int max_value : depths) {
+            const PPM_Image input = makeGradient(37, 11, max_value);
+            GainExposure gain("Gain", 0.7, 1.3);
+            Color2BlackWhite gray("Gray");
+            for (PointOperation* operation : std::vector<PointOperation*>{&gain, &gray}) {
+                const PPM_Image reference = (*runImageNode(*operation, input, max_value))[0];
+
+                if (max_value <= 255) {
+                    Image8 bytes = toImageBuffer<std::uint8_t>(input, max_value);
+                    operation->apply(bytes, max_value);
+                    EXPECT_EQ(toPPMImage(bytes), reference) << operation->getName();
+                }
+                Image16 words = toImageBuffer<std::uint16_t>(input, max_value);
+                operation->apply(words, max_value);
+                EXPECT_EQ(toPPMImage(words), reference) << operation->getName();
+
+                FloatImage floats = toImageBuffer<float>(input, max_value);
+                operation->apply(floats, max_value);
+                EXPECT_LE(maxDifference(toPPMImage(floats, max_value), reference), 1) << operation->getName();
+            }
+        }
+
+        // Between two levels, float channels interpolate the table instead of snapping to a level
+        Invert invert("Invert");
+        FloatImage half(1, 1);
+        half.data = {10.5f, 0.25f, 254.75f};
+        invert.apply(half, 255);
+        EXPECT_FLOAT_EQ(half.data[0], 244.5f);
+        EXPECT_FLOAT_EQ(half.data[1], 254.75f);
+        EXPECT_FLOAT_EQ(half.data[2], 0.25f);
+    }
+
+    {
+        // Convolutions: integer channels give the PPM_Image results; float results are neither rounded nor clamped
+        PPM_Image input(16, std::vector<channelsT>(21));
+        for (int y = 0; y < 16; ++y) {
+            for (int x = 0; x < 21; ++x) {
+                const int v = ((x / 4 + y / 4) % 2) * 255;
+                input[y][x] = channelsT{v, 255 - v, x * 12};
+            }
+        }
+        GaussianBlur blur("Blur", 1.2);
+        Sharpen sharpen("Sharpen", 1.5);
+        for (Convolution* filter : std::vector<Convolution*>{&blur, &sharpen}) {
+            const PPM_Image reference = (*runImageNode(*filter, input, 255))[0];
+            EXPECT_EQ(toPPMImage(filter->apply(toImageBuffer<std::uint8_t>(input, 255), 255)), reference);
+            EXPECT_EQ(toPPMImage(filter->apply(toImageBuffer<std::uint16_t>(input, 255), 255)), reference);
+            EXPECT_EQ(toPPMImage(filter->apply(toImageBuffer<float>(input, 255)), 255), reference);
+        }
+
+        const FloatImage sharpened = sharpen.apply(toImageBuffer<float>(input, 255));
+        EXPECT_LT(*std::min_element(sharpened.data.begin(), sharpened.data.end()), 0.0f);
+        EXPECT_GT(*std::max_element(sharpened.data.begin(), sharpened.data.end()), 255.0f);
+        EXPECT_THROW(blur.apply(toImageBuffer<std::uint16_t>(input, 255), 70000), InvalidOperation);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+/// Runs input_0.ppm and input_1.ppm through Invert, Levels and GaussianBlur on ImageBuffer<ChannelT>, to output_<i>.ppm
+template <typename ChannelT>
+static void runTypedPipeline(const std::string& input, const std::string& output) {
+    Pipeline pipeline("Typed");
+    pipeline.addNode<PPM_ImageBuffer_Source<ChannelT>>("Source", input, 2);
+    pipeline.addNode<TypedPointOperation<Invert, ChannelT>>("Invert");
+    pipeline.addNode<TypedPointOperation<Levels, ChannelT>>("Levels", 0.1, 0.9, 1.8);
+    pipeline.addNode<TypedConvolution<GaussianBlur, ChannelT>>("Blur", 1.2);
+    pipeline.addNode<PPM_ImageBuffer_Sink<ChannelT>>("Sink", output, PPM::Format::Binary);
+    EXPECT_EQ(pipeline.getExecutionPlan(), (std::vector<std::string>{"Source", "fused(Invert + Levels)", "Blur", "Sink"}));
+
+    // A copied pipeline keeps the typed nodes (and their fusion), each running its own program
+    Pipeline copied(pipeline);
+    EXPECT_EQ(copied.getExecutionPlan().size(), 4u);
+    copied.run();
+}
+
+TEST(ImageNodeTest, TypedPipelines) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: TypedPipelines" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    const TemporaryDirectory directory;
+
+    {
+        // The codec reads and writes compact images directly, with the bytes of the PPM_Image path
+        const PPM_Image image = makeGradient(37, 11, 1023);
+        for (const PPM::Format format : {PPM::Format::Plain, PPM::Format::Binary}) {
+            const std::vector<char> buffer = PPM::encode(image, 1023, format);
+            EXPECT_EQ(PPM::encode(toImageBuffer<std::uint16_t>(image, 1023), 1023, format), buffer);
+            EXPECT_EQ(PPM::encode(toImageBuffer<float>(image, 1023), 1023, format), buffer);
+
+            int decodedMax = 0;
+            const auto* data = reinterpret_cast<const std::uint8_t*>(buffer.data());
+            EXPECT_EQ(toPPMImage(PPM::decode<std::uint16_t>(data, buffer.size(), decodedMax)), image);
+            EXPECT_EQ(toPPMImage(PPM::decode<float>(data, buffer.size(), decodedMax), decodedMax), image);
+            EXPECT_THROW(PPM::decode<std::uint8_t>(data, buffer.size(), decodedMax), InvalidOperation);
+        }
+    }
+
+    {
+        // Whole pipelines on uint8, uint16 and float channels match the PPM_Image pipeline
+        for (const int max_value : {255, 1023}) {
+            const std::string input = directory.path("typed_input_" + std::to_string(max_value));
+            PPM_Image_Sink inputSink("Input", input, PPM::Format::Binary);
+            auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(
+                std::vector<PPM_Image>{makeGradient(37, 23, max_value), makeGradient(37, 23, max_value)}));
+            wrappedInput->metadata = std::make_shared<PPM_Metadata>(max_value, 37, 23);
+            inputSink.process(std::move(wrappedInput));
+
+            std::vector<PPM_Image> reference;
+            Pipeline pipeline("Reference");
+            pipeline.addNode<PPM_Image_Source>("Source", input, 2)
+                    .addNode<Invert>("Invert")
+                    .addNode<Levels>("Levels", 0.1, 0.9, 1.8)
+                    .addNode<GaussianBlur>("Blur", 1.2)
+                    .addNode<Sink<PPM_Image, PPM_Metadata>>("Sink", [&reference](std::vector<PPM_Image>& images) {
+                        reference = std::move(images);
+                    });
+            pipeline.run();
+            ASSERT_EQ(reference.size(), 2u);
+
+            const auto readOutput = [&directory](const std::string& output, const int expected_depth) {
+                PPM_Image_Source source("Output", directory.path(output), 2);
+                auto loaded = source.process(nullptr);
+                EXPECT_EQ(std::dynamic_pointer_cast<PPM_Metadata>(loaded->metadata)->bit_depth, expected_depth);
+                return *extractData<PPM_Image>(loaded);
+            };
+
+            if (max_value <= 255) {
+                runTypedPipeline<std::uint8_t>(input, directory.path("typed8"));
+                EXPECT_EQ(readOutput("typed8", max_value), reference);
+            } else {
+                // The Pipeline reports the InvalidOperation of the Source with the name of the node
+                EXPECT_THROW(runTypedPipeline<std::uint8_t>(input, directory.path("typed8")), PipeXException);
+            }
+
+            runTypedPipeline<std::uint16_t>(input, directory.path("typed16"));
+            EXPECT_EQ(readOutput("typed16", max_value), reference);
+
+            // Float channels are rounded once, when written, instead of after every node
+            runTypedPipeline<float>(input, directory.path("typed_float"));
+            const std::vector<PPM_Image> floats = readOutput("typed_float", max_value);
+            ASSERT_EQ(floats.size(), reference.size());
+            for (std::size_t i = 0; i < floats.size(); ++i) {
+                EXPECT_LE(maxDifference(floats[i], reference[i]), 1) << "max_value=" << max_value;
+            }
+        }
+    }
+
+    {
+        // PointOperation::apply compiles a program per call: threads applying one node at different depths do not
+        // interfere with each other
+        const Levels levels("Levels", 0.1, 0.9, 1.8);
+        const std::vector<int> depths = {255, 1023, 4095, 65535};
+        std::vector<Image16> expected;
+        for (const int max_value : depths) {
+            expected.push_back(toImageBuffer<std::uint16_t>(makeGradient(37, 11, max_value), max_value));
+            levels.apply(expected.back(), max_value);
+        }
+
+        std::vector<int> mismatches(depths.size(), 0);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < depths.size(); ++t) {
+            threads.emplace_back([&levels, &depths, &expected, &mismatches, t]() {
+                for (int repeat = 0; repeat < 20; ++repeat) {
+                    Image16 image = toImageBuffer<std::uint16_t>(makeGradient(37, 11, depths[t]), depths[t]);
+                    levels.apply(image, depths[t]);
+                    mismatches[t] += image.data != expected[t].data;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(mismatches, std::vector<int>(depths.size(), 0));
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+TEST(ImageNodeTest, ImageROI) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: ImageROI" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        const PPM_Image image = makeGradient(40, 30, 255);
+
+        // Views read the parent buffer in place, nested crops included
+        const ImageROI whole(image);
+        const ImageROI view = whole.crop(5, 4, 20, 10).crop(2, 1, 8, 6);
+        EXPECT_EQ(view.x0(), 7);
+        EXPECT_EQ(view.y0(), 5);
+        EXPECT_EQ(view.row(0), whole.row(5) + 3 * 7);
+        EXPECT_TRUE(view.isShared());
+
+        PPM_Image expected(6, std::vector<channelsT>(image[0].begin() + 7, image[0].begin() + 15));
+        for (int y = 0; y < 6; ++y) {
+            expected[y].assign(image[5 + y].begin() + 7, image[5 + y].begin() + 15);
+        }
+        EXPECT_EQ(view.toImage(), expected);
+        EXPECT_THROW(whole.crop(35, 0, 10, 10), InvalidOperation);
+
+        // Copy-on-write: writing to a shared view copies its region, the other views are unaffected
+        ImageROI writable = view;
+        writable.mutableRow(0)[0] = 1000;
+        EXPECT_NE(writable.row(0), view.row(0));
+        EXPECT_EQ(view.row(0)[0], image[5][7][0]);
+        EXPECT_EQ(writable.row(0)[0], 1000);
+        EXPECT_EQ(writable.row(1)[3], image[6][8][0]);
+
+        // A view owning its parent is written in place
+        ImageROI owner = ImageROI(image).crop(1, 1, 3, 3);
+        const int* before = owner.row(0);
+        EXPECT_FALSE(owner.isShared());
+        EXPECT_EQ(owner.mutableRow(0), before);
+
+        // Crop -> ROI_PointOperation -> MaterializeROI matches the operation applied to a cropped copy
+        Crop crop("Crop", 7, 5, 8, 6);
+        ROI_PointOperation invertROI("Invert ROI", Invert("Invert"));
+        MaterializeROI materialize("Materialize");
+
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(2, image));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, 40, 30);
+        auto output = materialize.process(invertROI.process(crop.process(std::move(wrappedInput))));
+
+        const auto metadata = std::dynamic_pointer_cast<PPM_Metadata>(output->metadata);
+        ASSERT_NE(metadata, nullptr);
+        EXPECT_EQ(metadata->width, 8);
+        EXPECT_EQ(metadata->height, 6);
+
+        Invert invert("Invert");
+        const auto reference = runImageNode(invert, expected, 255);
+        const auto results = extractData<PPM_Image>(output);
+        ASSERT_EQ(results->size(), 2u);
+        EXPECT_EQ((*results)[0], (*reference)[0]);
+        EXPECT_EQ((*results)[1], (*reference)[0]);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =====================================================================================================================
+TEST(ImageNodeTest, TemporalFilters) {
+    std::cout << "======================================================================" << std::endl;
+    std::cout << "ImageNodeTest test: TemporalFilters" << std::endl;
+
+    // Sequence of 7 frames: a gradient whose channels grow by 3 * t, plus a bright square moving right
+    const int width = 12, height = 9;
+    std::vector<PPM_Image> frames;
+    for (int t = 0; t < 7; ++t) {
+        PPM_Image frame = makeGradient(width, height, 200);
+        for (auto& row : frame) {
+            for (auto& pixel : row) {
+                for (int c = 0; c < 3; ++c) {
+                    pixel[c] += 3 * t;
+                }
+            }
+        }
+        for (int y = 3; y < 6; ++y) {
+            for (int x = t; x < t + 3; ++x) {
+                frame[y][x] = {{255, 255, 255}};
+            }
+        }
+        frames.push_back(frame);
+    }
+
+    const auto run = [&](INode& node, const std::size_t begin, const std::size_t end) {
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(frames.begin() + begin, frames.begin() + end));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, width, height);
+        return extractData<PPM_Image>(node.process(std::move(wrappedInput)));
+    };
+
+    {
+        // Average of the last 3 frames, streamed in two batches
+        TemporalAverage average("TemporalAverage", 3);
+        auto first = run(average, 0, 4);
+        auto second = run(average, 4, 7);
+        first->insert(first->end(), second->begin(), second->end());
+        ASSERT_EQ(first->size(), frames.size());
+
+        for (std::size_t t = 0; t < frames.size(); ++t) {
+            const std::size_t t0 = t >= 2 ? t - 2 : 0;
+            const int count = static_cast<int>(t - t0 + 1);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        int sum = 0;
+                        for (std::size_t k = t0; k <= t; ++k) {
+                            sum += frames[k][y][x][c];
+                        }
+                        ASSERT_EQ((*first)[t][y][x][c], (2 * sum + count) / (2 * count)) << "t=" << t << " x=" << x << " y=" << y;
+                    }
+                }
+            }
+        }
+
+        // reset() starts a new sequence: the next frame is its own average
+        average.reset();
+        const auto restarted = run(average, 5, 6);
+        EXPECT_EQ((*restarted)[0], frames[5]);
+
+        // The sequence streamed from files in blocks of 3 frames: the pipeline runs once per block and holds at most
+        // one block, the filter restarts with every run
+        const TemporaryDirectory directory;
+        PPM_Image_Sink writer("Writer", directory.path("sequence"));
+        auto wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(frames));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, width, height);
+        writer.process(std::move(wrappedInput));
+        QOI_Image_Sink qoiWriter("Writer", directory.path("sequence"));
+        wrappedInput = wrapData<PPM_Image>(extended_std::make_unique<std::vector<PPM_Image>>(frames));
+        wrappedInput->metadata = std::make_shared<PPM_Metadata>(255, width, height);
+        qoiWriter.process(std::move(wrappedInput));
+
+        for (const bool qoi : {false, true}) {
+            std::vector<std::size_t> blockSizes;
+            std::vector<PPM_Image> streamed;
+            Pipeline pipeline("Streamed sequence");
+            if (qoi) {
+                pipeline.addNode<QOI_Image_Source>("Source", directory.path("sequence"), 7, 3);
+            } else {
+                pipeline.addNode<PPM_Image_Source>("Source", directory.path("sequence"), 7, 3);
+            }
+            pipeline.addNode<TemporalAverage>("TemporalAverage", 3)
+                    .addNode<Sink<PPM_Image, PPM_Metadata>>("Sink", [&](std::vector<PPM_Image>& images) {
+                        blockSizes.push_back(images.size());
+                        streamed.insert(streamed.end(), images.begin(), images.end());
+                    });
+            for (int repeat = 0; repeat < 2; ++repeat) {
+                blockSizes.clear();
+                streamed.clear();
+                pipeline.run();
+                EXPECT_EQ(blockSizes, (std::vector<std::size_t>{3, 3, 1})) << "qoi=" << qoi;
+                EXPECT_EQ(streamed, *first) << "qoi=" << qoi << " run " << repeat;
+            }
+        }
+
+        // A braced list of names with a block size is a list of files, not a (filename, count) pair
+        PPM_Image_Source listed("Source", {"missing_a.ppm", "missing_b.ppm"}, 1);
+        try {
+            listed.process(nullptr);
+            ADD_FAILURE() << "missing file read";
+        } catch (const PipeX_IO_Exception& e) {
+            EXPECT_NE(std::string(e.what()).find("missing_a.ppm"), std::string::npos) << e.what();
+        }
+    }
+
+    {
+        FrameDifference difference("FrameDifference");
+        const auto output = run(difference, 0, 7);
+        for (std::size_t t = 0; t < frames.size(); ++t) {
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        const int expected = t == 0 ? 0 : std::abs(frames[t][y][x][c] - frames[t - 1][y][x][c]);
+                        ASSERT_EQ((*output)[t][y][x][c], expected);
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        // The background drifts by 3 per frame, below the threshold: only the moving square may be detected
+        MotionDetection motion("MotionDetection", 20, 2);
+        const auto output = run(motion, 0, 7);
+        int detected = 0;
+        for (std::size_t t = 0; t < frames.size(); ++t) {
+            const std::size_t t0 = t >= 2 ? t - 2 : 0;
+            const int count = static_cast<int>(t - t0);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    bool moving = false;
+                    for (int c = 0; c < 3; ++c) {
+                        int sum = 0;
+                        for (std::size_t k = t0; k < t; ++k) {
+                            sum += frames[k][y][x][c];
+                        }
+                        moving = moving || (count > 0 && std::abs(frames[t][y][x][c] * count - sum) > 20 * count);
+                    }
+                    const auto& pixel = (*output)[t][y][x];
+                    ASSERT_EQ(pixel[0], moving ? 255 : 0) << "t=" << t << " x=" << x << " y=" << y;
+                    EXPECT_EQ(pixel[1], pixel[0]);
+                    EXPECT_EQ(pixel[2], pixel[0]);
+                    if (moving) {
+                        EXPECT_TRUE(y >= 3 && y < 6);
+                        ++detected;
+                    }
+                }
+            }
+        }
+        EXPECT_GT(detected, 0);
+    }
+
+    EXPECT_THROW(TemporalAverage("TemporalAverage", 0), InvalidOperation);
+    EXPECT_THROW(MotionDetection("MotionDetection", -1), InvalidOperation);
+
+    std::cout << "======================================================================" << std::endl;
+
+}
@@ -69,6 +69,44 @@ TEST(NodeTest, Transformer) {
 
 // =========================================================================================================
 
+TEST(NodeTest, TransformerBatchParallelism) {
+    std::cout << "\n======================================================================" << std::endl;
+    std::cout << "NodeTest test: TransformerBatchParallelism" << std::endl;
+    std::cout << "======================================================================" << std::endl;
+
+    {
+        auto squareFunction = [](const int& data) {
+            return static_cast<long long>(data) * data;
+        };
+
+        Transformer<int, long long> transformer(squareFunction);
+        transformer.setBatchParallelism(0);
+        EXPECT_EQ(transformer.getBatchParallelism(), 0u);
+
+        std::vector<int> inputData;
+        std::vector<long long> expectedOutput;
+        for (int i = 0; i < 1000; ++i) {
+            inputData.push_back(i);
+            expectedOutput.push_back(static_cast<long long>(i) * i);
+        }
+
+        // Items are transformed concurrently but the output keeps the input order
+        auto wrappedInput = wrapData<int>(extended_std::make_unique<std::vector<int>>(inputData));
+        auto outputData = transformer.process(std::move(wrappedInput));
+        const auto extractedOutput = PipeX::extractData<long long>(outputData);
+        EXPECT_EQ(*extractedOutput, expectedOutput);
+
+        // Copies keep the setting
+        const Transformer<int, long long> copy(transformer);
+        EXPECT_EQ(copy.getBatchParallelism(), 0u);
+    }
+
+    std::cout << "======================================================================" << std::endl;
+
+}
+
+// =========================================================================================================
+
 TEST(NodeTest, Processor) {
     std::cout << "\n======================================================================" << std::endl;
     std::cout << "NodeTest test: Processor" << std::endl;
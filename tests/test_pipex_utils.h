@@ -0,0 +1,99 @@
+//
+// Created by Matteo Ranzi on 19/10/26.
+//
+
+#ifndef PIPEX_TEST_PIPEX_UTILS_H
+#define PIPEX_TEST_PIPEX_UTILS_H
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <io.h>
+#include <process.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int makeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    return _mkdir(path.c_str());
+#else
+    return mkdir(path.c_str(), 0755);
+#endif
+}
+
+/**
+ * @brief Directory for the files written by a test, removed with its content at the end of the scope.
+ *
+ * Tests must not depend on the working directory (ctest runs them from the build tree): the directory is created
+ * under the system temporary directory, named after the running test and the process. Only the files and the empty
+ * directories directly inside it are removed.
+ */
+class TemporaryDirectory {
+public:
+    TemporaryDirectory() {
+        const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+#if defined(_WIN32)
+        const int pid = _getpid();
+#else
+        const int pid = static_cast<int>(getpid());
+#endif
+        path_ = ::testing::TempDir() + "pipex_" + (test ? std::string(test->test_suite_name()) + "_" + test->name() : std::string("test")) + "_"
+                + std::to_string(pid);
+        removeAll();
+        makeDirectory(path_);
+    }
+
+    ~TemporaryDirectory() {
+        removeAll();
+    }
+
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief Path of a file (or file prefix) in the directory.
+     */
+    std::string path(const std::string& name) const { return path_ + "/" + name; }
+
+private:
+    std::string path_;
+
+    void removeAll() const {
+#if defined(_WIN32)
+        _finddata_t entry;
+        const intptr_t handle = _findfirst((path_ + "/*").c_str(), &entry);
+        if (handle != -1) {
+            do {
+                const std::string name = entry.name;
+                if (name != "." && name != "..") {
+                    (entry.attrib & _A_SUBDIR) ? _rmdir(path(name).c_str()) : std::remove(path(name).c_str());
+                }
+            } while (_findnext(handle, &entry) == 0);
+            _findclose(handle);
+        }
+        _rmdir(path_.c_str());
+#else
+        if (DIR* dir = opendir(path_.c_str())) {
+            while (const dirent* entry = readdir(dir)) {
+                const std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    std::remove(path(name).c_str());
+                }
+            }
+            closedir(dir);
+        }
+        rmdir(path_.c_str());
+#endif
+    }
+};
+
+#endif //PIPEX_TEST_PIPEX_UTILS_H